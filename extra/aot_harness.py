@@ -0,0 +1,65 @@
+## Runs the test scripts interpreted and with the native module written by
+## `carbon --aot` and checks that the outputs are the same.
+##
+## USAGE:
+##   python extra/aot_harness.py path/to/carbon [script.cb ...]
+##
+## the scripts default to tests/*.cb and tests/test_files/*.cb, the modules are
+## built with $CXX (default c++) and $CXXFLAGS which should have the defines the
+## carbon binary is built with (ex: -DDEBUG_BUILD). the binary should export
+## it's symbols to the modules (linked with -rdynamic).
+
+import os, sys, glob
+import subprocess, tempfile
+
+CARBON_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), '..'))
+
+def run(cmd):
+	proc = subprocess.run(cmd, input=b'', stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+	return proc.returncode, proc.stdout
+
+def check_script(carbon, script, build_dir):
+	name = os.path.splitext(os.path.basename(script))[0]
+	src = os.path.join(build_dir, name + '_aot.cpp')
+	lib = os.path.join(build_dir, name + '_aot.so')
+
+	code, out = run([carbon, '--aot', src, script])
+	if code != 0 or not os.path.exists(src):
+		return 'can\'t write the module\n' + out.decode(errors='replace')
+
+	cxx = os.environ.get('CXX', 'c++')
+	flags = os.environ.get('CXXFLAGS', '').split()
+	code, out = run([cxx, '-shared', '-fPIC', '-std=c++11', '-w', '-I', os.path.join(CARBON_DIR, 'include')] + flags + [src, '-o', lib])
+	if code != 0:
+		return 'can\'t build the module\n' + out.decode(errors='replace')
+
+	expected = run([carbon, '--no-predecode', script])
+	native = run([carbon, '--no-predecode', '--load', lib, script])
+	if expected != native:
+		return 'outputs are different\n--- interpreted\n%s\n--- native\n%s' % (
+			expected[1].decode(errors='replace'), native[1].decode(errors='replace'))
+	return None
+
+def main():
+	if len(sys.argv) < 2:
+		print('usage: python aot_harness.py path/to/carbon [script.cb ...]')
+		exit(-1)
+	carbon = os.path.abspath(sys.argv[1])
+	scripts = sys.argv[2:]
+	if len(scripts) == 0:
+		scripts = sorted(glob.glob(os.path.join(CARBON_DIR, 'tests/*.cb')) + glob.glob(os.path.join(CARBON_DIR, 'tests/test_files/*.cb')))
+
+	failed = 0
+	with tempfile.TemporaryDirectory() as build_dir:
+		for script in scripts:
+			error = check_script(carbon, os.path.abspath(script), build_dir)
+			if error is None:
+				print('[*]: OK     - %s' % script)
+			else:
+				print('[*]: FAILED - %s : %s' % (script, error))
+				failed += 1
+	print('[*]: %i of %i scripts failed.' % (failed, len(scripts)))
+	exit(1 if failed else 0)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,49 @@
+## Compiles generated files with increasing number of members and prints the
+## parse and analyze time of each with `carbon --bench-compile`, the time per
+## member should stay about the same as the files grow (the name lookups are hashed).
+##
+## USAGE:
+##   python extra/bench_analyzer.py path/to/carbon [count ...]
+##
+## the counts default to 500 1000 2000 4000 8000 (members of the class and of the
+## file, each function refers the members by name).
+
+import os, sys, re
+import subprocess, tempfile
+
+def generate(count):
+	src = 'class Aclass {\n'
+	for i in range(count):
+		src += '\tvar m%i = %i;\n' % (i, i)
+	for i in range(count):
+		src += '\tfunc f%i(a) { return this.m%i + m%i + a; }\n' % (i, i, count - 1 - i)
+	src += '}\n\n'
+	for i in range(count):
+		src += 'var g%i = %i;\n' % (i, i)
+	for i in range(count):
+		src += 'func h%i(a) { var x = g%i; return x + g%i + h%i(a); }\n' % (i, i, count - 1 - i, (i + 1) % count)
+	src += '\nfunc main() {}\n'
+	return src
+
+def main():
+	if len(sys.argv) < 2:
+		print('USAGE: python extra/bench_analyzer.py path/to/carbon [count ...]')
+		return 1
+	carbon = sys.argv[1]
+	counts = [int(c) for c in sys.argv[2:]] or [500, 1000, 2000, 4000, 8000]
+
+	with tempfile.TemporaryDirectory() as tmp:
+		for count in counts:
+			path = os.path.join(tmp, 'members_%i.cb' % count)
+			with open(path, 'w') as f:
+				f.write(generate(count))
+			out = subprocess.run([carbon, '--bench-compile', path], stdout=subprocess.PIPE).stdout.decode()
+			parse = float(re.search(r'parse: ([0-9.]+) ms', out).group(1))
+			analyze = float(re.search(r'analyze: ([0-9.]+) ms', out).group(1))
+			compile = float(re.search(r'\(([0-9.]+) ms per compile\)', out).group(1))
+			print('%6i members : parse %8.2f ms, analyze %8.2f ms (%6.2f us/member), compile %9.2f ms' % (
+				count, parse, analyze, analyze * 1000 / (count * 2), compile))
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,65 @@
+## Compiles a generated import graph cold with `carbon --jobs N` for increasing N
+## and prints the wall time of each, the independent modules of the graph are
+## compiled in parallel so the time should go down up to the core count.
+##
+## USAGE:
+##   python extra/bench_imports.py path/to/carbon [modules] [functions]
+##
+## the graph has the given modules (default 32) in layers of 8, each importing
+## two modules of the layer below and having the given functions (default 300).
+
+import os, sys, time
+import subprocess, tempfile
+
+LAYER = 8
+
+def generate(dir, modules, functions):
+	for i in range(modules):
+		layer = i // LAYER
+		src = ''
+		imports = []
+		if layer > 0:
+			below = range((layer - 1) * LAYER, layer * LAYER)
+			imports = [below[i % LAYER], below[(i + 1) % LAYER]]
+			for m in imports:
+				src += 'import m%i = "m%i.cb";\n' % (m, m)
+		for f in range(functions):
+			src += 'func f%i(a, b) { var x = a * %i; for (var i : [1, 2, 3]) { x += i * b; } return x; }\n' % (f, f)
+		src += 'func value() { return f0(1, 2)%s; }\n' % ''.join(' + m%i.value()' % m for m in imports)
+		with open(os.path.join(dir, 'm%i.cb' % i), 'w') as file:
+			file.write(src)
+
+	last = range(((modules - 1) // LAYER) * LAYER, modules)
+	src = ''.join('import m%i = "m%i.cb";\n' % (m, m) for m in last)
+	src += 'func main() { print(%s); }\n' % ' + '.join('m%i.value()' % m for m in last)
+	path = os.path.join(dir, 'main.cb')
+	with open(path, 'w') as file:
+		file.write(src)
+	return path
+
+def main():
+	if len(sys.argv) < 2:
+		print('USAGE: python extra/bench_imports.py path/to/carbon [modules] [functions]')
+		return 1
+	carbon = sys.argv[1]
+	modules = int(sys.argv[2]) if len(sys.argv) > 2 else 32
+	functions = int(sys.argv[3]) if len(sys.argv) > 3 else 300
+
+	with tempfile.TemporaryDirectory() as tmp:
+		path = generate(tmp, modules, functions)
+		jobs, expected = 1, None
+		while True:
+			begin = time.time()
+			out = subprocess.run([carbon, '--jobs', str(jobs), path], stdout=subprocess.PIPE).stdout
+			seconds = time.time() - begin
+			if expected is not None and out != expected:
+				print('output with %i jobs is different' % jobs)
+				return 1
+			expected = out
+			print('%3i jobs : %8.2f ms' % (jobs, seconds * 1000))
+			if jobs >= (os.cpu_count() or 1): break
+			jobs *= 2
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
@@ -0,0 +1,67 @@
+## Runs a generated program with `carbon --cache-dir` without it's .cbc files
+## (they're compiled and written) and with them (they're loaded instead of
+## compiled) and prints the mean wall time of each.
+##
+## USAGE:
+##   python extra/bench_startup.py path/to/carbon [modules] [functions] [runs]
+##
+## the program has the given modules (default 8) each having the given functions
+## (default 300), the runs (default 5) of each are averaged.
+
+import os, sys, time, shutil
+import subprocess, tempfile
+
+def generate(dir, modules, functions):
+	for i in range(modules):
+		src = ''
+		for f in range(functions):
+			src += 'func f%i(a, b) { var x = a * %i; for (var i : [1, 2, 3]) { x += i * b; } return x; }\n' % (f, f)
+		src += 'func value() { return f0(1, 2) + f%i(3, 4); }\n' % (functions - 1)
+		with open(os.path.join(dir, 'm%i.cb' % i), 'w') as file:
+			file.write(src)
+
+	src = ''.join('import m%i = "m%i.cb";\n' % (m, m) for m in range(modules))
+	src += 'func main() { print(%s); }\n' % ' + '.join('m%i.value()' % m for m in range(modules))
+	path = os.path.join(dir, 'main.cb')
+	with open(path, 'w') as file:
+		file.write(src)
+	return path
+
+def run(carbon, cache, path):
+	begin = time.time()
+	out = subprocess.run([carbon, '--cache-dir', cache, path], stdout=subprocess.PIPE).stdout
+	return time.time() - begin, out
+
+def main():
+	if len(sys.argv) < 2:
+		print('USAGE: python extra/bench_startup.py path/to/carbon [modules] [functions] [runs]')
+		return 1
+	carbon = sys.argv[1]
+	modules = int(sys.argv[2]) if len(sys.argv) > 2 else 8
+	functions = int(sys.argv[3]) if len(sys.argv) > 3 else 300
+	runs = int(sys.argv[4]) if len(sys.argv) > 4 else 5
+
+	with tempfile.TemporaryDirectory() as tmp:
+		path = generate(tmp, modules, functions)
+		cache = os.path.join(tmp, 'cache')
+
+		cold, hit, expected = 0, 0, None
+		for i in range(runs):
+			shutil.rmtree(cache, ignore_errors=True)
+			os.mkdir(cache)
+			seconds, out = run(carbon, cache, path)
+			cold += seconds
+			seconds, cached_out = run(carbon, cache, path)
+			hit += seconds
+			if out != cached_out or (expected is not None and out != expected):
+				print('output of the cached run is different')
+				return 1
+			expected = out
+
+		size = sum(os.path.getsize(os.path.join(cache, f)) for f in os.listdir(cache))
+		print('cold : %8.2f ms' % (cold * 1000 / runs))
+		print('hit  : %8.2f ms (%i bytes of .cbc)' % (hit * 1000 / runs, size))
+	return 0
+
+if __name__ == '__main__':
+	sys.exit(main())
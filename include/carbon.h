@@ -53,11 +53,14 @@
 #include "compiler/tokenizer.h"
 #include "compiler/parser.h"
 #include "compiler/analyzer.h"
+#include "compiler/ir.h"
 #include "compiler/codegen.h"
 #include "compiler/vm.h"
 #include "compiler/compiler.h"
+#include "compiler/aot.h"
 #include "compiler/function.h"
 #include "compiler/bytecode.h"
+#include "compiler/bytecode_cache.h"
 
 
 namespace carbon {
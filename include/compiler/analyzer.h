@@ -42,12 +42,17 @@ public:
 private:
 	friend class CodeGen;
 	ptr<Parser> parser;
-	ptr<Parser::FileNode> file_node; // Quick access.
+	Parser::FileNode* file_node = nullptr; // Quick access.
 	stdvec<Warning> warnings;
 
+	// flow-sensitive constant values of the local variables (primitives only) in the
+	// function being reduced, an identifier of a known local is reduced to it's value.
+	stdmap<const Parser::VarNode*, var> _local_consts;
+	bool _propagate_locals = true;
+
 	template<typename T = Parser::Node, typename... Targs>
-	ptr<T> new_node(Targs... p_args) {
-		ptr<T> ret = newptr<T>(p_args...);
+	T* new_node(Targs... p_args) {
+		T* ret = parser->alloc_node<T>(p_args...);
 		return ret;
 	}
 
@@ -55,10 +60,10 @@ private:
 	 void _analyzer_warning(Warning::Type p_type, const String& p_msg, Vect2i p_pos, const DBGSourceInfo& p_dbg_info);
 
 	var _call_compiletime_func(Parser::BuiltinFunctionNode* p_func, stdvec<var*>& args);
-	void _resolve_compiletime_funcs(const ptr<Parser::CallNode>& p_func);
+	void _resolve_compiletime_funcs(Parser::CallNode* p_func);
 
-	void _check_identifier(ptr<Parser::Node>& p_expr);
-	void _check_member_var_shadow(void* p_base, Parser::ClassNode::BaseType p_base_type, stdvec<ptr<Parser::VarNode>>& p_vars);
+	void _check_identifier(Parser::Node*& p_expr);
+	void _check_member_var_shadow(void* p_base, Parser::ClassNode::BaseType p_base_type, stdvec<Parser::VarNode*>& p_vars);
 	void _check_operator_methods(const Parser::FunctionNode* p_func);
 	void _check_super_constructor_call(const Parser::BlockNode* p_block);
 	void _check_arg_count(int p_argc, int p_default_argc, int p_args_given, Vect2i p_err_pos = Vect2i(0, 0));
@@ -67,12 +72,50 @@ private:
 	void _resolve_constant(Parser::ConstNode* p_const);
 	void _resolve_parameters(Parser::FunctionNode* p_func);
 	void _resolve_enumvalue(Parser::EnumValueNode& p_enumvalue, int* p_possible = nullptr);
+	void _resolve_const_func(Parser::FunctionNode* p_func);
+
+	void _reduce_expression(Parser::Node*& p_expr);
+	void _reduce_block(Parser::BlockNode*& p_block);
+	void _reduce_identifier(Parser::Node*& p_expr);
+	void _reduce_call(Parser::Node*& p_expr);
+	const Parser::FunctionNode* _find_direct_target(const String& p_name, bool p_method) const;
+	void _reduce_indexing(Parser::Node*& p_expr);
+
+	// type annotations of the locals, parameters and return values. a value known to be of another type is an
+	// error (a constant int is converted to a float), the others are checked at runtime (CHECK_TYPE).
+	var::Type _get_declared_type(const Parser::Node* p_expr) const;
+	var::Type _get_expression_type(const Parser::Node* p_expr) const;
+	void _check_type(var::Type p_type, Parser::Node*& p_expr);
+	void _check_var_type(Parser::VarNode* p_var);
+
+	void _set_local_const(const Parser::VarNode* p_var, Parser::Node* p_value);
+	void _merge_local_consts(const stdmap<const Parser::VarNode*, var>& p_other);
+	void _invalidate_local_consts(const Parser::Node* p_node); // invalidate locals written in an unreduced node.
+	static void _collect_written_names(const Parser::Node* p_node, stdvec<String>& r_names);
+
+	// evaluation of const functions (pure user functions) called with constant arguments.
+	struct _ConstFuncFrame {
+		const Parser::FunctionNode* func = nullptr;
+		stdvec<var> args;
+		stdmap<const Parser::VarNode*, var> locals;
+		var ret;
+	};
+	enum _ConstFuncFlow {
+		CF_FLOW_NEXT,
+		CF_FLOW_BREAK,
+		CF_FLOW_CONTINUE,
+		CF_FLOW_RETURN,
+	};
+	int _const_func_steps = 0;
+	int _const_func_depth = 0;
 
-	void _reduce_expression(ptr<Parser::Node>& p_expr);
-	void _reduce_block(ptr<Parser::BlockNode>& p_block);
-	void _reduce_identifier(ptr<Parser::Node>& p_expr);
-	void _reduce_call(ptr<Parser::Node>& p_expr);
-	void _reduce_indexing(ptr<Parser::Node>& p_expr);
+	void _check_const_func(const Parser::FunctionNode* p_func, const Parser::Node* p_node);
+	const Parser::FunctionNode* _find_const_func_target(const Parser::CallNode* p_call) const;
+	bool _reduce_const_func_call(Parser::Node*& p_expr, const Parser::FunctionNode* p_func, bool p_all_const);
+	var _const_func_call(const Parser::FunctionNode* p_func, stdvec<var>& p_args, Vect2i p_pos);
+	_ConstFuncFlow _const_func_block(_ConstFuncFrame& p_frame, const Parser::BlockNode* p_block);
+	var _const_func_expr(_ConstFuncFrame& p_frame, const Parser::Node* p_expr);
+	var* _const_func_local(_ConstFuncFrame& p_frame, const Parser::Node* p_expr);
 
 
 	Parser::IdentifierNode _find_member(const Parser::MemberContainer* p_member, const String& p_name);
@@ -0,0 +1,73 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef AOT_H
+#define AOT_H
+
+#include "predecode.h"
+
+namespace carbon {
+
+class Bytecode;
+
+// The native code of the functions of a file written ahead of time. The
+// instructions PredecodedFunction builds are written as C++ (with the operands
+// resolved to the frame and the jumps to labels) and the module built from it
+// is loaded by the compiler in place of the predecoded form of the functions it
+// has, anything else still falls back to the interpreter.
+//
+//     carbon --aot main_aot.cpp main.cb
+//     c++ -shared -fPIC -std=c++11 -I<carbon>/include main_aot.cpp -o main_aot.so
+//     carbon --load main_aot.so main.cb
+class AOTModule {
+public:
+	// the "carbon_aot_module" symbol of a module, adds it's functions to p_module.
+	typedef void (*ModuleFunc)(AOTModule* p_module);
+
+	static String write(Bytecode* p_bytecode);       // source of the module for the file and it's classes.
+	static ptr<AOTModule> load(const String& p_path);
+
+	void add(const char* p_name, uint32_t p_hash, PredecodedNativeFunc p_func);
+	uint32_t apply(Bytecode* p_bytecode) const;      // returns the number of functions replaced.
+	uint32_t get_function_count() const { return (uint32_t)_functions.size(); }
+
+	// the native code is only valid for the same opcodes it was written from.
+	static uint32_t hash(const Function* p_func);
+
+private:
+	struct _NativeFunc {
+		uint32_t hash = 0;
+		PredecodedNativeFunc func = nullptr;
+	};
+	stdmap<String, _NativeFunc> _functions; // qualified name (Class.method) -> native code.
+
+	// the functions of the file and it's classes by their qualified names.
+	static void _get_functions(Bytecode* p_bytecode, stdvec<std::pair<String, const Function*>>& r_functions);
+	static String _write_function(const PredecodedFunction* p_predecoded, const String& p_symbol);
+};
+
+}
+
+#endif // AOT_H
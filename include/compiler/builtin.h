@@ -94,6 +94,11 @@ namespace carbon {
 			MATH_MIN,
 			MATH_MAX,
 			MATH_POW,
+			MATH_ABS,
+			MATH_FLOOR,
+			MATH_SQRT,
+
+			LEN,
 
 			_FUNC_MAX_,
 		};
@@ -110,6 +115,10 @@ namespace carbon {
 		static bool can_const_fold(Type p_func);
 		static bool is_compiletime(Type p_func);
 		static void call(Type p_func, const stdvec<var*>& p_args, var& r_ret);
+
+		// fixed arity builtin calls (min(a, b), abs(x), ...) lowered to the CALL_INTRINSIC opcode.
+		static bool is_intrinsic(Type p_func, int p_argc);
+		static void call_intrinsic(Type p_func, const var& p_arg0, const var& p_arg1, var& r_ret);
 	};
 
 }
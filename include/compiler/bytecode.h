@@ -38,6 +38,12 @@ class Bytecode : public Object, public std::enable_shared_from_this<Bytecode> {
 	friend class CodeGen;
 	friend struct CGContext;
 	friend class Function;
+	friend class IRFunction;
+	friend class IRScalarReplacePass;
+	friend class VM;
+	friend struct RuntimeContext;
+	friend class _BytecodeWriter;
+	friend class _BytecodeReader;
 
 private: // members.
 	bool _is_class = false;
@@ -64,6 +70,7 @@ private: // members.
 	stdvec<String> _global_names_array;
 	stdmap<String, uint32_t> _global_names;
 	stdvec<var> _global_const_values;
+	stdvec<Function*> _direct_functions;     // targets of CALL_DIRECT of this file (owned by it's bytecodes).
 
 	bool _member_info_built = false;          // set to true after _member_info is built
 	stdmap<size_t, ptr<MemberInfo>> _member_info;
@@ -127,11 +134,13 @@ public:
 
 	const String& get_global_name(uint32_t p_pos);
 	var* get_global_const_value(uint32_t p_index);
+	Function* get_direct_function(uint32_t p_index) const;
 
 private:
 	uint32_t _global_name_get(const String& p_name);
 	void _build_global_names_array();
 	uint32_t _global_const_value_get(const var& p_value);
+	uint32_t _global_const_value_add(const var& p_value); // [1] and [1.0] are equal but not the same.
 
 };
 
@@ -0,0 +1,63 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef BYTECODE_CACHE_H
+#define BYTECODE_CACHE_H
+
+#include "var/var.h"
+
+namespace carbon {
+
+class Bytecode;
+class Function;
+
+// A compiled file written as a .cbc (next to it's source or in a cache dir, see
+// Compiler::set_bytecode_cache()) and loaded instead of compiling the file again
+// while it's still valid: the hash of the source and the hashes of it's imports
+// are written in the header. The opcodes refer to the names, constants and direct
+// functions by their indices so they're written as they are, a class refers to
+// it's base by name and an import by it's path which is compiled (or loaded)
+// before the file. Only the constant values (null, bool, int, float, String,
+// Array, Map) could be written, a file with any other constant isn't cached.
+class BytecodeCache {
+public:
+	struct Header {
+		uint64_t source_hash = 0;     // of the source text.
+		uint64_t hash = 0;            // of the source and the hashes of it's imports.
+		stdvec<String> import_paths;  // the paths of the imports as they're written in the source.
+	};
+
+	static uint64_t hash(const void* p_data, size_t p_size, uint64_t p_hash = 14695981039346656037ull);
+
+	// false if the file doesn't exists or isn't a cache of this version.
+	static bool read_header(const String& p_path, Header* r_header);
+	static void save(const String& p_path, const Header& p_header, const Bytecode* p_bytecode);
+	// p_get_import returns the compiled file of an import's absolute path.
+	static ptr<Bytecode> load(const String& p_path, const std::function<ptr<Bytecode>(const String&)>& p_get_import);
+};
+
+}
+
+#endif // BYTECODE_CACHE_H
@@ -31,6 +31,9 @@
 #include "analyzer.h"
 #include "bytecode.h"
 #include "function.h"
+#include "ir.h"
+
+#include <set>
 
 namespace carbon {
 
@@ -62,28 +65,67 @@ struct CGContext {
 };
 
 class CodeGen {
+public:
+	// what's kept of a generated file to generate only it's changed functions again (see regenerate()).
+	struct FunctionRecord {
+		uint64_t tokens_hash = 0;
+		uint32_t line = 0;
+		std::set<const Function*> dependencies; // called directly (their return types are used) or inlined.
+	};
+	struct FileRecord {
+		uint64_t declarations_hash = 0;
+		stdmap<const Function*, FunctionRecord> functions;
+	};
 
 private: // members
 	CGContext _context;
 	Bytecode* _bytecode = nullptr; // the file node version.
 	const Parser::FileNode* _file_node = nullptr;
+	IRPassManager _pass_manager;
+
+	// functions called with CALL_DIRECT, indexed in the order of their first call.
+	stdmap<const Parser::FunctionNode*, uint32_t> _direct_indices;
+	stdmap<const Parser::FunctionNode*, Function*> _generated_functions;
+	stdmap<const Function*, std::set<const Parser::FunctionNode*>> _direct_calls; // caller -> targets.
+	stdmap<const Function*, std::set<const Function*>> _inlined;                  // caller -> inlined functions.
+
+	static constexpr uint32_t INLINE_MAX_SIZE = 64;     // opcode words of an inlined function.
+	static constexpr uint32_t INLINE_MAX_GROWTH = 1024; // opcode words could be added to a caller.
 
 public:
-	ptr<Bytecode> generate(ptr<Analyzer> p_analyzer);
+	CodeGen();
+	ptr<Bytecode> generate(ptr<Analyzer> p_analyzer, FileRecord* r_record = nullptr);
+	// generates the changed functions of a file again into p_bytecode (generated from it's previous source with
+	// p_record) and swaps them in place, false if it's declarations are changed (nothing is modified then).
+	bool regenerate(ptr<Analyzer> p_analyzer, Bytecode* p_bytecode, FileRecord* p_record);
 
 private:
 	void _generate_members(Parser::MemberContainer* p_container, Bytecode* p_bytecode);
 
 	ptr<Function> _generate_function(const Parser::FunctionNode* p_func, const Parser::ClassNode* p_class, Bytecode* p_bytecode);
 	ptr<Function> _generate_initializer(bool p_static, Bytecode* p_bytecode, Parser::MemberContainer* p_container);
+	IRFunction _build_ir(const Function* p_func) const;
+	void _optimize_function(Function* p_func);
+	stdvec<Function*> _get_functions() const;
+	void _infer_return_types(const stdvec<Function*>& p_functions);
+	void _inline_functions(const stdvec<Function*>& p_functions);
+	void _scalar_replace_instances(const stdvec<Function*>& p_functions);
+	void _verify_functions();
+	void _record_function(FileRecord* r_record, const Parser::FunctionNode* p_node, Function* p_func) const;
+	static void _replace_function(Function* p_func, Function* p_generated);
+	void _inline_calls(Function* p_caller, const stdmap<const Function*, IRFunction>& p_bodies);
+	const Function* _find_inline_target(const Function* p_caller, const IRInstruction& p_call, bool* r_guarded) const;
 	void _generate_block(const Parser::BlockNode* p_block);
 	void _generate_control_flow(const Parser::ControlFlowNode* p_cflow);
 	Address _generate_expression(const Parser::Node* p_expr, Address* p_dst = nullptr);
 
 	Address add_global_const_value(const var& p_value);
 	uint32_t add_global_name(const String& p_name);
+	uint32_t add_direct_function(const Parser::FunctionNode* p_func);
 
+	var::Type _get_declared_type(const Parser::Node* p_expr) const; // annotated type of a local or a parameter.
 	void _pop_addr_if_temp(const Address& m_addr);
+	void _write_operator_assign(const Address& p_dst, var::Operator p_op, const Address& p_value);
 };
 
 }
@@ -28,6 +28,11 @@
 
 #include "var/var.h"
 #include "codegen.h"
+#include "aot.h"
+#include "profile.h"
+#include "bytecode_cache.h"
+
+#include <list>
 
 namespace carbon {
 
@@ -37,16 +42,61 @@ public:
 		// TODO: bitfield
 	};
 
+	struct StringCacheStats {
+		size_t hits = 0;
+		size_t misses = 0;    // compiled sources (and the ones with changed imports).
+		size_t evictions = 0;
+		size_t size = 0;
+		size_t capacity = 0;
+	};
+
 private:
 	static Compiler* _singleton;
 	struct _Cache {
 		bool compiling = true;
 		ptr<Bytecode> bytecode = nullptr;
+		uint64_t hash = 0;            // of the source and the hashes of it's imports.
+		ptr<CodeGen::FileRecord> record; // nullptr if it's loaded from it's .cbc.
+	};
+	// a file of the import graph which isn't compiled yet, it's tokenized while the graph is
+	// built (unless it's .cbc has it's imports) and compiled once all of it's imports are.
+	struct _Module {
+		String path;
+		ptr<Tokenizer> tokenizer;
+		uint64_t source_hash = 0;
+		uint64_t hash = 0;            // set once it's compiled.
+		ptr<CodeGen::FileRecord> record;
+		stdvec<String> import_paths;  // as they're written in the source.
+		stdvec<String> resolved;      // absolute paths of the imports.
+		stdvec<String> imports;       // absolute paths of the imports not in the cache.
+		stdvec<_Module*> dependents;  // the modules importing this.
+		int pending = 0;              // imports which aren't compiled yet.
+		_Cache previous;              // it's last compile if it's compiled again.
+		bool in_memory = false;       // a source of compile_string, it isn't in the cache.
+		ptr<Bytecode> bytecode;       // of an in memory module once it's compiled.
+	};
+	// a source compiled with compile_string, the most recently used one is at the front.
+	struct _StringEntry {
+		uint64_t key = 0;             // hash of the source and it's path.
+		String source, path;          // compared on a hit, the hash isn't collision resistant.
+		uint64_t source_hash = 0;
+		uint64_t hash = 0;            // of the source and the hashes of it's imports.
+		stdvec<String> resolved;
+		ptr<Bytecode> bytecode;
 	};
 	stdmap<String, _Cache> _cache;
+	std::list<_StringEntry> _string_cache;
+	stdhashtable<uint64_t, std::list<_StringEntry>::iterator> _string_cache_index;
+	size_t _string_cache_capacity = 64;
+	StringCacheStats _string_cache_stats;
+	mutable std::mutex _mutex; // guards the caches, the modules are compiled from the worker threads.
 	uint32_t _flags;
 	stdvec<String> _include_dirs;
-	std::stack<String> _cwd;
+	stdvec<ptr<AOTModule>> _aot_modules;
+	ptr<Profile> _profile;
+	int _thread_count = 0; // 0 for the hardware concurrency.
+	bool _bytecode_cache = false;
+	String _bytecode_cache_dir; // empty to write the .cbc files next to their sources.
 
 	Compiler() {} // private constructor singleton;
 
@@ -56,10 +106,30 @@ public:
 
 	void add_flag(CompileFlags p_flag);
 	void add_include_dir(const String& p_dir);
+	void add_aot_module(ptr<AOTModule> p_module); // it's native functions replace the compiled ones.
+	void set_profile(ptr<Profile> p_profile);     // a profile of a previous run to specialize the functions.
+	void set_thread_count(int p_count);           // threads to compile the independent imports with.
+	void set_bytecode_cache(bool p_enabled, const String& p_dir = ""); // write the compiled files as .cbc and load them while they're valid.
+	String get_bytecode_cache_path(const String& p_path) const;
+	String resolve_import(const String& p_path, const String& p_dir) const;
+	// without the cache the file is compiled again, if only the bodies of it's functions are changed they're
+	// generated again in place (the previous bytecode is returned), otherwise it's a new bytecode.
 	ptr<Bytecode> compile(const String& p_path, bool p_use_cache = true);
-	ptr<Bytecode> _compile(const String& p_path);
-	//ptr<Bytecode> compile_string(const String& p_source, const String& p_path = "<string-soruce>");
+	// a source which isn't a file, it's imports are relative to the directory of p_path. the same source
+	// and path returns the cached bytecode while it's imports are unchanged.
+	ptr<Bytecode> compile_string(const String& p_source, const String& p_path = "<string-source>");
+	void set_string_cache_capacity(size_t p_capacity); // 0 to compile the strings every time.
+	void clear_string_cache();                         // and it's stats.
+	StringCacheStats get_string_cache_stats() const;
 
+private:
+	int _get_thread_count(size_t p_jobs) const;
+	uint64_t _hash_imports(uint64_t p_source_hash, const stdvec<String>& p_resolved) const;
+	void _evict_strings(size_t p_capacity);
+	void _build_import_graph(ptr<_Module> p_root, stdmap<String, ptr<_Module>>& r_modules);
+	void _compile_modules(stdmap<String, ptr<_Module>>& p_modules);
+	ptr<Bytecode> _compile(_Module* p_module);
+	ptr<Bytecode> _load_bytecode_cache(const String& p_cache_path, uint64_t p_hash);
 };
 
 }
@@ -32,10 +32,17 @@
 namespace carbon {
 
 class Bytecode;
+class PredecodedFunction;
 
 class Function : public Object {
 	REGISTER_CLASS(Function, Object) {}
 	friend class CodeGen;
+	friend class IRFunction;
+	friend class VM;
+	friend class AOTModule;
+	friend class Profile;
+	friend class _BytecodeWriter;
+	friend class _BytecodeReader;
 
 private: // members
 	Bytecode* _owner;
@@ -43,10 +50,19 @@ private: // members
 	bool _is_static;
 	int _arg_count; // TODO: = _is_reference.size(); maybe remove this
 	stdvec<bool> _is_reference;
+	stdvec<var::Type> _arg_types; // var::VAR if it isn't annotated.
+	var::Type _return_type = var::VAR; // annotated, or inferred once every function of the file is generated.
 	stdvec<var> _default_args;
 	stdvec<uint32_t> _opcodes;
 	stdmap<uint32_t, uint32_t> op_dbg; // opcode line to pos
+	stdmap<uint32_t, uint32_t> op_inline; // opcode index to inline site (1 based, 0 if not inlined) same as op_dbg.
+	stdvec<InlineSite> _inline_sites;
 	uint32_t _stack_size;
+	bool _verified = false;
+
+	mutable uint32_t _hot_count = 0;              // calls and loop iterations till it's predecoded.
+	mutable bool _predecoded_built = false;
+	mutable ptr<PredecodedFunction> _predecoded;  // nullptr if it isn't hot yet or nothing could be predecoded.
 	
 public:
 	const String& get_name() const;
@@ -54,12 +70,20 @@ public:
 	int get_arg_count() const;
 	const stdvec<var>& get_default_args() const;
 	const stdvec<bool>& get_is_args_ref() const;
+	const stdvec<var::Type>& get_arg_types() const;
+	var::Type get_return_type() const;
 	// TODO: parameter names : only for debugging
 	uint32_t get_stack_size() const;
 	const Bytecode* get_owner() const;
 	
 	const stdvec<uint32_t>& get_opcodes() const;
 	const stdmap<uint32_t, uint32_t>& get_op_dbg() const;
+	const stdmap<uint32_t, uint32_t>& get_op_inline() const;
+	const stdvec<InlineSite>& get_inline_sites() const;
+
+	// validates the opcodes once, so the VM could read the operands without checking them.
+	void verify();
+	bool is_verified() const;
 
 	var __call(stdvec<var*>& p_args) override;
 };
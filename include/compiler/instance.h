@@ -81,11 +81,9 @@ public:
 	var __mul(const var& p_other) /*const*/ override;
 	var __div(const var& p_other) /*const*/ override;
 
-	// += are change into (+) and (=) at compile time and can't return var& here
-	//var& __add_eq(const var& p_other) override;
-	//var& __sub_eq(const var& p_other) override;
-	//var& __mul_eq(const var& p_other) override;
-	//var& __div_eq(const var& p_other) override;
+	// += can't return var& here, the VM calls the method (__add_eq, ...) if defined
+	// for the OPERATOR_ASSIGN opcode otherwise it's (+) and (=).
+	bool call_operator_assign(var::Operator p_op, const var& p_other);
 
 	bool __gt(const var& p_other) /*const*/ override;
 	bool __lt(const var& p_other) /*const*/ override;
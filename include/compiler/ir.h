@@ -0,0 +1,321 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef IR_H
+#define IR_H
+
+#include "opcodes.h"
+
+namespace carbon {
+
+class Bytecode;
+class Function;
+
+// IR is a basic block view of a function's opcodes. CodeGen writes the opcodes
+// from the analyzed AST and the instructions are lifted into blocks where every
+// operand is tagged with how the instruction uses it, optimisation passes run
+// over the blocks and the result is lowered back to the opcode stream.
+//
+// Stack slots are the virtual registers of the IR. They aren't renamed into a
+// strict SSA form since a slot could be written through a reference argument
+// of a call (tagged USE_DEF) instead the passes rely on the def/use tags.
+
+struct IRInstruction {
+	enum OperandKind {
+		OPCODE,   // the opcode itself, always the first word.
+		IMM,      // immediate value (operator, argc, builtin type/func).
+		NAME,     // index to the global names.
+		USE,      // address read by the instruction.
+		DEF,      // address written by the instruction.
+		USE_DEF,  // address read and could be written (args of a call, iterator).
+		TARGET,   // jump target, (block id in IR and opcode index in bytecode).
+	};
+
+	stdvec<uint32_t> words;
+	stdvec<OperandKind> kinds;
+	uint32_t line = 0;         // source line for op_dbg.
+	uint32_t site = 0;         // inline site of the instruction (1 based index of IRFunction::inline_sites).
+
+	Opcode get_opcode() const { return (Opcode)words[0]; }
+	Address get_address(int p_word) const { return Address(words[p_word]); }
+	void set_address(int p_word, const Address& p_addr) { words[p_word] = p_addr.get_address(); }
+	uint32_t size() const { return (uint32_t)words.size(); }
+
+	int get_target_word() const; // returns -1 if there isn't a jump target.
+	bool is_terminator() const;  // JUMP, RETURN, END (never falls through).
+	bool is_branch() const;      // has a jump target.
+
+	// an instruction which can't throw and has no other effect than writing it's DEF.
+	bool is_pure() const;
+
+	// decode the instruction starting at p_ip (jump targets are kept as they are).
+	static IRInstruction decode(const stdvec<uint32_t>& p_opcodes, uint32_t p_ip);
+	static uint32_t get_size(const stdvec<uint32_t>& p_opcodes, uint32_t p_ip);
+
+	// builders for the instructions passes are synthesizing.
+	static IRInstruction make_assign(const Address& p_dst, const Address& p_src, uint32_t p_line);
+	static IRInstruction make_jump(uint32_t p_target, uint32_t p_line);
+	static IRInstruction make_guard(uint32_t p_target, uint32_t p_line); // JUMP_IF_DERIVED
+	static IRInstruction make_clear(const Address& p_dst, uint32_t p_line);
+	static IRInstruction make_operator(const Address& p_dst, var::Operator p_op, const Address& p_left, const Address& p_right, uint32_t p_line);
+};
+
+struct IRBlock {
+	uint32_t id = 0;
+	stdvec<IRInstruction> instructions;
+	stdvec<uint32_t> successors;
+	stdvec<uint32_t> predecessors;
+
+	bool falls_through() const;          // not terminated with a JUMP, RETURN, END.
+	const IRInstruction* get_terminator() const; // last instruction if it's a branch or terminator.
+};
+
+// a natural loop, the header dominates every block of the loop.
+struct IRLoop {
+	uint32_t header = 0;
+	stdvec<bool> blocks; // blocks[id] is true if the block is a part of the loop.
+};
+
+class IRFunction {
+public:
+	String name;
+	uint32_t stack_size = 0;
+	Bytecode* bytecode_file = nullptr; // global names and constants (could be nullptr).
+	stdvec<var::Type> param_types;     // annotated types of the parameters (checked at the entry).
+	stdvec<var::Type> call_types;      // return types of the CALL_DIRECT targets by their index.
+	stdvec<IRBlock> blocks;            // in layout order, blocks[0] is the entry.
+	stdvec<InlineSite> inline_sites;   // calls expanded in this function.
+
+	static IRFunction build(const stdvec<uint32_t>& p_opcodes, const stdmap<uint32_t, uint32_t>& p_op_dbg, uint32_t p_stack_size,
+		const stdmap<uint32_t, uint32_t>* p_op_inline = nullptr);
+	void lower(stdvec<uint32_t>& r_opcodes, stdmap<uint32_t, uint32_t>& r_op_dbg, stdmap<uint32_t, uint32_t>* r_op_inline = nullptr) const;
+
+	// the same as above with the function's inline sites, lower also updates the stack size.
+	static IRFunction build(const Function* p_func);
+	void lower(Function* r_func) const;
+
+	void update_cfg();                 // recompute successors and predecessors.
+	void erase_blocks(const stdvec<bool>& p_erase); // references to an erased block goes to the next one.
+	uint32_t get_opcode_count() const; // total opcode words.
+	uint32_t get_instruction_count() const;
+	bool has_opcode(Opcode p_opcode) const;
+	bool has_address(Address::Type p_type) const;
+	bool is_name(uint32_t p_name, const String& p_str) const; // the global name at p_name is p_str.
+	void generalize_operators(); // rewrite the typed operators back to OPERATOR.
+	void set_param_types(const stdvec<var::Type>& p_types); // the types of the parameters never written are known.
+
+	// types of the stack slots at the entry of each block (flow sensitive), a slot is var::VAR if it
+	// could be any type. parameters, members and the elements of a container are always var::VAR.
+	stdvec<stdvec<var::Type>> infer_types() const;
+	var::Type get_type(const Address& p_addr, const stdvec<var::Type>& p_types) const;
+	void update_types(const IRInstruction& p_instr, stdvec<var::Type>& r_types) const;
+	var::Type get_return_type() const; // the type of every returned value, var::VAR if they could differ.
+
+	// stack slots holding a null, bool, int or float value at the entry of each block (a value which can't
+	// be an instance) even if the type isn't known. an accumulator of `total += arr[i]` starting with 0 is
+	// one since (+) on a number is a number or an error.
+	stdvec<stdvec<bool>> infer_numbers(const stdvec<stdvec<var::Type>>& p_types_in) const;
+	void update_numbers(const IRInstruction& p_instr, const stdvec<var::Type>& p_types, stdvec<bool>& r_numbers) const;
+
+	// true if the instruction (with it's operand types and the number slots if known) could call a script or
+	// a native function (a method, an operator or a constructor) or change the size of a container.
+	bool may_call_out(const IRInstruction& p_instr, const stdvec<var::Type>& p_types, const stdvec<bool>* p_numbers = nullptr) const;
+
+	// live stack slots at the entry of each block, and the backward transfer of an instruction.
+	stdvec<stdvec<bool>> get_live_in() const;
+	stdvec<bool> get_live_out(uint32_t p_block, const stdvec<stdvec<bool>>& p_live_in) const;
+	void update_live(const IRInstruction& p_instr, stdvec<bool>& r_live) const;
+
+	// dominators[b][d] is true if the block d dominates the block b.
+	stdvec<stdvec<bool>> get_dominators() const;
+	stdvec<IRLoop> find_loops() const;
+
+	// returns the block all the entries of the loop go through before the header, a new block is
+	// inserted before the header if there isn't one (ids after it are shifted). -1 if not possible.
+	int add_preheader(const IRLoop& p_loop);
+
+	// replace the call at p_block's p_index instruction with the body of p_callee. p_args (with the
+	// default values) are copied to new stack slots used for the parameters, the callee's stack is
+	// appended to this stack. if p_guarded the original call is kept for `this` of a derived class.
+	// if p_members isn't nullptr the member addresses of the callee are replaced with them.
+	// returns the block which continues after the call.
+	uint32_t inline_call(uint32_t p_block, uint32_t p_index, const IRFunction& p_callee, const stdvec<Address>& p_args, bool p_guarded,
+		const stdvec<Address>* p_members = nullptr);
+
+	String to_string() const;
+	static String dump_bytecode(Bytecode* p_bytecode); // every function of a file and it's classes.
+};
+
+class IRPass {
+public:
+	virtual ~IRPass() {}
+	virtual const char* get_name() const = 0;
+	virtual bool run(IRFunction& p_function) = 0; // returns true if anything changed.
+};
+
+class IRPassManager {
+	stdvec<ptr<IRPass>> _passes;
+	stdvec<ptr<IRPass>> _final_passes;
+
+public:
+	static constexpr int MAX_ITERATIONS = 8;
+
+	void add_pass(ptr<IRPass> p_pass);
+	void add_final_pass(ptr<IRPass> p_pass); // runs once after the other passes.
+	const stdvec<ptr<IRPass>>& get_passes() const { return _passes; }
+	const stdvec<ptr<IRPass>>& get_final_passes() const { return _final_passes; }
+	void run(IRFunction& p_function) const; // run all passes till there are no more changes.
+};
+
+// remove jumps to the next block and thread jumps to a block with only a jump.
+class IRSimplifyCFGPass : public IRPass {
+public:
+	const char* get_name() const override { return "simplify-cfg"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// conditional jumps on a constant condition are replaced with a jump or removed.
+class IRBranchFoldPass : public IRPass {
+public:
+	const char* get_name() const override { return "branch-fold"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// `x += y;` on a number is the same as `x = x + y;` which the other passes know about.
+class IROperatorAssignPass : public IRPass {
+public:
+	const char* get_name() const override { return "operator-assign"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// remove the blocks which can't be reached from the entry.
+class IRUnreachableBlockPass : public IRPass {
+public:
+	const char* get_name() const override { return "unreachable-blocks"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// remove the pure instructions writing to a stack slot which is never read after.
+class IRDeadStorePass : public IRPass {
+public:
+	const char* get_name() const override { return "dead-store"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// coalesce the copies in a block: `t = a + b; x = t;` becomes `x = a + b;` if t isn't used after
+// it, and the uses of x after `x = y;` reads y till either of them is written.
+class IRCoalescePass : public IRPass {
+public:
+	const char* get_name() const override { return "coalesce"; }
+	bool run(IRFunction& p_function) override;
+
+private:
+	bool _coalesce(IRFunction& p_function, IRBlock& p_block, const stdvec<bool>& p_live_out) const;
+	bool _propagate(IRFunction& p_function, IRBlock& p_block) const;
+};
+
+// move the loop invariant instructions at the start of a loop header to it's preheader. `arr.size()`
+// is invariant if the loop can't call out (which could resize it through another reference).
+class IRLoopInvariantPass : public IRPass {
+public:
+	const char* get_name() const override { return "licm"; }
+	bool run(IRFunction& p_function) override;
+
+private:
+	bool _hoist(IRFunction& p_function, const IRLoop& p_loop) const;
+};
+
+// replace `arr[i]` with GET_MAPPED_UNCHECKED where `0 <= i < arr.size()` is known to be true, the
+// size is taken from a `size()` call compared with the index on the path to it.
+class IRBoundsCheckPass : public IRPass {
+public:
+	const char* get_name() const override { return "bounds-check"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// remove the CHECK_TYPE of a stack slot which is already known to be of the type.
+class IRTypeCheckPass : public IRPass {
+public:
+	const char* get_name() const override { return "type-check"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// OPERATOR on the operands known to be ints (or numbers) is replaced with OPERATOR_INT (OPERATOR_FLOAT).
+// the other passes only know about OPERATOR (IRFunction::build reverts them) so it's a final pass.
+class IRTypeSpecializePass : public IRPass {
+public:
+	const char* get_name() const override { return "specialize"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// an instance constructed in the function which is only used to read and write it's members, call it's
+// methods or as the left operand of an arithmetic operator never escapes it. it's members are kept in stack
+// slots and the member initializer, constructor, methods and operators are inlined on them. it needs
+// every class of the file, so it runs after they're generated (not with the other passes).
+class IRScalarReplacePass : public IRPass {
+public:
+	static constexpr uint32_t MAX_BODY_SIZE = 64;   // opcode words of an inlined constructor or method.
+	static constexpr uint32_t MAX_GROWTH = 1024;    // opcode words could be added to a function.
+
+	const char* get_name() const override { return "scalar-replace"; }
+	bool run(IRFunction& p_function) override;
+	const stdvec<const Function*>& get_inlined() const { return _inlined; } // by the last run.
+
+private:
+	struct _Instance {
+		uint32_t slot = 0;
+		const Bytecode* blueprint = nullptr;
+		stdvec<std::pair<uint32_t, uint32_t>> sites; // (block, index) of the constructions and the uses.
+		stdmap<const Function*, IRFunction> bodies;  // to inline on the member slots.
+	};
+	stdvec<const Function*> _inlined;
+
+	bool _find(IRFunction& p_function, _Instance* r_instance) const;
+	bool _is_replaceable(IRFunction& p_function, const IRInstruction& p_instr, uint32_t p_slot, bool p_use, _Instance* r_instance) const;
+	bool _get_body(const Function* p_func, _Instance* r_instance) const;
+	bool _get_args(IRFunction& p_function, const Function* p_func, const IRInstruction& p_instr, uint32_t p_argc_word,
+		stdvec<Address>* r_args) const;
+	void _replace(IRFunction& p_function, _Instance& p_instance) const;
+};
+
+// stack slots which are never live at the same time share a slot, the locals and temps are numbered
+// with the greedy coloring of the interference graph. the CLEAR instructions are removed before it.
+class IRSlotAllocationPass : public IRPass {
+public:
+	const char* get_name() const override { return "slot-alloc"; }
+	bool run(IRFunction& p_function) override;
+};
+
+// insert a CLEAR after the last use of a slot which could hold a container or an object (or at the
+// start of a block it's dead on entry), only in the blocks outside of the loops.
+class IRReleaseSlotsPass : public IRPass {
+public:
+	const char* get_name() const override { return "release"; }
+	bool run(IRFunction& p_function) override;
+};
+
+}
+
+#endif // IR_H
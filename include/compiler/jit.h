@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef JIT_H
+#define JIT_H
+
+#include "predecode.h"
+
+namespace carbon {
+
+// The x86-64 machine code of a predecoded function, written into an mmap'd executable region (only
+// on Linux x86-64, compile() gives nullptr on the other platforms and the VM runs the predecoded
+// instructions). Every instruction calls a stub of PredecodedOps, the int and float add, sub and mul,
+// the int comparisons and jumps, the moves of ints and the conditional jumps on bools are inlined
+// after a check of the types, the stub is called if it fails. INTERPRET instructions return to the
+// VM which runs them with the interpreter.
+//
+// Generated code has no unwind info, so an exception must never be thrown through it. The stubs
+// catch them and return a status the code checks, it returns to run() which throws it again.
+class JITFunction {
+public:
+	JITFunction() {}
+	JITFunction(const JITFunction&) = delete;
+	~JITFunction();
+
+	// nullptr if the platform isn't supported or the memory couldn't be mapped.
+	static ptr<JITFunction> compile(const PredecodedFunction* p_predecoded);
+
+	// same as VM::_run_predecoded(), p_frame is resolved from the operands of the predecoded function.
+	bool run(var** p_frame, int p_index, uint32_t& r_ip, var& r_ret) const;
+	size_t get_code_size() const { return _code_size; }
+
+private:
+	static int _get_type_offset(); // offsets in a var for the inlined fast paths.
+	static int _get_data_offset();
+
+	uint8_t* _code = nullptr;
+	size_t _code_size = 0;
+	size_t _mapped_size = 0;
+	stdvec<uint32_t> _entries; // code offset of each instruction.
+};
+
+}
+
+#endif // JIT_H
@@ -37,30 +37,40 @@ enum Opcode {
 	GET,
 	SET,
 	GET_MAPPED,
+	GET_MAPPED_UNCHECKED, // arr[i]; an Array or String indexed with an int proven in range.
 	SET_MAPPED,
 	SET_TRUE,
 	SET_FALSE,
+	CLEAR,               // release the value of a stack slot after it's last use (set to null).
 
 	OPERATOR,
+	OPERATOR_ASSIGN,     // a += b; updates strings, arrays and instances (__add_eq) in place.
+	OPERATOR_INT,        // OPERATOR on ints without the var dispatch (other operand types take the generic path).
+	OPERATOR_FLOAT,      // OPERATOR on floats, or a float and an int.
 	ASSIGN,
+	CHECK_TYPE,          // var x: int = f(); type error if a typed local or parameter isn't of it's type (an int is converted to a float).
 
 	CONSTRUCT_BUILTIN,
 	CONSTRUCT_NATIVE,
 	CONSTRUCT_CARBON,
 	CONSTRUCT_LITERAL_ARRAY,
 	CONSTRUCT_LITERAL_MAP,
+	CONSTRUCT_LITERAL_CONST, // [1, "a"]; a deep copy of an all constant literal from the constant pool.
 
 	// Native and other types constructed from calling
 	CALL,                // a_var(...); -> a_var.__call(...);
 	CALL_FUNC,           // f(...); calling a function
+	CALL_DIRECT,         // f(...); this.f(...); calling a function resolved at compile time
 	CALL_METHOD,         // a.method(...)
 	CALL_BUILTIN,        // pritnln(...)
+	CALL_INTRINSIC,      // min(a, b), len(x); fixed arity builtin call without an argument vector.
 	CALL_SUPER_CTOR,     // super();
 	CALL_SUPER_METHOD,   // super.method(...);
 
 	JUMP,
 	JUMP_IF,
 	JUMP_IF_NOT,
+	JUMP_IF_DERIVED,     // `this` is an instance of a class derived from the current one (guards inlined methods).
 	RETURN,
 	ITER_BEGIN,
 	ITER_NEXT,
@@ -117,6 +127,14 @@ public:
 	bool operator!=(const Address& p_other) const { return !operator==(p_other); }
 };
 
+// a call expanded into the body of a function, an error in the expanded body is traced back through
+// the callee as if it was called (see VM's traceback).
+struct InlineSite {
+	String name;         // name of the callee (with it's class).
+	uint32_t line = 0;   // line of the call.
+	uint32_t parent = 0; // the site the call itself is expanded in (1 based), 0 if it's in the function.
+};
+
 struct Opcodes {
 	stdvec<uint32_t> opcodes;
 
@@ -157,6 +175,7 @@ struct Opcodes {
 	void write_return(const Address& p_ret_value);
 
 	void write_assign_bool(const Address& dst, bool value);
+	void write_clear(const Address& p_dst);
 	void write_and_left(const Address& p_left);
 	void write_and_right(const Address& p_right, const Address& p_dst);
 	void write_or_left(const Address& p_left);
@@ -169,16 +188,21 @@ struct Opcodes {
 	void write_set_mapped(const Address& p_on, const Address& p_key, const Address& p_value);
 	void write_array_literal(const Address& p_dst, const stdvec<Address>& p_values);
 	void write_map_literal(const Address& p_dst, const stdvec<Address>& p_keys, const stdvec<Address>& p_values);
+	void write_const_literal(const Address& p_dst, const Address& p_value);
 	void write_construct_builtin_type(const Address& p_dst, BuiltinTypes::Type p_type, const stdvec<Address>& p_args);
 	void write_construct_native(const Address& p_dst, uint32_t p_name, const stdvec<Address>& p_args);
 	void write_construct_carbon(const Address& p_dst, uint32_t p_name, const stdvec<Address>& p_args);
 	void write_call_builtin(const Address& p_ret, BuiltinFunctions::Type p_func, const stdvec<Address>& p_args);
+	void write_call_intrinsic(const Address& p_ret, BuiltinFunctions::Type p_func, const Address& p_arg0, const Address& p_arg1);
 	void write_call(const Address& p_ret, const Address& p_on, const stdvec<Address>& p_args);
 	void write_call_func(const Address& p_ret, uint32_t p_name, const stdvec<Address>& p_args);
+	void write_call_direct(const Address& p_ret, uint32_t p_index, uint32_t p_name, const stdvec<Address>& p_args);
 	void write_call_method(const Address& p_ret, Address& p_on, uint32_t p_method, const stdvec<Address>& p_args);
 	void write_call_super_constructor(const stdvec<Address>& p_args);
 	void write_call_super_method(const Address& p_ret, uint32_t p_method, const stdvec<Address>& p_args);
 	void write_operator(const Address& p_dst, var::Operator p_op, const Address& p_left, const Address& p_right);
+	void write_operator_assign(const Address& p_dst, var::Operator p_op, const Address& p_value);
+	void write_check_type(const Address& p_value, var::Type p_type);
 
 };
 
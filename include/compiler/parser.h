@@ -37,6 +37,41 @@ namespace carbon {
 #define UNEXP_TOKEN_ERROR(m_expected) _unexp_token_error(m_expected, _DBG_SOURCE)
 #define PREDEFINED_ERROR(m_what, m_name, m_pos) _predefined_error(m_what, m_name, m_pos, _DBG_SOURCE)
 
+// Bump allocator which owns the nodes of a single compilation unit. The nodes refer each other
+// with raw pointers, they're never freed one by one but destructed and released together with
+// the arena (owned by the parser).
+class NodeArena {
+public:
+	NodeArena() {}
+	~NodeArena();
+
+	template <typename T, typename... Targs>
+	T* create(Targs... p_args) {
+		T* node = new (allocate(sizeof(T), alignof(T))) T(p_args...);
+		_destructors.push_back(std::make_pair((void*)node, &_destruct<T>));
+		return node;
+	}
+
+	void* allocate(size_t p_size, size_t p_align);
+	size_t get_allocated() const { return _allocated; }
+	size_t get_reserved() const { return _reserved; }
+
+private:
+	NodeArena(const NodeArena&) = delete;
+	NodeArena& operator=(const NodeArena&) = delete;
+
+	template <typename T> static void _destruct(void* p_node) { ((T*)p_node)->~T(); }
+
+	static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+	stdvec<char*> _chunks;
+	stdvec<std::pair<void*, void(*)(void*)>> _destructors;
+	char* _current = nullptr;
+	char* _end = nullptr;
+	size_t _allocated = 0;
+	size_t _reserved = 0;
+};
+
 class Parser {
 public:
 	struct Node {
@@ -70,7 +105,7 @@ public:
 		Type type = Type::UNKNOWN;
 		Vect2i pos;
 		uint32_t width = 1; // width of the node ^^^^ (dbg).
-		ptr<Node> parernt_node;
+		Node* parernt_node = nullptr;
 		bool is_reduced = false;
 		bool _is_reducing = false;
 		static const char* get_node_type_name(Type p_type);
@@ -97,12 +132,21 @@ public:
 	struct MemberContainer : public Node {
 		MemberContainer(Type type) { this->type = type; }
 
-		ptr<EnumNode> unnamed_enum;
-		stdvec<ptr<EnumNode>> enums;
-		stdvec<ptr<VarNode>> vars;
-		stdvec<ptr<ConstNode>> constants;
-		stdvec<ptr<FunctionNode>> functions;
-		stdvec<ptr<CallNode>> compiletime_functions;
+		EnumNode* unnamed_enum = nullptr;
+		stdvec<EnumNode*> enums;
+		stdvec<VarNode*> vars;
+		stdvec<ConstNode*> constants;
+		stdvec<FunctionNode*> functions;
+		stdvec<CallNode*> compiletime_functions;
+
+		// every declaration above by it's name (the unnamed enum for it's values and the classes
+		// of a file), filled while parsing and used for the name lookups.
+		stdhashtable<String, Node*> members;
+		Node* find_member(const String& p_name) const {
+			auto it = members.find(p_name);
+			if (it == members.end()) return nullptr;
+			return it->second;
+		}
 	};
 
 	struct ImportNode : public Node {
@@ -113,8 +157,9 @@ public:
 	struct FileNode : public MemberContainer {
 		String path, source;
 
-		stdvec<ptr<ClassNode>> classes;
-		stdvec<ptr<ImportNode>> imports;
+		stdvec<ClassNode*> classes;
+		stdvec<ImportNode*> imports;
+		uint64_t declarations_hash = 0; // of the tokens out of the functions.
 
 		FileNode() : MemberContainer(Type::FILE) { }
 
@@ -159,13 +204,13 @@ public:
 
 	struct EnumValueNode {
 		Vect2i pos = Vect2i(-1, -1);
-		ptr<Node> expr;
+		Node* expr = nullptr;
 		bool is_reduced = false;
 		bool _is_reducing = false; // for cyclic dependancy.
 		int64_t value = 0;
 		EnumNode* _enum = nullptr; // if not named enum it'll be nullptr.
 		EnumValueNode() {}
-		EnumValueNode(ptr<Node> p_expr, Vect2i p_pos, EnumNode* p_enum = nullptr) {
+		EnumValueNode(Node* p_expr, Vect2i p_pos, EnumNode* p_enum = nullptr) {
 			pos = p_pos;
 			expr = p_expr;
 			_enum = p_enum;
@@ -185,7 +230,8 @@ public:
 		Vect2i pos = Vect2i(-1, -1);
 		String name;
 		bool is_reference = false;
-		ptr<Node> default_value;
+		var::Type type = var::VAR; // `a: int`, var::VAR if it isn't annotated.
+		Node* default_value = nullptr;
 		ParameterNode() {}
 		ParameterNode(String p_name, Vect2i p_pos) {
 			name = p_name;
@@ -197,10 +243,14 @@ public:
 		bool is_static = false;
 		bool has_return = false;
 		bool is_constructor = false;
+		bool is_const = false; // pure function, calls with constant args are evaluated by the analyzer.
+		var::Type return_type = var::VAR; // `func f(): int`, var::VAR if it isn't annotated.
 		uint32_t end_line = -1; // needed for debugger, it's where destructor called
+		int token_begin = 0, token_end = 0; // it's tokens from `func`.
+		uint64_t tokens_hash = 0;           // an unchanged function isn't generated again by CodeGen::regenerate().
 		stdvec<ParameterNode> args;
 		stdvec<var> default_args;
-		ptr<BlockNode> body;
+		BlockNode* body = nullptr;
 		Node* parent_node;
 		FunctionNode() {
 			type = Type::FUNCTION;
@@ -208,10 +258,17 @@ public:
 	};
 
 	struct BlockNode : public Node {
-		stdvec<ptr<Node>> statements;
+		stdvec<Node*> statements;
 		// quick reference instead of searching from statement (change to VarNode* maybe).
-		stdvec<ptr<VarNode>> local_vars;
-		stdvec<ptr<ConstNode>> local_const;
+		stdvec<VarNode*> local_vars;
+		stdvec<ConstNode*> local_const;
+		// by name lookup of the above, use add_local_var/const to keep them in sync.
+		stdhashtable<String, VarNode*> local_var_names;
+		stdhashtable<String, ConstNode*> local_const_names;
+		void add_local_var(VarNode* p_var);
+		void add_local_const(ConstNode* p_const);
+		VarNode* find_local_var(const String& p_name) const;
+		ConstNode* find_local_const(const String& p_name) const;
 		BlockNode() {
 			type = Type::BLOCK;
 		}
@@ -283,7 +340,8 @@ public:
 	struct VarNode : public Node {
 		String name;
 		bool is_static = false;
-		ptr<Node> assignment;
+		var::Type data_type = var::VAR; // `var x: int`, only locals could be annotated.
+		Node* assignment = nullptr;
 		VarNode() {
 			type = Type::VAR;
 		}
@@ -291,7 +349,7 @@ public:
 
 	struct ConstNode : public Node {
 		String name; // Every const are static.
-		ptr<Node> assignment;
+		Node* assignment = nullptr;
 		var value;
 		ConstNode() {
 			type = Type::CONST;
@@ -312,7 +370,7 @@ public:
 	};
 
 	struct ArrayNode : public Node {
-		stdvec<ptr<Node>> elements;
+		stdvec<Node*> elements;
 		bool _can_const_fold = false;
 		ArrayNode() {
 			type = Type::ARRAY;
@@ -321,10 +379,10 @@ public:
 
 	struct MapNode : public Node {
 		struct Pair {
-			ptr<Node> key;
-			ptr<Node> value;
+			Node* key = nullptr;
+			Node* value = nullptr;
 			Pair() {}
-			Pair(ptr<Node>& p_key, ptr<Node>& p_value) { key = p_key; value = p_value; }
+			Pair(Node*& p_key, Node*& p_value) { key = p_key; value = p_value; }
 		};
 		stdvec<Pair> elements;
 		bool _can_const_fold = false;
@@ -368,31 +426,33 @@ public:
 	};
 
 	struct CallNode : public Node {
-		ptr<Node> base;
+		Node* base = nullptr;
 		// should be Node (instead of identifier node) for reduce the identifier.
 		// if the method is nullptr and base is a var `a_var(...)` -> `a_var.__call(...)` will be called.
-		ptr<Node> method;
+		Node* method = nullptr;
 		bool is_compilttime = false;
-		stdvec<ptr<Node>> args;
+		stdvec<Node*> args;
+		// set by the analyzer if the call could only resolve to this function (class hierarchy analysis).
+		const FunctionNode* _direct_func = nullptr;
 		CallNode() {
 			type = Node::Type::CALL;
 		}
 	};
 
 	struct IndexNode : public Node {
-		ptr<Node> base;
-		ptr<IdentifierNode> member = nullptr;
+		Node* base = nullptr;
+		IdentifierNode* member = nullptr;
 
 		bool _ref_reduced = false;
-		//ptr<IdentifierNode> _ref = nullptr; // reduced index node reference.
+		//IdentifierNode* _ref = nullptr; // reduced index node reference.
 		IndexNode() {
 			type = Node::Type::INDEX;
 		}
 	};
 
 	struct MappedIndexNode : public Node {
-		ptr<Node> base;
-		ptr<Node> key;
+		Node* base = nullptr;
+		Node* key = nullptr;
 		MappedIndexNode() {
 			type = Node::Type::MAPPED_INDEX;
 		}
@@ -439,7 +499,7 @@ public:
 			_OP_MAX_,
 		};
 		OpType op_type;
-		stdvec<ptr<Node>> args;
+		stdvec<Node*> args;
 		OperatorNode() {
 			type = Type::OPERATOR;
 		}
@@ -479,15 +539,15 @@ public:
 		};
 		struct SwitchCase {
 			Vect2i pos;
-			ptr<Node> expr;
+			Node* expr = nullptr;
 			int64_t value;
-			ptr<BlockNode> body;
+			BlockNode* body = nullptr;
 			bool default_case = false;
 		};
 		CfType cf_type;
-		stdvec<ptr<Node>> args;
-		ptr<BlockNode> body;
-		ptr<BlockNode> body_else;
+		stdvec<Node*> args;
+		BlockNode* body = nullptr;
+		BlockNode* body_else = nullptr;
 		stdvec<SwitchCase> switch_cases;
 		
 		ControlFlowNode* break_continue = nullptr;
@@ -526,6 +586,12 @@ public:
 	// Methods.
 	//void parse(const String& p_source, const String& p_file_path);
 	void parse(ptr<Tokenizer> p_tokenizer);
+	const ptr<NodeArena>& get_arena() const { return _arena; }
+
+	template<typename T, typename... Targs>
+	T* alloc_node(Targs... p_args) {
+		return _arena->create<T>(p_args...);
+	}
 #ifdef DEBUG_BUILD
 	void print_tree() const;
 #endif
@@ -535,7 +601,7 @@ private:
 	friend class CodeGen;
 	struct Expr {
 		Expr(OperatorNode::OpType p_op, const Vect2i& p_pos) { _is_op = true; op = p_op; pos = p_pos; }
-		Expr(const ptr<Node>& p_node) { _is_op = false; expr = p_node; pos = p_node->pos; }
+		Expr(Node* p_node) { _is_op = false; expr = p_node; pos = p_node->pos; }
 		Expr(const Expr& p_other) {
 			if (p_other._is_op) { _is_op = true; op = p_other.op; } else { _is_op = false; expr = p_other.expr; }
 			pos = p_other.pos;
@@ -545,17 +611,16 @@ private:
 			pos = p_other.pos;
 			return *this;
 		}
-		~Expr() { if (!_is_op) { expr = nullptr; } }
 
 		bool is_op() const { return _is_op; }
 		Vect2i get_pos() const { return pos; }
 		OperatorNode::OpType get_op() const { return op; }
-		ptr<Node>& get_expr() { return expr; }
+		Node*& get_expr() { return expr; }
 	private:
 		bool _is_op = true;
 		Vect2i pos;
 		OperatorNode::OpType op;
-		ptr<Node> expr;
+		Node* expr = nullptr;
 	};
 
 	struct ParserContext {
@@ -572,14 +637,15 @@ private:
 	};
 
 	// members.
-	ptr<FileNode> file_node;
+	FileNode* file_node = nullptr;
 	ptr<Tokenizer> tokenizer;
+	ptr<NodeArena> _arena;
 	ParserContext parser_context;
 
 	// methods.
 	template<typename T=Node, typename... Targs>
-	ptr<T> new_node(Targs... p_args) {
-		ptr<T> ret = newptr<T>(p_args...);
+	T* new_node(Targs... p_args) {
+		T* ret = alloc_node<T>(p_args...);
 		ret->pos = tokenizer->get_pos();
 		ret->width = tokenizer->get_pos();
 		return ret;
@@ -589,22 +655,24 @@ private:
 	CompileTimeError _unexp_token_error(const char* p_expected, const DBGSourceInfo& p_dbg_info) const;
 	CompileTimeError _predefined_error(const String& p_what, const String& p_name, Vect2i p_pos, const DBGSourceInfo& p_dbg_info) const;
 
-	ptr<ImportNode> _parse_import();
-	ptr<ClassNode> _parse_class();
-	ptr<EnumNode> _parse_enum(ptr<Node> p_parent);
-	stdvec<ptr<VarNode>> _parse_var(ptr<Node> p_parent);
-	ptr<ConstNode> _parse_const(ptr<Node> p_parent);
-	ptr<FunctionNode> _parse_func(ptr<Node> p_parent);
+	ImportNode* _parse_import();
+	ClassNode* _parse_class();
+	EnumNode* _parse_enum(Node* p_parent);
+	stdvec<VarNode*> _parse_var(Node* p_parent);
+	ConstNode* _parse_const(Node* p_parent);
+	FunctionNode* _parse_func(Node* p_parent);
+	var::Type _parse_type_annotation(); // the type name after the ":".
 
-	ptr<BlockNode> _parse_block(const ptr<Node>& p_parent, bool p_single_statement = false, stdvec<Token> p_termination = { Token::BRACKET_RCUR } );
-	ptr<ControlFlowNode> _parse_if_block(const ptr<BlockNode>& p_parent);
+	BlockNode* _parse_block(Node* p_parent, bool p_single_statement = false, stdvec<Token> p_termination = { Token::BRACKET_RCUR } );
+	ControlFlowNode* _parse_if_block(BlockNode* p_parent);
 
-	ptr<Node> _parse_expression(const ptr<Node>& p_parent, bool p_allow_assign);
-	stdvec<ptr<Node>> _parse_arguments(const ptr<Node>& p_parent);
+	Node* _parse_expression(Node* p_parent, bool p_allow_assign);
+	stdvec<Node*> _parse_arguments(Node* p_parent);
 
-	ptr<Node> _build_operator_tree(stdvec<Expr>& p_expr);
+	Node* _build_operator_tree(stdvec<Expr>& p_expr);
 	static int _get_operator_precedence(OperatorNode::OpType p_op);
 	void _check_identifier_predefinition(const String& p_name, Node* p_scope) const;
+	uint64_t _hash_declarations() const;
 };
 
 
@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PREDECODE_H
+#define PREDECODE_H
+
+#include "opcodes.h"
+
+namespace carbon {
+
+class Function;
+class JITFunction;
+
+// native code of a function written ahead of time (see AOTModule), it runs the instructions from
+// p_index like VM::_run_predecoded().
+typedef bool (*PredecodedNativeFunc)(var** p_frame, int p_index, uint32_t& r_ip, var& r_ret);
+
+// A hot function is translated once into a pre-decoded form the VM runs instead
+// of decoding the opcodes and resolving the addresses of every instruction each
+// time. Operands are indices to the frame, an array of the addresses resolved
+// once per call. The typed operators are split into an instruction for each
+// common operator, and a comparison followed by a conditional jump on it is
+// fused into one instruction. It isn't machine code, the VM still dispatches
+// on each instruction (see VM::_run_predecoded()), the machine code of it is
+// a JITFunction where the platform supports it.
+//
+// Instructions it doesn't support are INTERPRET, the VM runs them with the
+// interpreter and comes back to the predecoded form after them. The instructions
+// are in the same order as the opcodes, so it could be entered at any of them
+// (in the middle of a loop which made the function hot).
+
+struct PredecodedInstruction {
+	enum Op {
+		INTERPRET,
+
+		MOVE,
+		SET_TRUE,
+		SET_FALSE,
+		CLEAR,
+
+		OPERATOR,       // generic operator.
+		ADD_INT,
+		SUB_INT,
+		MUL_INT,
+		OPERATOR_INT,   // the other int operators.
+		ADD_FLOAT,
+		SUB_FLOAT,
+		MUL_FLOAT,
+		OPERATOR_FLOAT, // the other float operators.
+		COMPARE_JUMP_INT,   // a comparison and the JUMP_IF/JUMP_IF_NOT on it's result after it.
+		COMPARE_JUMP_FLOAT,
+
+		GET_MAPPED,
+		GET_MAPPED_UNCHECKED,
+		SET_MAPPED,
+		CALL_INTRINSIC,
+
+		JUMP,
+		JUMP_IF,
+		JUMP_IF_NOT,
+		ITER_BEGIN,
+		ITER_NEXT,
+		RETURN,
+		END,
+	};
+
+	Op op = INTERPRET;
+	uint32_t imm = 0;        // operator or intrinsic.
+	uint32_t a = 0, b = 0, c = 0;
+	uint32_t target = 0;     // instruction index of a jump.
+	bool jump_if = false;    // COMPARE_JUMP_* jumps if the result is true (skips the jump after it if not).
+	uint32_t ip = 0;         // position of the opcode, for the interpreter and the debug info.
+};
+
+class PredecodedFunction {
+public:
+	static constexpr uint32_t HOT_COUNT = 256; // calls and loop iterations of a function before it's predecoded.
+
+	// nullptr if none of the instructions could be predecoded.
+	static ptr<PredecodedFunction> build(const Function* p_func);
+
+	int get_index(uint32_t p_ip) const; // -1 if the interpreter runs the opcode at p_ip.
+	const stdvec<PredecodedInstruction>& get_instructions() const { return _instructions; }
+	const stdvec<Address>& get_operands() const { return _operands; } // the frame is resolved from them.
+	uint32_t get_predecoded_count() const { return _predecoded_count; } // instructions which aren't INTERPRET.
+	PredecodedNativeFunc get_native() const { return _native; }
+	void set_native(PredecodedNativeFunc p_native) { _native = p_native; }
+	const JITFunction* get_jit() const { return _jit.get(); } // nullptr if it isn't compiled to machine code.
+	void set_jit(ptr<JITFunction> p_jit) { _jit = p_jit; }
+
+private:
+	stdvec<PredecodedInstruction> _instructions;
+	stdvec<int> _index;        // instruction index at each opcode position (-1 inside an opcode).
+	stdvec<Address> _operands;
+	uint32_t _predecoded_count = 0;
+	PredecodedNativeFunc _native = nullptr;
+	ptr<JITFunction> _jit;
+};
+
+// The semantics of the instructions shared by the interpreter, the predecoded
+// functions and the native code of an AOTModule. The typed ones are proven by
+// the compiler but they still check the types of the values, and anything else
+// goes to the generic operator.
+class PredecodedOps {
+public:
+	static void operator_generic(var::Operator p_op, var* p_left, var* p_right, var* p_dst);
+	static void get_mapped_unchecked(var* p_on, var* p_key, var* p_dst);
+
+	static inline void set_int(var* p_dst, int64_t p_value) {
+		int64_t* dst = p_dst->operator int64_t*();
+		if (dst != nullptr) *dst = p_value;
+		else *p_dst = p_value;
+	}
+
+	static inline void set_float(var* p_dst, double p_value) {
+		double* dst = p_dst->operator double*();
+		if (dst != nullptr) *dst = p_value;
+		else *p_dst = p_value;
+	}
+
+	static inline bool is_ints(const var* p_left, const var* p_right) {
+		return p_left->get_type() == var::INT && p_right->get_type() == var::INT;
+	}
+
+	// a float operator on two ints would give a float where the generic one gives an int.
+	static inline bool is_floats(const var* p_left, const var* p_right) {
+		return _is_number(p_left) && _is_number(p_right) && (p_left->get_type() == var::FLOAT || p_right->get_type() == var::FLOAT);
+	}
+
+	static inline void operator_int(var::Operator p_op, var* p_left, var* p_right, var* p_dst) {
+		if (is_ints(p_left, p_right) && _operator_int(p_op, *p_left->operator int64_t*(), *p_right->operator int64_t*(), p_dst)) return;
+		operator_generic(p_op, p_left, p_right, p_dst);
+	}
+
+	static inline void operator_float(var::Operator p_op, var* p_left, var* p_right, var* p_dst) {
+		if (is_floats(p_left, p_right) && _operator_float(p_op, p_left->operator double(), p_right->operator double(), p_dst)) return;
+		operator_generic(p_op, p_left, p_right, p_dst);
+	}
+
+#define _PREDECODED_INT_OPERATOR(m_name, m_op, m_operator)                                                      \
+	static inline void m_name(var* p_left, var* p_right, var* p_dst) {                                   \
+		if (is_ints(p_left, p_right)) set_int(p_dst, *p_left->operator int64_t*() m_operator *p_right->operator int64_t*()); \
+		else operator_generic(m_op, p_left, p_right, p_dst);                                             \
+	}
+#define _PREDECODED_FLOAT_OPERATOR(m_name, m_op, m_operator)                                                    \
+	static inline void m_name(var* p_left, var* p_right, var* p_dst) {                                   \
+		if (p_left->get_type() == var::FLOAT && p_right->get_type() == var::FLOAT)                       \
+			set_float(p_dst, *p_left->operator double*() m_operator *p_right->operator double*());         \
+		else if (is_floats(p_left, p_right))                                                              \
+			set_float(p_dst, p_left->operator double() m_operator p_right->operator double());             \
+		else operator_generic(m_op, p_left, p_right, p_dst);                                             \
+	}
+	_PREDECODED_INT_OPERATOR(add_int, var::OP_ADDITION, +)
+	_PREDECODED_INT_OPERATOR(sub_int, var::OP_SUBTRACTION, -)
+	_PREDECODED_INT_OPERATOR(mul_int, var::OP_MULTIPLICATION, *)
+	_PREDECODED_FLOAT_OPERATOR(add_float, var::OP_ADDITION, +)
+	_PREDECODED_FLOAT_OPERATOR(sub_float, var::OP_SUBTRACTION, -)
+	_PREDECODED_FLOAT_OPERATOR(mul_float, var::OP_MULTIPLICATION, *)
+#undef _PREDECODED_INT_OPERATOR
+#undef _PREDECODED_FLOAT_OPERATOR
+
+	// the comparison of a COMPARE_JUMP_*, returns the condition of the jump.
+	static inline bool compare(var::Operator p_op, bool p_float, var* p_left, var* p_right, var* p_dst) {
+		bool result;
+		if (is_ints(p_left, p_right)) {
+			result = _compare(p_op, *p_left->operator int64_t*(), *p_right->operator int64_t*());
+		} else if (p_float && _is_number(p_left) && _is_number(p_right)) {
+			result = _compare(p_op, p_left->operator double(), p_right->operator double());
+		} else {
+			operator_generic(p_op, p_left, p_right, p_dst);
+			return p_dst->operator bool();
+		}
+		*p_dst = result;
+		return result;
+	}
+
+private:
+	static bool _operator_int(var::Operator p_op, int64_t p_left, int64_t p_right, var* p_dst);  // false if it isn't an int operator.
+	static bool _operator_float(var::Operator p_op, double p_left, double p_right, var* p_dst);  // false if it isn't a float operator.
+
+	static inline bool _is_number(const var* p_value) {
+		return p_value->get_type() == var::INT || p_value->get_type() == var::FLOAT;
+	}
+
+	template <typename T>
+	static inline bool _compare(var::Operator p_op, T p_left, T p_right) {
+		switch (p_op) {
+			case var::OP_EQ_CHECK:     return p_left == p_right;
+			case var::OP_NOT_EQ_CHECK: return p_left != p_right;
+			case var::OP_LT:           return p_left < p_right;
+			case var::OP_LTEQ:         return p_left <= p_right;
+			case var::OP_GT:           return p_left > p_right;
+			case var::OP_GTEQ:         return p_left >= p_right;
+			default:
+				THROW_BUG("invalid comparison operator.");
+		}
+	}
+};
+
+}
+
+#endif // PREDECODE_H
@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "var/var.h"
+
+namespace carbon {
+
+class Bytecode;
+class Function;
+
+// The types the interpreter sees at the OPERATOR, GET_MAPPED and CALL_METHOD
+// sites of each function and whether it got hot, recorded by the VM (see
+// VM::set_profile()) and written to a file. The compiler applies a loaded
+// profile to the functions which are still the same: a monomorphic operator is
+// specialized to OPERATOR_INT or OPERATOR_FLOAT (those fall back to the generic
+// one if the type changes) and a hot function is compiled on it's first call.
+class Profile {
+public:
+	enum SiteKind {
+		OPERATOR,    // "int,float"
+		GET_MAPPED,  // "Array"
+		CALL_METHOD, // "String.size"
+
+		_SITE_MAX_,
+	};
+
+	struct Site {
+		SiteKind kind = OPERATOR;
+		stdmap<String, uint32_t> histogram; // types (or the type and the method) -> count.
+	};
+
+	struct FunctionProfile {
+		uint32_t hash = 0;                  // of the opcodes the sites are recorded at.
+		bool hot = false;
+		stdmap<uint32_t, Site> sites;       // ip -> site.
+	};
+
+	static ptr<Profile> load(const String& p_path);
+	void save(const String& p_path) const;
+
+	// the profile of p_func to record it's sites, created if it doesn't exists.
+	FunctionProfile* get_function(const Function* p_func);
+	void record(FunctionProfile* p_func, uint32_t p_ip, SiteKind p_kind, const String& p_key);
+	void record_operator(FunctionProfile* p_func, uint32_t p_ip, const var* p_left, const var* p_right);
+	void set_hot(const Function* p_func);
+
+	uint32_t apply(Bytecode* p_bytecode) const; // returns the number of operators specialized.
+	const stdmap<String, FunctionProfile>& get_functions() const { return _functions; }
+
+	// the typed operators are hashed as the generic one, so a specialized function matches it's profile.
+	static uint32_t hash(const Function* p_func);
+
+private:
+	stdmap<String, FunctionProfile> _functions;        // "path:Class.method" -> profile.
+	stdmap<const Function*, FunctionProfile*> _recording;
+
+	static String _get_key(const Function* p_func);
+	void _apply(Bytecode* p_bytecode, uint32_t& r_count) const;
+};
+
+}
+
+#endif // PROFILE_H
@@ -124,16 +124,24 @@ enum class Token {
 	_TK_MAX_,
 };
 
+// A token doesn't own anything, an identifier refers to the name interned by
+// the tokenizer and a value to it's text in the source which is converted when
+// the parser asks for it (the tokenizer must outlive it's tokens).
 struct TokenData {
 	Token type = Token::UNKNOWN;
-	int line = 0, col = 0;
-	
-	var constant;
-	String identifier;
 	BuiltinTypes::Type builtin_type = BuiltinTypes::UNKNOWN;
+	int line = 0, col = 0;
+	uint32_t length = 0;            // of the text of a value.
+	union {
+		const String* _identifier;  // IDENTIFIER
+		const char* _text;          // VALUE_*
+	};
 
-	TokenData() {}
-	TokenData(Token p_type) { type = p_type; }
+	TokenData() { _identifier = nullptr; }
+	TokenData(Token p_type) { type = p_type; _identifier = nullptr; }
+
+	const String& get_identifier() const;
+	var get_constant() const;
 
 	String to_string() const;
 	Vect2i get_pos() const {  return Vect2i(line, col);  }
@@ -149,9 +157,12 @@ private: // members.
 	int cur_line = 1, cur_col = 1;
 	int char_ptr = 0;
 	int token_ptr = 0;
-	// The float .3 length must be 2 but constant.to_string() result a longer size
-	// and it'll set wrong token column. here is a dirty way to prevent that.
-	int __const_val_token_len = 0;
+
+	struct _Identifier {
+		String name;
+		BuiltinTypes::Type builtin_type = BuiltinTypes::UNKNOWN;
+	};
+	stdhashtable<std::string, _Identifier> _identifiers; // the nodes aren't moved when it grows.
 
 	CompileTimeError _tokenize_error(Error::Type m_err_type, const String& m_msg, const DBGSourceInfo& p_dbg_info) const;
 
@@ -168,16 +179,19 @@ public:
 
 	const String& get_source() const;
 	const String& get_source_path() const;
+	size_t get_token_count() const { return tokens.size(); }
+	int get_token_index() const { return token_ptr; } // of the next token.
+	uint64_t hash_tokens(int p_begin, int p_end) const; // of the tokens in [p_begin, p_end) without their positions.
 
 	static const char* get_token_name(Token p_tk);
 
 private:
 	// methods.
-	void _eat_escape(String& p_str);
+	void _eat_escape();
 	void _eat_token(Token p_tk, int p_eat_size = 1);
 	void _eat_eof();
-	void _eat_const_value(const var& p_value, int p_eat_size = 0);
-	void _eat_identifier(const String& p_idf, int p_eat_size = 0);
+	void _eat_const_value(Token p_tk, int p_begin, int p_line, int p_col);
+	void _eat_identifier(int p_begin);
 
 	void _clear();
 
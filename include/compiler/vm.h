@@ -31,6 +31,9 @@
 #include "bytecode.h"
 #include "function.h"
 #include "instance.h"
+#include "jit.h"
+#include "predecode.h"
+#include "profile.h"
 
 namespace carbon {
 
@@ -68,6 +71,9 @@ private: // members
 	stdmap<String, var> _native_ref;
 	stdmap<uint32_t, var> _builtin_func_ref;
 	stdmap<uint32_t, var> _builtin_type_ref;
+	bool _predecode_enabled = true;
+	bool _jit_enabled = true;
+	ptr<Profile> _profile;
 
 public:
 	int run(ptr<Bytecode> bytecode, stdvec<String> args);
@@ -77,11 +83,24 @@ public:
 	static VM* singleton();
 	static void cleanup();
 
+	void set_predecode_enabled(bool p_enabled) { _predecode_enabled = p_enabled; } // hot functions are predecoded (see PredecodedFunction).
+	bool is_predecode_enabled() const { return _predecode_enabled; }
+	void set_jit_enabled(bool p_enabled) { _jit_enabled = p_enabled; } // predecoded functions are compiled to machine code (see JITFunction).
+	bool is_jit_enabled() const { return _jit_enabled; }
+	void set_profile(ptr<Profile> p_profile) { _profile = p_profile; } // records the types of the interpreted sites.
+	const ptr<Profile>& get_profile() const { return _profile; }
+
 private:
 	VM() {} // singleton
 	var* _get_native_ref(const String& p_name);
 	var* _get_builtin_func_ref(uint32_t p_type);
 	var* _get_builtin_type_ref(uint32_t p_type);
+	var _call_function_by_name(const String& p_name, const Function* p_func, Bytecode* p_bytecode, ptr<Instance> p_self, stdvec<var*>& p_args, int __stack);
+
+	const PredecodedFunction* _get_hot_predecoded(const Function* p_func);
+	// runs the predecoded instructions from p_index till it returns (true) or reaches an INTERPRET instruction
+	// (false), r_ip is the position of the current instruction.
+	bool _run_predecoded(const PredecodedFunction* p_predecoded, int p_index, var** p_frame, uint32_t& r_ip, var& r_ret);
 
 	static VM* _singleton;
 	const int STACK_MAX = 1024; // TODO: increase
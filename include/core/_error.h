@@ -182,6 +182,7 @@ public:
 
 	virtual Kind get_kind() const { return TRACEBACK; }
 	void console_log() const override;
+	const DBGSourceInfo& get_cb_dbg_info() const { return _cb_dbg_info; }
 
 private:
 	DBGSourceInfo _cb_dbg_info;
@@ -63,6 +63,9 @@ private:
 	static NativeClasses* _singleton;
 	stdhashtable<size_t, ClassEntries> classes;
 
+	// nullptr if not registered, the lookups don't insert so they're safe from the compiler threads.
+	ClassEntries* _get_entries(const String& p_class_name);
+
 public:
 	static NativeClasses* singleton();
 	static void cleanup();
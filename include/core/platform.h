@@ -47,6 +47,12 @@ public:
 	static bool path_exists(const std::string& p_path);
 	static bool path_isdir(const std::string& p_path);
 	static stdvec<std::string> path_listdir(const std::string& p_path);
+
+	static void* dl_open(const std::string& p_path);
+	static void* dl_symbol(void* p_handle, const std::string& p_name); // nullptr if it doesn't exists.
+
+	static const void* file_map(const std::string& p_path, size_t* r_size); // read only, nullptr if it can't be mapped.
+	static void file_unmap(const void* p_data, size_t p_size);
 };
 
 }
@@ -130,4 +130,10 @@ bool operator!=(const char* p_cstr, const String& p_str);
 
 }
 
+namespace std {
+template<> struct hash<carbon::String> {
+	size_t operator()(const carbon::String& p_str) const { return p_str.hash(); }
+};
+}
+
 #endif // STRING_H
\ No newline at end of file
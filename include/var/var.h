@@ -288,6 +288,7 @@ private:
 	Type type = _NULL;
 	VarData _data;
 	friend std::ostream& operator<<(std::ostream& p_ostream, const var& p_var);
+	friend class JITFunction; // the type and the value are read by the generated code.
 };
 
 
@@ -76,19 +76,19 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 	parser->parser_context.current_enum = nullptr;
 
 	for (int i = 0; i < (int)file_node->classes.size(); i++) {
-		_resolve_inheritance(file_node->classes[i].get());
+		_resolve_inheritance(file_node->classes[i]);
 	}
 
 	// File/class level constants.
 	for (size_t i = 0; i < file_node->constants.size(); i++) {
-		parser->parser_context.current_const = file_node->constants[i].get();
-		_resolve_constant(file_node->constants[i].get());
+		parser->parser_context.current_const = file_node->constants[i];
+		_resolve_constant(file_node->constants[i]);
 	}
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (size_t j = 0; j < file_node->classes[i]->constants.size(); j++) {
-				parser->parser_context.current_const = file_node->classes[i]->constants[j].get();
-				_resolve_constant(file_node->classes[i]->constants[j].get());
+				parser->parser_context.current_const = file_node->classes[i]->constants[j];
+				_resolve_constant(file_node->classes[i]->constants[j]);
 		}
 	}
 	parser->parser_context.current_const = nullptr;
@@ -96,14 +96,14 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 
 	// File/class enums/unnamed_enums.
 	for (size_t i = 0; i < file_node->enums.size(); i++) {
-		parser->parser_context.current_enum = file_node->enums[i].get();
+		parser->parser_context.current_enum = file_node->enums[i];
 		int _possible_value = 0;
 		for (std::pair<String, Parser::EnumValueNode> pair : file_node->enums[i]->values) {
 			_resolve_enumvalue(file_node->enums[i]->values[pair.first], &_possible_value);
 		}
 	}
 	if (file_node->unnamed_enum != nullptr) {
-		parser->parser_context.current_enum = file_node->unnamed_enum.get();
+		parser->parser_context.current_enum = file_node->unnamed_enum;
 		int _possible_value = 0;
 		for (std::pair<String, Parser::EnumValueNode> pair : file_node->unnamed_enum->values) {
 			_resolve_enumvalue(file_node->unnamed_enum->values[pair.first], &_possible_value);
@@ -112,16 +112,16 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 	parser->parser_context.current_enum = nullptr;
 
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (size_t j = 0; j < file_node->classes[i]->enums.size(); j++) {
-			parser->parser_context.current_enum = file_node->classes[i]->enums[j].get();
+			parser->parser_context.current_enum = file_node->classes[i]->enums[j];
 			int _possible_value = 0;
 			for (std::pair<String, Parser::EnumValueNode> pair : file_node->classes[i]->enums[j]->values) {
 				_resolve_enumvalue(file_node->classes[i]->enums[j]->values[pair.first], &_possible_value);
 			}
 		}
 		if (file_node->classes[i]->unnamed_enum != nullptr) {
-			parser->parser_context.current_enum = file_node->classes[i]->unnamed_enum.get();
+			parser->parser_context.current_enum = file_node->classes[i]->unnamed_enum;
 			int _possible_value = 0;
 			for (std::pair<String, Parser::EnumValueNode> pair : file_node->classes[i]->unnamed_enum->values) {
 				_resolve_enumvalue(file_node->classes[i]->unnamed_enum->values[pair.first], &_possible_value);
@@ -134,7 +134,7 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 	// call compile time functions.
 	for (auto& func : file_node->compiletime_functions) _resolve_compiletime_funcs(func);
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (auto& func : file_node->classes[i]->compiletime_functions)
 			_resolve_compiletime_funcs(func);
 	}
@@ -143,15 +143,15 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 	// File/class level variables.
 	for (size_t i = 0; i < file_node->vars.size(); i++) {
 		if (file_node->vars[i]->assignment != nullptr) {
-			parser->parser_context.current_var = file_node->vars[i].get();
+			parser->parser_context.current_var = file_node->vars[i];
 			_reduce_expression(file_node->vars[i]->assignment);
 		}
 	}
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (size_t j = 0; j < file_node->classes[i]->vars.size(); j++) {
 			if (file_node->classes[i]->vars[j]->assignment != nullptr) {
-				parser->parser_context.current_var = file_node->classes[i]->vars[j].get();
+				parser->parser_context.current_var = file_node->classes[i]->vars[j];
 				_reduce_expression(file_node->classes[i]->vars[j]->assignment);
 			}
 		}
@@ -161,14 +161,14 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 
 	// resolve parameters.
 	for (size_t i = 0; i < file_node->functions.size(); i++) {
-		Parser::FunctionNode* fn = file_node->functions[i].get();
+		Parser::FunctionNode* fn = file_node->functions[i];
 		_resolve_parameters(fn);
 	}
 
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (size_t j = 0; j < file_node->classes[i]->functions.size(); j++) {
-			Parser::FunctionNode* fn = file_node->classes[i]->functions[j].get();
+			Parser::FunctionNode* fn = file_node->classes[i]->functions[j];
 			_resolve_parameters(fn);
 		}
 		parser->parser_context.current_class = nullptr;
@@ -176,31 +176,45 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 
 	// file level function.
 	for (size_t i = 0; i < file_node->functions.size(); i++) {
-		parser->parser_context.current_func = file_node->functions[i].get();
-		Parser::FunctionNode* fn = file_node->functions[i].get();
+		parser->parser_context.current_func = file_node->functions[i];
+		Parser::FunctionNode* fn = file_node->functions[i];
 
 		if (fn->name == GlobalStrings::main) {
 			if (fn->args.size() >= 2) throw ANALYZER_ERROR(Error::INVALID_ARG_COUNT, "main function takes at most 1 argument.", fn->pos);
 		}
 
+		if (fn->is_const) {
+			_resolve_const_func(fn);
+			continue;
+		}
+
+		_local_consts.clear();
 		_reduce_block(file_node->functions[i]->body);
 	}
 	parser->parser_context.current_func = nullptr;
+	_local_consts.clear();
 
 	// class function.
 	for (size_t i = 0; i < file_node->classes.size(); i++) {
 
-		parser->parser_context.current_class = file_node->classes[i].get();
+		parser->parser_context.current_class = file_node->classes[i];
 		for (size_t j = 0; j < file_node->classes[i]->functions.size(); j++) {
 			// check magic methods arguments
-			_check_operator_methods(file_node->classes[i]->functions[j].get());
+			_check_operator_methods(file_node->classes[i]->functions[j]);
+
+			if (file_node->classes[i]->functions[j]->is_const) {
+				_resolve_const_func(file_node->classes[i]->functions[j]);
+				continue;
+			}
 
-			parser->parser_context.current_func = file_node->classes[i]->functions[j].get();
+			parser->parser_context.current_func = file_node->classes[i]->functions[j];
+			_local_consts.clear();
 			_reduce_block(file_node->classes[i]->functions[j]->body);
 		}
+		_local_consts.clear();
 
 		// add default constructor
-		Parser::ClassNode* cls = file_node->classes[i].get();
+		Parser::ClassNode* cls = file_node->classes[i];
 		if (!cls->has_super_ctor_call && cls->base_type != Parser::ClassNode::NO_BASE) {
 
 			bool can_add_default_ctor = true;
@@ -224,18 +238,18 @@ void Analyzer::analyze(ptr<Parser> p_parser) {
 
 			Parser::FunctionNode* fn = cls->constructor;
 			if (fn == nullptr) {
-				ptr<Parser::FunctionNode> new_fn = newptr<Parser::FunctionNode>();
+				Parser::FunctionNode* new_fn = new_node<Parser::FunctionNode>();
 				new_fn->name = cls->name;
 				new_fn->is_reduced = true;
 				new_fn->parent_node = cls;
 				new_fn->pos = cls->pos;
-				new_fn->body = newptr<Parser::BlockNode>();
+				new_fn->body = new_node<Parser::BlockNode>();
 				cls->functions.push_back(new_fn);
-				cls->constructor = new_fn.get();
-				fn = new_fn.get();
+				cls->constructor = new_fn;
+				fn = new_fn;
 			}
-			ptr<Parser::CallNode> super_call = newptr<Parser::CallNode>(); super_call->pos = cls->pos;
-			super_call->base = newptr<Parser::SuperNode>(); super_call->base->pos = cls->pos;
+			Parser::CallNode* super_call = new_node<Parser::CallNode>(); super_call->pos = cls->pos;
+			super_call->base = new_node<Parser::SuperNode>(); super_call->base->pos = cls->pos;
 			fn->body->statements.insert(fn->body->statements.begin(), super_call);
 		}
 	}
@@ -266,29 +280,29 @@ var Analyzer::_call_compiletime_func(Parser::BuiltinFunctionNode* p_func, stdvec
 	return var();
 }
 
-void Analyzer::_resolve_compiletime_funcs(const ptr<Parser::CallNode>& p_func) {
-	Parser::CallNode* call = p_func.get();
+void Analyzer::_resolve_compiletime_funcs(Parser::CallNode* p_func) {
+	Parser::CallNode* call = p_func;
 	ASSERT(call->is_compilttime);
 	ASSERT(call->base->type == Parser::Node::Type::BUILTIN_FUNCTION);
-	Parser::BuiltinFunctionNode* bf = ptrcast<Parser::BuiltinFunctionNode>(call->base).get();
+	Parser::BuiltinFunctionNode* bf = static_cast<Parser::BuiltinFunctionNode*>(call->base);
 	stdvec<var*> args;
 	for (int j = 0; j < (int)call->args.size(); j++) {
 		_reduce_expression(call->args[j]);
 		if (call->args[j]->type != Parser::Node::Type::CONST_VALUE) {
 			throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("compiletime function arguments must be compile time known values."), p_func->args[j]->pos);
 		}
-		args.push_back(&ptrcast<Parser::ConstValueNode>(call->args[j])->value);
+		args.push_back(&static_cast<Parser::ConstValueNode*>(call->args[j])->value);
 	}
 	_call_compiletime_func(bf, args);
 }
 
-void Analyzer::_check_member_var_shadow(void* p_base, Parser::ClassNode::BaseType p_base_type, stdvec<ptr<Parser::VarNode>>& p_vars) {
+void Analyzer::_check_member_var_shadow(void* p_base, Parser::ClassNode::BaseType p_base_type, stdvec<Parser::VarNode*>& p_vars) {
 	switch (p_base_type) {
 		case Parser::ClassNode::NO_BASE: // can't be
 			return;
 		case Parser::ClassNode::BASE_NATIVE: {
 			String* base = (String*)p_base;
-			for (const ptr<Parser::VarNode>& v : p_vars) {
+			for (Parser::VarNode* v : p_vars) {
 				ptr<MemberInfo> mi = NativeClasses::singleton()->get_member_info(*base, v->name);
 				if (mi == nullptr) continue;
 				if (mi->get_type() == MemberInfo::PROPERTY) {
@@ -302,7 +316,7 @@ void Analyzer::_check_member_var_shadow(void* p_base, Parser::ClassNode::BaseTyp
 		} break;
 		case Parser::ClassNode::BASE_EXTERN: {
 			Bytecode* base = (Bytecode*)p_base;
-			for (const ptr<Parser::VarNode>& v : p_vars) {
+			for (Parser::VarNode* v : p_vars) {
 				const ptr<MemberInfo> mi = base->get_member_info(v->name);
 				if (mi == nullptr) continue;
 				if (mi->get_type() == MemberInfo::PROPERTY) {
@@ -318,9 +332,9 @@ void Analyzer::_check_member_var_shadow(void* p_base, Parser::ClassNode::BaseTyp
 		} break;
 		case Parser::ClassNode::BASE_LOCAL: {
 			Parser::ClassNode* base = (Parser::ClassNode*)p_base;
-			for (const ptr<Parser::VarNode>& v : p_vars) {
+			for (Parser::VarNode* v : p_vars) {
 				if (v->is_static) continue;
-				for (const ptr<Parser::VarNode>& _v : base->vars) {
+				for (Parser::VarNode* _v : base->vars) {
 					if (_v->is_static) continue;
 					if (_v->name == v->name) throw ANALYZER_ERROR(Error::ATTRIBUTE_ERROR,
 						String::format("member named \"%s\" already exists in base \"%s\"", v->name.c_str(), base->name.c_str()), v->pos);
@@ -346,8 +360,8 @@ void Analyzer::_resolve_inheritance(Parser::ClassNode* p_class) {
 		for (int i = 0; i < (int)file_node->classes.size(); i++) {
 			if (p_class->base_class_name == file_node->classes[i]->name) {
 				found = true;
-				_resolve_inheritance(file_node->classes[i].get());
-				p_class->base_class = file_node->classes[i].get();
+				_resolve_inheritance(file_node->classes[i]);
+				p_class->base_class = file_node->classes[i];
 			}
 		}
 		if (!found) throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("base class \"%s\" not found.", p_class->base_class_name.c_str()), p_class->pos);
@@ -371,7 +385,7 @@ void Analyzer::_resolve_constant(Parser::ConstNode* p_const) {
 	_reduce_expression(p_const->assignment);
 
 	if (p_const->assignment->type == Parser::Node::Type::CONST_VALUE) {
-		ptr<Parser::ConstValueNode> cv = ptrcast<Parser::ConstValueNode>(p_const->assignment);
+		Parser::ConstValueNode* cv = static_cast<Parser::ConstValueNode*>(p_const->assignment);
 		if (cv->value.get_type() != var::INT && cv->value.get_type() != var::FLOAT &&
 			cv->value.get_type() != var::BOOL && cv->value.get_type() != var::STRING &&
 			cv->value.get_type() != var::_NULL) {
@@ -385,12 +399,14 @@ void Analyzer::_resolve_constant(Parser::ConstNode* p_const) {
 }
 
 void Analyzer::_resolve_parameters(Parser::FunctionNode* p_func) {
+	p_func->default_args.clear(); // a const function could already be resolved on demand.
 	for (int i = 0; i < p_func->args.size(); i++) {
 		if (p_func->args[i].default_value != nullptr) {
 			_reduce_expression(p_func->args[i].default_value);
 			if (p_func->args[i].default_value->type != Parser::Node::Type::CONST_VALUE) 
 				throw ANALYZER_ERROR(Error::TYPE_ERROR, "expected a contant expression.", p_func->args[i].default_value->pos);
-			ptr<Parser::ConstValueNode> cv = ptrcast<Parser::ConstValueNode>(p_func->args[i].default_value);
+			_check_type(p_func->args[i].type, p_func->args[i].default_value);
+			Parser::ConstValueNode* cv = static_cast<Parser::ConstValueNode*>(p_func->args[i].default_value);
 			if (cv->value.get_type() != var::INT && cv->value.get_type() != var::FLOAT &&
 				cv->value.get_type() != var::BOOL && cv->value.get_type() != var::STRING &&
 				cv->value.get_type() != var::_NULL) {
@@ -410,7 +426,7 @@ void Analyzer::_resolve_enumvalue(Parser::EnumValueNode& p_enumvalue, int* p_pos
 		_reduce_expression(p_enumvalue.expr);
 		if (p_enumvalue.expr->type != Parser::Node::Type::CONST_VALUE)
 			throw ANALYZER_ERROR(Error::TYPE_ERROR, "enum value must be a constant integer.", p_enumvalue.expr->pos);
-		ptr<Parser::ConstValueNode> cv = ptrcast<Parser::ConstValueNode>(p_enumvalue.expr);
+		Parser::ConstValueNode* cv = static_cast<Parser::ConstValueNode*>(p_enumvalue.expr);
 		if (cv->value.get_type() != var::INT) throw ANALYZER_ERROR(Error::TYPE_ERROR, "enum value must be a constant integer.", p_enumvalue.expr->pos);
 		p_enumvalue.value = cv->value;
 	} else {
@@ -439,6 +455,10 @@ void Analyzer::_check_operator_methods(const Parser::FunctionNode* p_func) {
 	else if (name == GlobalStrings::__sub) required = 1;
 	else if (name == GlobalStrings::__mul) required = 1;
 	else if (name == GlobalStrings::__div) required = 1;
+	else if (name == GlobalStrings::__add_eq) required = 1;
+	else if (name == GlobalStrings::__sub_eq) required = 1;
+	else if (name == GlobalStrings::__mul_eq) required = 1;
+	else if (name == GlobalStrings::__div_eq) required = 1;
 	else if (name == GlobalStrings::__gt) required = 1;
 	else if (name == GlobalStrings::__lt) required = 1;
 	else if (name == GlobalStrings::__eq) required = 1;
@@ -476,7 +496,7 @@ void Analyzer::_check_super_constructor_call(const Parser::BlockNode* p_block) {
 	if (constructor_argc - default_argc > 0) { // super call needed.
 		if ((p_block->statements.size() == 0) || (p_block->statements[0]->type != Parser::Node::Type::CALL))
 			throw ANALYZER_ERROR(Error::NOT_IMPLEMENTED, "super constructor call expected since base class doesn't have a default constructor.", p_block->pos);
-		const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_block->statements[0].get());
+		const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_block->statements[0]);
 		if (call->base->type != Parser::Node::Type::SUPER || call->method != nullptr)
 			throw ANALYZER_ERROR(Error::NOT_IMPLEMENTED, "super constructor call expected since base class doesn't have a default constructor.", call->pos);
 		current_class->has_super_ctor_call = true;
@@ -484,7 +504,7 @@ void Analyzer::_check_super_constructor_call(const Parser::BlockNode* p_block) {
 	}
 
 	if ((p_block->statements.size() > 0) && (p_block->statements[0]->type == Parser::Node::Type::CALL)) {
-		const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_block->statements[0].get());
+		const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_block->statements[0]);
 		if (call->base->type == Parser::Node::Type::SUPER && call->method == nullptr) current_class->has_super_ctor_call = true;
 	}
 }
@@ -518,10 +538,10 @@ void Analyzer::_check_arg_count(int p_argc, int p_default_argc, int p_args_given
 
 namespace carbon {
 
-void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
+void Analyzer::_reduce_block(Parser::BlockNode*& p_block) {
 
 	Parser::BlockNode* parent_block = parser->parser_context.current_block;
-	parser->parser_context.current_block = p_block.get();
+	parser->parser_context.current_block = p_block;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -539,7 +559,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 	// if reducing constructor -> check super() call
 	if (parser->parser_context.current_class && parser->parser_context.current_class->base_type != Parser::ClassNode::NO_BASE) {
 		if (parser->parser_context.current_class->constructor == parser->parser_context.current_func) {
-			_check_super_constructor_call(p_block.get());
+			_check_super_constructor_call(p_block);
 		}
 	}
 
@@ -562,18 +582,20 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 			} break;
 
 			case Parser::Node::Type::VAR: {
-				ptr<Parser::VarNode> var_node = ptrcast<Parser::VarNode>(p_block->statements[i]);
+				Parser::VarNode* var_node = static_cast<Parser::VarNode*>(p_block->statements[i]);
 				if (var_node->assignment != nullptr) {
-					parser->parser_context.current_var = var_node.get();
+					parser->parser_context.current_var = var_node;
 					_reduce_expression(var_node->assignment);
 					parser->parser_context.current_var = nullptr;
 				}
+				_check_var_type(var_node);
+				_set_local_const(var_node, var_node->assignment);
 			} break;
 
 			case Parser::Node::Type::CONST: {
-				ptr<Parser::ConstNode> const_node = ptrcast<Parser::ConstNode>(p_block->statements[i]);
-				parser->parser_context.current_const = const_node.get();
-				_resolve_constant(const_node.get());
+				Parser::ConstNode* const_node = static_cast<Parser::ConstNode*>(p_block->statements[i]);
+				parser->parser_context.current_const = const_node;
+				_resolve_constant(const_node);
 				parser->parser_context.current_const = nullptr;
 			} break;
 
@@ -597,7 +619,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 				break;
 
 			case Parser::Node::Type::CALL: {
-				ptr<Parser::CallNode> call = ptrcast<Parser::CallNode>(p_block->statements[i]);
+				Parser::CallNode* call = static_cast<Parser::CallNode*>(p_block->statements[i]);
 				if (call->is_compilttime) {
 					_resolve_compiletime_funcs(call);
 					p_block->statements.erase(p_block->statements.begin() + i--);
@@ -611,28 +633,34 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 			} break;
 
 			case Parser::Node::Type::CONTROL_FLOW: {
-				ptr<Parser::ControlFlowNode> cf_node = ptrcast<Parser::ControlFlowNode>(p_block->statements[i]);
+				Parser::ControlFlowNode* cf_node = static_cast<Parser::ControlFlowNode*>(p_block->statements[i]);
 				switch (cf_node->cf_type) {
 
 					case Parser::ControlFlowNode::IF: {
 						ASSERT(cf_node->args.size() == 1);
 						_reduce_expression(cf_node->args[0]);
+						stdmap<const Parser::VarNode*, var> consts_before = _local_consts;
 						_reduce_block(cf_node->body);
+						stdmap<const Parser::VarNode*, var> consts_if = _local_consts;
+						_local_consts = consts_before;
 						if (cf_node->body_else != nullptr) {
 							_reduce_block(cf_node->body_else);
 							// if it's statements cleared it needto be removed.
 							if (cf_node->body_else->statements.size() == 0) cf_node->body_else = nullptr;
 						}
+						_merge_local_consts(consts_if);
 					} break;
 
 					case Parser::ControlFlowNode::SWITCH: {
 						ASSERT(cf_node->args.size() == 1);
 						_reduce_expression(cf_node->args[0]);
+						_invalidate_local_consts(cf_node);
+						stdmap<const Parser::VarNode*, var> consts_before = _local_consts;
 
 						Parser::EnumNode* _switch_enum = nullptr;
 						int _enum_case_count = 0; bool _check_missed_enum = true;
 						if (cf_node->switch_cases.size() > 1 && cf_node->switch_cases[0].expr->type == Parser::Node::Type::IDENTIFIER) {
-							Parser::IdentifierNode* id = ptrcast<Parser::IdentifierNode>(cf_node->switch_cases[0].expr).get();
+							Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(cf_node->switch_cases[0].expr);
 							if (id->ref == Parser::IdentifierNode::REF_ENUM_VALUE) {
 								_switch_enum = id->_enum_value->_enum;
 							}
@@ -641,7 +669,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 						for (int j = 0; j < (int)cf_node->switch_cases.size(); j++) {
 							if (cf_node->switch_cases[j].default_case) _check_missed_enum = false;
 							if (_check_missed_enum && cf_node->switch_cases[j].expr->type == Parser::Node::Type::IDENTIFIER) {
-								Parser::IdentifierNode* id = ptrcast<Parser::IdentifierNode>(cf_node->switch_cases[j].expr).get();
+								Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(cf_node->switch_cases[j].expr);
 								if (id->ref == Parser::IdentifierNode::REF_ENUM_VALUE) {
 									if (id->_enum_value->_enum == _switch_enum) _enum_case_count++;
 								} else _check_missed_enum = false;
@@ -650,7 +678,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 							_reduce_expression(cf_node->switch_cases[j].expr);
 							if (cf_node->switch_cases[j].expr->type != Parser::Node::Type::CONST_VALUE)
 								throw ANALYZER_ERROR(Error::TYPE_ERROR, "switch case value must be a constant integer.", cf_node->switch_cases[j].expr->pos);
-							ptr<Parser::ConstValueNode> cv = ptrcast<Parser::ConstValueNode>(cf_node->switch_cases[j].expr);
+							Parser::ConstValueNode* cv = static_cast<Parser::ConstValueNode*>(cf_node->switch_cases[j].expr);
 							if (cv->value.get_type() != var::INT)
 								throw ANALYZER_ERROR(Error::TYPE_ERROR, "switch case must be a constant integer.", cf_node->switch_cases[j].expr->pos);
 							cf_node->switch_cases[j].value = cv->value;
@@ -662,20 +690,25 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 								}
 							}
 
+							_local_consts = consts_before;
 							_reduce_block(cf_node->switch_cases[j].body);
 						}
 
 						if (_check_missed_enum && _enum_case_count != _switch_enum->values.size()) {
 							ANALYZER_WARNING(Warning::MISSED_ENUM_IN_SWITCH, "", cf_node->pos);
 						}
+						_local_consts = consts_before;
 
 					} break;
 
 					case Parser::ControlFlowNode::WHILE: {
 						ASSERT(cf_node->args.size() == 1);
+						// locals written in the loop are unknown at the condition and after the loop.
+						_invalidate_local_consts(cf_node);
+						stdmap<const Parser::VarNode*, var> consts_before = _local_consts;
 						_reduce_expression(cf_node->args[0]);
 						if (cf_node->args[0]->type == Parser::Node::Type::CONST_VALUE) {
-							if (ptrcast<Parser::ConstValueNode>(cf_node->args[0])->value.operator bool()) {
+							if (static_cast<Parser::ConstValueNode*>(cf_node->args[0])->value.operator bool()) {
 								if (!cf_node->has_break) {
 									ANALYZER_WARNING(Warning::NON_TERMINATING_LOOP, "", cf_node->args[0]->pos);
 								}
@@ -685,6 +718,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 							}
 						}
 						_reduce_block(cf_node->body);
+						_local_consts = consts_before;
 					} break;
 
 					case Parser::ControlFlowNode::FOR: {
@@ -692,16 +726,20 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 
 						// reduce loop arguments.
 						Parser::BlockNode* parent_block = parser->parser_context.current_block;
-						parser->parser_context.current_block = cf_node->body.get();
+						parser->parser_context.current_block = cf_node->body;
 						if (cf_node->args[0] != nullptr && cf_node->args[0]->type == Parser::Node::Type::VAR) {
-							cf_node->body->local_vars.push_back(ptrcast<Parser::VarNode>(cf_node->args[0]));
-							_reduce_expression(ptrcast<Parser::VarNode>(cf_node->args[0])->assignment);
+							cf_node->body->add_local_var(static_cast<Parser::VarNode*>(cf_node->args[0]));
+							_reduce_expression(static_cast<Parser::VarNode*>(cf_node->args[0])->assignment);
+							_check_var_type(static_cast<Parser::VarNode*>(cf_node->args[0]));
 						} else _reduce_expression(cf_node->args[0]);
+						_invalidate_local_consts(cf_node);
+						stdmap<const Parser::VarNode*, var> consts_before = _local_consts;
 						_reduce_expression(cf_node->args[1]);
 						_reduce_expression(cf_node->args[2]);
 						parser->parser_context.current_block = parent_block;
 
 						_reduce_block(cf_node->body);
+						_local_consts = consts_before;
 						if (cf_node->args[0] == nullptr && cf_node->args[1] == nullptr && cf_node->args[2] == nullptr) {
 							if (!cf_node->has_break) {
 								ANALYZER_WARNING(Warning::NON_TERMINATING_LOOP, "", cf_node->pos);
@@ -714,13 +752,16 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 
 						// reduce loop arguments.
 						Parser::BlockNode* parent_block = parser->parser_context.current_block;
-						parser->parser_context.current_block = cf_node->body.get();
-						cf_node->body->local_vars.push_back(ptrcast<Parser::VarNode>(cf_node->args[0]));
-						_reduce_expression(ptrcast<Parser::VarNode>(cf_node->args[0])->assignment);
+						parser->parser_context.current_block = cf_node->body;
+						cf_node->body->add_local_var(static_cast<Parser::VarNode*>(cf_node->args[0]));
+						_reduce_expression(static_cast<Parser::VarNode*>(cf_node->args[0])->assignment);
 						_reduce_expression(cf_node->args[1]);
 						parser->parser_context.current_block = parent_block;
 
+						_invalidate_local_consts(cf_node);
+						stdmap<const Parser::VarNode*, var> consts_before = _local_consts;
 						_reduce_block(cf_node->body);
+						_local_consts = consts_before;
 					} break;
 
 					case Parser::ControlFlowNode::BREAK:
@@ -729,8 +770,12 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 					} break;
 					case Parser::ControlFlowNode::RETURN: {
 						ASSERT(cf_node->args.size() <= 1);
+						var::Type return_type = parser->parser_context.current_func->return_type;
 						if (cf_node->args.size() == 1) {
 							_reduce_expression(cf_node->args[0]);
+							_check_type(return_type, cf_node->args[0]);
+						} else if (return_type != var::VAR) {
+							throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("expected a return value of type \"%s\".", var::get_type_name_s(return_type)), cf_node->pos);
 						}
 					} break;
 				}
@@ -749,16 +794,16 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 			ANALYZER_WARNING(Warning::STAND_ALONE_EXPRESSION, "", p_block->statements[i]->pos);
 			p_block->statements.erase(p_block->statements.begin() + i--);
 
-			// remove all statements after return
+			// remove all statements after return, break and continue.
 		} else if (p_block->statements[i]->type == Parser::Node::Type::CONTROL_FLOW) {
-			Parser::ControlFlowNode* cf = ptrcast<Parser::ControlFlowNode>(p_block->statements[i]).get();
-			if (cf->cf_type == Parser::ControlFlowNode::RETURN) {
+			Parser::ControlFlowNode* cf = static_cast<Parser::ControlFlowNode*>(p_block->statements[i]);
+			if (cf->cf_type == Parser::ControlFlowNode::RETURN || cf->cf_type == Parser::ControlFlowNode::BREAK || cf->cf_type == Parser::ControlFlowNode::CONTINUE) {
 				if (i != p_block->statements.size() - 1) {
 					ANALYZER_WARNING(Warning::UNREACHABLE_CODE, "", p_block->statements[i + 1]->pos);
 					p_block->statements.erase(p_block->statements.begin() + i + 1, p_block->statements.end());
 				}
 			} else if (cf->cf_type == Parser::ControlFlowNode::IF) {
-				if (cf->args[0]->type == Parser::Node::Type::CONST_VALUE && ptrcast<Parser::ConstValueNode>(cf->args[0])->value.operator bool() == false) {
+				if (cf->args[0]->type == Parser::Node::Type::CONST_VALUE && static_cast<Parser::ConstValueNode*>(cf->args[0])->value.operator bool() == false) {
 					if (cf->body_else == nullptr) {
 						ANALYZER_WARNING(Warning::UNREACHABLE_CODE, "", p_block->statements[i]->pos);
 						p_block->statements.erase(p_block->statements.begin() + i--);
@@ -768,9 +813,9 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 
 			// remove all compile time functions.
 		} else if (p_block->statements[i]->type == Parser::Node::Type::CALL) {
-			Parser::CallNode* call = ptrcast<Parser::CallNode>(p_block->statements[i]).get();
+			Parser::CallNode* call = static_cast<Parser::CallNode*>(p_block->statements[i]);
 			if (call->base->type == Parser::Node::Type::BUILTIN_FUNCTION) {
-				if (BuiltinFunctions::is_compiletime(ptrcast<Parser::BuiltinFunctionNode>(call->base)->func)) {
+				if (BuiltinFunctions::is_compiletime(static_cast<Parser::BuiltinFunctionNode*>(call->base)->func)) {
 					p_block->statements.erase(p_block->statements.begin() + i--);
 				}
 			}
@@ -780,6 +825,305 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 
 } // namespace carbon
 
+/******************************************************************************************************************/
+/*                                         TYPE ANNOTATIONS                                                       */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+var::Type Analyzer::_get_declared_type(const Parser::Node* p_expr) const {
+	if (p_expr->type != Parser::Node::Type::IDENTIFIER) return var::VAR;
+	const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(p_expr);
+	switch (id->ref) {
+		case Parser::IdentifierNode::REF_LOCAL_VAR:
+			return id->_var->data_type;
+		case Parser::IdentifierNode::REF_PARAMETER: {
+			const Parser::FunctionNode* func = parser->parser_context.current_func;
+			if (func == nullptr || id->param_index >= (int)func->args.size()) return var::VAR;
+			return func->args[id->param_index].type;
+		}
+		default:
+			return var::VAR;
+	}
+}
+
+var::Type Analyzer::_get_expression_type(const Parser::Node* p_expr) const {
+	switch (p_expr->type) {
+		case Parser::Node::Type::CONST_VALUE:
+			return static_cast<const Parser::ConstValueNode*>(p_expr)->value.get_type();
+		case Parser::Node::Type::ARRAY:
+			return var::ARRAY;
+		case Parser::Node::Type::MAP:
+			return var::MAP;
+		case Parser::Node::Type::IDENTIFIER:
+			return _get_declared_type(p_expr);
+
+		case Parser::Node::Type::OPERATOR: {
+			const Parser::OperatorNode* op = static_cast<const Parser::OperatorNode*>(p_expr);
+			switch (op->op_type) {
+				case Parser::OperatorNode::OP_EQEQ:
+				case Parser::OperatorNode::OP_NOTEQ:
+				case Parser::OperatorNode::OP_LT:
+				case Parser::OperatorNode::OP_LTEQ:
+				case Parser::OperatorNode::OP_GT:
+				case Parser::OperatorNode::OP_GTEQ:
+				case Parser::OperatorNode::OP_AND:
+				case Parser::OperatorNode::OP_OR:
+				case Parser::OperatorNode::OP_NOT:
+					return var::BOOL;
+
+				case Parser::OperatorNode::OP_PLUS:
+				case Parser::OperatorNode::OP_MINUS:
+				case Parser::OperatorNode::OP_MUL:
+				case Parser::OperatorNode::OP_DIV: {
+					var::Type left = _get_expression_type(op->args[0]);
+					var::Type right = _get_expression_type(op->args[1]);
+					if (op->op_type == Parser::OperatorNode::OP_PLUS && left == var::STRING && right == var::STRING) return var::STRING;
+					if ((left != var::INT && left != var::FLOAT) || (right != var::INT && right != var::FLOAT)) return var::VAR;
+					return (left == var::FLOAT || right == var::FLOAT) ? var::FLOAT : var::INT;
+				}
+				default:
+					return var::VAR;
+			}
+		}
+
+		default:
+			return var::VAR;
+	}
+}
+
+void Analyzer::_check_type(var::Type p_type, Parser::Node*& p_expr) {
+	if (p_type == var::VAR || p_expr == nullptr) return;
+
+	var::Type type = _get_expression_type(p_expr);
+	if (type == var::VAR || type == p_type) return;
+	if (p_type == var::FLOAT && type == var::INT) {
+		if (p_expr->type == Parser::Node::Type::CONST_VALUE) {
+			Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(static_cast<Parser::ConstValueNode*>(p_expr)->value.operator double());
+			cv->pos = p_expr->pos;
+			p_expr = cv;
+		}
+		return; // converted at runtime.
+	}
+	throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("expected a value of type \"%s\" but got \"%s\".",
+		var::get_type_name_s(p_type), var::get_type_name_s(type)), p_expr->pos);
+}
+
+void Analyzer::_check_var_type(Parser::VarNode* p_var) {
+	if (p_var->data_type == var::VAR) return;
+	if (p_var->assignment != nullptr) {
+		_check_type(p_var->data_type, p_var->assignment);
+		return;
+	}
+
+	// `var x: int;` starts with the default value of it's type.
+	var value;
+	switch (p_var->data_type) {
+		case var::BOOL:   value = false; break;
+		case var::INT:    value = (int64_t)0; break;
+		case var::FLOAT:  value = 0.0; break;
+		case var::STRING: value = String(); break;
+		case var::ARRAY:  value = Array(); break;
+		case var::MAP:    value = Map(); break;
+		default:
+			THROW_BUG("invalid type annotation.");
+	}
+	Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(value);
+	cv->pos = p_var->pos;
+	p_var->assignment = cv;
+}
+
+} // namespace carbon
+
+/******************************************************************************************************************/
+/*                                         CONSTANT PROPAGATION                                                   */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+void Analyzer::_set_local_const(const Parser::VarNode* p_var, Parser::Node* p_value) {
+	// only the primitives, others are references (arrays, maps, objects) or could be modified in place (strings).
+	if (p_value != nullptr && p_value->type == Parser::Node::Type::CONST_VALUE) {
+		const var& value = static_cast<const Parser::ConstValueNode*>(p_value)->value;
+		switch (value.get_type()) {
+			case var::BOOL:
+			case var::INT:
+			case var::FLOAT:
+				_local_consts[p_var] = value;
+				return;
+			default:
+				break;
+		}
+	}
+	_local_consts.erase(p_var);
+}
+
+void Analyzer::_merge_local_consts(const stdmap<const Parser::VarNode*, var>& p_other) {
+	// at a join only the values known (and the same) in both paths are remain.
+	for (auto it = _local_consts.begin(); it != _local_consts.end();) {
+		auto other = p_other.find(it->first);
+		if (other != p_other.end() && other->second.get_type() == it->second.get_type() && other->second == it->second) it++;
+		else it = _local_consts.erase(it);
+	}
+}
+
+void Analyzer::_invalidate_local_consts(const Parser::Node* p_node) {
+	stdvec<String> names;
+	_collect_written_names(p_node, names);
+	if (names.size() == 0) return;
+
+	// the node isn't reduced yet (identifiers aren't resolved) so the locals are matched by name.
+	for (auto it = _local_consts.begin(); it != _local_consts.end();) {
+		if (std::find(names.begin(), names.end(), it->first->name) != names.end()) it = _local_consts.erase(it);
+		else it++;
+	}
+}
+
+void Analyzer::_collect_written_names(const Parser::Node* p_node, stdvec<String>& r_names) {
+	if (p_node == nullptr) return;
+
+	switch (p_node->type) {
+		case Parser::Node::Type::VAR: {
+			_collect_written_names(static_cast<const Parser::VarNode*>(p_node)->assignment, r_names);
+		} break;
+
+		case Parser::Node::Type::BLOCK: {
+			for (Parser::Node* statement : static_cast<const Parser::BlockNode*>(p_node)->statements) {
+				_collect_written_names(statement, r_names);
+			}
+		} break;
+
+		case Parser::Node::Type::CONTROL_FLOW: {
+			const Parser::ControlFlowNode* cf = static_cast<const Parser::ControlFlowNode*>(p_node);
+			for (Parser::Node* arg : cf->args) _collect_written_names(arg, r_names);
+			_collect_written_names(cf->body, r_names);
+			_collect_written_names(cf->body_else, r_names);
+			for (const Parser::ControlFlowNode::SwitchCase& case_ : cf->switch_cases) {
+				_collect_written_names(case_.expr, r_names);
+				_collect_written_names(case_.body, r_names);
+			}
+		} break;
+
+		case Parser::Node::Type::OPERATOR: {
+			const Parser::OperatorNode* op = static_cast<const Parser::OperatorNode*>(p_node);
+			if (Parser::OperatorNode::is_assignment(op->op_type) && op->args[0]->type == Parser::Node::Type::IDENTIFIER) {
+				r_names.push_back(static_cast<const Parser::IdentifierNode*>(op->args[0])->name);
+			}
+			for (Parser::Node* arg : op->args) _collect_written_names(arg, r_names);
+		} break;
+
+		case Parser::Node::Type::CALL: {
+			const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_node);
+			bool is_builtin_call = call->base->type == Parser::Node::Type::BUILTIN_FUNCTION || call->base->type == Parser::Node::Type::BUILTIN_TYPE;
+			for (Parser::Node* arg : call->args) {
+				if (!is_builtin_call && arg->type == Parser::Node::Type::IDENTIFIER) {
+					r_names.push_back(static_cast<const Parser::IdentifierNode*>(arg)->name);
+				}
+				_collect_written_names(arg, r_names);
+			}
+			_collect_written_names(call->base, r_names);
+		} break;
+
+		case Parser::Node::Type::INDEX: {
+			_collect_written_names(static_cast<const Parser::IndexNode*>(p_node)->base, r_names);
+		} break;
+
+		case Parser::Node::Type::MAPPED_INDEX: {
+			const Parser::MappedIndexNode* mapped_index = static_cast<const Parser::MappedIndexNode*>(p_node);
+			_collect_written_names(mapped_index->base, r_names);
+			_collect_written_names(mapped_index->key, r_names);
+		} break;
+
+		case Parser::Node::Type::ARRAY: {
+			for (Parser::Node* element : static_cast<const Parser::ArrayNode*>(p_node)->elements) {
+				_collect_written_names(element, r_names);
+			}
+		} break;
+
+		case Parser::Node::Type::MAP: {
+			for (const Parser::MapNode::Pair& element : static_cast<const Parser::MapNode*>(p_node)->elements) {
+				_collect_written_names(element.key, r_names);
+				_collect_written_names(element.value, r_names);
+			}
+		} break;
+
+		default:
+			break;
+	}
+}
+
+} // namespace carbon
+
+/******************************************************************************************************************/
+/*                                        CLASS HIERARCHY ANALYSIS                                                */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+// the function a call `f()` (or `this.f()` if p_method) from the current function will always resolve to at
+// runtime, if all the classes of this file that could be `this` (the current class and it's subclasses) resolve
+// the name to the same function, nullptr otherwise. a class from another file could still override it, the vm
+// will check that before taking the direct path.
+const Parser::FunctionNode* Analyzer::_find_direct_target(const String& p_name, bool p_method) const {
+	const Parser::ClassNode* curr_class = parser->parser_context.current_class;
+	const Parser::FunctionNode* curr_func = parser->parser_context.current_func;
+	if (curr_func == nullptr) return nullptr; // member/static var initializer.
+
+	auto find_in = [&p_name](const Parser::MemberContainer* p_container) -> const Parser::FunctionNode* {
+		const Parser::Node* member = p_container->find_member(p_name);
+		if (member == nullptr || member->type != Parser::Node::Type::FUNCTION) return nullptr;
+		return static_cast<const Parser::FunctionNode*>(member);
+	};
+
+	// same order as the vm's lookup : the inheritance chain of the instance, (methods stop there) the file.
+	auto resolve = [&](const Parser::ClassNode* p_class) -> const Parser::FunctionNode* {
+		for (const Parser::ClassNode* cls = p_class; cls != nullptr;) {
+			const Parser::FunctionNode* fn = find_in(cls);
+			if (fn != nullptr) return fn;
+			switch (cls->base_type) {
+				case Parser::ClassNode::NO_BASE: cls = nullptr; break;
+				case Parser::ClassNode::BASE_LOCAL: cls = cls->base_class; break;
+				case Parser::ClassNode::BASE_NATIVE: {
+					if (p_method) return nullptr;
+					cls = nullptr;
+				} break;
+				case Parser::ClassNode::BASE_EXTERN: {
+					for (const Bytecode* base = cls->base_binary.get(); base != nullptr; base = base->get_base_binary().get()) {
+						if (base->get_functions().find(p_name) != base->get_functions().end()) return nullptr;
+						if (p_method && base->is_base_native()) return nullptr;
+					}
+					cls = nullptr;
+				} break;
+			}
+		}
+		if (p_method) return nullptr;
+		return find_in(file_node);
+	};
+
+	if (curr_class == nullptr) return find_in(file_node);
+	if (curr_func->is_static) {
+		if (p_method) return nullptr;
+		const Parser::FunctionNode* fn = find_in(curr_class);
+		return (fn != nullptr) ? fn : find_in(file_node);
+	}
+
+	const Parser::FunctionNode* target = nullptr;
+	for (Parser::ClassNode* cls : file_node->classes) {
+		const Parser::ClassNode* base = cls;
+		while (base != nullptr && base != curr_class) {
+			base = (base->base_type == Parser::ClassNode::BASE_LOCAL) ? base->base_class : nullptr;
+		}
+		if (base == nullptr) continue; // not a subclass.
+
+		const Parser::FunctionNode* fn = resolve(cls);
+		if (fn == nullptr || (target != nullptr && fn != target)) return nullptr;
+		target = fn;
+	}
+	return target;
+}
+
+} // namespace carbon
+
 /******************************************************************************************************************/
 /*                                         REDUCE EXPRESSION                                                      */
 /******************************************************************************************************************/
@@ -787,7 +1131,7 @@ void Analyzer::_reduce_block(ptr<Parser::BlockNode>& p_block) {
 
 namespace carbon {
 
-void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
+void Analyzer::_reduce_expression(Parser::Node*& p_expr) {
 
 	if (p_expr == nullptr) return;
 
@@ -810,7 +1154,7 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 
 			// reduce ArrayNode
 		case Parser::Node::Type::ARRAY: {
-			ptr<Parser::ArrayNode> arr = ptrcast<Parser::ArrayNode>(p_expr);
+			Parser::ArrayNode* arr = static_cast<Parser::ArrayNode*>(p_expr);
 			bool all_const = true;
 			for (int i = 0; i < (int)arr->elements.size(); i++) {
 				_reduce_expression(arr->elements[i]);
@@ -823,21 +1167,21 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 			if (all_const && parser->parser_context.current_const != nullptr) {
 				Array arr_v;
 				for (int i = 0; i < (int)arr->elements.size(); i++) {
-					arr_v.push_back(ptrcast<Parser::ConstValueNode>(arr->elements[i])->value);
+					arr_v.push_back(static_cast<Parser::ConstValueNode*>(arr->elements[i])->value);
 				}
-				ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(arr_v);
+				Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(arr_v);
 				cv->pos = arr->pos; p_expr = cv;
 			}
 		} break;
 
 			// reduce MapNode
 		case Parser::Node::Type::MAP: {
-			ptr<Parser::MapNode> map = ptrcast<Parser::MapNode>(p_expr);
+			Parser::MapNode* map = static_cast<Parser::MapNode*>(p_expr);
 			bool all_const = true;
 			for (int i = 0; i < (int)map->elements.size(); i++) {
 				_reduce_expression(map->elements[i].key);
 				if (map->elements[i].key->type == Parser::Node::Type::CONST_VALUE) {
-					var& key_v = ptrcast<Parser::ConstValueNode>(map->elements[i].key)->value;
+					var& key_v = static_cast<Parser::ConstValueNode*>(map->elements[i].key)->value;
 					if (!var::is_hashable(key_v.get_type())) throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("unhasnable type %s used as map key.", key_v.get_type_name().c_str()), map->pos);
 				}
 				_reduce_expression(map->elements[i].value);
@@ -851,11 +1195,11 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 			if (all_const && parser->parser_context.current_const != nullptr) {
 				Map map_v;
 				for (int i = 0; i < (int)map->elements.size(); i++) {
-					var& _key = ptrcast<Parser::ConstValueNode>(map->elements[i].key)->value;
-					var& _val = ptrcast<Parser::ConstValueNode>(map->elements[i].value)->value;
+					var& _key = static_cast<Parser::ConstValueNode*>(map->elements[i].key)->value;
+					var& _val = static_cast<Parser::ConstValueNode*>(map->elements[i].value)->value;
 					map_v[_key] = _val;
 				}
-				ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(map_v);
+				Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(map_v);
 				cv->pos = map->pos; p_expr = cv;
 			}
 		} break;
@@ -870,14 +1214,14 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 
 			// reduce MappedIndexNode
 		case Parser::Node::Type::MAPPED_INDEX: {
-			ptr<Parser::MappedIndexNode> mapped_index = ptrcast<Parser::MappedIndexNode>(p_expr);
+			Parser::MappedIndexNode* mapped_index = static_cast<Parser::MappedIndexNode*>(p_expr);
 			_reduce_expression(mapped_index->base);
 			_reduce_expression(mapped_index->key);
 			if (mapped_index->base->type == Parser::Node::Type::CONST_VALUE && mapped_index->key->type == Parser::Node::Type::CONST_VALUE) {
-				Parser::ConstValueNode* base = ptrcast<Parser::ConstValueNode>(mapped_index->base).get();
-				Parser::ConstValueNode* key = ptrcast<Parser::ConstValueNode>(mapped_index->key).get();
+				Parser::ConstValueNode* base = static_cast<Parser::ConstValueNode*>(mapped_index->base);
+				Parser::ConstValueNode* key = static_cast<Parser::ConstValueNode*>(mapped_index->key);
 				try {
-					ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(base->value.__get_mapped(key->value));
+					Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(base->value.__get_mapped(key->value));
 					cv->pos = base->pos; p_expr = cv;
 				} catch (Error& err) {
 					throw ANALYZER_ERROR(err.get_type(), err.what(), key->pos);
@@ -888,11 +1232,16 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 			///////////////////////////////////////////////////////////////////////////////////////////////
 
 		case Parser::Node::Type::OPERATOR: {
-			ptr<Parser::OperatorNode> op = ptrcast<Parser::OperatorNode>(p_expr);
+			Parser::OperatorNode* op = static_cast<Parser::OperatorNode*>(p_expr);
 
 			bool all_const = true;
 			for (int i = 0; i < (int)op->args.size(); i++) {
+				// the assignee is written, not read (don't propagate it's constant value).
+				bool is_assignee = i == 0 && Parser::OperatorNode::is_assignment(op->op_type) && op->args[0]->type == Parser::Node::Type::IDENTIFIER;
+				bool propagate = _propagate_locals;
+				if (is_assignee) _propagate_locals = false;
 				_reduce_expression(op->args[i]);
+				_propagate_locals = propagate;
 				if (op->args[i]->type != Parser::Node::Type::CONST_VALUE) all_const = false;
 			}
 
@@ -904,8 +1253,6 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 				case Parser::OperatorNode::OpType::OP_MULEQ:
 				case Parser::OperatorNode::OpType::OP_DIVEQ:
 				case Parser::OperatorNode::OpType::OP_MOD_EQ:
-				case Parser::OperatorNode::OpType::OP_LTEQ:
-				case Parser::OperatorNode::OpType::OP_GTEQ:
 				case Parser::OperatorNode::OpType::OP_BIT_LSHIFT_EQ:
 				case Parser::OperatorNode::OpType::OP_BIT_RSHIFT_EQ:
 				case Parser::OperatorNode::OpType::OP_BIT_OR_EQ:
@@ -913,9 +1260,20 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 				case Parser::OperatorNode::OpType::OP_BIT_XOR_EQ: {
 
 					if (op->args[0]->type == Parser::Node::Type::IDENTIFIER) {
-						switch (ptrcast<Parser::IdentifierNode>(op->args[0])->ref) {
+						switch (static_cast<Parser::IdentifierNode*>(op->args[0])->ref) {
+							case Parser::IdentifierNode::REF_LOCAL_VAR: {
+								// x = 1; the value is known till it's written again.
+								Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(op->args[0]);
+								if (op->op_type == Parser::OperatorNode::OpType::OP_EQ) {
+									_check_type(id->_var->data_type, op->args[1]);
+									_set_local_const(id->_var, op->args[1]);
+								} else {
+									_local_consts.erase(id->_var);
+								}
+							} break;
 							case Parser::IdentifierNode::REF_PARAMETER:
-							case Parser::IdentifierNode::REF_LOCAL_VAR:
+								if (op->op_type == Parser::OperatorNode::OpType::OP_EQ) _check_type(_get_declared_type(op->args[0]), op->args[1]);
+								break;
 							case Parser::IdentifierNode::REF_MEMBER_VAR:
 							case Parser::IdentifierNode::REF_STATIC_VAR:
 								break;
@@ -949,7 +1307,7 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 				default: { // Remaining binary/unary operators.
 					if (!all_const) break;
 					stdvec<var*> args;
-					for (int i = 0; i < (int)op->args.size(); i++) args.push_back(&ptrcast<Parser::ConstValueNode>(op->args[i])->value);
+					for (int i = 0; i < (int)op->args.size(); i++) args.push_back(&static_cast<Parser::ConstValueNode*>(op->args[i])->value);
 				#define SET_EXPR_CONST_NODE(m_expr, m_pos)											      \
 					do {                                                                                  \
 						var value;																		  \
@@ -958,7 +1316,7 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 						} catch (Throwable& err) {														  \
 							throw ANALYZER_ERROR(err.get_type(), err.what(), op->pos);					  \
 						}																				  \
-						ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(value);         \
+						Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(value);         \
 						cv->pos = m_pos;                                                                  \
 						p_expr = cv;                                                                      \
 					} while (false)
@@ -988,6 +1346,12 @@ void Analyzer::_reduce_expression(ptr<Parser::Node>& p_expr) {
 						case Parser::OperatorNode::OpType::OP_GT:
 							SET_EXPR_CONST_NODE(*args[0] > * args[1], op->pos);
 							break;
+						case Parser::OperatorNode::OpType::OP_LTEQ:
+							SET_EXPR_CONST_NODE(*args[0] <= *args[1], op->pos);
+							break;
+						case Parser::OperatorNode::OpType::OP_GTEQ:
+							SET_EXPR_CONST_NODE(*args[0] >= *args[1], op->pos);
+							break;
 						case Parser::OperatorNode::OpType::OP_AND:
 							SET_EXPR_CONST_NODE(args[0]->operator bool() && args[1]->operator bool(), op->pos);
 							break;
@@ -1075,45 +1439,47 @@ Parser::IdentifierNode Analyzer::_find_member(const Parser::MemberContainer* p_c
 
 	id.ref_base = Parser::IdentifierNode::BASE_LOCAL;
 
-	for (int i = 0; i < (int)p_container->vars.size(); i++) {
-		if (p_container->vars[i]->name == id.name) {
-			if (p_container->vars[i]->is_static) id.ref = Parser::IdentifierNode::REF_STATIC_VAR;
-			else id.ref = Parser::IdentifierNode::REF_MEMBER_VAR;
-			id._var = p_container->vars[i].get();
-			return id;
-		}
-	}
-	for (int i = 0; i < (int)p_container->functions.size(); i++) {
-		// constructors are REF_CARBON_CLASS 
-		if (!p_container->functions[i]->is_constructor && p_container->functions[i]->name == id.name) {
-			id.ref = Parser::IdentifierNode::REF_FUNCTION;
-			id._func = p_container->functions[i].get();
-			return id;
-		}
-	}
-	for (int i = 0; i < (int)p_container->constants.size(); i++) {
-		if (p_container->constants[i]->name == id.name) {
-			id.ref = Parser::IdentifierNode::REF_MEMBER_CONST;
-			_resolve_constant(p_container->constants[i].get());
-			id._const = p_container->constants[i].get();
-			return id;
-		}
-	}
-	if (p_container->unnamed_enum != nullptr) {
-		for (std::pair<String, Parser::EnumValueNode> pair : p_container->unnamed_enum->values) {
-			if (pair.first == id.name) {
-				id.ref = Parser::IdentifierNode::REF_ENUM_VALUE;
-				_resolve_enumvalue(p_container->unnamed_enum->values[pair.first]);
-				id._enum_value = &p_container->unnamed_enum->values[pair.first];
+	Parser::Node* member = p_container->find_member(p_name);
+	if (member != nullptr) {
+		switch (member->type) {
+			case Parser::Node::Type::VAR: {
+				Parser::VarNode* _var = static_cast<Parser::VarNode*>(member);
+				if (_var->is_static) id.ref = Parser::IdentifierNode::REF_STATIC_VAR;
+				else id.ref = Parser::IdentifierNode::REF_MEMBER_VAR;
+				id._var = _var;
 				return id;
-			}
-		}
-	}
-	for (int i = 0; i < (int)p_container->enums.size(); i++) {
-		if (p_container->enums[i]->name == id.name) {
-			id.ref = Parser::IdentifierNode::REF_ENUM_NAME;
-			id._enum_node = p_container->enums[i].get();
-			return id;
+			} break;
+			case Parser::Node::Type::FUNCTION: {
+				// constructors are REF_CARBON_CLASS
+				if (static_cast<Parser::FunctionNode*>(member)->is_constructor) break;
+				id.ref = Parser::IdentifierNode::REF_FUNCTION;
+				id._func = static_cast<Parser::FunctionNode*>(member);
+				return id;
+			} break;
+			case Parser::Node::Type::CONST: {
+				id.ref = Parser::IdentifierNode::REF_MEMBER_CONST;
+				_resolve_constant(static_cast<Parser::ConstNode*>(member));
+				id._const = static_cast<Parser::ConstNode*>(member);
+				return id;
+			} break;
+			case Parser::Node::Type::ENUM: {
+				if (member == p_container->unnamed_enum) {
+					id.ref = Parser::IdentifierNode::REF_ENUM_VALUE;
+					_resolve_enumvalue(p_container->unnamed_enum->values[p_name]);
+					id._enum_value = &p_container->unnamed_enum->values[p_name];
+					return id;
+				}
+				id.ref = Parser::IdentifierNode::REF_ENUM_NAME;
+				id._enum_node = static_cast<Parser::EnumNode*>(member);
+				return id;
+			} break;
+			case Parser::Node::Type::CLASS: {
+				id.ref = Parser::IdentifierNode::REF_CARBON_CLASS;
+				id._class = static_cast<Parser::ClassNode*>(member);
+				return id;
+			} break;
+			default:
+				THROW_BUG("invalid member node type.");
 		}
 	}
 
@@ -1190,16 +1556,6 @@ Parser::IdentifierNode Analyzer::_find_member(const Parser::MemberContainer* p_c
 		}
 
 	} else { // container is FileNode
-		const Parser::FileNode* file_node = static_cast<const Parser::FileNode*>(p_container);
-
-		for (int i = 0; i < (int)file_node->classes.size(); i++) {
-			if (file_node->classes[i]->name == id.name) {
-				id.ref = Parser::IdentifierNode::REF_CARBON_CLASS;
-				id._class = file_node->classes[i].get();
-				return id;
-			}
-		}
-
 		if (NativeClasses::singleton()->is_class_registered(id.name)) {
 			id.ref = Parser::IdentifierNode::REF_NATIVE_CLASS;
 			id.ref_base = Parser::IdentifierNode::BASE_NATIVE;
@@ -1211,11 +1567,11 @@ Parser::IdentifierNode Analyzer::_find_member(const Parser::MemberContainer* p_c
 	return id;
 }
 
-void Analyzer::_reduce_identifier(ptr<Parser::Node>& p_expr) {
+void Analyzer::_reduce_identifier(Parser::Node*& p_expr) {
 	ASSERT(p_expr->type == Parser::Node::Type::IDENTIFIER);
 
 	// search parameters.
-	ptr<Parser::IdentifierNode> id = ptrcast<Parser::IdentifierNode>(p_expr);
+	Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(p_expr);
 	if (parser->parser_context.current_func) {
 		for (int i = 0; i < (int)parser->parser_context.current_func->args.size(); i++) {
 			if (parser->parser_context.current_func->args[i].name == id->name) {
@@ -1230,31 +1586,27 @@ void Analyzer::_reduce_identifier(ptr<Parser::Node>& p_expr) {
 	// search in locals (var, const)
 	Parser::BlockNode* outer_block = parser->parser_context.current_block;
 	while (outer_block != nullptr && id->ref == Parser::IdentifierNode::REF_UNKNOWN) {
-		for (int i = 0; i < (int)outer_block->local_vars.size(); i++) {
-			Parser::VarNode* local_var = outer_block->local_vars[i].get();
-			if (local_var->name == id->name) {
-
-				if (p_expr->pos.x < local_var->pos.x || (p_expr->pos.x == local_var->pos.x && p_expr->pos.y < local_var->pos.y))
-					throw ANALYZER_ERROR(Error::NAME_ERROR, String::format("local variable \"%s\" referenced before assigned", local_var->name.c_str()), id->pos);
-				id->ref = Parser::IdentifierNode::REF_LOCAL_VAR;
-				id->ref_base = Parser::IdentifierNode::BASE_LOCAL;
-				id->_var = outer_block->local_vars[i].get();
-				return;
-			}
+		Parser::VarNode* local_var = outer_block->find_local_var(id->name);
+		if (local_var != nullptr) {
+			if (p_expr->pos.x < local_var->pos.x || (p_expr->pos.x == local_var->pos.x && p_expr->pos.y < local_var->pos.y))
+				throw ANALYZER_ERROR(Error::NAME_ERROR, String::format("local variable \"%s\" referenced before assigned", local_var->name.c_str()), id->pos);
+			id->ref = Parser::IdentifierNode::REF_LOCAL_VAR;
+			id->ref_base = Parser::IdentifierNode::BASE_LOCAL;
+			id->_var = local_var;
+			return;
 		}
 
-		for (int i = 0; i < (int)outer_block->local_const.size(); i++) {
-			if (outer_block->local_const[i]->name == id->name) {
-				id->ref = Parser::IdentifierNode::REF_LOCAL_CONST;
-				id->ref_base = Parser::IdentifierNode::BASE_LOCAL;
-				_resolve_constant(outer_block->local_const[i].get());
-				id->_const = outer_block->local_const[i].get();
-				return;
-			}
+		Parser::ConstNode* local_const = outer_block->find_local_const(id->name);
+		if (local_const != nullptr) {
+			id->ref = Parser::IdentifierNode::REF_LOCAL_CONST;
+			id->ref_base = Parser::IdentifierNode::BASE_LOCAL;
+			_resolve_constant(local_const);
+			id->_const = local_const;
+			return;
 		}
 
 		if (outer_block->parernt_node->type == Parser::Node::Type::BLOCK) {
-			outer_block = ptrcast<Parser::BlockNode>(outer_block->parernt_node).get();
+			outer_block = static_cast<Parser::BlockNode*>(outer_block->parernt_node);
 		} else {
 			outer_block = nullptr;
 		}
@@ -1262,27 +1614,26 @@ void Analyzer::_reduce_identifier(ptr<Parser::Node>& p_expr) {
 
 	// if analyzing enum search in enums
 	if (parser->parser_context.current_enum != nullptr) {
-		for (std::pair<String, Parser::EnumValueNode> pair : parser->parser_context.current_enum->values) {
-			if (pair.first == id->name) {
-				id->ref = Parser::IdentifierNode::REF_ENUM_VALUE;
-				_resolve_enumvalue(parser->parser_context.current_enum->values[pair.first]);
-				id->_enum_value = &pair.second;
-				return;
-			}
+		auto it = parser->parser_context.current_enum->values.find(id->name);
+		if (it != parser->parser_context.current_enum->values.end()) {
+			id->ref = Parser::IdentifierNode::REF_ENUM_VALUE;
+			_resolve_enumvalue(it->second);
+			id->_enum_value = &it->second;
+			return;
 		}
 	}
 
 	// search in current class.
 	Parser::IdentifierNode _id = _find_member(parser->parser_context.current_class, id->name);
 	if (_id.ref != Parser::IdentifierNode::REF_UNKNOWN) {
-		_id.pos = id->pos; p_expr = newptr<Parser::IdentifierNode>(_id);
+		_id.pos = id->pos; p_expr = new_node<Parser::IdentifierNode>(_id);
 		return;
 	}
 
 	// search in current file.
-	_id = _find_member(parser->file_node.get(), id->name);
+	_id = _find_member(parser->file_node, id->name);
 	if (_id.ref != Parser::IdentifierNode::REF_UNKNOWN) {
-		_id.pos = id->pos; p_expr = newptr<Parser::IdentifierNode>(_id);
+		_id.pos = id->pos; p_expr = new_node<Parser::IdentifierNode>(_id);
 		return;
 	}
 
@@ -1297,20 +1648,20 @@ void Analyzer::_reduce_identifier(ptr<Parser::Node>& p_expr) {
 }
 
 
-void Analyzer::_check_identifier(ptr<Parser::Node>& p_expr) {
+void Analyzer::_check_identifier(Parser::Node*& p_expr) {
 	ASSERT(p_expr->type == Parser::Node::Type::IDENTIFIER);
 
-	ptr<Parser::IdentifierNode> id = ptrcast<Parser::IdentifierNode>(p_expr);
+	Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(p_expr);
 	switch (id->ref) {
 		case Parser::IdentifierNode::REF_UNKNOWN:
 			throw ANALYZER_ERROR(Error::NAME_ERROR, String::format("identifier \"%s\" isn't defined.", id->name.c_str()), id->pos);
 		case Parser::IdentifierNode::REF_LOCAL_CONST:
 		case Parser::IdentifierNode::REF_MEMBER_CONST: {
-			ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(id->_const->value);
+			Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(id->_const->value);
 			cv->pos = id->pos; p_expr = cv;
 		} break;
 		case Parser::IdentifierNode::REF_ENUM_VALUE: {
-			ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(id->_enum_value->value);
+			Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(id->_enum_value->value);
 			cv->pos = id->pos; p_expr = cv;
 		} break;
 
@@ -1322,6 +1673,14 @@ void Analyzer::_check_identifier(ptr<Parser::Node>& p_expr) {
 					throw ANALYZER_ERROR(Error::ATTRIBUTE_ERROR, String::format("invalid attribute access \"%s\" can't be used in it's own initialization.", id->name.c_str()), id->pos);
 				}
 			}
+			if (id->ref == Parser::IdentifierNode::REF_LOCAL_VAR && _propagate_locals) {
+				auto it = _local_consts.find(id->_var);
+				if (it != _local_consts.end()) {
+					Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(it->second);
+					cv->pos = id->pos; p_expr = cv;
+					break;
+				}
+			}
 		} // [[fallthrought]]
 		default: { // variable, parameter, function name, ...
 			p_expr = id;
@@ -1339,19 +1698,19 @@ void Analyzer::_check_identifier(ptr<Parser::Node>& p_expr) {
 
 namespace carbon {
 
-void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
+void Analyzer::_reduce_indexing(Parser::Node*& p_expr) {
 	ASSERT(p_expr->type == Parser::Node::Type::INDEX);
 
-	ptr<Parser::IndexNode> index = ptrcast<Parser::IndexNode>(p_expr);
+	Parser::IndexNode* index = static_cast<Parser::IndexNode*>(p_expr);
 	_reduce_expression(index->base);
 	ASSERT(index->member->type == Parser::Node::Type::IDENTIFIER);
-	ptr<Parser::IdentifierNode> member = ptrcast<Parser::IdentifierNode>(index->member);
+	Parser::IdentifierNode* member = static_cast<Parser::IdentifierNode*>(index->member);
 
 	switch (index->base->type) {
 
 		// String.prop; index base on built in type
 		case Parser::Node::Type::BUILTIN_TYPE: {
-			Parser::BuiltinTypeNode* bt = ptrcast<Parser::BuiltinTypeNode>(index->base).get();
+			Parser::BuiltinTypeNode* bt = static_cast<Parser::BuiltinTypeNode*>(index->base);
 			const MemberInfo* mi = TypeInfo::get_member_info(BuiltinTypes::get_var_type(bt->builtin_type), member->name).get();
 			if (!mi) throw ANALYZER_ERROR(Error::NAME_ERROR, String::format("attribute \"%s\" doesn't exists on base %s.", member->name.c_str(), BuiltinTypes::get_type_name(bt->builtin_type).c_str()), member->pos);
 
@@ -1364,7 +1723,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 				case MemberInfo::PROPERTY: {
 					PropertyInfo* pi = (PropertyInfo*)mi;
 					if (pi->is_const()) {
-						ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(pi->get_value());
+						Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(pi->get_value());
 						cv->pos = index->pos, p_expr = cv;
 					}
 					else THROW_BUG("can't be."); // builtin types can only have a constant property
@@ -1379,9 +1738,9 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 
 			// "string".member;
 		case Parser::Node::Type::CONST_VALUE: {
-			Parser::ConstValueNode* base = ptrcast<Parser::ConstValueNode>(index->base).get();
+			Parser::ConstValueNode* base = static_cast<Parser::ConstValueNode*>(index->base);
 			try {
-				ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(base->value.get_member(member->name));
+				Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(base->value.get_member(member->name));
 				cv->pos = member->pos; p_expr = cv;
 			} catch (Error& err) {
 				throw ANALYZER_ERROR(err.get_type(), err.what(), index->pos);
@@ -1390,7 +1749,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 
 			// this.member; super.member; idf.member;
 		case Parser::Node::Type::INDEX: { // <-- base is index node but reference reduced.
-			Parser::IndexNode* _ind = ptrcast<Parser::IndexNode>(index->base).get();
+			Parser::IndexNode* _ind = static_cast<Parser::IndexNode*>(index->base);
 			if (!_ind->_ref_reduced) break;
 		}  // [[ FALLTHROUGH ]]
 		case Parser::Node::Type::THIS:
@@ -1402,19 +1761,19 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 			_BaseClassRef _base_class_ref = _NEITHER;
 
 			if (index->base->type == Parser::Node::Type::THIS) {
-				ptr<Parser::IdentifierNode> _id = newptr<Parser::IdentifierNode>(parser->parser_context.current_class->name);
+				Parser::IdentifierNode* _id = new_node<Parser::IdentifierNode>(parser->parser_context.current_class->name);
 				_id->ref = Parser::IdentifierNode::REF_CARBON_CLASS;
 				_id->_class = parser->parser_context.current_class;
 				index->base = _id;
 				_base_class_ref = _THIS;
 			} else if (index->base->type == Parser::Node::Type::SUPER) {
 				if (parser->parser_context.current_class->base_type == Parser::ClassNode::BASE_LOCAL) {
-					ptr<Parser::IdentifierNode> _id = newptr<Parser::IdentifierNode>(parser->parser_context.current_class->base_class->name);
+					Parser::IdentifierNode* _id = new_node<Parser::IdentifierNode>(parser->parser_context.current_class->base_class->name);
 					_id->ref = Parser::IdentifierNode::REF_CARBON_CLASS;
 					_id->_class = parser->parser_context.current_class->base_class;
 					index->base = _id;
 				} else if (parser->parser_context.current_class->base_type == Parser::ClassNode::BASE_EXTERN) {
-					ptr<Parser::IdentifierNode> _id = newptr<Parser::IdentifierNode>(parser->parser_context.current_class->base_class->name);
+					Parser::IdentifierNode* _id = new_node<Parser::IdentifierNode>(parser->parser_context.current_class->base_class->name);
 					_id->ref = Parser::IdentifierNode::REF_EXTERN;
 					_id->_bytecode = parser->parser_context.current_class->base_binary.get();
 					index->base = _id;
@@ -1423,9 +1782,9 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 			}
 
 			if (index->base->type == Parser::Node::Type::INDEX) {
-				base = ptrcast<Parser::IndexNode>(index->base)->member.get();
+				base = static_cast<Parser::IndexNode*>(index->base)->member;
 			} else {
-				base = ptrcast<Parser::IdentifierNode>(index->base).get();
+				base = static_cast<Parser::IdentifierNode*>(index->base);
 			}
 
 			switch (base->ref) {
@@ -1452,7 +1811,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 							member->ref_base = Parser::IdentifierNode::BASE_LOCAL;
 							member->_enum_value = &(it->second);
 							_resolve_enumvalue(base->_enum_node->values[it->first]);
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(base->_enum_node->values[it->first].value);
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(base->_enum_node->values[it->first].value);
 							cv->pos = member->pos; p_expr = cv;
 						} else {
 							throw ANALYZER_ERROR(Error::NAME_ERROR,
@@ -1464,7 +1823,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 						if (it != base->_enum_info->get_values().end()) {
 							member->ref = Parser::IdentifierNode::REF_ENUM_VALUE;
 							member->ref_base = base->ref_base;
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(it->second);
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(it->second);
 							cv->pos = member->pos; p_expr = cv;
 						} else {
 							throw ANALYZER_ERROR(Error::NAME_ERROR,
@@ -1497,9 +1856,9 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 								throw ANALYZER_ERROR(Error::ATTRIBUTE_ERROR, String::format("non-static attribute \"%s\" cannot be access with a class reference \"%s\".", member->name.c_str(), base->name.c_str()), member->pos);
 							}
 							if (_base_class_ref == _THIS) {
-								p_expr = newptr<Parser::IdentifierNode>(_id);
+								p_expr = new_node<Parser::IdentifierNode>(_id);
 							} else {
-								index->member = newptr<Parser::IdentifierNode>(_id);
+								index->member = new_node<Parser::IdentifierNode>(_id);
 								index->_ref_reduced = true;
 							}
 						} break;
@@ -1509,7 +1868,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 							var value;
 							if (_id.ref_base == Parser::IdentifierNode::BASE_LOCAL) value = _id._const->value;
 							else value = _id._prop_info->get_value();
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(value);
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(value);
 							cv->pos = member->pos; p_expr = cv;
 						} break;
 
@@ -1517,9 +1876,9 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 						case Parser::IdentifierNode::REF_ENUM_NAME: {
 							_id.pos = member->pos;
 							if (_base_class_ref == _THIS) {
-								p_expr = newptr<Parser::IdentifierNode>(_id);
+								p_expr = new_node<Parser::IdentifierNode>(_id);
 							} else {
-								index->member = newptr<Parser::IdentifierNode>(_id);
+								index->member = new_node<Parser::IdentifierNode>(_id);
 								index->_ref_reduced = true;
 							}
 						} break;
@@ -1529,7 +1888,7 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 							int64_t value = 0;
 							if (_id.ref_base == Parser::IdentifierNode::BASE_LOCAL) value = _id._enum_value->value;
 							else value = _id._enum_value_info->get_value();
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(value);
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(value);
 							cv->pos = member->pos; p_expr = cv;
 						} break;
 
@@ -1542,9 +1901,9 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 							}
 
 							if (_base_class_ref == _THIS) {
-								p_expr = newptr<Parser::IdentifierNode>(_id);
+								p_expr = new_node<Parser::IdentifierNode>(_id);
 							} else {
-								index->member = newptr<Parser::IdentifierNode>(_id);
+								index->member = new_node<Parser::IdentifierNode>(_id);
 								index->_ref_reduced = true;
 							}
 						} break;
@@ -1571,13 +1930,13 @@ void Analyzer::_reduce_indexing(ptr < Parser::Node>& p_expr) {
 
 							// NativeClass.CONT_VALUE
 						case BindData::STATIC_CONST: {
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(((ConstantBind*)bd)->get());
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(((ConstantBind*)bd)->get());
 							cv->pos = member->pos; p_expr = cv;
 						} break;
 
 							// File.READ
 						case BindData::ENUM_VALUE: {
-							ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(((EnumValueBind*)bd)->get());
+							Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(((EnumValueBind*)bd)->get());
 							cv->pos = member->pos; p_expr = cv;
 						} break;
 					}
@@ -1614,41 +1973,54 @@ namespace carbon {
 #define GET_ARGS(m_nodes)                                                             \
 	stdvec<var*> args;                                                                \
 	for (int i = 0; i < (int)m_nodes.size(); i++) {                                   \
-	    args.push_back(&ptrcast<Parser::ConstValueNode>(m_nodes[i])->value);          \
+	    args.push_back(&static_cast<Parser::ConstValueNode*>(m_nodes[i])->value);          \
 	}
 
 #define SET_EXPR_CONST_NODE(m_var, m_pos)                                             \
 do {                                                                                  \
-	ptr<Parser::ConstValueNode> cv = new_node<Parser::ConstValueNode>(m_var);         \
+	Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(m_var);         \
 	cv->pos = m_pos, p_expr = cv;                                                     \
 } while (false)
 
 
-void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
+void Analyzer::_reduce_call(Parser::Node*& p_expr) {
 	ASSERT(p_expr->type == Parser::Node::Type::CALL);
 
-	ptr<Parser::CallNode> call = ptrcast<Parser::CallNode>(p_expr);
+	Parser::CallNode* call = static_cast<Parser::CallNode*>(p_expr);
 
-	// reduce arguments.
+	// reduce arguments. (a local passed to a carbon function could be written through a reference parameter).
+	bool is_builtin_call = call->base->type == Parser::Node::Type::BUILTIN_FUNCTION || call->base->type == Parser::Node::Type::BUILTIN_TYPE;
+	bool propagate = _propagate_locals;
 	bool all_const = true;
 	for (int i = 0; i < (int)call->args.size(); i++) {
+		if (!is_builtin_call && call->args[i]->type == Parser::Node::Type::IDENTIFIER) _propagate_locals = false;
 		_reduce_expression(call->args[i]);
+		_propagate_locals = propagate;
 		if (call->args[i]->type != Parser::Node::Type::CONST_VALUE) {
 			all_const = false;
 		}
 	}
 
 	// reduce base.
-	if (call->base->type == Parser::Node::Type::BUILTIN_FUNCTION || call->base->type == Parser::Node::Type::BUILTIN_TYPE) {
+	if (is_builtin_call) {
 		// don't_reduce_anything();
 	} else {
+		_propagate_locals = false;
 		if (call->base->type == Parser::Node::Type::UNKNOWN) {
 			_reduce_expression(call->method);
+			_propagate_locals = propagate;
 			if (call->method->type == Parser::Node::Type::CONST_VALUE)
 				throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("constant value is not callable."), call->pos);
 			ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
 		} else {
 			_reduce_expression(call->base);
+			_propagate_locals = propagate;
+		}
+
+		for (int i = 0; i < (int)call->args.size(); i++) {
+			if (call->args[i]->type != Parser::Node::Type::IDENTIFIER) continue;
+			const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(call->args[i]);
+			if (id->ref == Parser::IdentifierNode::REF_LOCAL_VAR) _local_consts.erase(id->_var);
 		}
 	}
 
@@ -1659,11 +2031,11 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 
 			if (call->method == nullptr) { // print();
 				if (all_const) {
-					ptr<Parser::BuiltinFunctionNode> bf = ptrcast<Parser::BuiltinFunctionNode>(call->base);
+					Parser::BuiltinFunctionNode* bf = static_cast<Parser::BuiltinFunctionNode*>(call->base);
 					if (BuiltinFunctions::can_const_fold(bf->func)) {
 						GET_ARGS(call->args);
 						if (BuiltinFunctions::is_compiletime(bf->func)) {
-							var ret = _call_compiletime_func(bf.get(), args);
+							var ret = _call_compiletime_func(bf, args);
 							SET_EXPR_CONST_NODE(ret, call->pos);
 						} else {
 							try {
@@ -1685,7 +2057,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 			// String(); String.format(...); method call on base built in type
 		case Parser::Node::Type::BUILTIN_TYPE: {
 			if (call->method == nullptr) { // String(...); constructor.
-				Parser::BuiltinTypeNode* bt = static_cast<Parser::BuiltinTypeNode*>(call->base.get());
+				Parser::BuiltinTypeNode* bt = static_cast<Parser::BuiltinTypeNode*>(call->base);
 				if (all_const && BuiltinTypes::can_construct_compile_time(bt->builtin_type)) {
 					try {
 						GET_ARGS(call->args);
@@ -1707,7 +2079,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 				try {
 					ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
 					GET_ARGS(call->args); // 0 : const value, 1: name, ... args.
-					var ret = ptrcast<Parser::ConstValueNode>(call->base)->value.call_method(ptrcast<Parser::IdentifierNode>(call->method)->name, args);
+					var ret = static_cast<Parser::ConstValueNode*>(call->base)->value.call_method(static_cast<Parser::IdentifierNode*>(call->method)->name, args);
 					SET_EXPR_CONST_NODE(ret, call->pos);
 				} catch (const Error& err) {
 					throw ANALYZER_ERROR(err.get_type(), err.what(), call->method->pos);
@@ -1718,7 +2090,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 			// call base is unknown. search method from this to super, or static function.
 		case Parser::Node::Type::UNKNOWN: {
 
-			Parser::IdentifierNode* id = ptrcast<Parser::IdentifierNode>(call->method).get();
+			Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(call->method);
 			switch (id->ref) {
 
 				// a_var(); call `__call` method on the variable.
@@ -1751,6 +2123,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 						case Parser::IdentifierNode::BASE_LOCAL: {
 							// TODO: this logic may be false.
 							is_illegal_call = parser->parser_context.current_class && !id->_func->is_static;
+							if (id->_func->is_const) _resolve_const_func(const_cast<Parser::FunctionNode*>(id->_func)); // for the default args.
 							argc = (int)id->_func->args.size();
 							argc_default = (int)id->_func->default_args.size();
 						} break;
@@ -1764,6 +2137,12 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 					}
 
 					_check_arg_count(argc, argc_default, argc_given, call->pos);
+					if (id->ref_base == Parser::IdentifierNode::BASE_LOCAL) call->_direct_func = _find_direct_target(id->name, false);
+
+					// f(1, 2); evaluate a const function at compile time.
+					if (id->ref_base == Parser::IdentifierNode::BASE_LOCAL && id->_func->is_const) {
+						_reduce_const_func_call(p_expr, id->_func, all_const);
+					}
 
 				} break;
 
@@ -1806,7 +2185,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 						const stdvec<VarTypeInfo>& arg_types = initializer->get_method_info()->get_arg_types();
 						for (int i = 0; i < argc_given; i++) {
 							if (call->args[i]->type == Parser::Node::Type::CONST_VALUE) {
-								var value = ptrcast<Parser::ConstValueNode>(call->args[i])->value;
+								var value = static_cast<Parser::ConstValueNode*>(call->args[i])->value;
 								if (!var::is_compatible(value.get_type(), arg_types[i + 1].type)) // +1 for skip self argument.
 									throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("expected type \"%s\" at argument %i.", var::get_type_name_s(arg_types[i + 1].type), i), call->args[i]->pos);
 							}
@@ -1838,9 +2217,9 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 			if (call->method == nullptr) {
 				if (call->base->type == Parser::Node::Type::THIS) { // this(); = __call() = operator ()()
 					const Parser::FunctionNode* func = nullptr;
-					for (const ptr<Parser::FunctionNode>& fn : curr_class->functions) {
+					for (Parser::FunctionNode* fn : curr_class->functions) {
 						if (fn->name == GlobalStrings::__call) {
-							func = fn.get(); break;
+							func = fn; break;
 						}
 					}
 					if (func == nullptr) throw ANALYZER_ERROR(Error::NOT_IMPLEMENTED, String::format("operator method __call not implemented on base %s", curr_class->name.c_str()), call->pos);
@@ -1849,7 +2228,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 					if (parser->parser_context.current_class == nullptr || parser->parser_context.current_class->base_type == Parser::ClassNode::NO_BASE ||
 						(parser->parser_context.current_class->constructor != parser->parser_context.current_func))
 						throw ANALYZER_ERROR(Error::SYNTAX_ERROR, "invalid super call.", call->pos);
-					if ((parser->parser_context.current_statement_ind != 0) || (parser->parser_context.current_block->statements[0].get() != p_expr.get()))
+					if ((parser->parser_context.current_statement_ind != 0) || (parser->parser_context.current_block->statements[0] != p_expr))
 						throw ANALYZER_ERROR(Error::SYNTAX_ERROR, "super call should be the first and stand-alone statement of a constructor.", call->pos);
 
 					switch (curr_class->base_type) {
@@ -1874,7 +2253,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 				}
 
 			} else {
-				const String& method_name = ptrcast<Parser::IdentifierNode>(call->method)->name;
+				const String& method_name = static_cast<Parser::IdentifierNode*>(call->method)->name;
 				if (call->base->type == Parser::Node::Type::THIS) {
 					// this.method();
 					Parser::IdentifierNode _id = _find_member(curr_class, method_name);
@@ -1903,6 +2282,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 							int argc = (int)_id._func->args.size();
 							int argc_default = (int)_id._func->default_args.size();
 							_check_arg_count(argc, argc_default, (int)call->args.size(), call->pos);
+							call->_direct_func = _find_direct_target(method_name, true);
 
 						} break;
 
@@ -2032,8 +2412,8 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 			// idf.method(); method call on base with identifier id.
 		case Parser::Node::Type::IDENTIFIER: {
 			ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-			Parser::IdentifierNode* base = ptrcast<Parser::IdentifierNode>(call->base).get();
-			Parser::IdentifierNode* id = ptrcast<Parser::IdentifierNode>(call->method).get();
+			Parser::IdentifierNode* base = static_cast<Parser::IdentifierNode*>(call->base);
+			Parser::IdentifierNode* id = static_cast<Parser::IdentifierNode*>(call->method);
 
 			switch (base->ref) {
 
@@ -2108,6 +2488,12 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 							}
 
 							if (_is_func_static) {
+								// Aclass.f(1, 2); evaluate a const function at compile time.
+								if (id->ref_base == Parser::IdentifierNode::BASE_LOCAL && _id._func->is_const) {
+									_resolve_const_func(const_cast<Parser::FunctionNode*>(_id._func));
+									_check_arg_count((int)_id._func->args.size(), (int)_id._func->default_args.size(), (int)call->args.size(), call->pos);
+									_reduce_const_func_call(p_expr, _id._func, all_const);
+								}
 								break; // Class.static_func(args...);
 							} else {
 								throw ANALYZER_ERROR(Error::ATTRIBUTE_ERROR, String::format("can't call non-static method\"%s\" statically", id->name.c_str()), id->pos);
@@ -2146,7 +2532,7 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 
 							for (int i = 0; i < (int)call->args.size(); i++) {
 								if (call->args[i]->type == Parser::Node::Type::CONST_VALUE) {
-									if (!var::is_compatible(mi->get_arg_types()[i].type, ptrcast<Parser::ConstValueNode>(call->args[i])->value.get_type())) {
+									if (!var::is_compatible(mi->get_arg_types()[i].type, static_cast<Parser::ConstValueNode*>(call->args[i])->value.get_type())) {
 										throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("expected type \"%s\" at argument %i.", var::get_type_name_s(mi->get_arg_types()[i].type), i), call->args[i]->pos);
 									}
 								}
@@ -2207,3 +2593,536 @@ void Analyzer::_reduce_call(ptr<Parser::Node>& p_expr) {
 }
 
 } // namespace carbon
+
+/******************************************************************************************************************/
+/*                                         CONST FUNCTIONS                                                        */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+// a const function is evaluated at compile time only if it's cheap enough, otherwise the call is left to the runtime.
+#define CONST_FUNC_MAX_STEPS 1000000
+#define CONST_FUNC_MAX_DEPTH 64
+
+// thrown when a call can't be evaluated at compile time (not an error).
+struct _ConstFuncGiveUp {};
+
+// a value of another type than it's annotation is a type error at runtime, the call isn't evaluated.
+static void _const_func_check_type(var& r_value, var::Type p_type) {
+	if (p_type == var::VAR || r_value.get_type() == p_type) return;
+	if (p_type == var::FLOAT && r_value.get_type() == var::INT) {
+		r_value = r_value.operator double();
+		return;
+	}
+	throw _ConstFuncGiveUp();
+}
+
+static var::Operator _const_func_var_op(Parser::OperatorNode::OpType p_op) {
+	switch (p_op) {
+		case Parser::OperatorNode::OP_PLUS:
+		case Parser::OperatorNode::OP_PLUSEQ:         return var::OP_ADDITION;
+		case Parser::OperatorNode::OP_MINUS:
+		case Parser::OperatorNode::OP_MINUSEQ:        return var::OP_SUBTRACTION;
+		case Parser::OperatorNode::OP_MUL:
+		case Parser::OperatorNode::OP_MULEQ:          return var::OP_MULTIPLICATION;
+		case Parser::OperatorNode::OP_DIV:
+		case Parser::OperatorNode::OP_DIVEQ:          return var::OP_DIVISION;
+		case Parser::OperatorNode::OP_MOD:
+		case Parser::OperatorNode::OP_MOD_EQ:         return var::OP_MODULO;
+		case Parser::OperatorNode::OP_BIT_LSHIFT:
+		case Parser::OperatorNode::OP_BIT_LSHIFT_EQ:  return var::OP_BIT_LSHIFT;
+		case Parser::OperatorNode::OP_BIT_RSHIFT:
+		case Parser::OperatorNode::OP_BIT_RSHIFT_EQ:  return var::OP_BIT_RSHIFT;
+		case Parser::OperatorNode::OP_BIT_OR:
+		case Parser::OperatorNode::OP_BIT_OR_EQ:      return var::OP_BIT_OR;
+		case Parser::OperatorNode::OP_BIT_AND:
+		case Parser::OperatorNode::OP_BIT_AND_EQ:     return var::OP_BIT_AND;
+		case Parser::OperatorNode::OP_BIT_XOR:
+		case Parser::OperatorNode::OP_BIT_XOR_EQ:     return var::OP_BIT_XOR;
+		case Parser::OperatorNode::OP_EQEQ:           return var::OP_EQ_CHECK;
+		case Parser::OperatorNode::OP_NOTEQ:          return var::OP_NOT_EQ_CHECK;
+		case Parser::OperatorNode::OP_LT:             return var::OP_LT;
+		case Parser::OperatorNode::OP_LTEQ:           return var::OP_LTEQ;
+		case Parser::OperatorNode::OP_GT:             return var::OP_GT;
+		case Parser::OperatorNode::OP_GTEQ:           return var::OP_GTEQ;
+		case Parser::OperatorNode::OP_NOT:            return var::OP_NOT;
+		case Parser::OperatorNode::OP_BIT_NOT:        return var::OP_BIT_NOT;
+		case Parser::OperatorNode::OP_POSITIVE:       return var::OP_POSITIVE;
+		case Parser::OperatorNode::OP_NEGATIVE:       return var::OP_NEGATIVE;
+		default:                                      return var::_OP_MAX_;
+	}
+}
+
+// same as the OPERATOR opcode.
+static var _const_func_operator(var::Operator p_op, const var& p_left, const var& p_right) {
+	switch (p_op) {
+		case var::OP_ADDITION:       return p_left + p_right;
+		case var::OP_SUBTRACTION:    return p_left - p_right;
+		case var::OP_MULTIPLICATION: return p_left * p_right;
+		case var::OP_DIVISION:       return p_left / p_right;
+		case var::OP_MODULO:         return p_left % p_right;
+		case var::OP_POSITIVE:       return p_left;
+		case var::OP_NEGATIVE: {
+			if (p_left.get_type() == var::INT) return -p_left.operator int64_t();
+			if (p_left.get_type() == var::FLOAT) return -p_left.operator double();
+			THROW_ERROR(Error::OPERATOR_NOT_SUPPORTED, String::format("operator (-) not supported on base %s.", p_left.get_type_name().c_str()));
+		}
+		case var::OP_EQ_CHECK:       return p_left == p_right;
+		case var::OP_NOT_EQ_CHECK:   return p_left != p_right;
+		case var::OP_LT:             return p_left < p_right;
+		case var::OP_LTEQ:           return p_left <= p_right;
+		case var::OP_GT:             return p_left > p_right;
+		case var::OP_GTEQ:           return p_left >= p_right;
+		case var::OP_NOT:            return !p_left;
+		case var::OP_BIT_LSHIFT:     return p_left.operator int64_t() << p_right.operator int64_t();
+		case var::OP_BIT_RSHIFT:     return p_left.operator int64_t() >> p_right.operator int64_t();
+		case var::OP_BIT_AND:        return p_left.operator int64_t() & p_right.operator int64_t();
+		case var::OP_BIT_OR:         return p_left.operator int64_t() | p_right.operator int64_t();
+		case var::OP_BIT_XOR:        return p_left.operator int64_t() ^ p_right.operator int64_t();
+		case var::OP_BIT_NOT:        return ~p_left.operator int64_t();
+		default:
+			THROW_BUG("invalid operator in a const function.");
+	}
+}
+
+void Analyzer::_resolve_const_func(Parser::FunctionNode* p_func) {
+	ASSERT(p_func->is_const);
+	if (p_func->is_reduced) return;
+	if (p_func->_is_reducing) return; // recursive call, it'll be resolved by the caller.
+	p_func->_is_reducing = true;
+
+	// a const function could be required while reducing anything else (a constant, a variable, another function).
+	Parser::ParserContext context = parser->parser_context;
+	stdmap<const Parser::VarNode*, var> local_consts = _local_consts;
+	bool propagate = _propagate_locals;
+
+	parser->parser_context = Parser::ParserContext();
+	if (p_func->parent_node->type == Parser::Node::Type::CLASS) {
+		parser->parser_context.current_class = static_cast<Parser::ClassNode*>(p_func->parent_node);
+	}
+	parser->parser_context.current_func = p_func;
+	_local_consts.clear();
+	_propagate_locals = true;
+
+	for (const Parser::ParameterNode& param : p_func->args) {
+		if (param.is_reference) {
+			throw ANALYZER_ERROR(Error::TYPE_ERROR, String::format("const function \"%s\" can't have a reference parameter.", p_func->name.c_str()), param.pos);
+		}
+	}
+	_resolve_parameters(p_func);
+	_reduce_block(p_func->body);
+	_check_const_func(p_func, p_func->body);
+
+	parser->parser_context = context;
+	_local_consts = local_consts;
+	_propagate_locals = propagate;
+
+	p_func->_is_reducing = false;
+	p_func->is_reduced = true;
+}
+
+void Analyzer::_check_const_func(const Parser::FunctionNode* p_func, const Parser::Node* p_node) {
+	if (p_node == nullptr) return;
+
+#define CONST_FUNC_ERROR(m_what, m_pos) \
+	ANALYZER_ERROR(Error::TYPE_ERROR, String::format("%s can't be used in the const function \"%s\".", m_what, p_func->name.c_str()), m_pos)
+
+	switch (p_node->type) {
+		case Parser::Node::Type::BLOCK: {
+			for (Parser::Node* statement : static_cast<const Parser::BlockNode*>(p_node)->statements) {
+				_check_const_func(p_func, statement);
+			}
+		} break;
+
+		case Parser::Node::Type::VAR: {
+			_check_const_func(p_func, static_cast<const Parser::VarNode*>(p_node)->assignment);
+		} break;
+
+		case Parser::Node::Type::CONST_VALUE:
+			break;
+
+		case Parser::Node::Type::IDENTIFIER: {
+			const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(p_node);
+			if (id->ref != Parser::IdentifierNode::REF_PARAMETER && id->ref != Parser::IdentifierNode::REF_LOCAL_VAR) {
+				throw CONST_FUNC_ERROR(String::format("attribute \"%s\"", id->name.c_str()).c_str(), id->pos);
+			}
+		} break;
+
+		case Parser::Node::Type::ARRAY: {
+			for (Parser::Node* element : static_cast<const Parser::ArrayNode*>(p_node)->elements) {
+				_check_const_func(p_func, element);
+			}
+		} break;
+
+		case Parser::Node::Type::MAP: {
+			for (const Parser::MapNode::Pair& pair : static_cast<const Parser::MapNode*>(p_node)->elements) {
+				_check_const_func(p_func, pair.key);
+				_check_const_func(p_func, pair.value);
+			}
+		} break;
+
+		case Parser::Node::Type::MAPPED_INDEX: {
+			const Parser::MappedIndexNode* mapped = static_cast<const Parser::MappedIndexNode*>(p_node);
+			_check_const_func(p_func, mapped->base);
+			_check_const_func(p_func, mapped->key);
+		} break;
+
+		case Parser::Node::Type::OPERATOR: {
+			for (Parser::Node* arg : static_cast<const Parser::OperatorNode*>(p_node)->args) {
+				_check_const_func(p_func, arg);
+			}
+		} break;
+
+		case Parser::Node::Type::CALL: {
+			const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_node);
+			for (Parser::Node* arg : call->args) _check_const_func(p_func, arg);
+
+			switch (call->base->type) {
+				case Parser::Node::Type::BUILTIN_FUNCTION: {
+					BuiltinFunctions::Type func = static_cast<const Parser::BuiltinFunctionNode*>(call->base)->func;
+					if (call->method != nullptr || !BuiltinFunctions::can_const_fold(func) || BuiltinFunctions::is_compiletime(func)) {
+						throw CONST_FUNC_ERROR(String::format("builtin function \"%s\"", BuiltinFunctions::get_func_name(func).c_str()).c_str(), call->pos);
+					}
+				} break;
+				case Parser::Node::Type::BUILTIN_TYPE: {
+					if (call->method != nullptr) throw CONST_FUNC_ERROR("static method call", call->pos);
+				} break;
+				case Parser::Node::Type::UNKNOWN:
+				case Parser::Node::Type::IDENTIFIER: {
+					if (call->base->type == Parser::Node::Type::UNKNOWN ||
+						static_cast<const Parser::IdentifierNode*>(call->base)->ref == Parser::IdentifierNode::REF_CARBON_CLASS) {
+						if (_find_const_func_target(call) == nullptr) {
+							throw CONST_FUNC_ERROR("non-const function call", call->pos);
+						}
+						break;
+					}
+				} // [[FALLTHROUGH]]
+				default: { // a_value.method();
+					if (call->method == nullptr) throw CONST_FUNC_ERROR("__call()", call->pos);
+					_check_const_func(p_func, call->base);
+				} break;
+			}
+		} break;
+
+		case Parser::Node::Type::CONTROL_FLOW: {
+			const Parser::ControlFlowNode* cf = static_cast<const Parser::ControlFlowNode*>(p_node);
+			if (cf->cf_type == Parser::ControlFlowNode::SWITCH) throw CONST_FUNC_ERROR("switch", cf->pos);
+			for (Parser::Node* arg : cf->args) _check_const_func(p_func, arg);
+			_check_const_func(p_func, cf->body);
+			_check_const_func(p_func, cf->body_else);
+		} break;
+
+		default: {
+			throw CONST_FUNC_ERROR(Parser::Node::get_node_type_name(p_node->type), p_node->pos);
+		}
+	}
+#undef CONST_FUNC_ERROR
+}
+
+const Parser::FunctionNode* Analyzer::_find_const_func_target(const Parser::CallNode* p_call) const {
+	if (p_call->method == nullptr || p_call->method->type != Parser::Node::Type::IDENTIFIER) return nullptr;
+	const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(p_call->method);
+
+	const Parser::FunctionNode* func = nullptr;
+	if (p_call->base->type == Parser::Node::Type::UNKNOWN) { // f();
+		if (id->ref == Parser::IdentifierNode::REF_FUNCTION && id->ref_base == Parser::IdentifierNode::BASE_LOCAL) func = id->_func;
+
+	} else if (p_call->base->type == Parser::Node::Type::IDENTIFIER) { // Aclass.f();
+		const Parser::IdentifierNode* base = static_cast<const Parser::IdentifierNode*>(p_call->base);
+		if (base->ref != Parser::IdentifierNode::REF_CARBON_CLASS) return nullptr;
+		const Parser::Node* member = base->_class->find_member(id->name);
+		if (member != nullptr && member->type == Parser::Node::Type::FUNCTION) func = static_cast<const Parser::FunctionNode*>(member);
+	}
+	return (func && func->is_const) ? func : nullptr;
+}
+
+bool Analyzer::_reduce_const_func_call(Parser::Node*& p_expr, const Parser::FunctionNode* p_func, bool p_all_const) {
+	_resolve_const_func(const_cast<Parser::FunctionNode*>(p_func));
+	if (!p_all_const || !p_func->is_reduced) return false;
+
+	const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_expr);
+	stdvec<var> args;
+	for (Parser::Node* arg : call->args) {
+		const var& value = static_cast<const Parser::ConstValueNode*>(arg)->value;
+		args.push_back((value.get_type() == var::ARRAY || value.get_type() == var::MAP) ? value.copy(true) : value);
+	}
+
+	var ret;
+	_const_func_steps = 0;
+	_const_func_depth = 0;
+	try {
+		ret = _const_func_call(p_func, args, call->pos);
+	} catch (const _ConstFuncGiveUp&) {
+		return false;
+	}
+	if (ret.get_type() == var::OBJECT) return false;
+
+	Parser::ConstValueNode* cv = new_node<Parser::ConstValueNode>(ret);
+	cv->pos = call->pos;
+	p_expr = cv;
+	return true;
+}
+
+var Analyzer::_const_func_call(const Parser::FunctionNode* p_func, stdvec<var>& p_args, Vect2i p_pos) {
+	if (!p_func->is_reduced) throw _ConstFuncGiveUp(); // (mutual) recursive call of a function being resolved.
+	if (_const_func_depth >= CONST_FUNC_MAX_DEPTH) throw _ConstFuncGiveUp();
+
+	int argc = (int)p_func->args.size(), argc_default = (int)p_func->default_args.size();
+	_check_arg_count(argc, argc_default, (int)p_args.size(), p_pos);
+	for (int i = (int)p_args.size(); i < argc; i++) {
+		p_args.push_back(p_func->default_args[i - (argc - argc_default)]);
+	}
+
+	for (int i = 0; i < argc; i++) _const_func_check_type(p_args[i], p_func->args[i].type);
+
+	_ConstFuncFrame frame;
+	frame.func = p_func;
+	frame.args = p_args;
+
+	_const_func_depth++;
+	_const_func_block(frame, p_func->body);
+	_const_func_depth--;
+	_const_func_check_type(frame.ret, p_func->return_type);
+	return frame.ret;
+}
+
+Analyzer::_ConstFuncFlow Analyzer::_const_func_block(_ConstFuncFrame& p_frame, const Parser::BlockNode* p_block) {
+	for (Parser::Node* statement : p_block->statements) {
+		if (++_const_func_steps > CONST_FUNC_MAX_STEPS) throw _ConstFuncGiveUp();
+
+		_ConstFuncFlow flow = CF_FLOW_NEXT;
+		try {
+			switch (statement->type) {
+				case Parser::Node::Type::VAR: {
+					const Parser::VarNode* var_node = static_cast<const Parser::VarNode*>(statement);
+					p_frame.locals[var_node] = (var_node->assignment != nullptr) ? _const_func_expr(p_frame, var_node->assignment) : var();
+					_const_func_check_type(p_frame.locals[var_node], var_node->data_type);
+				} break;
+
+				case Parser::Node::Type::CONTROL_FLOW: {
+					const Parser::ControlFlowNode* cf = static_cast<const Parser::ControlFlowNode*>(statement);
+					switch (cf->cf_type) {
+						case Parser::ControlFlowNode::IF: {
+							if (_const_func_expr(p_frame, cf->args[0]).operator bool()) {
+								flow = _const_func_block(p_frame, cf->body);
+							} else if (cf->body_else != nullptr) {
+								flow = _const_func_block(p_frame, cf->body_else);
+							}
+						} break;
+
+						case Parser::ControlFlowNode::SWITCH:
+							THROW_BUG("switch should be an error in a const function.");
+
+						case Parser::ControlFlowNode::WHILE: {
+							while (_const_func_expr(p_frame, cf->args[0]).operator bool()) {
+								if (++_const_func_steps > CONST_FUNC_MAX_STEPS) throw _ConstFuncGiveUp();
+								flow = _const_func_block(p_frame, cf->body);
+								if (flow == CF_FLOW_BREAK || flow == CF_FLOW_RETURN) break;
+							}
+							if (flow != CF_FLOW_RETURN) flow = CF_FLOW_NEXT;
+						} break;
+
+						case Parser::ControlFlowNode::FOR: {
+							if (cf->args[0] != nullptr && cf->args[0]->type == Parser::Node::Type::VAR) {
+								const Parser::VarNode* iterator = static_cast<const Parser::VarNode*>(cf->args[0]);
+								p_frame.locals[iterator] = (iterator->assignment != nullptr) ? _const_func_expr(p_frame, iterator->assignment) : var();
+								_const_func_check_type(p_frame.locals[iterator], iterator->data_type);
+							} else if (cf->args[0] != nullptr) {
+								_const_func_expr(p_frame, cf->args[0]);
+							}
+							while (cf->args[1] == nullptr || _const_func_expr(p_frame, cf->args[1]).operator bool()) {
+								if (++_const_func_steps > CONST_FUNC_MAX_STEPS) throw _ConstFuncGiveUp();
+								flow = _const_func_block(p_frame, cf->body);
+								if (flow == CF_FLOW_BREAK || flow == CF_FLOW_RETURN) break;
+								if (cf->args[2] != nullptr) _const_func_expr(p_frame, cf->args[2]);
+							}
+							if (flow != CF_FLOW_RETURN) flow = CF_FLOW_NEXT;
+						} break;
+
+						case Parser::ControlFlowNode::FOREACH: {
+							const Parser::VarNode* iter_value = static_cast<const Parser::VarNode*>(cf->args[0]);
+							var on = _const_func_expr(p_frame, cf->args[1]);
+							var iterator = on.__iter_begin();
+							while (iterator.__iter_has_next()) {
+								if (++_const_func_steps > CONST_FUNC_MAX_STEPS) throw _ConstFuncGiveUp();
+								p_frame.locals[iter_value] = iterator.__iter_next();
+								flow = _const_func_block(p_frame, cf->body);
+								if (flow == CF_FLOW_BREAK || flow == CF_FLOW_RETURN) break;
+							}
+							if (flow != CF_FLOW_RETURN) flow = CF_FLOW_NEXT;
+						} break;
+
+						case Parser::ControlFlowNode::BREAK:
+							flow = CF_FLOW_BREAK;
+							break;
+						case Parser::ControlFlowNode::CONTINUE:
+							flow = CF_FLOW_CONTINUE;
+							break;
+						case Parser::ControlFlowNode::RETURN: {
+							p_frame.ret = (cf->args.size() == 1) ? _const_func_expr(p_frame, cf->args[0]) : var();
+							flow = CF_FLOW_RETURN;
+						} break;
+					}
+					MISSED_ENUM_CHECK(Parser::ControlFlowNode::CfType::_CF_MAX_, 8);
+				} break;
+
+				default: {
+					_const_func_expr(p_frame, statement);
+				} break;
+			}
+		} catch (const CompileTimeError&) {
+			throw;
+		} catch (const Throwable& err) {
+			throw ANALYZER_ERROR(err.get_type(), err.what(), statement->pos);
+		}
+
+		if (flow != CF_FLOW_NEXT) return flow;
+	}
+	return CF_FLOW_NEXT;
+}
+
+var* Analyzer::_const_func_local(_ConstFuncFrame& p_frame, const Parser::Node* p_expr) {
+	if (p_expr->type != Parser::Node::Type::IDENTIFIER) return nullptr;
+	const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(p_expr);
+	switch (id->ref) {
+		case Parser::IdentifierNode::REF_PARAMETER:
+			return &p_frame.args[id->param_index];
+		case Parser::IdentifierNode::REF_LOCAL_VAR:
+			return &p_frame.locals[id->_var];
+		default:
+			THROW_BUG("invalid identifier in a const function.");
+	}
+}
+
+var Analyzer::_const_func_expr(_ConstFuncFrame& p_frame, const Parser::Node* p_expr) {
+	switch (p_expr->type) {
+		case Parser::Node::Type::CONST_VALUE: {
+			const var& value = static_cast<const Parser::ConstValueNode*>(p_expr)->value;
+			if (value.get_type() == var::ARRAY || value.get_type() == var::MAP) return value.copy(true);
+			return value;
+		}
+
+		case Parser::Node::Type::IDENTIFIER:
+			return *_const_func_local(p_frame, p_expr);
+
+		case Parser::Node::Type::ARRAY: {
+			Array arr;
+			for (Parser::Node* element : static_cast<const Parser::ArrayNode*>(p_expr)->elements) {
+				arr.push_back(_const_func_expr(p_frame, element));
+			}
+			return arr;
+		}
+
+		case Parser::Node::Type::MAP: {
+			Map map;
+			for (const Parser::MapNode::Pair& pair : static_cast<const Parser::MapNode*>(p_expr)->elements) {
+				var key = _const_func_expr(p_frame, pair.key);
+				map[key] = _const_func_expr(p_frame, pair.value);
+			}
+			return map;
+		}
+
+		case Parser::Node::Type::MAPPED_INDEX: {
+			const Parser::MappedIndexNode* mapped = static_cast<const Parser::MappedIndexNode*>(p_expr);
+			var on = _const_func_expr(p_frame, mapped->base);
+			return on.__get_mapped(_const_func_expr(p_frame, mapped->key));
+		}
+
+		case Parser::Node::Type::CALL: {
+			const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_expr);
+			stdvec<var> args;
+			for (Parser::Node* arg : call->args) args.push_back(_const_func_expr(p_frame, arg));
+			stdvec<var*> arg_ptrs;
+			for (var& arg : args) arg_ptrs.push_back(&arg);
+
+			switch (call->base->type) {
+				case Parser::Node::Type::BUILTIN_FUNCTION: {
+					var ret;
+					BuiltinFunctions::call(static_cast<const Parser::BuiltinFunctionNode*>(call->base)->func, arg_ptrs, ret);
+					return ret;
+				}
+				case Parser::Node::Type::BUILTIN_TYPE:
+					return BuiltinTypes::construct(static_cast<const Parser::BuiltinTypeNode*>(call->base)->builtin_type, arg_ptrs);
+				default: {
+					const Parser::FunctionNode* func = _find_const_func_target(call);
+					if (func != nullptr) return _const_func_call(func, args, call->pos);
+
+					// the method is called on the local itself (if it's one) as the runtime does.
+					var temp;
+					var* on = (call->base->type == Parser::Node::Type::IDENTIFIER) ? _const_func_local(p_frame, call->base) : nullptr;
+					if (on == nullptr) {
+						temp = _const_func_expr(p_frame, call->base);
+						on = &temp;
+					}
+					if (on->get_type() == var::OBJECT) throw _ConstFuncGiveUp();
+					return on->call_method(static_cast<const Parser::IdentifierNode*>(call->method)->name, arg_ptrs);
+				}
+			}
+		}
+
+		case Parser::Node::Type::OPERATOR: {
+			const Parser::OperatorNode* op = static_cast<const Parser::OperatorNode*>(p_expr);
+
+			if (Parser::OperatorNode::is_assignment(op->op_type)) {
+				var::Operator var_op = (op->op_type == Parser::OperatorNode::OP_EQ) ? var::_OP_MAX_ : _const_func_var_op(op->op_type);
+
+				var temp, key;
+				var* dst = nullptr;
+				const Parser::Node* target = op->args[0];
+				if (target->type == Parser::Node::Type::MAPPED_INDEX) {
+					const Parser::MappedIndexNode* mapped = static_cast<const Parser::MappedIndexNode*>(target);
+					dst = (mapped->base->type == Parser::Node::Type::IDENTIFIER) ? _const_func_local(p_frame, mapped->base) : nullptr;
+					if (dst == nullptr) {
+						temp = _const_func_expr(p_frame, mapped->base);
+						dst = &temp;
+					}
+					key = _const_func_expr(p_frame, mapped->key);
+				} else {
+					dst = _const_func_local(p_frame, target);
+				}
+				var value = _const_func_expr(p_frame, op->args[1]);
+
+				if (var_op != var::_OP_MAX_) {
+					var result = (target->type == Parser::Node::Type::MAPPED_INDEX) ? dst->__get_mapped(key) : *dst;
+					// same as the OPERATOR_ASSIGN opcode: appending to a string or an array is in-place.
+					if (var_op == var::OP_ADDITION && result.get_type() == value.get_type() &&
+						(result.get_type() == var::STRING || result.get_type() == var::ARRAY)) {
+						result += value;
+					} else {
+						result = _const_func_operator(var_op, result, value);
+					}
+					value = result;
+				}
+
+				if (target->type == Parser::Node::Type::MAPPED_INDEX) {
+					dst->__set_mapped(key, value);
+				} else {
+					const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(target);
+					if (id->ref == Parser::IdentifierNode::REF_LOCAL_VAR) _const_func_check_type(value, id->_var->data_type);
+					else if (id->ref == Parser::IdentifierNode::REF_PARAMETER) _const_func_check_type(value, p_frame.func->args[id->param_index].type);
+					*dst = value;
+				}
+				return value;
+			}
+
+			switch (op->op_type) {
+				case Parser::OperatorNode::OP_AND:
+					if (!_const_func_expr(p_frame, op->args[0]).operator bool()) return false;
+					return _const_func_expr(p_frame, op->args[1]).operator bool();
+				case Parser::OperatorNode::OP_OR:
+					if (_const_func_expr(p_frame, op->args[0]).operator bool()) return true;
+					return _const_func_expr(p_frame, op->args[1]).operator bool();
+				default: {
+					var left = _const_func_expr(p_frame, op->args[0]);
+					var right = (op->args.size() == 2) ? _const_func_expr(p_frame, op->args[1]) : var();
+					return _const_func_operator(_const_func_var_op(op->op_type), left, right);
+				}
+			}
+		}
+
+		default:
+			THROW_BUG("invalid expression in a const function.");
+	}
+}
+
+} // namespace carbon
@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/aot.h"
+#include "compiler/bytecode.h"
+#include "compiler/function.h"
+#include "core/platform.h"
+
+namespace carbon {
+
+static const char* _MODULE_SYMBOL = "carbon_aot_module";
+
+uint32_t AOTModule::hash(const Function* p_func) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (uint32_t word : p_func->get_opcodes()) {
+		for (int i = 0; i < 4; i++) {
+			hash ^= (word >> (i * 8)) & 0xff;
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+void AOTModule::_get_functions(Bytecode* p_bytecode, stdvec<std::pair<String, const Function*>>& r_functions) {
+	String prefix = (p_bytecode->is_class()) ? p_bytecode->get_name() + "." : "";
+	for (auto& it : p_bytecode->get_functions()) {
+		r_functions.push_back(std::make_pair(prefix + it.first, (const Function*)it.second.get()));
+	}
+	if (p_bytecode->get_static_initializer() != nullptr) {
+		r_functions.push_back(std::make_pair(prefix + "@static_initializer", p_bytecode->get_static_initializer()));
+	}
+	if (p_bytecode->is_class() && p_bytecode->get_member_initializer() != nullptr) {
+		r_functions.push_back(std::make_pair(prefix + "@member_initializer", p_bytecode->get_member_initializer()));
+	}
+	if (!p_bytecode->is_class()) {
+		for (auto& it : p_bytecode->get_classes()) _get_functions(it.second.get(), r_functions);
+	}
+}
+
+// a native function runs the same instructions as VM::_run_predecoded() with the operands and the
+// jumps written in place, from the instruction at p_index till one which isn't predecoded.
+String AOTModule::_write_function(const PredecodedFunction* p_predecoded, const String& p_symbol) {
+	const stdvec<PredecodedInstruction>& instructions = p_predecoded->get_instructions();
+
+	stdvec<bool> is_label(instructions.size(), false);
+	for (int i = 0; i < (int)instructions.size(); i++) {
+		const PredecodedInstruction& instr = instructions[i];
+		if (instr.op == PredecodedInstruction::INTERPRET) continue;
+		is_label[i] = true; // could be entered from the interpreter.
+		switch (instr.op) {
+			case PredecodedInstruction::COMPARE_JUMP_INT:
+			case PredecodedInstruction::COMPARE_JUMP_FLOAT:
+				if (i + 2 < (int)instructions.size()) is_label[i + 2] = true;
+			case PredecodedInstruction::JUMP:
+			case PredecodedInstruction::JUMP_IF:
+			case PredecodedInstruction::JUMP_IF_NOT:
+			case PredecodedInstruction::ITER_NEXT:
+				is_label[instr.target] = true;
+				break;
+			default:
+				break;
+		}
+	}
+
+	String src = String::format("static bool %s(var** f, int p_index, uint32_t& r_ip, var& r_ret) {\n", p_symbol.c_str());
+	src += "\tswitch (p_index) {\n";
+	for (int i = 0; i < (int)instructions.size(); i++) {
+		if (instructions[i].op != PredecodedInstruction::INTERPRET) src += String::format("\t\tcase %i: goto L%i;\n", i, i);
+	}
+	src += "\t\tdefault: THROW_BUG(\"invalid entry of a native function.\");\n\t}\n\n";
+
+	for (int i = 0; i < (int)instructions.size(); i++) {
+		const PredecodedInstruction& instr = instructions[i];
+		if (is_label[i]) src += String::format("L%i:\n", i);
+		src += String::format("\tr_ip = %u; ", instr.ip);
+
+		unsigned a = instr.a, b = instr.b, c = instr.c, imm = instr.imm;
+		switch (instr.op) {
+			case PredecodedInstruction::INTERPRET: src += "return false;"; break;
+
+			case PredecodedInstruction::MOVE:      src += String::format("*f[%u] = *f[%u];", c, a); break;
+			case PredecodedInstruction::SET_TRUE:  src += String::format("*f[%u] = true;", c); break;
+			case PredecodedInstruction::SET_FALSE: src += String::format("*f[%u] = false;", c); break;
+			case PredecodedInstruction::CLEAR:     src += String::format("*f[%u] = var();", c); break;
+
+#define _WRITE_OPERATOR(m_op, m_func) \
+			case PredecodedInstruction::m_op: src += String::format("PredecodedOps::" m_func "(f[%u], f[%u], f[%u]);", a, b, c); break
+#define _WRITE_OPERATOR_IMM(m_op, m_func) \
+			case PredecodedInstruction::m_op: src += String::format("PredecodedOps::" m_func "((var::Operator)%u, f[%u], f[%u], f[%u]);", imm, a, b, c); break
+			_WRITE_OPERATOR_IMM(OPERATOR, "operator_generic");
+			_WRITE_OPERATOR(ADD_INT, "add_int");
+			_WRITE_OPERATOR(SUB_INT, "sub_int");
+			_WRITE_OPERATOR(MUL_INT, "mul_int");
+			_WRITE_OPERATOR_IMM(OPERATOR_INT, "operator_int");
+			_WRITE_OPERATOR(ADD_FLOAT, "add_float");
+			_WRITE_OPERATOR(SUB_FLOAT, "sub_float");
+			_WRITE_OPERATOR(MUL_FLOAT, "mul_float");
+			_WRITE_OPERATOR_IMM(OPERATOR_FLOAT, "operator_float");
+			_WRITE_OPERATOR(GET_MAPPED_UNCHECKED, "get_mapped_unchecked");
+#undef _WRITE_OPERATOR
+#undef _WRITE_OPERATOR_IMM
+
+			case PredecodedInstruction::COMPARE_JUMP_INT:
+			case PredecodedInstruction::COMPARE_JUMP_FLOAT:
+				src += String::format("if (PredecodedOps::compare((var::Operator)%u, %s, f[%u], f[%u], f[%u]) == %s) goto L%u; goto L%i;",
+					imm, (instr.op == PredecodedInstruction::COMPARE_JUMP_FLOAT) ? "true" : "false", a, b, c,
+					(instr.jump_if) ? "true" : "false", instr.target, i + 2);
+				break;
+
+			case PredecodedInstruction::GET_MAPPED: src += String::format("*f[%u] = f[%u]->__get_mapped(*f[%u]);", c, a, b); break;
+			case PredecodedInstruction::SET_MAPPED: src += String::format("f[%u]->__set_mapped(*f[%u], *f[%u]);", a, b, c); break;
+			case PredecodedInstruction::CALL_INTRINSIC:
+				src += String::format("BuiltinFunctions::call_intrinsic((BuiltinFunctions::Type)%u, *f[%u], *f[%u], *f[%u]);", imm, a, b, c);
+				break;
+
+			case PredecodedInstruction::JUMP:        src += String::format("goto L%u;", instr.target); break;
+			case PredecodedInstruction::JUMP_IF:     src += String::format("if (f[%u]->operator bool()) goto L%u;", a, instr.target); break;
+			case PredecodedInstruction::JUMP_IF_NOT: src += String::format("if (!f[%u]->operator bool()) goto L%u;", a, instr.target); break;
+			case PredecodedInstruction::ITER_BEGIN:  src += String::format("*f[%u] = f[%u]->__iter_begin();", c, a); break;
+			case PredecodedInstruction::ITER_NEXT:
+				src += String::format("if (!f[%u]->__iter_has_next()) goto L%u; *f[%u] = f[%u]->__iter_next();", a, instr.target, c, a);
+				break;
+
+			case PredecodedInstruction::RETURN: src += String::format("r_ret = *f[%u]; return true;", a); break;
+			case PredecodedInstruction::END:    src += "r_ret = var(); return true;"; break;
+		}
+		src += "\n";
+	}
+	src += "\treturn false;\n}\n\n";
+	return src;
+}
+
+String AOTModule::write(Bytecode* p_bytecode) {
+	stdvec<std::pair<String, const Function*>> functions;
+	_get_functions(p_bytecode, functions);
+
+	String src = String::format("// generated by carbon --aot from \"%s\", do not edit.\n\n", p_bytecode->get_name().c_str());
+	src += "#include \"carbon.h\"\n#include \"compiler/builtin.h\"\n#include \"compiler/predecode.h\"\n\n";
+	src += "using namespace carbon;\n\n";
+
+	String module = "";
+	for (int i = 0; i < (int)functions.size(); i++) {
+		ptr<PredecodedFunction> predecoded = PredecodedFunction::build(functions[i].second);
+		if (predecoded == nullptr) continue; // nothing predecoded, it's interpreted.
+
+		String symbol = String::format("_aot_function_%i", i);
+		src += String::format("// %s\n", functions[i].first.c_str());
+		src += _write_function(predecoded.get(), symbol);
+		module += String::format("\tp_module->add(\"%s\", %uu, %s);\n", functions[i].first.c_str(), hash(functions[i].second), symbol.c_str());
+	}
+
+	src += "#ifdef _WIN32\n__declspec(dllexport)\n#endif\n";
+	src += String::format("extern \"C\" void %s(AOTModule* p_module) {\n", _MODULE_SYMBOL);
+	src += module;
+	src += "}\n";
+	return src;
+}
+
+ptr<AOTModule> AOTModule::load(const String& p_path) {
+	void* handle = _Platform::dl_open(p_path); // it's never closed, the functions are referenced till the end.
+	ModuleFunc module_func = (ModuleFunc)_Platform::dl_symbol(handle, _MODULE_SYMBOL);
+	if (module_func == nullptr) {
+		THROW_ERROR(Error::IO_ERROR, String::format("\"%s\" isn't a carbon aot module.", p_path.c_str()));
+	}
+
+	ptr<AOTModule> module = newptr<AOTModule>();
+	module_func(module.get());
+	return module;
+}
+
+void AOTModule::add(const char* p_name, uint32_t p_hash, PredecodedNativeFunc p_func) {
+	_NativeFunc& native = _functions[p_name];
+	native.hash = p_hash;
+	native.func = p_func;
+}
+
+uint32_t AOTModule::apply(Bytecode* p_bytecode) const {
+	stdvec<std::pair<String, const Function*>> functions;
+	_get_functions(p_bytecode, functions);
+
+	uint32_t count = 0;
+	for (const std::pair<String, const Function*>& func : functions) {
+		auto it = _functions.find(func.first);
+		if (it == _functions.end() || it->second.hash != hash(func.second)) continue; // changed after it's written.
+
+		// the native code is written for the same instructions, it's frame and entries are the predecoded one's.
+		ptr<PredecodedFunction> predecoded = PredecodedFunction::build(func.second);
+		if (predecoded == nullptr) continue;
+		predecoded->set_native(it->second.func);
+		func.second->_predecoded = predecoded;
+		func.second->_predecoded_built = true;
+		count++;
+	}
+	return count;
+}
+
+}
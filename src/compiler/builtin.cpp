@@ -181,9 +181,14 @@ int BuiltinFunctions::get_arg_count(BuiltinFunctions::Type p_func) {
 			return -1;
 		case Type::MATH_POW:
 			return 2;
+		case Type::MATH_ABS:
+		case Type::MATH_FLOOR:
+		case Type::MATH_SQRT:
+		case Type::LEN:
+			return 1;
 	}
 	return 0;
-	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 13);
+	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
 }
 
 bool BuiltinFunctions::can_const_fold(Type p_func) {
@@ -195,7 +200,7 @@ bool BuiltinFunctions::can_const_fold(Type p_func) {
 		default:
 			return true;
 	}
-	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 13);
+	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
 }
 
 bool BuiltinFunctions::is_compiletime(Type p_func) {
@@ -208,7 +213,7 @@ bool BuiltinFunctions::is_compiletime(Type p_func) {
 		default:
 			return false;
 	}
-	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 13);
+	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
 }
 
 // TODO: change this to return r_ret for consistancy.
@@ -254,8 +259,8 @@ void BuiltinFunctions::call(Type p_func, const stdvec<var*>& p_args, var& r_ret)
 			r_ret = String(ss.str());
 		} break;
 
-		case Type::MATH_MAX: {
-			if (p_args.size() <= 1) THROW_ERROR(Error::INVALID_ARG_COUNT, "Expected at least 2 arguments.");
+		case Type::MATH_MIN: {
+			if (p_args.size() <= 1) THROW_ERROR(Error::INVALID_ARG_COUNT, "expected at least 2 arguments.");
 			var min = *p_args[0];
 			for (int i = 1; i < (int)p_args.size(); i++) {
 				if (*p_args[i] < min) {
@@ -265,9 +270,9 @@ void BuiltinFunctions::call(Type p_func, const stdvec<var*>& p_args, var& r_ret)
 			r_ret = min;
 		} break;
 
-		case Type::MATH_MIN: {
+		case Type::MATH_MAX: {
 			if (p_args.size() <= 1) THROW_ERROR(Error::INVALID_ARG_COUNT, "expected at least 2 arguments.");
-			var max = p_args[0];
+			var max = *p_args[0];
 			for (int i = 1; i < (int)p_args.size(); i++) {
 				if (*p_args[i] > max) {
 					max = *p_args[i];
@@ -276,19 +281,110 @@ void BuiltinFunctions::call(Type p_func, const stdvec<var*>& p_args, var& r_ret)
 			r_ret = max;
 		} break;
 
-		case Type::MATH_POW: {
+		case Type::MATH_POW:
 			if (p_args.size() != 2) THROW_ERROR(Error::INVALID_ARG_COUNT, "Expected exactly 2 arguments.");
-			if (p_args[0]->get_type() != var::INT && p_args[1]->get_type() != var::FLOAT)
+			call_intrinsic(p_func, *p_args[0], *p_args[1], r_ret);
+			break;
+
+		case Type::MATH_ABS:
+		case Type::MATH_FLOOR:
+		case Type::MATH_SQRT:
+		case Type::LEN:
+			if (p_args.size() != 1) THROW_ERROR(Error::INVALID_ARG_COUNT, "Expected exactly 1 argument.");
+			call_intrinsic(p_func, *p_args[0], var(), r_ret);
+			break;
+
+	}
+	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
+}
+
+bool BuiltinFunctions::is_intrinsic(Type p_func, int p_argc) {
+	switch (p_func) {
+		case Type::MATH_MIN:
+		case Type::MATH_MAX:
+		case Type::MATH_POW:
+			return p_argc == 2;
+		case Type::MATH_ABS:
+		case Type::MATH_FLOOR:
+		case Type::MATH_SQRT:
+		case Type::LEN:
+			return p_argc == 1;
+		default:
+			return false;
+	}
+	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
+}
+
+#define IS_NUMERIC(m_var) ((m_var).get_type() == var::INT || (m_var).get_type() == var::FLOAT)
+
+// r_ret could be one of the arguments, they're read before it's written.
+void BuiltinFunctions::call_intrinsic(Type p_func, const var& p_arg0, const var& p_arg1, var& r_ret) {
+	switch (p_func) {
+		case Type::MATH_MIN:
+		case Type::MATH_MAX: {
+			bool second; // the first one wins a tie.
+			if (p_arg0.get_type() == var::INT && p_arg1.get_type() == var::INT) {
+				int64_t a = p_arg0.operator int64_t(), b = p_arg1.operator int64_t();
+				r_ret = (p_func == Type::MATH_MIN) ? ((b < a) ? b : a) : ((b > a) ? b : a);
+				return;
+			} else if (IS_NUMERIC(p_arg0) && IS_NUMERIC(p_arg1)) {
+				double a = p_arg0.operator double(), b = p_arg1.operator double();
+				second = (p_func == Type::MATH_MIN) ? (b < a) : (b > a);
+			} else {
+				second = (p_func == Type::MATH_MIN) ? (p_arg1 < p_arg0) : (p_arg0 < p_arg1);
+			}
+			r_ret = (second) ? p_arg1 : p_arg0;
+		} break;
+
+		case Type::MATH_POW: {
+			if (!IS_NUMERIC(p_arg0)) THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 0.");
+			if (!IS_NUMERIC(p_arg1)) THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 1.");
+			r_ret = pow(p_arg0.operator double(), p_arg1.operator double());
+		} break;
+
+		case Type::MATH_ABS: {
+			if (p_arg0.get_type() == var::INT) {
+				int64_t value = p_arg0.operator int64_t();
+				r_ret = (value < 0) ? -value : value;
+			} else if (p_arg0.get_type() == var::FLOAT) {
+				r_ret = fabs(p_arg0.operator double());
+			} else {
+				THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 0.");
+			}
+		} break;
+
+		case Type::MATH_FLOOR: {
+			if (p_arg0.get_type() == var::INT) {
+				r_ret = p_arg0.operator int64_t();
+			} else if (p_arg0.get_type() == var::FLOAT) {
+				r_ret = floor(p_arg0.operator double());
+			} else {
 				THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 0.");
-			if (p_args[1]->get_type() != var::INT && p_args[1]->get_type() != var::FLOAT)
-				THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 1.");
-			r_ret = pow(p_args[0]->operator double(), p_args[1]->operator double());
+			}
+		} break;
+
+		case Type::MATH_SQRT: {
+			if (!IS_NUMERIC(p_arg0)) THROW_ERROR(Error::TYPE_ERROR, "expected a numeric value at argument 0.");
+			r_ret = sqrt(p_arg0.operator double());
 		} break;
 
+		case Type::LEN: {
+			switch (p_arg0.get_type()) {
+				case var::STRING: r_ret = (int64_t)p_arg0.operator const String&().size(); break;
+				case var::ARRAY:  r_ret = (int64_t)p_arg0.operator const Array&().size(); break;
+				case var::MAP:    r_ret = (int64_t)p_arg0.operator const Map&().size(); break;
+				default:
+					THROW_ERROR(Error::TYPE_ERROR, String::format("object of type %s has no len().", p_arg0.get_type_name().c_str()));
+			}
+		} break;
+
+		default:
+			THROW_BUG(String::format("builtin function \"%s\" isn't an intrinsic.", get_func_name(p_func).c_str()));
 	}
-	MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 13);
 }
 
+#undef IS_NUMERIC
+
 } // namespace carbon
 
 /******************************************************************************************************************/
@@ -75,6 +75,11 @@ var* Bytecode::get_global_const_value(uint32_t p_index) {
 	return &_global_const_values[p_index];
 }
 
+Function* Bytecode::get_direct_function(uint32_t p_index) const {
+	THROW_INVALID_INDEX(_direct_functions.size(), p_index);
+	return _direct_functions[p_index];
+}
+
 #define _GET_OR_NULL(m_map, m_addr)         \
 	auto it = m_map.find(p_name);			\
 	if (it == m_map.end()) return nullptr;	\
@@ -340,4 +345,9 @@ uint32_t Bytecode::_global_const_value_get(const var& p_value) {
 	return (uint32_t)(_global_const_values.size() - 1);
 }
 
+uint32_t Bytecode::_global_const_value_add(const var& p_value) {
+	_global_const_values.push_back(p_value);
+	return (uint32_t)(_global_const_values.size() - 1);
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,557 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/bytecode_cache.h"
+#include "compiler/bytecode.h"
+#include "compiler/function.h"
+#include "core/platform.h"
+#include "native/file.h"
+#include "native/buffer.h"
+
+#include <cstring>
+
+namespace carbon {
+
+// the bytes are written in the host's order, a cache of the other order doesn't match the magic.
+static const uint32_t CACHE_MAGIC = 0x00434243; // "CBC"
+static const uint32_t CACHE_VERSION = 2;        // increase when the format or the opcodes are changed.
+
+#define THROW_CORRUPTED(m_path) THROW_ERROR(Error::IO_ERROR, String::format("bytecode cache \"%s\" is corrupted.", (m_path).c_str()))
+
+class _CacheWriter {
+	std::string _data;
+
+public:
+	const std::string& get_data() const { return _data; }
+
+	void write_bytes(const void* p_data, size_t p_size) { _data.append((const char*)p_data, p_size); }
+	void write_u8(uint8_t p_value) { write_bytes(&p_value, sizeof p_value); }
+	void write_u32(uint32_t p_value) { write_bytes(&p_value, sizeof p_value); }
+	void write_u64(uint64_t p_value) { write_bytes(&p_value, sizeof p_value); }
+	void write_i64(int64_t p_value) { write_bytes(&p_value, sizeof p_value); }
+	void write_f64(double p_value) { write_bytes(&p_value, sizeof p_value); }
+	void write_string(const String& p_value) {
+		write_u32((uint32_t)p_value.size());
+		write_bytes(p_value.c_str(), p_value.size());
+	}
+
+	void write_var(const var& p_value) {
+		write_u8((uint8_t)p_value.get_type());
+		switch (p_value.get_type()) {
+			case var::_NULL:
+			case var::VAR:
+				break;
+			case var::BOOL: write_u8(p_value.operator bool()); break;
+			case var::INT: write_i64(p_value.operator int64_t()); break;
+			case var::FLOAT: write_f64(p_value.operator double()); break;
+			case var::STRING: write_string(p_value.operator String()); break;
+			case var::ARRAY: {
+				Array arr = p_value.operator Array();
+				write_u32((uint32_t)arr.size());
+				for (const var& element : *arr.get_stdvec()) write_var(element);
+			} break;
+			case var::MAP: {
+				Map map = p_value.operator Map();
+				const Map::_map_internal_t* data = (const Map::_map_internal_t*)map.get_data();
+				write_u32((uint32_t)data->size());
+				for (const auto& it : *data) {
+					write_var(it.first);
+					write_var(it.second);
+				}
+			} break;
+			case var::OBJECT:
+				THROW_ERROR(Error::TYPE_ERROR, String::format("a constant of type %s can't be cached.", p_value.get_type_name().c_str()));
+			case var::_TYPE_MAX_:
+				THROW_BUG("invalid var type.");
+		}
+		MISSED_ENUM_CHECK(var::_TYPE_MAX_, 9);
+	}
+};
+
+class _CacheReader {
+	const uint8_t* _data;
+	const uint8_t* _end;
+	String _path;
+
+public:
+	_CacheReader(const void* p_data, size_t p_size, const String& p_path)
+		: _data((const uint8_t*)p_data), _end((const uint8_t*)p_data + p_size), _path(p_path) {}
+
+	bool is_end() const { return _data == _end; }
+	const String& get_path() const { return _path; }
+
+	const uint8_t* read_bytes(size_t p_size) {
+		if ((size_t)(_end - _data) < p_size) THROW_CORRUPTED(_path);
+		const uint8_t* bytes = _data;
+		_data += p_size;
+		return bytes;
+	}
+	template <typename T> T read() {
+		T value;
+		memcpy(&value, read_bytes(sizeof value), sizeof value);
+		return value;
+	}
+	uint8_t read_u8() { return read<uint8_t>(); }
+	uint32_t read_u32() { return read<uint32_t>(); }
+	uint64_t read_u64() { return read<uint64_t>(); }
+	int64_t read_i64() { return read<int64_t>(); }
+	double read_f64() { return read<double>(); }
+	String read_string() {
+		uint32_t size = read_u32();
+		return std::string((const char*)read_bytes(size), size);
+	}
+
+	var read_var() {
+		uint8_t type = read_u8();
+		switch (type) {
+			case var::_NULL: return var();
+			case var::VAR: return var();
+			case var::BOOL: return read_u8() != 0;
+			case var::INT: return read_i64();
+			case var::FLOAT: return read_f64();
+			case var::STRING: return read_string();
+			case var::ARRAY: {
+				Array arr;
+				uint32_t size = read_u32();
+				for (uint32_t i = 0; i < size; i++) arr.push_back(read_var());
+				return arr;
+			}
+			case var::MAP: {
+				Map map;
+				uint32_t size = read_u32();
+				for (uint32_t i = 0; i < size; i++) {
+					var key = read_var();
+					map.insert(key, read_var());
+				}
+				return map;
+			}
+		}
+		THROW_CORRUPTED(_path);
+	}
+
+	void read_header(BytecodeCache::Header* r_header) {
+		r_header->source_hash = read_u64();
+		r_header->hash = read_u64();
+		uint32_t count = read_u32();
+		for (uint32_t i = 0; i < count; i++) r_header->import_paths.push_back(read_string());
+	}
+};
+
+// a file maps the cache in memory, it's copied out as the opcodes are patched at runtime (by a
+// profile or the predecoded functions) so it's unmapped once loaded.
+class _MappedFile {
+	const void* _data = nullptr;
+	size_t _size = 0;
+
+public:
+	_MappedFile(const String& p_path) { _data = _Platform::file_map(p_path, &_size); }
+	~_MappedFile() { if (_data != nullptr) _Platform::file_unmap(_data, _size); }
+	const void* get_data() const { return _data; }
+	size_t get_size() const { return _size; }
+};
+
+class _BytecodeWriter {
+public:
+	_CacheWriter writer;
+
+	void write_function(const Function* p_func) {
+		writer.write_string(p_func->_name);
+		writer.write_u8(p_func->_is_static);
+		writer.write_u32((uint32_t)p_func->_arg_count);
+		writer.write_u32((uint32_t)p_func->_is_reference.size());
+		for (bool is_reference : p_func->_is_reference) writer.write_u8(is_reference);
+		writer.write_u32((uint32_t)p_func->_arg_types.size());
+		for (var::Type type : p_func->_arg_types) writer.write_u8((uint8_t)type);
+		writer.write_u8((uint8_t)p_func->_return_type);
+		writer.write_u32((uint32_t)p_func->_default_args.size());
+		for (const var& value : p_func->_default_args) writer.write_var(value);
+		writer.write_u32((uint32_t)p_func->_opcodes.size());
+		writer.write_bytes(p_func->_opcodes.data(), p_func->_opcodes.size() * sizeof(uint32_t));
+		writer.write_u32((uint32_t)p_func->op_dbg.size());
+		for (const auto& it : p_func->op_dbg) {
+			writer.write_u32(it.first);
+			writer.write_u32(it.second);
+		}
+		writer.write_u32((uint32_t)p_func->op_inline.size());
+		for (const auto& it : p_func->op_inline) {
+			writer.write_u32(it.first);
+			writer.write_u32(it.second);
+		}
+		writer.write_u32((uint32_t)p_func->_inline_sites.size());
+		for (const InlineSite& site : p_func->_inline_sites) {
+			writer.write_string(site.name);
+			writer.write_u32(site.line);
+			writer.write_u32(site.parent);
+		}
+		writer.write_u32(p_func->_stack_size);
+	}
+
+	void write_optional_function(const Function* p_func) {
+		writer.write_u8(p_func != nullptr);
+		if (p_func != nullptr) write_function(p_func);
+	}
+
+	// the name of a function of p_bytecode ("" if it's nullptr).
+	static String get_function_name(const Bytecode* p_bytecode, const Function* p_func) {
+		if (p_func == nullptr) return "";
+		for (const auto& it : p_bytecode->_functions) {
+			if (it.second.get() == p_func) return it.first;
+		}
+		THROW_BUG("function not found in it's bytecode.");
+	}
+
+	void write_bytecode(const Bytecode* p_bytecode) {
+		writer.write_u8(p_bytecode->_is_class);
+		writer.write_string(p_bytecode->_name);
+
+		if (p_bytecode->_is_class) {
+			writer.write_u8(p_bytecode->_has_base);
+			writer.write_u8(p_bytecode->_is_base_native);
+			writer.write_string(p_bytecode->_base_native);
+
+			// a local base by it's name, an extern one by the name of it's import and it's name.
+			String base_import, base_name;
+			if (p_bytecode->_base != nullptr) {
+				base_name = p_bytecode->_base->_name;
+				if (p_bytecode->_base->_file != p_bytecode->_file) {
+					for (const auto& it : p_bytecode->_file->_externs) {
+						if (it.second == p_bytecode->_base->_file) base_import = it.first;
+					}
+					if (base_import.size() == 0) THROW_BUG("the base of a class isn't imported.");
+				}
+			}
+			writer.write_string(base_import);
+			writer.write_string(base_name);
+		}
+
+		writer.write_u32((uint32_t)p_bytecode->_members.size());
+		for (const auto& it : p_bytecode->_members) {
+			writer.write_string(it.first);
+			writer.write_u32(it.second);
+		}
+		writer.write_u32((uint32_t)p_bytecode->_static_vars.size());
+		for (const auto& it : p_bytecode->_static_vars) {
+			writer.write_string(it.first);
+			writer.write_var(it.second);
+		}
+		writer.write_u32((uint32_t)p_bytecode->_constants.size());
+		for (const auto& it : p_bytecode->_constants) {
+			writer.write_string(it.first);
+			writer.write_var(it.second);
+		}
+		writer.write_u32((uint32_t)p_bytecode->_unnamed_enums.size());
+		for (const auto& it : p_bytecode->_unnamed_enums) {
+			writer.write_string(it.first);
+			writer.write_i64(it.second);
+		}
+		writer.write_u32((uint32_t)p_bytecode->_enums.size());
+		for (const auto& it : p_bytecode->_enums) {
+			writer.write_string(it.first);
+			writer.write_u32((uint32_t)it.second->get_values().size());
+			for (const auto& value : it.second->get_values()) {
+				writer.write_string(value.first);
+				writer.write_i64(value.second);
+			}
+		}
+
+		writer.write_u32((uint32_t)p_bytecode->_functions.size());
+		for (const auto& it : p_bytecode->_functions) write_function(it.second.get());
+		writer.write_string(get_function_name(p_bytecode, p_bytecode->_main)); // or the constructor.
+		write_optional_function(p_bytecode->_static_initializer.get());
+		write_optional_function(p_bytecode->_member_initializer.get());
+
+		if (p_bytecode->_is_class) return;
+
+		writer.write_u32((uint32_t)p_bytecode->_externs.size());
+		for (const auto& it : p_bytecode->_externs) {
+			writer.write_string(it.first);
+			writer.write_string(it.second->_name);
+		}
+		writer.write_u32((uint32_t)p_bytecode->_classes.size());
+		for (const auto& it : p_bytecode->_classes) write_bytecode(it.second.get());
+
+		writer.write_u32((uint32_t)p_bytecode->_global_names_array.size());
+		for (const String& name : p_bytecode->_global_names_array) writer.write_string(name);
+		writer.write_u32((uint32_t)p_bytecode->_global_const_values.size());
+		for (const var& value : p_bytecode->_global_const_values) writer.write_var(value);
+
+		// the targets of CALL_DIRECT by the class ("" for the file) and their names.
+		writer.write_u32((uint32_t)p_bytecode->_direct_functions.size());
+		for (const Function* func : p_bytecode->_direct_functions) {
+			const Bytecode* owner = func->_owner;
+			if (owner != p_bytecode && owner->_file.get() != p_bytecode) THROW_BUG("a direct function of an other file.");
+			writer.write_string((owner->_is_class) ? owner->_name : "");
+			writer.write_string(get_function_name(owner, func));
+		}
+	}
+};
+
+class _BytecodeReader {
+public:
+	_CacheReader& reader;
+	const std::function<ptr<Bytecode>(const String&)>& get_import;
+	stdvec<std::pair<Bytecode*, String>> local_bases;
+
+	_BytecodeReader(_CacheReader& p_reader, const std::function<ptr<Bytecode>(const String&)>& p_get_import)
+		: reader(p_reader), get_import(p_get_import) {}
+
+	ptr<Function> read_function(Bytecode* p_owner) {
+		ptr<Function> func = newptr<Function>();
+		func->_owner = p_owner;
+		func->_name = reader.read_string();
+		func->_is_static = reader.read_u8() != 0;
+		func->_arg_count = (int)reader.read_u32();
+		uint32_t count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) func->_is_reference.push_back(reader.read_u8() != 0);
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) func->_arg_types.push_back(read_type());
+		func->_return_type = read_type();
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) func->_default_args.push_back(reader.read_var());
+		count = reader.read_u32();
+		func->_opcodes.resize(count);
+		memcpy(func->_opcodes.data(), reader.read_bytes(count * sizeof(uint32_t)), count * sizeof(uint32_t));
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t line = reader.read_u32();
+			func->op_dbg[line] = reader.read_u32();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t ip = reader.read_u32();
+			func->op_inline[ip] = reader.read_u32();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			InlineSite site;
+			site.name = reader.read_string();
+			site.line = reader.read_u32();
+			site.parent = reader.read_u32();
+			func->_inline_sites.push_back(site);
+		}
+		func->_stack_size = reader.read_u32();
+		return func;
+	}
+
+	var::Type read_type() {
+		uint8_t type = reader.read_u8();
+		if (type >= var::_TYPE_MAX_) THROW_CORRUPTED(reader.get_path());
+		return (var::Type)type;
+	}
+
+	Function* find_function(Bytecode* p_bytecode, const String& p_name) {
+		if (p_name.size() == 0) return nullptr;
+		auto it = p_bytecode->_functions.find(p_name);
+		if (it == p_bytecode->_functions.end()) THROW_CORRUPTED(reader.get_path());
+		return it->second.get();
+	}
+
+	// the opcodes are validated as they're after the codegen, a corrupted cache isn't run.
+	void verify(Bytecode* p_file) {
+		stdvec<Bytecode*> bytecodes = { p_file };
+		for (auto& it : p_file->_classes) bytecodes.push_back(it.second.get());
+		for (Bytecode* bytecode : bytecodes) {
+			for (auto& it : bytecode->_functions) it.second->verify();
+			if (bytecode->_member_initializer != nullptr) bytecode->_member_initializer->verify();
+			if (bytecode->_static_initializer != nullptr) bytecode->_static_initializer->verify();
+		}
+	}
+
+	ptr<Bytecode> read_bytecode(const ptr<Bytecode>& p_file) {
+		ptr<Bytecode> bytecode = newptr<Bytecode>();
+		bytecode->_is_class = reader.read_u8() != 0;
+		bytecode->_name = reader.read_string();
+
+		if (bytecode->_is_class) {
+			if (p_file == nullptr) THROW_CORRUPTED(reader.get_path());
+			bytecode->_file = p_file;
+			bytecode->_has_base = reader.read_u8() != 0;
+			bytecode->_is_base_native = reader.read_u8() != 0;
+			bytecode->_base_native = reader.read_string();
+			String base_import = reader.read_string();
+			String base_name = reader.read_string();
+			if (base_import.size() != 0) {
+				auto it = p_file->_externs.find(base_import);
+				if (it == p_file->_externs.end()) THROW_CORRUPTED(reader.get_path());
+				bytecode->_base = it->second->get_class(base_name);
+				if (bytecode->_base == nullptr) THROW_CORRUPTED(reader.get_path());
+			} else if (base_name.size() != 0) {
+				local_bases.push_back(std::pair<Bytecode*, String>(bytecode.get(), base_name));
+			}
+		}
+
+		uint32_t count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String name = reader.read_string();
+			bytecode->_members[name] = reader.read_u32();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String name = reader.read_string();
+			bytecode->_static_vars[name] = reader.read_var();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String name = reader.read_string();
+			bytecode->_constants[name] = reader.read_var();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String name = reader.read_string();
+			bytecode->_unnamed_enums[name] = reader.read_i64();
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			ptr<EnumInfo> ei = newptr<EnumInfo>(reader.read_string());
+			uint32_t value_count = reader.read_u32();
+			for (uint32_t j = 0; j < value_count; j++) {
+				String name = reader.read_string();
+				ei->get_edit_values()[name] = reader.read_i64();
+			}
+			bytecode->_enums[ei->get_name()] = ei;
+		}
+
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			ptr<Function> func = read_function(bytecode.get());
+			bytecode->_functions[func->_name] = func;
+		}
+		bytecode->_main = find_function(bytecode.get(), reader.read_string());
+		if (reader.read_u8()) bytecode->_static_initializer = read_function(bytecode.get());
+		if (reader.read_u8()) bytecode->_member_initializer = read_function(bytecode.get());
+
+		if (bytecode->_is_class) return bytecode;
+
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String name = reader.read_string();
+			String path = reader.read_string();
+			ptr<Bytecode> import = get_import(path);
+			if (import == nullptr) THROW_ERROR(Error::IO_ERROR, String::format("import \"%s\" of a bytecode cache isn't compiled.", path.c_str()));
+			bytecode->_externs[name] = import;
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			ptr<Bytecode> _class = read_bytecode(bytecode);
+			bytecode->_classes[_class->_name] = _class;
+		}
+		for (const auto& it : local_bases) {
+			auto base = bytecode->_classes.find(it.second);
+			if (base == bytecode->_classes.end()) THROW_CORRUPTED(reader.get_path());
+			it.first->_base = base->second;
+		}
+
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			bytecode->_global_names_array.push_back(reader.read_string());
+			bytecode->_global_names[bytecode->_global_names_array.back()] = i;
+		}
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) bytecode->_global_const_values.push_back(reader.read_var());
+
+		count = reader.read_u32();
+		for (uint32_t i = 0; i < count; i++) {
+			String owner = reader.read_string();
+			String name = reader.read_string();
+			Bytecode* owner_bytecode = bytecode.get();
+			if (owner.size() != 0) {
+				auto it = bytecode->_classes.find(owner);
+				if (it == bytecode->_classes.end()) THROW_CORRUPTED(reader.get_path());
+				owner_bytecode = it->second.get();
+			}
+			Function* func = find_function(owner_bytecode, name);
+			if (func == nullptr) THROW_CORRUPTED(reader.get_path());
+			bytecode->_direct_functions.push_back(func);
+		}
+		return bytecode;
+	}
+};
+
+uint64_t BytecodeCache::hash(const void* p_data, size_t p_size, uint64_t p_hash) {
+	const uint8_t* data = (const uint8_t*)p_data;
+	for (size_t i = 0; i < p_size; i++) { // FNV-1a
+		p_hash ^= data[i];
+		p_hash *= 1099511628211ull;
+	}
+	return p_hash;
+}
+
+// magic, version, header : { source hash, hash, import paths }, file bytecode.
+void BytecodeCache::save(const String& p_path, const Header& p_header, const Bytecode* p_bytecode) {
+	_BytecodeWriter bytecode_writer;
+	_CacheWriter& writer = bytecode_writer.writer;
+	writer.write_u32(CACHE_MAGIC);
+	writer.write_u32(CACHE_VERSION);
+	writer.write_u64(p_header.source_hash);
+	writer.write_u64(p_header.hash);
+	writer.write_u32((uint32_t)p_header.import_paths.size());
+	for (const String& path : p_header.import_paths) writer.write_string(path);
+	bytecode_writer.write_bytecode(p_bytecode);
+
+	// written to a temporary file and renamed, so a reader never maps a partially written one.
+	const std::string& data = writer.get_data();
+	ptr<Buffer> buffer = newptr<Buffer>(data.size());
+	memcpy(buffer->front(), data.data(), data.size());
+	String temp_path = p_path + ".tmp";
+	File file(temp_path, File::WRITE | File::BINARY);
+	file.write_bytes(buffer);
+	file.close();
+	if (std::rename(temp_path.c_str(), p_path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		THROW_ERROR(Error::IO_ERROR, String::format("can't write the bytecode cache \"%s\".", p_path.c_str()));
+	}
+}
+
+bool BytecodeCache::read_header(const String& p_path, Header* r_header) {
+	_MappedFile file(p_path);
+	if (file.get_data() == nullptr) return false;
+	_CacheReader reader(file.get_data(), file.get_size(), p_path);
+	try {
+		if (reader.read_u32() != CACHE_MAGIC || reader.read_u32() != CACHE_VERSION) return false;
+		reader.read_header(r_header);
+	} catch (Error&) {
+		return false;
+	}
+	return true;
+}
+
+ptr<Bytecode> BytecodeCache::load(const String& p_path, const std::function<ptr<Bytecode>(const String&)>& p_get_import) {
+	_MappedFile file(p_path);
+	if (file.get_data() == nullptr) THROW_ERROR(Error::IO_ERROR, String::format("can't open the bytecode cache \"%s\".", p_path.c_str()));
+	_CacheReader reader(file.get_data(), file.get_size(), p_path);
+	if (reader.read_u32() != CACHE_MAGIC || reader.read_u32() != CACHE_VERSION) {
+		THROW_ERROR(Error::IO_ERROR, String::format("\"%s\" isn't a bytecode cache of this version.", p_path.c_str()));
+	}
+	Header header;
+	reader.read_header(&header);
+
+	_BytecodeReader bytecode_reader(reader, p_get_import);
+	ptr<Bytecode> bytecode = bytecode_reader.read_bytecode(nullptr);
+	if (bytecode->is_class() || !reader.is_end()) THROW_CORRUPTED(p_path);
+	bytecode_reader.verify(bytecode.get());
+	return bytecode;
+}
+
+}
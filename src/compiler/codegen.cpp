@@ -90,10 +90,77 @@ Address CGContext::add_stack_temp() {
 }
 //--------------------------------------------------------------------
 
+// an array or map literal of constants (or literals of them) is built once at compile time.
+static bool _fold_literal(const Parser::Node* p_expr, var& r_value) {
+	switch (p_expr->type) {
+		case Parser::Node::Type::CONST_VALUE: {
+			// a const array or map (result of a const function) is deep copied with the literal.
+			r_value = static_cast<const Parser::ConstValueNode*>(p_expr)->value;
+			var::Type type = r_value.get_type();
+			return type == var::_NULL || type == var::BOOL || type == var::INT || type == var::FLOAT || type == var::STRING ||
+				type == var::ARRAY || type == var::MAP;
+		}
+		case Parser::Node::Type::ARRAY: {
+			const Parser::ArrayNode* arr = static_cast<const Parser::ArrayNode*>(p_expr);
+			Array value;
+			for (Parser::Node* element : arr->elements) {
+				var element_value;
+				if (!_fold_literal(element, element_value)) return false;
+				value.push_back(element_value);
+			}
+			r_value = value;
+			return true;
+		}
+		case Parser::Node::Type::MAP: {
+			const Parser::MapNode* map = static_cast<const Parser::MapNode*>(p_expr);
+			Map value;
+			for (const Parser::MapNode::Pair& pair : map->elements) {
+				var key, element_value;
+				if (pair.key->type != Parser::Node::Type::CONST_VALUE || !_fold_literal(pair.key, key)) return false;
+				if (!_fold_literal(pair.value, element_value)) return false;
+				value[key] = element_value;
+			}
+			r_value = value;
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+var::Type CodeGen::_get_declared_type(const Parser::Node* p_expr) const {
+	if (p_expr->type != Parser::Node::Type::IDENTIFIER) return var::VAR;
+	const Parser::IdentifierNode* id = static_cast<const Parser::IdentifierNode*>(p_expr);
+	switch (id->ref) {
+		case Parser::IdentifierNode::REF_LOCAL_VAR:
+			return id->_var->data_type;
+		case Parser::IdentifierNode::REF_PARAMETER: {
+			const stdvec<var::Type>& types = _context.function->_arg_types;
+			if (id->param_index >= (int)types.size()) return var::VAR;
+			return types[id->param_index];
+		}
+		default:
+			return var::VAR;
+	}
+}
+
 void CodeGen::_pop_addr_if_temp(const Address& m_addr) {
 	if (m_addr.is_temp()) _context.pop_stack_temp();
 }
 
+void CodeGen::_write_operator_assign(const Address& p_dst, var::Operator p_op, const Address& p_value) {
+	switch (p_op) {
+		case var::OP_ADDITION:
+		case var::OP_SUBTRACTION:
+		case var::OP_MULTIPLICATION:
+		case var::OP_DIVISION:
+			_context.opcodes->write_operator_assign(p_dst, p_op, p_value);
+			break;
+		default:
+			_context.opcodes->write_operator(p_dst, p_op, p_dst, p_value);
+	}
+}
+
 Address CodeGen::add_global_const_value(const var& p_value) {
 	uint32_t pos = _bytecode->_global_const_value_get(p_value);
 	return Address(Address::CONST_VALUE, pos);
@@ -103,10 +170,34 @@ uint32_t CodeGen::add_global_name(const String& p_name) {
 	return _bytecode->_global_name_get(p_name);
 }
 
-ptr<Bytecode> CodeGen::generate(ptr<Analyzer> p_analyzer) {
+uint32_t CodeGen::add_direct_function(const Parser::FunctionNode* p_func) {
+	_direct_calls[_context.function].insert(p_func);
+	auto it = _direct_indices.find(p_func);
+	if (it != _direct_indices.end()) return it->second;
+	uint32_t index = (uint32_t)_direct_indices.size();
+	_direct_indices[p_func] = index;
+	return index;
+}
+
+CodeGen::CodeGen() {
+	_pass_manager.add_pass(newptr<IROperatorAssignPass>());
+	_pass_manager.add_pass(newptr<IRTypeCheckPass>());
+	_pass_manager.add_pass(newptr<IRBranchFoldPass>());
+	_pass_manager.add_pass(newptr<IRUnreachableBlockPass>());
+	_pass_manager.add_pass(newptr<IRCoalescePass>());
+	_pass_manager.add_pass(newptr<IRDeadStorePass>());
+	_pass_manager.add_pass(newptr<IRLoopInvariantPass>());
+	_pass_manager.add_pass(newptr<IRBoundsCheckPass>());
+	_pass_manager.add_pass(newptr<IRSimplifyCFGPass>());
+	_pass_manager.add_final_pass(newptr<IRTypeSpecializePass>());
+	_pass_manager.add_final_pass(newptr<IRSlotAllocationPass>());
+	_pass_manager.add_final_pass(newptr<IRReleaseSlotsPass>());
+}
+
+ptr<Bytecode> CodeGen::generate(ptr<Analyzer> p_analyzer, FileRecord* r_record) {
 	ptr<Bytecode> bytecode = newptr<Bytecode>();
 	_bytecode = bytecode.get();
-	Parser::FileNode* root = p_analyzer->parser->file_node.get();
+	Parser::FileNode* root = p_analyzer->parser->file_node;
 
 	_file_node = root;
 	_context.bytecode = bytecode.get();
@@ -114,12 +205,12 @@ ptr<Bytecode> CodeGen::generate(ptr<Analyzer> p_analyzer) {
 	bytecode->_name = root->path;
 	_generate_members(static_cast<Parser::MemberContainer*>(root), bytecode.get());
 
-	for (ptr<Parser::ImportNode>& import_node : root->imports) {
+	for (Parser::ImportNode*& import_node : root->imports) {
 		_bytecode->_externs[import_node->name] = import_node->bytecode;
 	}
 
 	stdmap<Bytecode*, String> pending_inheritance;
-	for (ptr<Parser::ClassNode>& class_node : root->classes) {
+	for (Parser::ClassNode*& class_node : root->classes) {
 		ptr<Bytecode>_class = newptr<Bytecode>();
 		_class->_file = bytecode;
 		_class->_is_class = true;
@@ -143,7 +234,7 @@ ptr<Bytecode> CodeGen::generate(ptr<Analyzer> p_analyzer) {
 				_class->_base = class_node->base_binary;
 				break;
 		}
-		_generate_members(static_cast<Parser::MemberContainer*>(class_node.get()), _class.get());
+		_generate_members(static_cast<Parser::MemberContainer*>(class_node), _class.get());
 		_class->_pending_base = nullptr;
 		bytecode->_classes[_class->_name] = _class;
 	}
@@ -154,16 +245,167 @@ ptr<Bytecode> CodeGen::generate(ptr<Analyzer> p_analyzer) {
 
 	_context.curr_class = nullptr;
 
+	bytecode->_direct_functions.resize(_direct_indices.size());
+	for (auto& it : _direct_indices) {
+		bytecode->_direct_functions[it.second] = _generated_functions.at(it.first);
+	}
+
 	bytecode->_build_global_names_array();
+	stdvec<Function*> functions = _get_functions();
+	_infer_return_types(functions);
+	_inline_functions(functions);
+	_scalar_replace_instances(functions);
+	_verify_functions();
+
+	if (r_record != nullptr) {
+		r_record->declarations_hash = root->declarations_hash;
+		r_record->functions.clear();
+		for (auto& it : _generated_functions) _record_function(r_record, it.first, it.second);
+	}
 	return bytecode;
 }
 
+void CodeGen::_record_function(FileRecord* r_record, const Parser::FunctionNode* p_node, Function* p_func) const {
+	FunctionRecord& record = r_record->functions[p_func];
+	record.tokens_hash = p_node->tokens_hash;
+	record.line = p_node->pos.x;
+	record.dependencies.clear();
+	auto calls = _direct_calls.find(p_func);
+	if (calls != _direct_calls.end()) {
+		for (const Parser::FunctionNode* target : calls->second) record.dependencies.insert(_generated_functions.at(target));
+	}
+	auto inlined = _inlined.find(p_func);
+	if (inlined != _inlined.end()) record.dependencies.insert(inlined->second.begin(), inlined->second.end());
+}
+
+// the generated function is moved into the existing one, it's verified and predecoded again.
+void CodeGen::_replace_function(Function* p_func, Function* p_generated) {
+	p_func->_name = p_generated->_name;
+	p_func->_is_static = p_generated->_is_static;
+	p_func->_arg_count = p_generated->_arg_count;
+	p_func->_is_reference = p_generated->_is_reference;
+	p_func->_arg_types = p_generated->_arg_types;
+	p_func->_return_type = p_generated->_return_type;
+	p_func->_default_args = p_generated->_default_args;
+	p_func->_opcodes = p_generated->_opcodes;
+	p_func->op_dbg = p_generated->op_dbg;
+	p_func->op_inline = p_generated->op_inline;
+	p_func->_inline_sites = p_generated->_inline_sites;
+	p_func->_stack_size = p_generated->_stack_size;
+	p_func->_verified = false;
+	p_func->_hot_count = 0;
+	p_func->_predecoded_built = false;
+	p_func->_predecoded = nullptr;
+}
+
+// the functions which aren't changed are kept, so the instances, the direct calls and anything else
+// referring to a function (or the bytecode) refers to the new one.
+bool CodeGen::regenerate(ptr<Analyzer> p_analyzer, Bytecode* p_bytecode, FileRecord* p_record) {
+	Parser::FileNode* root = p_analyzer->parser->file_node;
+	if (root->declarations_hash != p_record->declarations_hash) return false;
+
+	// the new function nodes of the existing functions, a function added or removed is a declaration change.
+	stdmap<const Parser::FunctionNode*, Function*> existing;
+	stdmap<const Function*, const Parser::FunctionNode*> nodes;
+	size_t function_count = p_bytecode->_functions.size();
+	stdvec<std::pair<Bytecode*, const Parser::FunctionNode*>> all;
+	for (Parser::FunctionNode* fn : root->functions) all.push_back({ p_bytecode, fn });
+	for (Parser::ClassNode* class_node : root->classes) {
+		auto it = p_bytecode->_classes.find(class_node->name);
+		if (it == p_bytecode->_classes.end()) return false;
+		function_count += it->second->_functions.size();
+		for (Parser::FunctionNode* fn : class_node->functions) all.push_back({ it->second.get(), fn });
+	}
+	if (all.size() != function_count) return false;
+	for (const std::pair<Bytecode*, const Parser::FunctionNode*>& it : all) {
+		auto fn = it.first->_functions.find(it.second->name);
+		if (fn == it.first->_functions.end() || p_record->functions.find(fn->second.get()) == p_record->functions.end()) return false;
+		existing[it.second] = fn->second.get();
+		nodes[fn->second.get()] = it.second;
+	}
+
+	// the changed functions and the ones generated from them (the return type or the body of a changed function
+	// could be used by them), a const function is evaluated by the analyzer so the calls to it aren't known.
+	std::set<const Function*> changed;
+	for (const std::pair<const Parser::FunctionNode* const, Function*>& it : existing) {
+		if (it.first->tokens_hash == p_record->functions.at(it.second).tokens_hash) continue;
+		if (it.first->is_const) return false;
+		changed.insert(it.second);
+	}
+	for (bool updated = true; updated;) {
+		updated = false;
+		for (const std::pair<const Function* const, FunctionRecord>& it : p_record->functions) {
+			if (changed.count(it.first) != 0) continue;
+			for (const Function* dependency : it.second.dependencies) {
+				if (changed.count(dependency) == 0) continue;
+				changed.insert(it.first);
+				updated = true;
+				break;
+			}
+		}
+	}
+
+	// nothing could be failed from here, the existing bytecode is modified.
+	_bytecode = p_bytecode;
+	_file_node = root;
+	_context.bytecode = p_bytecode;
+	_generated_functions = existing;
+	for (uint32_t i = 0; i < (uint32_t)p_bytecode->_direct_functions.size(); i++) {
+		_direct_indices[nodes.at(p_bytecode->_direct_functions[i])] = i;
+	}
+
+	stdvec<Function*> functions;
+	for (const std::pair<Bytecode*, const Parser::FunctionNode*>& it : all) {
+		Function* function = existing.at(it.second);
+		if (changed.count(function) == 0) {
+			// an unchanged function moved with the lines above it.
+			int offset = it.second->pos.x - (int)p_record->functions.at(function).line;
+			for (auto& dbg : function->op_dbg) dbg.second = (uint32_t)((int)dbg.second + offset);
+			for (InlineSite& site : function->_inline_sites) site.line = (uint32_t)((int)site.line + offset);
+			continue;
+		}
+		const Parser::ClassNode* class_node = nullptr;
+		if (it.first->_is_class) class_node = static_cast<const Parser::ClassNode*>(it.second->parent_node);
+		ptr<Function> generated = _generate_function(it.second, class_node, it.first);
+		_replace_function(function, generated.get());
+		_direct_calls[function] = _direct_calls[generated.get()];
+		_direct_calls.erase(generated.get());
+		functions.push_back(function);
+	}
+	_context.curr_class = nullptr;
+
+	p_bytecode->_direct_functions.resize(_direct_indices.size());
+	for (auto& it : _direct_indices) {
+		p_bytecode->_direct_functions[it.second] = _generated_functions.at(it.first);
+	}
+	p_bytecode->_build_global_names_array();
+
+	_infer_return_types(functions);
+	_inline_functions(functions);
+	_scalar_replace_instances(functions);
+	for (Function* fn : functions) fn->verify();
+
+	// a changed function could have other arguments.
+	p_bytecode->_member_info.clear();
+	p_bytecode->_member_info_built = false;
+	for (auto& it : p_bytecode->_classes) {
+		it.second->_member_info.clear();
+		it.second->_member_info_built = false;
+	}
+
+	for (auto& it : _generated_functions) {
+		if (changed.count(it.second) != 0) _record_function(p_record, it.first, it.second);
+		else p_record->functions[it.second].line = it.first->pos.x;
+	}
+	return true;
+}
+
 void CodeGen::_generate_members(Parser::MemberContainer* p_container, Bytecode* p_bytecode) {
 
 	// members/ static vars
 	bool static_var_init_fn_need = false, member_var_init_fn_need = false;
 	int member_index = 0;
-	for (ptr<Parser::VarNode>& var_node : p_container->vars) {
+	for (Parser::VarNode*& var_node : p_container->vars) {
 		if (var_node->is_static) {
 			var default_value; // default value set at runtime `static var x = f();`
 			p_bytecode->_static_vars[var_node->name] = default_value;
@@ -175,7 +417,7 @@ void CodeGen::_generate_members(Parser::MemberContainer* p_container, Bytecode*
 	}
 
 	// constants
-	for (ptr<Parser::ConstNode>& const_node : p_container->constants) {
+	for (Parser::ConstNode*& const_node : p_container->constants) {
 		p_bytecode->_constants[const_node->name] = const_node->value;
 	}
 
@@ -187,7 +429,7 @@ void CodeGen::_generate_members(Parser::MemberContainer* p_container, Bytecode*
 	}
 
 	// named enums
-	for (ptr<Parser::EnumNode> en : p_container->enums) {
+	for (Parser::EnumNode* en : p_container->enums) {
 		ptr<EnumInfo> ei = newptr<EnumInfo>(en->name);
 		for (std::pair<String, Parser::EnumValueNode> value : en->values) {
 			ei->get_edit_values()[value.first] = value.second.value;
@@ -204,14 +446,15 @@ void CodeGen::_generate_members(Parser::MemberContainer* p_container, Bytecode*
 	}
 
 	// functions
-	for (ptr<Parser::FunctionNode> fn : p_container->functions) {
+	for (Parser::FunctionNode* fn : p_container->functions) {
 		const Parser::ClassNode* class_node = nullptr;
 		if (p_container->type == Parser::Node::Type::CLASS) class_node = static_cast<const Parser::ClassNode*>(p_container);
-		ptr<Function> cfn = _generate_function(fn.get(), class_node, p_bytecode);
+		ptr<Function> cfn = _generate_function(fn, class_node, p_bytecode);
 		p_bytecode->_functions[cfn->_name] = cfn;
+		_generated_functions[fn] = cfn.get();
 
 		if (fn->name == GlobalStrings::main) p_bytecode->_main = cfn.get();
-		if (class_node && class_node->constructor == fn.get()) p_bytecode->_constructor = cfn.get();
+		if (class_node && class_node->constructor == fn) p_bytecode->_constructor = cfn.get();
 	}
 }
 
@@ -229,7 +472,7 @@ ptr<Function> CodeGen::_generate_initializer(bool p_static, Bytecode* p_bytecode
 	_context.curr_class = class_node;
 	_context.opcodes->op_dbg = &cfn->op_dbg;
 
-	for (ptr<Parser::VarNode>& var_node : p_container->vars) {
+	for (Parser::VarNode*& var_node : p_container->vars) {
 		if (var_node->is_static == p_static && var_node->assignment != nullptr) {
 			Address member;
 			if (p_static) {
@@ -238,9 +481,9 @@ ptr<Function> CodeGen::_generate_initializer(bool p_static, Bytecode* p_bytecode
 			} else {
 				member = Address(Address::MEMBER_VAR, _context.bytecode->get_member_index(var_node->name));
 			}
-			Address value = _generate_expression(var_node->assignment.get(), &member);
+			Address value = _generate_expression(var_node->assignment, &member);
 			if (member != value) {
-				_context.insert_dbg(var_node.get());
+				_context.insert_dbg(var_node);
 				_context.opcodes->write_assign(member, value);
 			}
 			_pop_addr_if_temp(value);
@@ -254,6 +497,7 @@ ptr<Function> CodeGen::_generate_initializer(bool p_static, Bytecode* p_bytecode
 	cfn->_owner = _context.bytecode;
 	cfn->_opcodes = _context.opcodes->opcodes;
 	cfn->_stack_size = _context.stack_max_size;
+	_optimize_function(cfn.get());
 
 	return cfn;
 }
@@ -268,10 +512,28 @@ ptr<Function> CodeGen::_generate_function(const Parser::FunctionNode* p_func, co
 	_context.opcodes->op_dbg = &cfn->op_dbg;
 	for (int i = 0; i < (int)p_func->args.size(); i++) {
 		cfn->_is_reference.push_back(p_func->args[i].is_reference);
+		cfn->_arg_types.push_back(p_func->args[i].type);
 		_context.parameters.push_back(p_func->args[i].name);
 	}
+	cfn->_return_type = p_func->return_type;
 
-	_generate_block(p_func->body.get());
+	// the arguments of the annotated parameters are checked before the body.
+	for (int i = 0; i < (int)p_func->args.size(); i++) {
+		if (p_func->args[i].type == var::VAR) continue;
+		_context.insert_dbg(p_func);
+		_context.opcodes->write_check_type(Address(Address::PARAMETER, i), p_func->args[i].type);
+	}
+
+	_generate_block(p_func->body);
+
+	// reaching the end of a function with a return type (returns null) is a type error.
+	if (p_func->return_type != var::VAR) {
+		Address ret = _context.add_stack_temp();
+		_context.opcodes->insert_dbg(p_func->end_line);
+		_context.opcodes->write_assign(ret, add_global_const_value(var()));
+		_context.opcodes->write_check_type(ret, p_func->return_type);
+		_context.pop_stack_temp();
+	}
 
 	// Opcode::END dbg position
 	_context.opcodes->insert_dbg(p_func->end_line);
@@ -285,16 +547,254 @@ ptr<Function> CodeGen::_generate_function(const Parser::FunctionNode* p_func, co
 	cfn->_default_args = p_func->default_args;
 	cfn->_opcodes = _context.opcodes->opcodes;
 	cfn->_stack_size = _context.stack_max_size;
+	_optimize_function(cfn.get());
 
 	return cfn;
 }
 
+IRFunction CodeGen::_build_ir(const Function* p_func) const {
+	IRFunction ir = IRFunction::build(p_func);
+	ir.bytecode_file = _bytecode;
+	ir.set_param_types(p_func->_arg_types);
+	ir.generalize_operators();
+
+	// a CALL_DIRECT with `this` could call an override of the target (see VM's CALL_DIRECT).
+	bool has_self = p_func->_owner->is_class() && !p_func->_is_static;
+	if (!has_self) {
+		for (const Function* fn : _bytecode->_direct_functions) ir.call_types.push_back(fn->_return_type);
+	}
+	return ir;
+}
+
+void CodeGen::_optimize_function(Function* p_func) {
+	IRFunction ir = _build_ir(p_func);
+	_pass_manager.run(ir);
+
+	ir.lower(p_func);
+}
+
+stdvec<Function*> CodeGen::_get_functions() const {
+	stdvec<Function*> functions;
+	for (auto& it : _bytecode->_functions) functions.push_back(it.second.get());
+	for (auto& it : _bytecode->_classes) {
+		for (auto& fn : it.second->_functions) functions.push_back(fn.second.get());
+	}
+	return functions;
+}
+
+void CodeGen::_infer_return_types(const stdvec<Function*>& p_functions) {
+
+	// a return type could be known from the return types of the functions it calls, they're
+	// inferred again till nothing changes (calls in a cycle stay var::VAR).
+	bool updated = true;
+	for (int i = 0; updated && i < IRPassManager::MAX_ITERATIONS; i++) {
+		updated = false;
+		for (Function* fn : p_functions) {
+			if (fn->_return_type != var::VAR) continue;
+			fn->_return_type = _build_ir(fn).get_return_type();
+			updated = updated || fn->_return_type != var::VAR;
+		}
+	}
+
+	// the typed operators are selected again with the results of the calls.
+	for (Function* fn : p_functions) {
+		IRFunction ir = _build_ir(fn);
+		bool typed_call = false;
+		for (const IRBlock& block : ir.blocks) {
+			for (const IRInstruction& instr : block.instructions) {
+				if (instr.get_opcode() != Opcode::CALL_DIRECT || instr.words[1] >= ir.call_types.size()) continue;
+				typed_call = typed_call || ir.call_types[instr.words[1]] != var::VAR;
+			}
+		}
+		if (typed_call) _optimize_function(fn);
+	}
+}
+
+void CodeGen::_inline_functions(const stdvec<Function*>& p_functions) {
+
+	// bodies are taken before any inlining, so a call in an inlined body isn't expanded again.
+	stdmap<const Function*, IRFunction> bodies;
+	for (const Function* fn : p_functions) {
+		if (fn->_opcodes.size() > INLINE_MAX_SIZE) continue;
+		if (std::find(fn->_is_reference.begin(), fn->_is_reference.end(), true) != fn->_is_reference.end()) continue;
+
+		IRFunction ir = IRFunction::build(fn);
+		ir.generalize_operators(); // the passes know about OPERATOR, they're selected again in the caller.
+		if (ir.has_opcode(Opcode::CALL_SUPER_CTOR) || ir.has_opcode(Opcode::CALL_SUPER_METHOD)) continue;
+
+		bool jumps_out = false; // a jump to the end of the function (without END).
+		for (const IRBlock& block : ir.blocks) {
+			for (const IRInstruction& instr : block.instructions) {
+				int target = instr.get_target_word();
+				if (target >= 0 && instr.words[target] >= ir.blocks.size()) jumps_out = true;
+			}
+		}
+		if (!jumps_out) bodies[fn] = ir;
+	}
+	if (bodies.size() == 0) return;
+
+	for (Function* fn : p_functions) _inline_calls(fn, bodies);
+}
+
+void CodeGen::_scalar_replace_instances(const stdvec<Function*>& p_functions) {
+
+	IRScalarReplacePass scalar_replace;
+	for (Function* fn : p_functions) {
+		IRFunction ir = _build_ir(fn);
+
+		// the other passes could coalesce a copy of an instance it's reading, and the inlined
+		// bodies could construct more instances.
+		bool replaced = false;
+		for (int i = 0; i < IRPassManager::MAX_ITERATIONS && scalar_replace.run(ir); i++) {
+			_inlined[fn].insert(scalar_replace.get_inlined().begin(), scalar_replace.get_inlined().end());
+			_pass_manager.run(ir);
+			replaced = true;
+		}
+		if (!replaced) continue;
+		ir.lower(fn);
+	}
+}
+
+void CodeGen::_verify_functions() {
+	stdvec<Bytecode*> bytecodes = { _bytecode };
+	for (auto& it : _bytecode->_classes) bytecodes.push_back(it.second.get());
+
+	for (Bytecode* bytecode : bytecodes) {
+		for (auto& it : bytecode->_functions) it.second->verify();
+		if (bytecode->_member_initializer != nullptr) bytecode->_member_initializer->verify();
+		if (bytecode->_static_initializer != nullptr) bytecode->_static_initializer->verify();
+	}
+}
+
+void CodeGen::_inline_calls(Function* p_caller, const stdmap<const Function*, IRFunction>& p_bodies) {
+	IRFunction ir = _build_ir(p_caller);
+
+	const uint32_t max_size = ir.get_opcode_count() + INLINE_MAX_GROWTH;
+	bool inlined = false;
+
+	uint32_t b = 0, i = 0;
+	while (b < ir.blocks.size()) {
+		if (i >= ir.blocks[b].instructions.size()) {
+			b++; i = 0;
+			continue;
+		}
+
+		const IRInstruction& call = ir.blocks[b].instructions[i];
+		bool guarded = false;
+		const Function* callee = _find_inline_target(p_caller, call, &guarded);
+		auto body = (callee != nullptr) ? p_bodies.find(callee) : p_bodies.end();
+		if (body == p_bodies.end() || ir.get_opcode_count() + body->second.get_opcode_count() > max_size) {
+			i++;
+			continue;
+		}
+
+		// a body which isn't running in it's own context (this, class) can't refer to it.
+		bool callee_self = callee->_owner->is_class() && !callee->_is_static;
+		bool same_context = callee->_owner == p_caller->_owner && callee->_is_static == p_caller->_is_static;
+		if (!same_context) {
+			const IRFunction& callee_ir = body->second;
+			bool context_dependent = callee_ir.has_address(Address::STATIC_MEMBER);
+			if (!callee_self) {
+				context_dependent = context_dependent || callee_ir.has_address(Address::THIS) || callee_ir.has_address(Address::MEMBER_VAR) ||
+					callee_ir.has_opcode(Opcode::CALL_FUNC) || callee_ir.has_opcode(Opcode::CALL_DIRECT);
+			}
+			if (context_dependent) {
+				i++;
+				continue;
+			}
+		}
+
+		// arguments with the default values.
+		uint32_t argc_word = (call.get_opcode() == Opcode::CALL_FUNC) ? 2 : 3; // CALL_DIRECT, CALL_METHOD
+		uint32_t argc = call.words[argc_word];
+		const stdvec<var>& defaults = callee->_default_args;
+		if (argc > (uint32_t)callee->_arg_count || argc + defaults.size() < (uint32_t)callee->_arg_count) {
+			i++;
+			continue; // an error at runtime.
+		}
+		stdvec<Address> args;
+		for (uint32_t j = 0; j < argc; j++) args.push_back(call.get_address(argc_word + 1 + j));
+		while (args.size() < (size_t)callee->_arg_count) {
+			args.push_back(add_global_const_value(defaults[defaults.size() - (callee->_arg_count - args.size())]));
+		}
+
+		b = ir.inline_call(b, i, body->second, args, guarded);
+		i = 0;
+		inlined = true;
+		_inlined[p_caller].insert(callee);
+	}
+
+	if (!inlined) return;
+	_pass_manager.run(ir);
+	ir.lower(p_caller);
+}
+
+const Function* CodeGen::_find_inline_target(const Function* p_caller, const IRInstruction& p_call, bool* r_guarded) const {
+	const Bytecode* owner = p_caller->_owner;
+	bool has_self = owner->is_class() && !p_caller->_is_static;
+
+	uint32_t name_word;
+	switch (p_call.get_opcode()) {
+		case Opcode::CALL_FUNC:
+			name_word = 1;
+			break;
+		case Opcode::CALL_DIRECT: { // resolved by the analyzer, the vm takes it for the instances of this file only.
+			*r_guarded = has_self;
+			const Function* target = _bytecode->_direct_functions[p_call.words[1]];
+			return (target == p_caller) ? nullptr : target;
+		}
+		case Opcode::CALL_METHOD: // this.f();
+			if (!has_self || p_call.get_address(1).get_type() != Address::THIS) return nullptr;
+			name_word = 2;
+			break;
+		default:
+			return nullptr;
+	}
+	const String& name = _bytecode->_global_names_array[p_call.words[name_word]];
+
+	// same as VM's lookup. a method called on `this` could be overridden in a derived class (even
+	// in another file) so it's guarded to be called only if `this` isn't an instance of a derived class.
+	const Function* target = nullptr;
+	if (has_self) {
+		*r_guarded = true;
+		const Bytecode* cls = owner;
+		while (cls != nullptr) {
+			auto it = cls->_functions.find(name);
+			if (it != cls->_functions.end()) {
+				target = it->second.get();
+				break;
+			}
+			if (!cls->_has_base) break;
+			if (cls->_is_base_native) {
+				if (p_call.get_opcode() == Opcode::CALL_METHOD) return nullptr; // a native method.
+				break;
+			}
+			if (cls->_base == nullptr || cls->_base->_file.get() != _bytecode) return nullptr; // defined in another file.
+			cls = cls->_base.get();
+		}
+		if (target == nullptr && p_call.get_opcode() == Opcode::CALL_METHOD) return nullptr;
+
+	} else if (owner->is_class()) {
+		auto it = owner->_functions.find(name);
+		if (it != owner->_functions.end()) target = it->second.get();
+	}
+
+	if (target == nullptr) {
+		auto it = _bytecode->_functions.find(name);
+		if (it != _bytecode->_functions.end()) target = it->second.get();
+	}
+
+	if (target == p_caller) return nullptr;
+	if (target != nullptr && target->_owner->is_class() && !target->_is_static && !has_self) return nullptr;
+	return target;
+}
+
 void CodeGen::_generate_block(const Parser::BlockNode* p_block) {
 
 	_context.push_stack_locals();
 
 	for (int i = 0; i < (int)p_block->statements.size(); i++) {
-		const Parser::Node* statement = p_block->statements[i].get();
+		const Parser::Node* statement = p_block->statements[i];
 
 		switch (statement->type) {
 			case Parser::Node::Type::UNKNOWN:
@@ -313,12 +813,20 @@ void CodeGen::_generate_block(const Parser::BlockNode* p_block) {
 				const Parser::VarNode* var_node = static_cast<const Parser::VarNode*>(statement);
 				Address local_var = _context.add_stack_local(var_node->name);
 				if (var_node->assignment != nullptr) {
-					Address assign_value = _generate_expression(var_node->assignment.get(), &local_var);
+					Address assign_value = _generate_expression(var_node->assignment, &local_var);
 					if (assign_value != local_var) {
 						_context.insert_dbg(var_node);
 						_context.opcodes->write_assign(local_var, assign_value);
 					}
 					_pop_addr_if_temp(assign_value);
+				} else {
+					// the slot could be holding a value of a previous local or temp.
+					_context.insert_dbg(var_node);
+					_context.opcodes->write_assign(local_var, add_global_const_value(var()));
+				}
+				if (var_node->data_type != var::VAR) {
+					_context.insert_dbg(var_node);
+					_context.opcodes->write_check_type(local_var, var_node->data_type);
 				}
 			} break;
 
@@ -367,17 +875,17 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 	switch (p_cflow->cf_type) {
 		case Parser::ControlFlowNode::CfType::IF: {
 			ASSERT(p_cflow->args.size() == 1);
-			Address cond = _generate_expression(p_cflow->args[0].get());
+			Address cond = _generate_expression(p_cflow->args[0]);
 			_context.insert_dbg(p_cflow);
 			_context.opcodes->write_if(cond);
 			if (cond.is_temp()) _context.pop_stack_temp();
 
-			_generate_block(p_cflow->body.get());
+			_generate_block(p_cflow->body);
 
 			if (p_cflow->body_else != nullptr) {
-				_context.insert_dbg(p_cflow->body_else.get());
+				_context.insert_dbg(p_cflow->body_else);
 				_context.opcodes->write_else();
-				_generate_block(p_cflow->body_else.get());
+				_generate_block(p_cflow->body_else);
 			}
 
 			_context.opcodes->write_endif();
@@ -390,11 +898,11 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 		case Parser::ControlFlowNode::CfType::WHILE: {
 			ASSERT(p_cflow->args.size() == 1);
 			_context.opcodes->jump_to_continue.push(_context.opcodes->next());
-			Address cond = _generate_expression(p_cflow->args[0].get());
+			Address cond = _generate_expression(p_cflow->args[0]);
 			_context.insert_dbg(p_cflow);
 			_context.opcodes->write_while(cond);
 			if (cond.is_temp()) _context.pop_stack_temp();
-			_generate_block(p_cflow->body.get());
+			_generate_block(p_cflow->body);
 			_context.opcodes->write_endwhile();
 		} break;
 
@@ -404,13 +912,22 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 
 			// iterator
 			if (p_cflow->args[0] != nullptr) {
-				const Parser::VarNode* var_node = static_cast<const Parser::VarNode*>(p_cflow->args[0].get());
+				const Parser::VarNode* var_node = static_cast<const Parser::VarNode*>(p_cflow->args[0]);
 				Address iterator = _context.add_stack_local(var_node->name);
 				if (var_node->assignment != nullptr) {
-					Address assign_value = _generate_expression(var_node->assignment.get());
-					_context.insert_dbg(var_node);
-					_context.opcodes->write_assign(iterator, assign_value);
+					Address assign_value = _generate_expression(var_node->assignment, &iterator);
+					if (assign_value != iterator) {
+						_context.insert_dbg(var_node);
+						_context.opcodes->write_assign(iterator, assign_value);
+					}
 					if (assign_value.is_temp()) _context.pop_stack_temp();
+				} else {
+					_context.insert_dbg(var_node);
+					_context.opcodes->write_assign(iterator, add_global_const_value(var()));
+				}
+				if (var_node->data_type != var::VAR) {
+					_context.insert_dbg(var_node);
+					_context.opcodes->write_check_type(iterator, var_node->data_type);
 				}
 			}
 
@@ -418,7 +935,7 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 			Address cond;
 			_context.opcodes->jump_to_continue.push(_context.opcodes->next());
 			if (p_cflow->args[1] != nullptr) {
-				const Parser::Node* cond_node = p_cflow->args[1].get();
+				const Parser::Node* cond_node = p_cflow->args[1];
 				cond = _generate_expression(cond_node);
 			}
 			_context.insert_dbg(p_cflow);
@@ -426,12 +943,12 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 			if (cond.is_temp()) _context.pop_stack_temp();
 
 			// body
-			_generate_block(p_cflow->body.get());
+			_generate_block(p_cflow->body);
 
 			// end
 			Address end_statement;
 			if (p_cflow->args[2] != nullptr) {
-				const Parser::Node* end_statement_node = p_cflow->args[2].get();
+				const Parser::Node* end_statement_node = p_cflow->args[2];
 				end_statement = _generate_expression(end_statement_node);
 				if (end_statement.is_temp()) _context.pop_stack_temp();
 			}
@@ -444,14 +961,14 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 			ASSERT(p_cflow->args.size() == 2);
 			_context.push_stack_locals();
 
-			const String& iterator_name = static_cast<const Parser::VarNode*>(p_cflow->args[0].get())->name;
+			const String& iterator_name = static_cast<const Parser::VarNode*>(p_cflow->args[0])->name;
 			Address iter_value = _context.add_stack_local(iterator_name);
 			Address iterator = _context.add_stack_temp();
-			Address on = _generate_expression(p_cflow->args[1].get());
+			Address on = _generate_expression(p_cflow->args[1]);
 
 			_context.insert_dbg(p_cflow);
 			_context.opcodes->write_foreach(iter_value, iterator, on);
-			_generate_block(p_cflow->body.get());
+			_generate_block(p_cflow->body);
 			_pop_addr_if_temp(iterator);
 			_context.opcodes->write_endforeach();
 			if (on.is_temp()) _context.pop_stack_temp();
@@ -472,8 +989,17 @@ void CodeGen::_generate_control_flow(const Parser::ControlFlowNode* p_cflow) {
 		case Parser::ControlFlowNode::CfType::RETURN: {
 			ASSERT(p_cflow->args.size() <= 1);
 			Address ret;
-			if (p_cflow->args.size() == 1) ret = _generate_expression(p_cflow->args[0].get());
+			if (p_cflow->args.size() == 1) ret = _generate_expression(p_cflow->args[0]);
 			_context.insert_dbg(p_cflow);
+			if (_context.function->_return_type != var::VAR) {
+				// the value is checked in a temp, it could be a constant or a local which is still used.
+				if (!ret.is_temp()) {
+					Address tmp = _context.add_stack_temp();
+					_context.opcodes->write_assign(tmp, ret);
+					ret = tmp;
+				}
+				_context.opcodes->write_check_type(ret, _context.function->_return_type);
+			}
 			_context.opcodes->write_return(ret);
 			if (ret.is_temp()) _context.pop_stack_temp();
 			
@@ -549,48 +1075,71 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 		} break;
 
 		case Parser::Node::Type::CONST_VALUE: {
-			return add_global_const_value(static_cast<const Parser::ConstValueNode*>(p_expr)->value);
+			const var& value = static_cast<const Parser::ConstValueNode*>(p_expr)->value;
+			// containers are mutable, every evaluation needs it's own copy of the constant.
+			if (value.get_type() == var::ARRAY || value.get_type() == var::MAP) {
+				Address dst = ADDR_DST();
+				_context.insert_dbg(p_expr);
+				_context.opcodes->write_const_literal(dst, Address(Address::CONST_VALUE, _bytecode->_global_const_value_add(value)));
+				return dst;
+			}
+			return add_global_const_value(value);
 		} break;
 
 		case Parser::Node::Type::ARRAY: {
 			const Parser::ArrayNode* arr = static_cast<const Parser::ArrayNode*>(p_expr);
 
-			Address arr_dst = ADDR_DST();
+			var literal;
+			if (arr->elements.size() > 0 && _fold_literal(p_expr, literal)) {
+				Address arr_dst = ADDR_DST();
+				_context.insert_dbg(p_expr);
+				_context.opcodes->write_const_literal(arr_dst, Address(Address::CONST_VALUE, _bytecode->_global_const_value_add(literal)));
+				return arr_dst;
+			}
 
 			stdvec<Address> values;
 			for (int i = 0; i < (int)arr->elements.size(); i++) {
-				Address val = _generate_expression(arr->elements[i].get());
+				Address val = _generate_expression(arr->elements[i]);
 				values.push_back(val);
 			}
-			_context.insert_dbg(p_expr);
-			_context.opcodes->write_array_literal(arr_dst, values);
-
 			for (Address& addr : values) {
 				_pop_addr_if_temp(addr);
 			}
 
+			// the elements are read before it's written, it could reuse their temp.
+			Address arr_dst = ADDR_DST();
+			_context.insert_dbg(p_expr);
+			_context.opcodes->write_array_literal(arr_dst, values);
+
 			return arr_dst;
 		} break;
 
 		case Parser::Node::Type::MAP: {
 			const Parser::MapNode* map = static_cast<const Parser::MapNode*>(p_expr);
 
-			Address map_dst = ADDR_DST();
+			var literal;
+			if (map->elements.size() > 0 && _fold_literal(p_expr, literal)) {
+				Address map_dst = ADDR_DST();
+				_context.insert_dbg(p_expr);
+				_context.opcodes->write_const_literal(map_dst, Address(Address::CONST_VALUE, _bytecode->_global_const_value_add(literal)));
+				return map_dst;
+			}
 
 			stdvec<Address> keys, values;
 			for (auto& pair : map->elements) {
-				Address key = _generate_expression(pair.key.get());
-				Address value = _generate_expression(pair.value.get());
+				Address key = _generate_expression(pair.key);
+				Address value = _generate_expression(pair.value);
 
 				keys.push_back(key);
 				values.push_back(value);
 			}
-			_context.insert_dbg(p_expr);
-			_context.opcodes->write_map_literal(map_dst, keys, values);
-
 			for (Address& addr : keys) _pop_addr_if_temp(addr);
 			for (Address& addr : values) _pop_addr_if_temp(addr);
 
+			Address map_dst = ADDR_DST();
+			_context.insert_dbg(p_expr);
+			_context.opcodes->write_map_literal(map_dst, keys, values);
+
 			return map_dst;
 		} break;
 
@@ -612,28 +1161,50 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 
 		case Parser::Node::Type::CALL: {
 			const Parser::CallNode* call = static_cast<const Parser::CallNode*>(p_expr);
-			Address ret = ADDR_DST();
 
 			stdvec<Address> args;
 			for (int i = 0; i < (int)call->args.size(); i++) {
-				Address arg = _generate_expression(call->args[i].get());
+				Address arg = _generate_expression(call->args[i]);
 				args.push_back(arg);
 			}
 
+			// the base is evaluated after the arguments (print.member(), String.format(), a.f(), f()).
+			Address base;
+			switch (call->base->type) {
+				case Parser::Node::Type::BUILTIN_FUNCTION:
+				case Parser::Node::Type::BUILTIN_TYPE:
+					if (call->method != nullptr) base = _generate_expression(call->base);
+					break;
+				case Parser::Node::Type::SUPER:
+				case Parser::Node::Type::UNKNOWN:
+					break;
+				default:
+					base = _generate_expression(call->base);
+					break;
+			}
+
+			// the return value is written after the arguments are read, it could reuse their temp.
+			_pop_addr_if_temp(base);
+			for (Address& addr : args) _pop_addr_if_temp(addr);
+			Address ret = ADDR_DST();
+
 			switch (call->base->type) {
 
 				// print(); builtin func call
 				case Parser::Node::Type::BUILTIN_FUNCTION: {
 					if (call->method == nullptr) { // print(...);
 						_context.insert_dbg(p_expr);
-						_context.opcodes->write_call_builtin(ret, static_cast<const Parser::BuiltinFunctionNode*>(call->base.get())->func, args);
+						BuiltinFunctions::Type func = static_cast<const Parser::BuiltinFunctionNode*>(call->base)->func;
+						if (BuiltinFunctions::is_intrinsic(func, (int)args.size())) {
+							_context.opcodes->write_call_intrinsic(ret, func, args[0], (args.size() == 2) ? args[1] : Address());
+						} else {
+							_context.opcodes->write_call_builtin(ret, func, args);
+						}
 					} else { // print.member(...);
-						Address base = _generate_expression(call->base.get());
 						ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method.get())->name);
-						_context.insert_dbg(call->method.get());
+						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method)->name);
+						_context.insert_dbg(call->method);
 						_context.opcodes->write_call_method(ret, base, name,  args);
-						_pop_addr_if_temp(base);
 					}
 				} break;
 
@@ -641,14 +1212,12 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 				case Parser::Node::Type::BUILTIN_TYPE: {
 					if (call->method == nullptr) { // Array(); constructor
 						_context.insert_dbg(p_expr);
-						_context.opcodes->write_construct_builtin_type(ret, static_cast<const Parser::BuiltinTypeNode*>(call->base.get())->builtin_type, args);
+						_context.opcodes->write_construct_builtin_type(ret, static_cast<const Parser::BuiltinTypeNode*>(call->base)->builtin_type, args);
 					} else { // String.format(); // static method call on builtin type
-						Address base = _generate_expression(call->base.get());
 						ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method.get())->name);
-						_context.insert_dbg(call->method.get());
+						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method)->name);
+						_context.insert_dbg(call->method);
 						_context.opcodes->write_call_method(ret, base, name, args);
-						_pop_addr_if_temp(base);
 					}
 				} break;
 
@@ -659,9 +1228,9 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 						_context.opcodes->write_call_super_constructor(args);
 					} else { // super.f();
 						ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-						const Parser::IdentifierNode* method = ptrcast<Parser::IdentifierNode>(call->method).get();
+						const Parser::IdentifierNode* method = static_cast<Parser::IdentifierNode*>(call->method);
 						uint32_t name = add_global_name(method->name);
-						_context.insert_dbg(call->method.get());
+						_context.insert_dbg(call->method);
 						_context.opcodes->write_call_super_method(ret, name, args);
 					}
 
@@ -669,12 +1238,16 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 
 				case Parser::Node::Type::UNKNOWN: {
 					ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-					const Parser::IdentifierNode* func = ptrcast<Parser::IdentifierNode>(call->method).get();
+					const Parser::IdentifierNode* func = static_cast<Parser::IdentifierNode*>(call->method);
 					uint32_t name = add_global_name(func->name);
 					switch (func->ref) {
 						case  Parser::IdentifierNode::REF_FUNCTION: {
 							_context.insert_dbg(p_expr);
-							_context.opcodes->write_call_func(ret, name, args);
+							if (call->_direct_func != nullptr) {
+								_context.opcodes->write_call_direct(ret, add_direct_function(call->_direct_func), name, args);
+							} else {
+								_context.opcodes->write_call_func(ret, name, args);
+							}
 						} break;
 						case  Parser::IdentifierNode::REF_CARBON_CLASS: {
 							_context.insert_dbg(p_expr);
@@ -691,45 +1264,45 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 				} break;
 
 				default: {
-					Address base = _generate_expression(call->base.get());
 					if (call->method != nullptr) {
 						ASSERT(call->method->type == Parser::Node::Type::IDENTIFIER);
-						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method.get())->name);
-						_context.insert_dbg(call->method.get());
-						_context.opcodes->write_call_method(ret, base, name, args);
+						uint32_t name = add_global_name(static_cast<const Parser::IdentifierNode*>(call->method)->name);
+						_context.insert_dbg(call->method);
+						if (call->_direct_func != nullptr) { // this.f();
+							_context.opcodes->write_call_direct(ret, add_direct_function(call->_direct_func), name, args);
+						} else {
+							_context.opcodes->write_call_method(ret, base, name, args);
+						}
 					} else {
 						_context.insert_dbg(p_expr);
 						_context.opcodes->write_call(ret, base, args);
 					}
-					_pop_addr_if_temp(base);
 				} break;
 			}
-			for (Address& addr : args) _pop_addr_if_temp(addr);
 			return ret;
 		} break;
 
 		case Parser::Node::Type::INDEX: {
-			Address dst = ADDR_DST();
 			const Parser::IndexNode* index_node = static_cast<const Parser::IndexNode*>(p_expr);
-			Address on = _generate_expression(index_node->base.get());
+			Address on = _generate_expression(index_node->base);
+			_pop_addr_if_temp(on);
+			Address dst = ADDR_DST();
 			uint32_t name = add_global_name(index_node->member->name);
-			_context.insert_dbg(index_node->member.get());
+			_context.insert_dbg(index_node->member);
 			_context.opcodes->write_get_index(on, name, dst);
-			_pop_addr_if_temp(on);
 			return dst;
 		} break;
 
 		case Parser::Node::Type::MAPPED_INDEX: {
-			Address dst = ADDR_DST();
 			const Parser::MappedIndexNode* index_node = static_cast<const Parser::MappedIndexNode*>(p_expr);
-			Address on = _generate_expression(index_node->base.get());
-			Address key = _generate_expression(index_node->key.get());
-
-			_context.insert_dbg(index_node->key.get());
-			_context.opcodes->write_get_mapped(on, key, dst);
-
+			Address on = _generate_expression(index_node->base);
+			Address key = _generate_expression(index_node->key);
 			_pop_addr_if_temp(on);
 			_pop_addr_if_temp(key);
+			Address dst = ADDR_DST();
+
+			_context.insert_dbg(index_node->key);
+			_context.opcodes->write_get_mapped(on, key, dst);
 			return dst;
 		} break;
 		case Parser::Node::Type::OPERATOR: {
@@ -751,28 +1324,30 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 				_addr_operator_assign_:
 					// indexing, mapped indexing is special case.
 					if (op->args[0]->type == Parser::Node::Type::INDEX) {
-						const Parser::IndexNode* index = static_cast<Parser::IndexNode*>(op->args[0].get());
-						Address on = _generate_expression(index->base.get());
-						uint32_t name = add_global_name(ptrcast<Parser::IdentifierNode>(index->member)->name);
-						Address value = _generate_expression(op->args[1].get());
+						const Parser::IndexNode* index = static_cast<Parser::IndexNode*>(op->args[0]);
+						// the result of `a.b += c` is below the operand temps to be released first.
+						Address tmp = (var_op != var::_OP_MAX_) ? _context.add_stack_temp() : Address();
+						Address on = _generate_expression(index->base);
+						uint32_t name = add_global_name(static_cast<Parser::IdentifierNode*>(index->member)->name);
+						Address value = _generate_expression(op->args[1]);
 
 						if (var_op != var::_OP_MAX_) {
-							Address tmp = _context.add_stack_temp();
-							_context.insert_dbg(index->member.get());
+							_context.insert_dbg(index->member);
 							_context.opcodes->write_get_index(on, name, tmp);
 
 							_context.insert_dbg(p_expr);
-							_context.opcodes->write_operator(tmp, var_op, tmp, value);
+							_write_operator_assign(tmp, var_op, value);
 
-							_context.insert_dbg(index->member.get());
+							_context.insert_dbg(index->member);
 							_context.opcodes->write_set_index(on, name, tmp);
 
 							_pop_addr_if_temp(on);
+							_pop_addr_if_temp(value);
 							return tmp;
 
 						} else {
 
-							_context.insert_dbg(index->member.get());
+							_context.insert_dbg(index->member);
 							_context.opcodes->write_set_index(on, name, value);
 
 							_pop_addr_if_temp(on);
@@ -780,28 +1355,29 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 						}
 
 					} else if (op->args[0]->type == Parser::Node::Type::MAPPED_INDEX) {
-						const Parser::MappedIndexNode* mapped = static_cast<const Parser::MappedIndexNode*>(op->args[0].get());
-						Address on = _generate_expression(mapped->base.get());
-						Address key = _generate_expression(mapped->key.get());
-						Address value = _generate_expression(op->args[1].get());
+						const Parser::MappedIndexNode* mapped = static_cast<const Parser::MappedIndexNode*>(op->args[0]);
+						Address tmp = (var_op != var::_OP_MAX_) ? _context.add_stack_temp() : Address();
+						Address on = _generate_expression(mapped->base);
+						Address key = _generate_expression(mapped->key);
+						Address value = _generate_expression(op->args[1]);
 
 						if (var_op != var::_OP_MAX_) {
-							Address tmp = _context.add_stack_temp();
-							_context.insert_dbg(mapped->key.get());
+							_context.insert_dbg(mapped->key);
 							_context.opcodes->write_get_mapped(on, key, tmp);
 
 							_context.insert_dbg(p_expr);
-							_context.opcodes->write_operator(tmp, var_op, tmp, value);
+							_write_operator_assign(tmp, var_op, value);
 
-							_context.insert_dbg(mapped->key.get());
+							_context.insert_dbg(mapped->key);
 							_context.opcodes->write_set_mapped(on, key, tmp);
 
 							_pop_addr_if_temp(on);
 							_pop_addr_if_temp(key);
+							_pop_addr_if_temp(value);
 							return tmp;
 
 						} else {
-							_context.insert_dbg(mapped->key.get());
+							_context.insert_dbg(mapped->key);
 							_context.opcodes->write_set_mapped(on, key, value);
 
 							_pop_addr_if_temp(on);
@@ -810,19 +1386,25 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 						}
 
 					} else {
-						Address left = _generate_expression(op->args[0].get());
+						Address left = _generate_expression(op->args[0]);
 						if (left.is_temp()) THROW_ERROR(Error::SYNTAX_ERROR, "invalid assignment to an expression"); // f() = 12; TODO: throw with dbg info.
 						if (var_op != var::_OP_MAX_) {
-							Address right = _generate_expression(op->args[1].get());
+							Address right = _generate_expression(op->args[1]);
 							_context.insert_dbg(p_expr);
-							_context.opcodes->write_operator(left, var_op, left, right);
+							_write_operator_assign(left, var_op, right);
 							_pop_addr_if_temp(right);
 						} else {
-							Address right = _generate_expression(op->args[1].get(), &left);
+							// `x = x && y;` && and || set the destination before reading the operands.
+							Parser::OperatorNode::OpType rhs = (op->args[1]->type == Parser::Node::Type::OPERATOR) ?
+								static_cast<const Parser::OperatorNode*>(op->args[1])->op_type : Parser::OperatorNode::OP_EQ;
+							bool direct = rhs != Parser::OperatorNode::OP_AND && rhs != Parser::OperatorNode::OP_OR;
+							Address right = _generate_expression(op->args[1], (direct) ? &left : nullptr);
 							_context.insert_dbg(p_expr);
 							if (left != right) _context.opcodes->write_assign(left, right);
 							_pop_addr_if_temp(right);
 						}
+						var::Type type = _get_declared_type(op->args[0]);
+						if (type != var::VAR) _context.opcodes->write_check_type(left, type);
 						return left;
 					}
 				} break;
@@ -831,10 +1413,10 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 					Address dst = ADDR_DST();
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_assign_bool(dst, false);
-					Address left = _generate_expression(op->args[0].get());
+					Address left = _generate_expression(op->args[0]);
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_and_left(left);
-					Address right = _generate_expression(op->args[1].get());
+					Address right = _generate_expression(op->args[1]);
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_and_right(right, dst);
 					_pop_addr_if_temp(left);
@@ -846,10 +1428,10 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 					Address dst = ADDR_DST();
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_assign_bool(dst, true);
-					Address left = _generate_expression(op->args[0].get());
+					Address left = _generate_expression(op->args[0]);
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_or_left(left);
-					Address right = _generate_expression(op->args[1].get());
+					Address right = _generate_expression(op->args[1]);
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_or_right(right, dst);
 					_pop_addr_if_temp(left);
@@ -874,48 +1456,48 @@ Address CodeGen::_generate_expression(const Parser::Node* p_expr, Address* p_dst
 				case Parser::OperatorNode::OP_BIT_AND:    var_op = var::OP_BIT_AND;		   goto _addr_operator_;
 				case Parser::OperatorNode::OP_BIT_XOR: {  var_op = var::OP_BIT_XOR;
 					_addr_operator_:
-					Address dst = ADDR_DST();
-					Address left = _generate_expression(op->args[0].get());
-					Address right = _generate_expression(op->args[1].get());
-					_context.insert_dbg(p_expr);
-					_context.opcodes->write_operator(dst, var_op, left, right);
+					Address left = _generate_expression(op->args[0]);
+					Address right = _generate_expression(op->args[1]);
 					_pop_addr_if_temp(left);
 					_pop_addr_if_temp(right);
+					Address dst = ADDR_DST(); // could be the temp of an operand.
+					_context.insert_dbg(p_expr);
+					_context.opcodes->write_operator(dst, var_op, left, right);
 					return dst;
 				} break;
 
 				case Parser::OperatorNode::OP_NOT: {
+					Address left = _generate_expression(op->args[0]);
+					_pop_addr_if_temp(left);
 					Address dst = ADDR_DST();
-					Address left = _generate_expression(op->args[0].get());
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_operator(dst, var::OP_NOT, left, Address());
-					_pop_addr_if_temp(left);
 					return dst;
 				} break;
 
 				case Parser::OperatorNode::OP_BIT_NOT: {
+					Address left = _generate_expression(op->args[0]);
+					_pop_addr_if_temp(left);
 					Address dst = ADDR_DST();
-					Address left = _generate_expression(op->args[0].get());
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_operator(dst, var::OP_BIT_NOT, left, Address());
-					_pop_addr_if_temp(left);
 					return dst;
 				} break;
 
 				case Parser::OperatorNode::OP_POSITIVE: {
+					Address left = _generate_expression(op->args[0]);
+					_pop_addr_if_temp(left);
 					Address dst = ADDR_DST();
-					Address left = _generate_expression(op->args[0].get());
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_operator(dst, var::OP_POSITIVE, left, Address());
-					_pop_addr_if_temp(left);
 					return dst;
 				} break;
 				case Parser::OperatorNode::OP_NEGATIVE: {
+					Address left = _generate_expression(op->args[0]);
+					_pop_addr_if_temp(left);
 					Address dst = ADDR_DST();
-					Address left = _generate_expression(op->args[0].get());
 					_context.insert_dbg(p_expr);
 					_context.opcodes->write_operator(dst, var::OP_NEGATIVE, left, Address());
-					_pop_addr_if_temp(left);
 					return dst;
 				} break;
 			}
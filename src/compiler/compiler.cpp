@@ -27,7 +27,10 @@
 
 #include "native/path.h"
 #include "native/file.h"
-#include "native/os.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 
 namespace carbon {
 
@@ -49,45 +52,334 @@ void Compiler::add_include_dir(const String& p_dir) {
 		_include_dirs.push_back(Path(p_dir).absolute());
 	}
 }
+void Compiler::add_aot_module(ptr<AOTModule> p_module) { _aot_modules.push_back(p_module); }
+void Compiler::set_profile(ptr<Profile> p_profile) { _profile = p_profile; }
+void Compiler::set_thread_count(int p_count) { _thread_count = p_count; }
+void Compiler::set_bytecode_cache(bool p_enabled, const String& p_dir) {
+	_bytecode_cache = p_enabled;
+	_bytecode_cache_dir = (p_dir.size() != 0) ? Path(p_dir).absolute() : "";
+}
+
+// main.cb -> main.cbc or <cache dir>/main.cb.<hash of the path>.cbc (files of different directories could
+// have the same name).
+String Compiler::get_bytecode_cache_path(const String& p_path) const {
+	if (_bytecode_cache_dir.size() == 0) return (p_path.endswith(".cb")) ? p_path + "c" : p_path + ".cbc";
+	uint64_t hash = BytecodeCache::hash(p_path.c_str(), p_path.size());
+	return _bytecode_cache_dir + "/" + Path(p_path).filename() + String::format(".%016llx.cbc", (unsigned long long)hash);
+}
 
-ptr<Bytecode> Compiler::_compile(const String& p_path) {
+// an import path is relative to the directory of the file importing it (not the cwd, it's process
+// wide and the files are compiled from multiple threads) and then to the include dirs.
+String Compiler::resolve_import(const String& p_path, const String& p_dir) const {
+	const std::string& path = p_path;
+	bool absolute = path.size() != 0 && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+	if (absolute || p_dir.size() == 0) return p_path;
 
-	// TODO: print only if serialize to bytecode.
-	//Logger::log(String::format("compiling: %s\n", p_path.c_str()).c_str());
+	String joined = p_dir + "/" + p_path;
+	if (Path(joined).exists()) return joined;
+	for (const String& dir : _include_dirs) {
+		String included = dir + "/" + p_path;
+		if (Path(included).exists()) return included;
+	}
+	return joined;
+}
+
+int Compiler::_get_thread_count(size_t p_jobs) const {
+	int count = _thread_count;
+	if (count <= 0) count = (int)std::thread::hardware_concurrency();
+	if (count <= 0) count = 1;
+	return (int)std::min((size_t)count, std::max(p_jobs, (size_t)1));
+}
+
+// a change in any of the imports invalidates the compiled file, _mutex should be locked.
+uint64_t Compiler::_hash_imports(uint64_t p_source_hash, const stdvec<String>& p_resolved) const {
+	uint64_t hash = p_source_hash;
+	for (const String& path : p_resolved) {
+		hash = BytecodeCache::hash(path.c_str(), path.size(), hash);
+		auto it = _cache.find(path);
+		if (it != _cache.end()) hash = BytecodeCache::hash(&it->second.hash, sizeof(uint64_t), hash);
+	}
+	return hash;
+}
 
-	class ScopeDestruct {
-	public:
-		std::stack<String>* _cwd_ptr = nullptr;
-		ScopeDestruct(std::stack<String>* p_cwd_ptr) {
-			_cwd_ptr = p_cwd_ptr;
+// runs p_func(i) for every i in [0, p_count) on p_threads threads (the calling thread is one of them),
+// the first exception thrown is rethrown once all of them are done.
+static void _parallel_for(size_t p_count, int p_threads, const std::function<void(size_t)>& p_func) {
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
+	std::mutex error_mutex;
+	auto worker = [&]() {
+		for (size_t i = next++; i < p_count; i = next++) {
+			try {
+				p_func(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(error_mutex);
+				if (error == nullptr) error = std::current_exception();
+				next = p_count;
+			}
 		}
-		~ScopeDestruct() {
-			OS::chdir(_cwd_ptr->top());
-			_cwd_ptr->pop();
+	};
+	stdvec<std::thread> threads;
+	for (int i = 1; i < p_threads; i++) threads.push_back(std::thread(worker));
+	worker();
+	for (std::thread& thread : threads) thread.join();
+	if (error != nullptr) std::rethrow_exception(error);
+}
+
+void Compiler::_build_import_graph(ptr<_Module> p_root, stdmap<String, ptr<_Module>>& r_modules) {
+
+	// breadth first, the files of each level are tokenized in parallel to find their imports.
+	stdvec<_Module*> level;
+	r_modules[p_root->path] = p_root;
+	level.push_back(p_root.get());
+
+	while (level.size() != 0) {
+		_parallel_for(level.size(), _get_thread_count(level.size()), [&](size_t i) {
+			_Module* module = level[i];
+
+			// an in memory source is tokenized already.
+			if (!module->in_memory) {
+				ptr<File> file = newptr<File>(module->path, File::READ);
+				String source = file->read_text();
+				file->close();
+				module->source_hash = BytecodeCache::hash(source.c_str(), source.size());
+
+				// an unchanged source has the imports of it's .cbc, it's tokenized only if it's compiled.
+				BytecodeCache::Header header;
+				if (_bytecode_cache && BytecodeCache::read_header(get_bytecode_cache_path(module->path), &header) &&
+					header.source_hash == module->source_hash) {
+					module->import_paths = header.import_paths;
+				} else {
+					module->tokenizer = newptr<Tokenizer>();
+					module->tokenizer->tokenize(source, module->path);
+				}
+			}
+
+			if (module->tokenizer != nullptr) {
+				// import name = "path"; (a malformed one is reported by the parser).
+				for (int j = 0; j < (int)module->tokenizer->get_token_count(); j++) {
+					if (module->tokenizer->peek(j).type != Token::KWORD_IMPORT) continue;
+					if (module->tokenizer->peek(j + 1, true).type != Token::IDENTIFIER) continue;
+					if (module->tokenizer->peek(j + 2, true).type != Token::OP_EQ) continue;
+					const TokenData& tk = module->tokenizer->peek(j + 3, true);
+					if (tk.type != Token::VALUE_STRING) continue;
+					module->import_paths.push_back(tk.get_constant().operator String());
+				}
+			}
+
+			String dir = Path(module->path).parent();
+			for (const String& import_path : module->import_paths) {
+				String path = resolve_import(import_path, dir);
+				if (Path(path).exists()) module->resolved.push_back(Path(path).absolute());
+			}
+		});
+
+		stdvec<_Module*> next_level;
+		for (size_t i = 0; i < level.size(); i++) {
+			for (const String& path : level[i]->resolved) {
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					auto it = _cache.find(path);
+					if (it != _cache.end() && !it->second.compiling) continue; // already compiled.
+				}
+				level[i]->imports.push_back(path);
+				if (r_modules.find(path) != r_modules.end()) continue;
+				ptr<_Module> module = newptr<_Module>();
+				module->path = path;
+				r_modules[path] = module;
+				next_level.push_back(module.get());
+			}
 		}
+		level = next_level;
+	}
+
+	// a cyclic import can't be ordered.
+	stdmap<const _Module*, int> state; // 1 : visiting, 2 : done.
+	std::function<void(const _Module*)> visit = [&](const _Module* p_module) {
+		state[p_module] = 1;
+		for (const String& path : p_module->imports) {
+			const _Module* import = r_modules[path].get();
+			if (state[import] == 1) THROW_ERROR(Error::IO_ERROR, String::format("cyclic import found in \"%s\"", path.c_str()));
+			if (state[import] == 0) visit(import);
+		}
+		state[p_module] = 2;
 	};
-	ScopeDestruct destruct = ScopeDestruct(&_cwd);
-	_cwd.push(OS::getcwd());
-	OS::chdir(Path(p_path).parent());
-
-	ptr<File> file = newptr<File>();
-	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
-	ptr<Parser> parser = newptr<Parser>();
-	ptr<Analyzer> analyzer = newptr<Analyzer>();
-	ptr<CodeGen> codegen = newptr<CodeGen>();
+	visit(p_root.get());
+
+	for (auto& it : r_modules) {
+		for (const String& path : it.second->imports) {
+			it.second->pending++;
+			r_modules[path]->dependents.push_back(it.second.get());
+		}
+	}
+}
+
+void Compiler::_compile_modules(stdmap<String, ptr<_Module>>& p_modules) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& it : p_modules) {
+			if (!it.second->in_memory) _cache[it.first] = _Cache();
+		}
+	}
+
+	// a module is compiled once all of it's imports are, independent modules at the same time.
+	std::mutex mutex;
+	std::condition_variable cv;
+	stdvec<_Module*> ready;
+	size_t remaining = p_modules.size();
+	std::exception_ptr error;
+	for (auto& it : p_modules) {
+		if (it.second->pending == 0) ready.push_back(it.second.get());
+	}
+
+	auto worker = [&]() {
+		while (true) {
+			_Module* module = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&]() { return ready.size() != 0 || remaining == 0 || error != nullptr; });
+				if (remaining == 0 || error != nullptr) return;
+				module = ready.back();
+				ready.pop_back();
+			}
+
+			ptr<Bytecode> bytecode;
+			try {
+				bytecode = _compile(module);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (error == nullptr) error = std::current_exception();
+				cv.notify_all();
+				return;
+			}
+			module->tokenizer = nullptr;
+
+			if (module->in_memory) {
+				module->bytecode = bytecode;
+			} else {
+				std::lock_guard<std::mutex> lock(_mutex);
+				_cache[module->path].bytecode = bytecode;
+				_cache[module->path].hash = module->hash;
+				_cache[module->path].record = module->record;
+				_cache[module->path].compiling = false;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining--;
+			for (_Module* dependent : module->dependents) {
+				if (--dependent->pending == 0) ready.push_back(dependent);
+			}
+			cv.notify_all();
+		}
+	};
+
+	stdvec<std::thread> threads;
+	int thread_count = _get_thread_count(p_modules.size());
+	for (int i = 1; i < thread_count; i++) threads.push_back(std::thread(worker));
+	worker();
+	for (std::thread& thread : threads) thread.join();
+
+	if (error != nullptr) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& it : p_modules) {
+			if (it.second->in_memory || !_cache[it.first].compiling) continue;
+			if (it.second->previous.bytecode != nullptr) _cache[it.first] = it.second->previous; // still the last one.
+			else _cache.erase(it.first);
+		}
+		std::rethrow_exception(error);
+	}
+}
+
+ptr<Bytecode> Compiler::_load_bytecode_cache(const String& p_cache_path, uint64_t p_hash) {
+	BytecodeCache::Header header;
+	if (!BytecodeCache::read_header(p_cache_path, &header) || header.hash != p_hash) return nullptr;
+	try {
+		return BytecodeCache::load(p_cache_path, [this](const String& p_path) -> ptr<Bytecode> {
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _cache.find(p_path);
+			return (it != _cache.end()) ? it->second.bytecode : nullptr;
+		});
+	} catch (Throwable&) {
+		return nullptr; // a corrupted cache is compiled again.
+	}
+}
+
+ptr<Bytecode> Compiler::_compile(_Module* p_module) {
+
+	// TODO: print only if serialize to bytecode.
+	//Logger::log(String::format("compiling: %s\n", p_module->path.c_str()).c_str());
+
+	// the imports are compiled, a change in any of them invalidates the cache of this file.
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		p_module->hash = _hash_imports(p_module->source_hash, p_module->resolved);
+	}
+
+	// a file compiled again isn't loaded from it's .cbc, if only the bodies of it's functions are changed
+	// they're generated again in place (the profile and the modules are applied to the others already).
+	const _Cache& previous = p_module->previous;
+	String cache_path = (_bytecode_cache && !p_module->in_memory) ? get_bytecode_cache_path(p_module->path) : "";
 	ptr<Bytecode> bytecode;
+	if (cache_path.size() != 0 && previous.bytecode == nullptr) bytecode = _load_bytecode_cache(cache_path, p_module->hash);
 
-	file->open(p_path, File::READ);
-	tokenizer->tokenize(file);
-	parser->parse(tokenizer);
-	analyzer->analyze(parser);
-	bytecode = codegen->generate(analyzer);
-	file->close();
+	if (bytecode == nullptr) {
+		ptr<Tokenizer> tokenizer = p_module->tokenizer;
+		ptr<Parser> parser = newptr<Parser>();
+		ptr<Analyzer> analyzer = newptr<Analyzer>();
+		ptr<CodeGen> codegen = newptr<CodeGen>();
 
-	for (const Warning& warning : analyzer->get_warnings()) {
-		warning.console_log(); // TODO: it shouldn't print, add to warnings list instead.
+		if (tokenizer == nullptr) {
+			ptr<File> file = newptr<File>(p_module->path, File::READ);
+			tokenizer = newptr<Tokenizer>();
+			tokenizer->tokenize(file);
+			file->close();
+		}
+		parser->parse(tokenizer);
+		analyzer->analyze(parser);
+		bool regenerated = false;
+		if (previous.record != nullptr) {
+			regenerated = codegen->regenerate(analyzer, previous.bytecode.get(), previous.record.get());
+		}
+		if (regenerated) {
+			bytecode = previous.bytecode;
+			p_module->record = previous.record;
+		} else {
+			p_module->record = newptr<CodeGen::FileRecord>();
+			bytecode = codegen->generate(analyzer, p_module->record.get());
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (const Warning& warning : analyzer->get_warnings()) {
+				warning.console_log(); // TODO: it shouldn't print, add to warnings list instead.
+			}
+		}
+
+		// written before the profile is applied, a file with warnings isn't cached as a loaded one won't print them.
+		if (cache_path.size() != 0 && !regenerated && analyzer->get_warnings().size() == 0) {
+			BytecodeCache::Header header;
+			header.source_hash = p_module->source_hash;
+			header.hash = p_module->hash;
+			header.import_paths = p_module->import_paths;
+			try {
+				BytecodeCache::save(cache_path, header, bytecode.get());
+			} catch (Throwable&) {
+				// the cache is optional (the directory could be read only or a constant couldn't be written).
+			}
+		}
+	}
+
+	// before the modules, they're written from the specialized opcodes.
+	if (_profile != nullptr) _profile->apply(bytecode.get());
+	for (const ptr<AOTModule>& module : _aot_modules) {
+		module->apply(bytecode.get());
 	}
 
+	// the files importing this one read it from the other threads, the member infos are built
+	// on the first access so build them now.
+	bytecode->get_member_info_list();
+	for (auto& it : bytecode->get_classes()) it.second->get_member_info_list();
+
 	return bytecode;
 }
 
@@ -96,19 +388,110 @@ ptr<Bytecode> Compiler::compile(const String& p_path, bool p_use_cache) {
 	if (!Path(p_path).exists()) THROW_ERROR(Error::IO_ERROR, String::format("path \"%s\" does not exists.", p_path.c_str()));
 
 	String path = Path(p_path).absolute();
-	auto it = _cache.find(path);
-	if (it != _cache.end()) {
-		if (it->second.compiling)  THROW_ERROR(Error::IO_ERROR, String::format("cyclic import found in \"%s\"", path.c_str()));
-		if (p_use_cache) return it->second.bytecode;
-	} else {
-		_cache[path] = _Cache();
+	_Cache previous;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _cache.find(path);
+		if (it != _cache.end()) {
+			if (it->second.compiling)  THROW_ERROR(Error::IO_ERROR, String::format("cyclic import found in \"%s\"", path.c_str()));
+			if (p_use_cache) return it->second.bytecode;
+			previous = it->second;
+		}
 	}
 
-	ptr<Bytecode> bytecode = _compile(path);
+	ptr<_Module> root = newptr<_Module>();
+	root->path = path;
+	root->previous = previous;
+	stdmap<String, ptr<_Module>> modules;
+	_build_import_graph(root, modules);
+	_compile_modules(modules);
 
-	_cache[path].bytecode = bytecode;
-	_cache[path].compiling = false;
-	return bytecode;
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _cache[path].bytecode;
+}
+
+ptr<Bytecode> Compiler::compile_string(const String& p_source, const String& p_path) {
+
+	uint64_t source_hash = BytecodeCache::hash(p_source.c_str(), p_source.size());
+	uint64_t key = BytecodeCache::hash(p_path.c_str(), p_path.size(), source_hash);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _string_cache_index.find(key);
+		if (it != _string_cache_index.end()) {
+			_StringEntry& entry = *it->second;
+			if (entry.source == p_source && entry.path == p_path && _hash_imports(entry.source_hash, entry.resolved) == entry.hash) {
+				_string_cache.splice(_string_cache.begin(), _string_cache, it->second);
+				_string_cache_stats.hits++;
+				return entry.bytecode;
+			}
+			_string_cache.erase(it->second); // an import is compiled again (or an other source with the same key).
+			_string_cache_index.erase(it);
+		}
+		_string_cache_stats.misses++;
+	}
+
+	ptr<_Module> root = newptr<_Module>();
+	root->path = p_path;
+	root->in_memory = true;
+	root->source_hash = source_hash;
+	root->tokenizer = newptr<Tokenizer>();
+	root->tokenizer->tokenize(p_source, p_path);
+
+	stdmap<String, ptr<_Module>> modules;
+	_build_import_graph(root, modules);
+	_compile_modules(modules);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_string_cache_capacity == 0) return root->bytecode;
+
+	// the same source could be compiled from an other thread meanwhile.
+	auto it = _string_cache_index.find(key);
+	if (it != _string_cache_index.end()) {
+		_string_cache.erase(it->second);
+		_string_cache_index.erase(it);
+	}
+	_StringEntry entry;
+	entry.key = key;
+	entry.source = p_source;
+	entry.path = p_path;
+	entry.source_hash = source_hash;
+	entry.hash = root->hash;
+	entry.resolved = root->resolved;
+	entry.bytecode = root->bytecode;
+	_string_cache.push_front(entry);
+	_string_cache_index[key] = _string_cache.begin();
+	_evict_strings(_string_cache_capacity);
+	return root->bytecode;
+}
+
+// the least recently used ones, _mutex should be locked.
+void Compiler::_evict_strings(size_t p_capacity) {
+	while (_string_cache.size() > p_capacity) {
+		_string_cache_index.erase(_string_cache.back().key);
+		_string_cache.pop_back();
+		_string_cache_stats.evictions++;
+	}
+}
+
+void Compiler::set_string_cache_capacity(size_t p_capacity) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_string_cache_capacity = p_capacity;
+	_evict_strings(p_capacity);
+}
+
+void Compiler::clear_string_cache() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_string_cache.clear();
+	_string_cache_index.clear();
+	_string_cache_stats = StringCacheStats();
+}
+
+Compiler::StringCacheStats Compiler::get_string_cache_stats() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+	StringCacheStats stats = _string_cache_stats;
+	stats.size = _string_cache.size();
+	stats.capacity = _string_cache_capacity;
+	return stats;
 }
 
 }
@@ -24,6 +24,7 @@
 //------------------------------------------------------------------------------
 
 #include "compiler/function.h"
+#include "compiler/ir.h"
 #include "compiler/vm.h"
 
 namespace carbon {
@@ -33,11 +34,147 @@ bool Function::is_static() const { return _is_static; }
 int Function::get_arg_count() const { return _arg_count; }
 const stdvec<var>& Function::get_default_args() const { return _default_args; }
 const stdvec<bool>& Function::get_is_args_ref() const { return _is_reference; }
+const stdvec<var::Type>& Function::get_arg_types() const { return _arg_types; }
+var::Type Function::get_return_type() const { return _return_type; }
 uint32_t Function::get_stack_size() const { return _stack_size; }
 const Bytecode* Function::get_owner() const { return _owner; }
 
 const stdvec<uint32_t>& Function::get_opcodes() const { return _opcodes; }
 const stdmap<uint32_t, uint32_t>& Function::get_op_dbg() const { return op_dbg; }
+const stdmap<uint32_t, uint32_t>& Function::get_op_inline() const { return op_inline; }
+const stdvec<InlineSite>& Function::get_inline_sites() const { return _inline_sites; }
+bool Function::is_verified() const { return _verified; }
+
+#define VERIFY(m_cond, m_msg)                                                                                        \
+	if (!(m_cond)) THROW_BUG(String::format("invalid bytecode in function \"%s\" at %i: %s.", _name.c_str(), ip, m_msg))
+
+void Function::verify() {
+	if (_verified) return;
+	ASSERT(_owner != nullptr);
+
+	const Bytecode* file = (_owner->is_class()) ? _owner->get_file().get() : _owner;
+	uint32_t names_count = (uint32_t)file->_global_names_array.size();
+
+	uint32_t ip = 0;
+	stdvec<bool> starts(_opcodes.size() + 1, false); // a jump to the end returns null.
+	starts[_opcodes.size()] = true;
+	stdmap<uint32_t, uint32_t> targets;              // jump target to the instruction.
+
+	while (ip < _opcodes.size()) {
+		VERIFY(_opcodes[ip] <= Opcode::END, "invalid opcode");
+		IRInstruction instr = IRInstruction::decode(_opcodes, ip);
+		starts[ip] = true;
+
+		for (int w = 1; w < (int)instr.size(); w++) {
+			uint32_t word = instr.words[w];
+			switch (instr.kinds[w]) {
+				case IRInstruction::OPCODE:
+					break;
+
+				case IRInstruction::IMM: {
+					switch (instr.get_opcode()) {
+						case Opcode::OPERATOR:
+						case Opcode::OPERATOR_ASSIGN:
+						case Opcode::OPERATOR_INT:
+						case Opcode::OPERATOR_FLOAT:
+							VERIFY(word < var::_OP_MAX_, "invalid operator");
+							break;
+						case Opcode::CHECK_TYPE: {
+							var::Type type = (var::Type)word;
+							VERIFY(type == var::BOOL || type == var::INT || type == var::FLOAT || type == var::STRING ||
+								type == var::ARRAY || type == var::MAP, "invalid type");
+							Address::Type addr = Address(instr.words[2]).get_type();
+							VERIFY(addr == Address::STACK || addr == Address::PARAMETER, "only a local or a parameter could be checked");
+						} break;
+						case Opcode::CONSTRUCT_BUILTIN:
+							if (w == 1) VERIFY(word < BuiltinTypes::_TYPE_MAX_, "invalid builtin type");
+							break;
+						case Opcode::CALL_BUILTIN:
+							if (w == 1) VERIFY(word < BuiltinFunctions::_FUNC_MAX_, "invalid builtin function");
+							break;
+						case Opcode::CALL_INTRINSIC: {
+							VERIFY(word < BuiltinFunctions::_FUNC_MAX_, "invalid builtin function");
+							int argc = (Address(instr.words[3]).get_type() == Address::_NULL) ? 1 : 2;
+							VERIFY(BuiltinFunctions::is_intrinsic((BuiltinFunctions::Type)word, argc), "invalid intrinsic");
+						} break;
+						case Opcode::CALL_DIRECT:
+							if (w == 1) VERIFY(word < file->_direct_functions.size(), "invalid direct function");
+							break;
+						default: // argument counts, already checked with the size of the instruction.
+							break;
+					}
+				} break;
+
+				case IRInstruction::NAME:
+					VERIFY(word < names_count, "invalid name index");
+					break;
+
+				case IRInstruction::USE:
+				case IRInstruction::DEF:
+				case IRInstruction::USE_DEF: {
+					Address addr(word);
+					uint32_t index = addr.get_index();
+					switch (addr.get_type()) {
+						case Address::_NULL:
+						case Address::THIS:
+							break;
+						case Address::STACK:
+							VERIFY(index < _stack_size, "stack address out of bounds");
+							break;
+						case Address::PARAMETER:
+							VERIFY(index < _is_reference.size(), "parameter address out of bounds");
+							break;
+						case Address::EXTERN:
+						case Address::NATIVE_CLASS:
+						case Address::STATIC_MEMBER:
+							VERIFY(index < names_count, "invalid name index");
+							break;
+						case Address::BUILTIN_FUNC:
+							VERIFY(index < BuiltinFunctions::_FUNC_MAX_, "invalid builtin function");
+							break;
+						case Address::BUILTIN_TYPE:
+							VERIFY(index < BuiltinTypes::_TYPE_MAX_, "invalid builtin type");
+							break;
+						case Address::MEMBER_VAR:
+							VERIFY(_owner->is_class() && !_is_static, "member address outside of a method");
+							VERIFY(index < (uint32_t)_owner->get_member_count(), "member address out of bounds");
+							break;
+						case Address::CONST_VALUE:
+							VERIFY(index < file->_global_const_values.size(), "constant address out of bounds");
+							break;
+						default:
+							VERIFY(false, "invalid address type");
+					}
+					MISSED_ENUM_CHECK(Address::CONST_VALUE, 10);
+				} break;
+
+				case IRInstruction::TARGET:
+					VERIFY(word <= _opcodes.size(), "jump target out of bounds");
+					targets[word] = ip;
+					break;
+			}
+		}
+		ip += instr.size();
+	}
+
+	for (auto& it : targets) {
+		ip = it.second;
+		VERIFY(starts[it.first], "jump target isn't an instruction");
+	}
+
+	// the traceback walks the inline sites to their parents.
+	for (auto& it : op_inline) {
+		ip = it.first;
+		VERIFY(it.second <= _inline_sites.size(), "invalid inline site");
+	}
+	for (uint32_t i = 0; i < (uint32_t)_inline_sites.size(); i++) {
+		ip = 0;
+		VERIFY(_inline_sites[i].parent <= i, "invalid parent of an inline site");
+	}
+	_verified = true;
+}
+
+#undef VERIFY
 
 
 var Function::__call(stdvec<var*>& p_args) {
@@ -176,5 +176,20 @@ CALL_OPERATOR(var, __sub);
 CALL_OPERATOR(var, __mul);
 CALL_OPERATOR(var, __div);
 
+bool Instance::call_operator_assign(var::Operator p_op, const var& p_other) {
+	ptr<Function> fn;
+	switch (p_op) {
+		case var::OP_ADDITION:       fn = blueprint->get_function(GlobalStrings::__add_eq); break;
+		case var::OP_SUBTRACTION:    fn = blueprint->get_function(GlobalStrings::__sub_eq); break;
+		case var::OP_MULTIPLICATION: fn = blueprint->get_function(GlobalStrings::__mul_eq); break;
+		case var::OP_DIVISION:       fn = blueprint->get_function(GlobalStrings::__div_eq); break;
+		default: break;
+	}
+	if (fn == nullptr) return false;
+	stdvec<var*> args = { const_cast<var*>(&p_other) };
+	VM::singleton()->call_function(fn.get(), blueprint.get(), shared_from_this(), args);
+	return true;
+}
+
 
 }
\ No newline at end of file
@@ -0,0 +1,2625 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/ir.h"
+#include "compiler/bytecode.h"
+#include "compiler/function.h"
+#include "compiler/globals.h"
+
+#include <algorithm>
+#include <set>
+
+/******************************************************************************************************************/
+/*                                         IR INSTRUCTION                                                         */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+uint32_t IRInstruction::get_size(const stdvec<uint32_t>& p_opcodes, uint32_t p_ip) {
+	THROW_INVALID_INDEX(p_opcodes.size(), p_ip);
+
+	// the argument count could be past the end of a truncated instruction.
+	auto count_at = [&](uint32_t p_offset) -> uint32_t {
+		if (p_ip + p_offset >= p_opcodes.size()) THROW_BUG(String::format("truncated instruction at %i", p_ip));
+		return p_opcodes[p_ip + p_offset];
+	};
+
+	switch ((Opcode)p_opcodes[p_ip]) {
+		case Opcode::GET:
+		case Opcode::SET:
+		case Opcode::GET_MAPPED:
+		case Opcode::GET_MAPPED_UNCHECKED:
+		case Opcode::SET_MAPPED:
+			return 4;
+		case Opcode::SET_TRUE:
+		case Opcode::SET_FALSE:
+		case Opcode::CLEAR:
+			return 2;
+		case Opcode::OPERATOR:
+		case Opcode::OPERATOR_INT:
+		case Opcode::OPERATOR_FLOAT:
+			return 5;
+		case Opcode::OPERATOR_ASSIGN:
+			return 4;
+		case Opcode::ASSIGN:
+		case Opcode::CHECK_TYPE:
+			return 3;
+		case Opcode::CONSTRUCT_BUILTIN:
+		case Opcode::CONSTRUCT_NATIVE:
+		case Opcode::CONSTRUCT_CARBON:
+		case Opcode::CALL_FUNC:
+		case Opcode::CALL_BUILTIN:
+		case Opcode::CALL_SUPER_METHOD:
+		case Opcode::CALL:
+			return 4 + count_at(2);
+		case Opcode::CONSTRUCT_LITERAL_ARRAY:
+			return 3 + count_at(1);
+		case Opcode::CONSTRUCT_LITERAL_MAP:
+			return 3 + 2 * count_at(1);
+		case Opcode::CONSTRUCT_LITERAL_CONST:
+			return 3;
+		case Opcode::CALL_INTRINSIC:
+			return 5;
+		case Opcode::CALL_DIRECT:
+		case Opcode::CALL_METHOD:
+			return 5 + count_at(3);
+		case Opcode::CALL_SUPER_CTOR:
+			return 2 + count_at(1);
+		case Opcode::JUMP:
+		case Opcode::JUMP_IF_DERIVED:
+		case Opcode::RETURN:
+			return 2;
+		case Opcode::JUMP_IF:
+		case Opcode::JUMP_IF_NOT:
+		case Opcode::ITER_BEGIN:
+			return 3;
+		case Opcode::ITER_NEXT:
+			return 4;
+		case Opcode::END:
+			return 1;
+	}
+	MISSED_ENUM_CHECK(Opcode::END, 35);
+	THROW_BUG(String::format("invalid opcode (%i) at %i", p_opcodes[p_ip], p_ip));
+}
+
+IRInstruction IRInstruction::decode(const stdvec<uint32_t>& p_opcodes, uint32_t p_ip) {
+	uint32_t size = get_size(p_opcodes, p_ip);
+	if (p_ip + size > p_opcodes.size()) THROW_BUG(String::format("truncated instruction at %i", p_ip));
+
+	IRInstruction instr;
+	instr.words = stdvec<uint32_t>(p_opcodes.begin() + p_ip, p_opcodes.begin() + p_ip + size);
+	instr.kinds = stdvec<OperandKind>(size, USE);
+	instr.kinds[0] = OPCODE;
+
+	stdvec<OperandKind>& k = instr.kinds;
+	switch (instr.get_opcode()) {
+		case Opcode::GET:               k[2] = NAME; k[3] = DEF; break;
+		case Opcode::SET:               k[2] = NAME; break;
+		case Opcode::GET_MAPPED:
+		case Opcode::GET_MAPPED_UNCHECKED: k[3] = DEF; break;
+		case Opcode::SET_MAPPED:        k[1] = USE_DEF; break; // "str"[0] = 'c';
+		case Opcode::SET_TRUE:
+		case Opcode::SET_FALSE:
+		case Opcode::CLEAR:             k[1] = DEF; break;
+		case Opcode::OPERATOR:
+		case Opcode::OPERATOR_INT:
+		case Opcode::OPERATOR_FLOAT:    k[1] = IMM; k[4] = DEF; break;
+		case Opcode::OPERATOR_ASSIGN:   k[1] = IMM; k[2] = USE_DEF; break;
+		case Opcode::ASSIGN:            k[1] = DEF; break;
+		case Opcode::CHECK_TYPE:        k[1] = IMM; k[2] = USE_DEF; break;
+
+		case Opcode::CONSTRUCT_BUILTIN:
+		case Opcode::CALL_BUILTIN:
+			k[1] = IMM; k[2] = IMM; k[size - 1] = DEF;
+			break;
+
+		case Opcode::CONSTRUCT_NATIVE:
+		case Opcode::CONSTRUCT_CARBON:
+		case Opcode::CALL_FUNC:
+		case Opcode::CALL_SUPER_METHOD:
+			k[1] = NAME; k[2] = IMM;
+			for (uint32_t i = 3; i < size - 1; i++) k[i] = USE_DEF;
+			k[size - 1] = DEF;
+			break;
+
+		case Opcode::CONSTRUCT_LITERAL_ARRAY:
+		case Opcode::CONSTRUCT_LITERAL_MAP:
+			k[1] = IMM; k[size - 1] = DEF;
+			break;
+
+		case Opcode::CONSTRUCT_LITERAL_CONST: k[2] = DEF; break;
+		case Opcode::CALL_INTRINSIC:          k[1] = IMM; k[4] = DEF; break;
+
+		case Opcode::CALL:
+			k[1] = USE_DEF; k[2] = IMM;
+			for (uint32_t i = 3; i < size - 1; i++) k[i] = USE_DEF;
+			k[size - 1] = DEF;
+			break;
+
+		case Opcode::CALL_METHOD:
+			k[1] = USE_DEF; k[2] = NAME; k[3] = IMM;
+			for (uint32_t i = 4; i < size - 1; i++) k[i] = USE_DEF;
+			k[size - 1] = DEF;
+			break;
+
+		case Opcode::CALL_DIRECT:
+			k[1] = IMM; k[2] = NAME; k[3] = IMM;
+			for (uint32_t i = 4; i < size - 1; i++) k[i] = USE_DEF;
+			k[size - 1] = DEF;
+			break;
+
+		case Opcode::CALL_SUPER_CTOR:
+			k[1] = IMM;
+			for (uint32_t i = 2; i < size; i++) k[i] = USE_DEF;
+			break;
+
+		case Opcode::JUMP:
+		case Opcode::JUMP_IF_DERIVED:   k[1] = TARGET; break;
+		case Opcode::JUMP_IF:
+		case Opcode::JUMP_IF_NOT:       k[2] = TARGET; break;
+		case Opcode::RETURN:            break;
+		case Opcode::ITER_BEGIN:        k[1] = DEF; k[2] = USE_DEF; break; // the iterator refers to the container's data.
+		case Opcode::ITER_NEXT:         k[1] = USE_DEF; k[2] = USE_DEF; k[3] = TARGET; break;
+		case Opcode::END:               break;
+	}
+	MISSED_ENUM_CHECK(Opcode::END, 35);
+	return instr;
+}
+
+int IRInstruction::get_target_word() const {
+	for (int i = 0; i < (int)kinds.size(); i++) {
+		if (kinds[i] == TARGET) return i;
+	}
+	return -1;
+}
+
+bool IRInstruction::is_terminator() const {
+	Opcode op = get_opcode();
+	return op == Opcode::JUMP || op == Opcode::RETURN || op == Opcode::END;
+}
+
+bool IRInstruction::is_branch() const {
+	return get_target_word() >= 0;
+}
+
+bool IRInstruction::is_pure() const {
+	switch (get_opcode()) {
+		case Opcode::ASSIGN: {
+			// reading a member, static or an extern could throw or have side effects.
+			Address::Type src = get_address(2).get_type();
+			return src == Address::_NULL || src == Address::STACK || src == Address::PARAMETER || src == Address::CONST_VALUE;
+		}
+		case Opcode::SET_TRUE:
+		case Opcode::SET_FALSE:
+		case Opcode::CONSTRUCT_LITERAL_ARRAY:
+		case Opcode::CONSTRUCT_LITERAL_CONST:
+		case Opcode::GET_MAPPED_UNCHECKED:
+			return true;
+		case Opcode::CLEAR: // writes a dead slot, removing it would keep the value alive.
+			return false;
+		default:
+			return false;
+	}
+}
+
+IRInstruction IRInstruction::make_assign(const Address& p_dst, const Address& p_src, uint32_t p_line) {
+	Opcodes opcodes;
+	opcodes.write_assign(p_dst, p_src);
+	IRInstruction instr = decode(opcodes.opcodes, 0);
+	instr.line = p_line;
+	return instr;
+}
+
+IRInstruction IRInstruction::make_jump(uint32_t p_target, uint32_t p_line) {
+	Opcodes opcodes;
+	opcodes.insert(Opcode::JUMP);
+	opcodes.insert(p_target);
+	IRInstruction instr = decode(opcodes.opcodes, 0);
+	instr.line = p_line;
+	return instr;
+}
+
+IRInstruction IRInstruction::make_guard(uint32_t p_target, uint32_t p_line) {
+	Opcodes opcodes;
+	opcodes.insert(Opcode::JUMP_IF_DERIVED);
+	opcodes.insert(p_target);
+	IRInstruction instr = decode(opcodes.opcodes, 0);
+	instr.line = p_line;
+	return instr;
+}
+
+IRInstruction IRInstruction::make_clear(const Address& p_dst, uint32_t p_line) {
+	Opcodes opcodes;
+	opcodes.write_clear(p_dst);
+	IRInstruction instr = decode(opcodes.opcodes, 0);
+	instr.line = p_line;
+	return instr;
+}
+
+IRInstruction IRInstruction::make_operator(const Address& p_dst, var::Operator p_op, const Address& p_left, const Address& p_right, uint32_t p_line) {
+	Opcodes opcodes;
+	opcodes.write_operator(p_dst, p_op, p_left, p_right);
+	IRInstruction instr = decode(opcodes.opcodes, 0);
+	instr.line = p_line;
+	return instr;
+}
+
+bool IRBlock::falls_through() const {
+	if (instructions.size() == 0) return true;
+	return !instructions.back().is_terminator();
+}
+
+const IRInstruction* IRBlock::get_terminator() const {
+	if (instructions.size() == 0) return nullptr;
+	const IRInstruction& last = instructions.back();
+	if (last.is_terminator() || last.is_branch()) return &last;
+	return nullptr;
+}
+
+}
+
+/******************************************************************************************************************/
+/*                                         IR FUNCTION                                                            */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+IRFunction IRFunction::build(const stdvec<uint32_t>& p_opcodes, const stdmap<uint32_t, uint32_t>& p_op_dbg, uint32_t p_stack_size,
+		const stdmap<uint32_t, uint32_t>* p_op_inline) {
+	IRFunction fn;
+	fn.stack_size = p_stack_size;
+
+	// decode and find the leaders.
+	stdvec<IRInstruction> instructions;
+	stdvec<uint32_t> starts;
+	stdvec<bool> leaders(p_opcodes.size() + 1, false);
+	leaders[0] = true;
+
+	uint32_t ip = 0;
+	while (ip < p_opcodes.size()) {
+		IRInstruction instr = IRInstruction::decode(p_opcodes, ip);
+
+		// the VM uses the first dbg entry at or after the instruction.
+		auto it = p_op_dbg.lower_bound(ip);
+		instr.line = (it != p_op_dbg.end()) ? it->second : 0;
+		if (p_op_inline != nullptr) {
+			auto site = p_op_inline->lower_bound(ip);
+			instr.site = (site != p_op_inline->end()) ? site->second : 0;
+		}
+
+		int target = instr.get_target_word();
+		if (target >= 0) {
+			if (instr.words[target] > p_opcodes.size()) THROW_BUG(String::format("invalid jump target at %i", ip));
+			leaders[instr.words[target]] = true;
+		}
+		starts.push_back(ip);
+		ip += instr.size();
+		if (instr.is_branch() || instr.is_terminator()) leaders[ip] = true;
+		instructions.push_back(instr);
+	}
+
+	// map leader ip -> block id. (a leader at the end is an empty block).
+	stdmap<uint32_t, uint32_t> block_of;
+	for (uint32_t leader = 0; leader < leaders.size(); leader++) {
+		if (!leaders[leader]) continue;
+		if (leader == p_opcodes.size() && leader != 0) {
+			bool targeted = false;
+			for (const IRInstruction& instr : instructions) {
+				int target = instr.get_target_word();
+				if (target >= 0 && instr.words[target] == leader) targeted = true;
+			}
+			if (!targeted) continue;
+		}
+		block_of[leader] = (uint32_t)fn.blocks.size();
+		IRBlock block;
+		block.id = (uint32_t)fn.blocks.size();
+		fn.blocks.push_back(block);
+	}
+
+	uint32_t curr = 0;
+	for (int i = 0; i < (int)instructions.size(); i++) {
+		auto it = block_of.find(starts[i]);
+		if (it != block_of.end()) curr = it->second;
+		IRInstruction& instr = instructions[i];
+		int target = instr.get_target_word();
+		if (target >= 0) instr.words[target] = block_of.at(instr.words[target]);
+		fn.blocks[curr].instructions.push_back(instr);
+	}
+
+	fn.update_cfg();
+	return fn;
+}
+
+IRFunction IRFunction::build(const Function* p_func) {
+	IRFunction fn = build(p_func->_opcodes, p_func->op_dbg, p_func->_stack_size, &p_func->op_inline);
+	fn.inline_sites = p_func->_inline_sites;
+	for (const IRBlock& block : fn.blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			if (instr.site > fn.inline_sites.size()) THROW_BUG(String::format("invalid inline site in function \"%s\"", p_func->_name.c_str()));
+		}
+	}
+
+	fn.name = p_func->_name;
+	if (p_func->_owner != nullptr && p_func->_owner->is_class()) fn.name = p_func->_owner->get_name() + "." + fn.name;
+	return fn;
+}
+
+void IRFunction::lower(Function* r_func) const {
+	lower(r_func->_opcodes, r_func->op_dbg, &r_func->op_inline);
+	r_func->_inline_sites = inline_sites;
+	r_func->_stack_size = stack_size;
+}
+
+void IRFunction::lower(stdvec<uint32_t>& r_opcodes, stdmap<uint32_t, uint32_t>& r_op_dbg, stdmap<uint32_t, uint32_t>* r_op_inline) const {
+	stdvec<uint32_t> block_start(blocks.size() + 1);
+	uint32_t pos = 0;
+	for (int i = 0; i < (int)blocks.size(); i++) {
+		block_start[i] = pos;
+		for (const IRInstruction& instr : blocks[i].instructions) pos += instr.size();
+	}
+	block_start[blocks.size()] = pos;
+
+	r_opcodes.clear();
+	r_op_dbg.clear();
+	if (r_op_inline != nullptr) r_op_inline->clear();
+
+	const IRInstruction* prev = nullptr;
+	uint32_t prev_pos = 0;
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+
+			// an entry is needed only at the last instruction of the same line (VM uses lower_bound).
+			if (prev != nullptr && prev->line != instr.line) r_op_dbg[prev_pos] = prev->line;
+			if (prev != nullptr && prev->site != instr.site && r_op_inline != nullptr) (*r_op_inline)[prev_pos] = prev->site;
+			prev = &instr;
+			prev_pos = (uint32_t)r_opcodes.size();
+
+			for (int i = 0; i < (int)instr.words.size(); i++) {
+				if (instr.kinds[i] == IRInstruction::TARGET) {
+					ASSERT(instr.words[i] <= blocks.size());
+					r_opcodes.push_back(block_start[instr.words[i]]);
+				} else {
+					r_opcodes.push_back(instr.words[i]);
+				}
+			}
+		}
+	}
+	if (prev != nullptr) r_op_dbg[prev_pos] = prev->line;
+	if (prev != nullptr && r_op_inline != nullptr && prev->site != 0) (*r_op_inline)[prev_pos] = prev->site;
+}
+
+void IRFunction::update_cfg() {
+	for (IRBlock& block : blocks) {
+		block.successors.clear();
+		block.predecessors.clear();
+	}
+
+	for (int i = 0; i < (int)blocks.size(); i++) {
+		IRBlock& block = blocks[i];
+		block.id = i;
+		auto add_edge = [&](uint32_t p_to) {
+			if (p_to >= blocks.size()) return; // jump to the end.
+			if (std::find(block.successors.begin(), block.successors.end(), p_to) != block.successors.end()) return;
+			block.successors.push_back(p_to);
+			blocks[p_to].predecessors.push_back(i);
+		};
+
+		const IRInstruction* term = block.get_terminator();
+		if (term != nullptr && term->is_branch()) add_edge(term->words[term->get_target_word()]);
+		if (block.falls_through()) add_edge(i + 1);
+	}
+}
+
+void IRFunction::erase_blocks(const stdvec<bool>& p_erase) {
+	ASSERT(p_erase.size() == blocks.size());
+
+	// an erased block's references are redirected to the next block which survives,
+	// both are the count of the surviving blocks before it.
+	stdvec<uint32_t> remap(blocks.size() + 1);
+	uint32_t id = 0;
+	for (int i = 0; i < (int)blocks.size(); i++) {
+		remap[i] = id;
+		if (!p_erase[i]) id++;
+	}
+	remap[blocks.size()] = id;
+
+	stdvec<IRBlock> surviving;
+	for (int i = 0; i < (int)blocks.size(); i++) {
+		if (p_erase[i]) continue;
+		surviving.push_back(blocks[i]);
+	}
+	for (IRBlock& block : surviving) {
+		for (IRInstruction& instr : block.instructions) {
+			int target = instr.get_target_word();
+			if (target >= 0) instr.words[target] = remap[instr.words[target]];
+		}
+	}
+	blocks = surviving;
+	update_cfg();
+}
+
+uint32_t IRFunction::get_opcode_count() const {
+	uint32_t count = 0;
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) count += instr.size();
+	}
+	return count;
+}
+
+uint32_t IRFunction::get_instruction_count() const {
+	uint32_t count = 0;
+	for (const IRBlock& block : blocks) count += (uint32_t)block.instructions.size();
+	return count;
+}
+
+bool IRFunction::has_opcode(Opcode p_opcode) const {
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() == p_opcode) return true;
+		}
+	}
+	return false;
+}
+
+bool IRFunction::has_address(Address::Type p_type) const {
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			for (int i = 1; i < (int)instr.size(); i++) {
+				if (instr.kinds[i] != IRInstruction::USE && instr.kinds[i] != IRInstruction::DEF && instr.kinds[i] != IRInstruction::USE_DEF) continue;
+				if (instr.get_address(i).get_type() == p_type) return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool IRFunction::is_name(uint32_t p_name, const String& p_str) const {
+	if (bytecode_file == nullptr) return false;
+	auto it = bytecode_file->_global_names.find(p_str);
+	return it != bytecode_file->_global_names.end() && it->second == p_name;
+}
+
+// operands of these types can't call out or be changed by another reference.
+static bool _is_primitive(var::Type p_type) {
+	return p_type == var::_NULL || p_type == var::BOOL || p_type == var::INT || p_type == var::FLOAT || p_type == var::STRING;
+}
+
+// an operator on these types (as the left operand) never calls the right operand, it's an error for
+// anything but a number.
+static bool _is_number(var::Type p_type) {
+	return p_type == var::_NULL || p_type == var::BOOL || p_type == var::INT || p_type == var::FLOAT;
+}
+
+static bool _is_container(var::Type p_type) {
+	return p_type == var::STRING || p_type == var::ARRAY || p_type == var::MAP;
+}
+
+static var::Type _operator_type(var::Operator p_op, var::Type p_left, var::Type p_right) {
+	bool numeric = (p_left == var::BOOL || p_left == var::INT || p_left == var::FLOAT) &&
+		(p_right == var::BOOL || p_right == var::INT || p_right == var::FLOAT);
+	var::Type number = (p_left == var::FLOAT || p_right == var::FLOAT) ? var::FLOAT : var::INT;
+
+	switch (p_op) {
+		case var::OP_ADDITION:
+			if (p_left == var::STRING && p_right == var::STRING) return var::STRING;
+			return (numeric) ? number : var::VAR;
+		case var::OP_SUBTRACTION:
+		case var::OP_MULTIPLICATION:
+		case var::OP_DIVISION:
+			return (numeric) ? number : var::VAR;
+		case var::OP_MODULO:
+			return (numeric && number == var::INT) ? var::INT : var::VAR;
+		case var::OP_POSITIVE:
+			return p_left;
+		case var::OP_NEGATIVE:
+			return (p_left == var::INT || p_left == var::FLOAT) ? p_left : var::VAR;
+		case var::OP_EQ_CHECK:
+		case var::OP_NOT_EQ_CHECK:
+		case var::OP_LT:
+		case var::OP_LTEQ:
+		case var::OP_GT:
+		case var::OP_GTEQ:
+		case var::OP_AND:
+		case var::OP_OR:
+		case var::OP_NOT:
+			return var::BOOL;
+		case var::OP_BIT_LSHIFT:
+		case var::OP_BIT_RSHIFT:
+		case var::OP_BIT_AND:
+		case var::OP_BIT_OR:
+		case var::OP_BIT_XOR:
+		case var::OP_BIT_NOT:
+			return var::INT;
+		default:
+			return var::VAR;
+	}
+}
+
+static var::Type _intrinsic_type(BuiltinFunctions::Type p_func, var::Type p_arg0, var::Type p_arg1) {
+	bool numeric0 = p_arg0 == var::INT || p_arg0 == var::FLOAT;
+	bool numeric1 = p_arg1 == var::INT || p_arg1 == var::FLOAT;
+	switch (p_func) {
+		case BuiltinFunctions::MATH_MIN:
+		case BuiltinFunctions::MATH_MAX:
+			return (p_arg0 == p_arg1 && numeric0) ? p_arg0 : var::VAR; // one of the arguments.
+		case BuiltinFunctions::MATH_POW:
+			return (numeric0 && numeric1) ? var::FLOAT : var::VAR;
+		case BuiltinFunctions::MATH_ABS:
+		case BuiltinFunctions::MATH_FLOOR:
+			return (numeric0) ? p_arg0 : var::VAR;
+		case BuiltinFunctions::MATH_SQRT:
+			return (numeric0) ? var::FLOAT : var::VAR;
+		case BuiltinFunctions::LEN:
+			return (_is_container(p_arg0)) ? var::INT : var::VAR;
+		default:
+			return var::VAR;
+	}
+}
+
+// `a.size()`, it doesn't change the receiver even if it's an instance.
+static bool _is_size_call(const IRFunction& p_function, const IRInstruction& p_instr) {
+	return p_instr.get_opcode() == Opcode::CALL_METHOD && p_instr.words[3] == 0 && p_function.is_name(p_instr.words[2], "size");
+}
+
+// the operators dispatched on the type of the left operand (see var's operators).
+static bool _is_left_dispatched(var::Operator p_op) {
+	switch (p_op) {
+		case var::OP_ADDITION:
+		case var::OP_SUBTRACTION:
+		case var::OP_MULTIPLICATION:
+		case var::OP_DIVISION:
+		case var::OP_EQ_CHECK:
+		case var::OP_NOT_EQ_CHECK:
+		case var::OP_LT:
+		case var::OP_LTEQ:
+		case var::OP_GT:
+		case var::OP_GTEQ:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static bool _is_number_operand(const IRFunction& p_function, const Address& p_addr, const stdvec<var::Type>& p_types, const stdvec<bool>* p_numbers) {
+	if (_is_number(p_function.get_type(p_addr, p_types))) return true;
+	if (p_numbers == nullptr || p_addr.get_type() != Address::STACK || p_addr.get_index() >= p_numbers->size()) return false;
+	return (*p_numbers)[p_addr.get_index()];
+}
+
+// an argument of a String, Array or Map method, the native methods of them never write their arguments.
+static bool _is_container_method_arg(const IRFunction& p_function, const IRInstruction& p_instr, int p_word, const stdvec<var::Type>& p_types) {
+	if (p_instr.get_opcode() != Opcode::CALL_METHOD || p_word < 4 || p_word >= (int)p_instr.size() - 1) return false;
+	return _is_container(p_function.get_type(p_instr.get_address(1), p_types));
+}
+
+// the word p_word is written, `arr[i] = v` changes the elements of the array not the slot.
+static bool _is_write(const IRFunction& p_function, const IRInstruction& p_instr, int p_word, const stdvec<var::Type>& p_types) {
+	if (p_instr.kinds[p_word] == IRInstruction::DEF) return true;
+	if (p_instr.kinds[p_word] != IRInstruction::USE_DEF) return false;
+	if (p_word == 1 && _is_size_call(p_function, p_instr)) return false;
+	if (p_word == 1 && p_instr.get_opcode() == Opcode::SET_MAPPED && p_function.get_type(p_instr.get_address(1), p_types) == var::ARRAY) return false;
+	if (_is_container_method_arg(p_function, p_instr, p_word, p_types)) return false;
+	return true;
+}
+
+var::Type IRFunction::get_type(const Address& p_addr, const stdvec<var::Type>& p_types) const {
+	switch (p_addr.get_type()) {
+		case Address::_NULL:
+			return var::_NULL;
+		case Address::STACK:
+			return (p_addr.get_index() < p_types.size()) ? p_types[p_addr.get_index()] : var::VAR;
+		case Address::PARAMETER:
+			return (p_addr.get_index() < param_types.size()) ? param_types[p_addr.get_index()] : var::VAR;
+		case Address::CONST_VALUE:
+			if (bytecode_file == nullptr) return var::VAR;
+			return bytecode_file->get_global_const_value(p_addr.get_index())->get_type();
+		default:
+			return var::VAR;
+	}
+}
+
+void IRFunction::generalize_operators() {
+	// the passes know about OPERATOR, the typed ones are selected again after them.
+	for (IRBlock& block : blocks) {
+		for (IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() == Opcode::OPERATOR_INT || instr.get_opcode() == Opcode::OPERATOR_FLOAT) instr.words[0] = Opcode::OPERATOR;
+		}
+	}
+}
+
+void IRFunction::set_param_types(const stdvec<var::Type>& p_types) {
+	param_types = p_types;
+
+	// a parameter written in the function (or through a reference) could be of any type after it.
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() == Opcode::CHECK_TYPE) continue;
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (instr.kinds[w] != IRInstruction::DEF && instr.kinds[w] != IRInstruction::USE_DEF) continue;
+				// a method's receiver and an indexed value keeps it's type (see update_types).
+				if (w == 1 && (instr.get_opcode() == Opcode::CALL_METHOD || instr.get_opcode() == Opcode::SET_MAPPED)) continue;
+				Address addr = instr.get_address(w);
+				if (addr.get_type() == Address::PARAMETER && addr.get_index() < param_types.size()) param_types[addr.get_index()] = var::VAR;
+			}
+		}
+	}
+}
+
+void IRFunction::update_types(const IRInstruction& p_instr, stdvec<var::Type>& r_types) const {
+	auto type_of = [&](int p_word) { return get_type(p_instr.get_address(p_word), r_types); };
+
+	var::Type result = var::VAR;
+	Opcode op = p_instr.get_opcode();
+	switch (op) {
+		case Opcode::ASSIGN:                  result = type_of(2); break;
+		case Opcode::SET_TRUE:
+		case Opcode::SET_FALSE:               result = var::BOOL; break;
+		case Opcode::CLEAR:                   result = var::_NULL; break;
+		case Opcode::CONSTRUCT_BUILTIN:       result = BuiltinTypes::get_var_type((BuiltinTypes::Type)p_instr.words[1]); break;
+		case Opcode::CONSTRUCT_LITERAL_ARRAY: result = var::ARRAY; break;
+		case Opcode::CONSTRUCT_LITERAL_MAP:   result = var::MAP; break;
+		case Opcode::CONSTRUCT_LITERAL_CONST: result = type_of(1); break;
+		case Opcode::OPERATOR:
+		case Opcode::OPERATOR_INT:
+		case Opcode::OPERATOR_FLOAT:
+		case Opcode::OPERATOR_ASSIGN:         result = _operator_type((var::Operator)p_instr.words[1], type_of(2), type_of(3)); break;
+		case Opcode::CHECK_TYPE:              result = (var::Type)p_instr.words[1]; break;
+		case Opcode::GET_MAPPED:              if (type_of(1) == var::STRING) result = var::STRING; break;
+		case Opcode::CALL_METHOD:             if (_is_size_call(*this, p_instr) && _is_container(type_of(1))) result = var::INT; break;
+		case Opcode::CALL_INTRINSIC:          result = _intrinsic_type((BuiltinFunctions::Type)p_instr.words[1], type_of(2), type_of(3)); break;
+		case Opcode::CALL_DIRECT:             if (p_instr.words[1] < call_types.size()) result = call_types[p_instr.words[1]]; break;
+		default: break;
+	}
+
+	for (int w = 1; w < (int)p_instr.size(); w++) {
+		Address addr = p_instr.get_address(w);
+		if (addr.get_type() != Address::STACK || addr.get_index() >= r_types.size()) continue;
+		if (p_instr.kinds[w] == IRInstruction::USE_DEF) {
+			// a method's receiver and an indexed value keeps it's type, arguments could be a reference.
+			if (w == 1 && (op == Opcode::CALL_METHOD || op == Opcode::SET_MAPPED)) continue;
+			if (_is_container_method_arg(*this, p_instr, w, r_types)) continue;
+			r_types[addr.get_index()] = (op == Opcode::OPERATOR_ASSIGN || op == Opcode::CHECK_TYPE) ? result : var::VAR;
+		} else if (p_instr.kinds[w] == IRInstruction::DEF) {
+			r_types[addr.get_index()] = result;
+		}
+	}
+}
+
+stdvec<stdvec<var::Type>> IRFunction::infer_types() const {
+	stdvec<stdvec<var::Type>> types_in(blocks.size(), stdvec<var::Type>(stack_size, var::VAR));
+	if (blocks.size() == 0) return types_in;
+
+	// the stack starts with null values, a slot with different types on two paths is var::VAR.
+	stdvec<bool> visited(blocks.size(), false);
+	types_in[0] = stdvec<var::Type>(stack_size, var::_NULL);
+	visited[0] = true;
+
+	bool updated = true;
+	while (updated) {
+		updated = false;
+		for (const IRBlock& block : blocks) {
+			if (!visited[block.id]) continue;
+			stdvec<var::Type> types = types_in[block.id];
+			for (const IRInstruction& instr : block.instructions) update_types(instr, types);
+
+			for (uint32_t succ : block.successors) {
+				if (!visited[succ]) {
+					visited[succ] = true;
+					types_in[succ] = types;
+					updated = true;
+					continue;
+				}
+				for (uint32_t s = 0; s < stack_size; s++) {
+					if (types_in[succ][s] != types[s] && types_in[succ][s] != var::VAR) {
+						types_in[succ][s] = var::VAR;
+						updated = true;
+					}
+				}
+			}
+		}
+	}
+	return types_in;
+}
+
+var::Type IRFunction::get_return_type() const {
+	stdvec<stdvec<var::Type>> types_in = infer_types();
+
+	bool any = false;
+	var::Type ret = var::VAR;
+	for (const IRBlock& block : blocks) {
+		// the last block could be unreachable, the others are removed by the passes.
+		if (block.id != 0 && block.predecessors.size() == 0) continue;
+
+		stdvec<var::Type> types = types_in[block.id];
+		for (const IRInstruction& instr : block.instructions) {
+			var::Type type;
+			if (instr.get_opcode() == Opcode::RETURN) type = get_type(instr.get_address(1), types);
+			else if (instr.get_opcode() == Opcode::END) type = var::_NULL;
+			else {
+				update_types(instr, types);
+				continue;
+			}
+			if (any && type != ret) return var::VAR;
+			ret = type;
+			any = true;
+		}
+	}
+	return ret;
+}
+
+void IRFunction::update_numbers(const IRInstruction& p_instr, const stdvec<var::Type>& p_types, stdvec<bool>& r_numbers) const {
+	auto is_number = [&](int p_word) { return _is_number_operand(*this, p_instr.get_address(p_word), p_types, &r_numbers); };
+
+	// (*) of a number with a String or an Array repeats it.
+	bool number = false;
+	Opcode op = p_instr.get_opcode();
+	if (op == Opcode::ASSIGN) {
+		number = is_number(2);
+	} else if (op == Opcode::OPERATOR || op == Opcode::OPERATOR_ASSIGN) {
+		var::Operator oper = (var::Operator)p_instr.words[1];
+		number = _is_left_dispatched(oper) && is_number(2) && (oper != var::OP_MULTIPLICATION || is_number(3));
+	}
+
+	stdvec<var::Type> after = p_types;
+	update_types(p_instr, after);
+	for (int w = 1; w < (int)p_instr.size(); w++) {
+		Address addr = p_instr.get_address(w);
+		if (p_instr.kinds[w] != IRInstruction::DEF && p_instr.kinds[w] != IRInstruction::USE_DEF) continue;
+		if (addr.get_type() != Address::STACK || addr.get_index() >= r_numbers.size()) continue;
+		if (w == 1 && (op == Opcode::CALL_METHOD || op == Opcode::SET_MAPPED)) continue; // the receiver keeps it's type.
+		if (_is_container_method_arg(*this, p_instr, w, p_types)) continue;
+		r_numbers[addr.get_index()] = number || _is_number(after[addr.get_index()]);
+	}
+}
+
+stdvec<stdvec<bool>> IRFunction::infer_numbers(const stdvec<stdvec<var::Type>>& p_types_in) const {
+	stdvec<stdvec<bool>> numbers_in(blocks.size(), stdvec<bool>(stack_size, false));
+	if (blocks.size() == 0) return numbers_in;
+
+	// the stack starts with null values, a slot is a number at the entry of a block if it's on every path.
+	stdvec<bool> visited(blocks.size(), false);
+	numbers_in[0] = stdvec<bool>(stack_size, true);
+	visited[0] = true;
+
+	bool updated = true;
+	while (updated) {
+		updated = false;
+		for (const IRBlock& block : blocks) {
+			if (!visited[block.id]) continue;
+			stdvec<var::Type> types = p_types_in[block.id];
+			stdvec<bool> numbers = numbers_in[block.id];
+			for (const IRInstruction& instr : block.instructions) {
+				update_numbers(instr, types, numbers);
+				update_types(instr, types);
+			}
+
+			for (uint32_t succ : block.successors) {
+				if (!visited[succ]) {
+					visited[succ] = true;
+					numbers_in[succ] = numbers;
+					updated = true;
+					continue;
+				}
+				for (uint32_t s = 0; s < stack_size; s++) {
+					if (numbers_in[succ][s] && !numbers[s]) {
+						numbers_in[succ][s] = false;
+						updated = true;
+					}
+				}
+			}
+		}
+	}
+	return numbers_in;
+}
+
+bool IRFunction::may_call_out(const IRInstruction& p_instr, const stdvec<var::Type>& p_types, const stdvec<bool>* p_numbers) const {
+	auto type_of = [&](int p_word) { return get_type(p_instr.get_address(p_word), p_types); };
+	auto primitive_args = [&](int p_begin, int p_end) -> bool {
+		for (int w = p_begin; w < p_end; w++) if (!_is_primitive(type_of(w))) return false;
+		return true;
+	};
+
+	switch (p_instr.get_opcode()) {
+		case Opcode::ASSIGN: {
+			// static members and externs could be initialized on their first access.
+			for (int w = 1; w <= 2; w++) {
+				switch (p_instr.get_address(w).get_type()) {
+					case Address::_NULL:
+					case Address::STACK:
+					case Address::PARAMETER:
+					case Address::THIS:
+					case Address::MEMBER_VAR:
+					case Address::CONST_VALUE:
+						break;
+					default:
+						return true;
+				}
+			}
+			return false;
+		}
+
+		case Opcode::SET_TRUE:
+		case Opcode::SET_FALSE:
+		case Opcode::CLEAR:
+		case Opcode::GET_MAPPED_UNCHECKED:
+		case Opcode::CONSTRUCT_LITERAL_ARRAY:
+		case Opcode::CONSTRUCT_LITERAL_CONST:
+		case Opcode::JUMP:
+		case Opcode::JUMP_IF:
+		case Opcode::JUMP_IF_NOT:
+		case Opcode::JUMP_IF_DERIVED:
+		case Opcode::RETURN:
+		case Opcode::END:
+			return false;
+
+		case Opcode::OPERATOR:
+		case Opcode::OPERATOR_INT:
+		case Opcode::OPERATOR_FLOAT:
+		case Opcode::OPERATOR_ASSIGN:
+			if (_is_left_dispatched((var::Operator)p_instr.words[1]) && _is_number_operand(*this, p_instr.get_address(2), p_types, p_numbers)) return false;
+			return !_is_primitive(type_of(2)) || !_is_primitive(type_of(3));
+
+		case Opcode::CHECK_TYPE:
+			return false;
+
+		case Opcode::GET_MAPPED:
+			return !_is_container(type_of(1)) || !_is_primitive(type_of(2));
+
+		case Opcode::SET_MAPPED: // a new key could be added to a map.
+			return !(type_of(1) == var::ARRAY || type_of(1) == var::STRING) || !_is_primitive(type_of(2));
+
+		case Opcode::CALL_METHOD:
+			return !_is_size_call(*this, p_instr) || !_is_container(type_of(1));
+
+		case Opcode::CONSTRUCT_BUILTIN:
+		case Opcode::CALL_BUILTIN:
+			return !primitive_args(3, (int)p_instr.size() - 1);
+
+		case Opcode::CALL_INTRINSIC: // len() doesn't call anything on a container.
+			if ((BuiltinFunctions::Type)p_instr.words[1] == BuiltinFunctions::LEN) return !_is_container(type_of(2));
+			return !primitive_args(2, 4);
+
+		case Opcode::CONSTRUCT_LITERAL_MAP: { // keys are hashed.
+			for (int w = 2; w < (int)p_instr.size() - 1; w += 2) {
+				if (!_is_primitive(type_of(w))) return true;
+			}
+			return false;
+		}
+
+		default:
+			return true;
+	}
+}
+
+void IRFunction::update_live(const IRInstruction& p_instr, stdvec<bool>& r_live) const {
+	for (int w = 1; w < (int)p_instr.size(); w++) {
+		Address addr = p_instr.get_address(w);
+		if (p_instr.kinds[w] == IRInstruction::DEF && addr.get_type() == Address::STACK && addr.get_index() < stack_size) r_live[addr.get_index()] = false;
+	}
+	for (int w = 1; w < (int)p_instr.size(); w++) {
+		Address addr = p_instr.get_address(w);
+		if (addr.get_type() != Address::STACK || addr.get_index() >= stack_size) continue;
+		if (p_instr.kinds[w] == IRInstruction::USE || p_instr.kinds[w] == IRInstruction::USE_DEF) r_live[addr.get_index()] = true;
+	}
+}
+
+stdvec<bool> IRFunction::get_live_out(uint32_t p_block, const stdvec<stdvec<bool>>& p_live_in) const {
+	stdvec<bool> live(stack_size, false);
+	for (uint32_t succ : blocks[p_block].successors) {
+		for (uint32_t s = 0; s < stack_size; s++) live[s] = live[s] || p_live_in[succ][s];
+	}
+	return live;
+}
+
+stdvec<stdvec<bool>> IRFunction::get_live_in() const {
+	// iterated backward till the fixed point.
+	stdvec<stdvec<bool>> live_in(blocks.size(), stdvec<bool>(stack_size, false));
+	bool updated = true;
+	while (updated) {
+		updated = false;
+		for (int i = (int)blocks.size() - 1; i >= 0; i--) {
+			stdvec<bool> live = get_live_out(i, live_in);
+			for (int j = (int)blocks[i].instructions.size() - 1; j >= 0; j--) update_live(blocks[i].instructions[j], live);
+			if (live != live_in[i]) {
+				live_in[i] = live;
+				updated = true;
+			}
+		}
+	}
+	return live_in;
+}
+
+stdvec<stdvec<bool>> IRFunction::get_dominators() const {
+	stdvec<stdvec<bool>> dom(blocks.size(), stdvec<bool>(blocks.size(), true));
+	if (blocks.size() == 0) return dom;
+	dom[0] = stdvec<bool>(blocks.size(), false);
+	dom[0][0] = true;
+
+	bool updated = true;
+	while (updated) {
+		updated = false;
+		for (uint32_t b = 1; b < blocks.size(); b++) {
+			stdvec<bool> d(blocks.size(), blocks[b].predecessors.size() > 0);
+			for (uint32_t pred : blocks[b].predecessors) {
+				for (uint32_t i = 0; i < blocks.size(); i++) d[i] = d[i] && dom[pred][i];
+			}
+			d[b] = true;
+			if (d != dom[b]) {
+				dom[b] = d;
+				updated = true;
+			}
+		}
+	}
+	return dom;
+}
+
+stdvec<IRLoop> IRFunction::find_loops() const {
+	stdvec<stdvec<bool>> dom = get_dominators();
+	stdvec<IRLoop> loops;
+
+	for (const IRBlock& block : blocks) {
+		for (uint32_t succ : block.successors) {
+			if (!dom[block.id][succ]) continue; // not a back edge.
+
+			IRLoop* loop = nullptr;
+			for (IRLoop& l : loops) if (l.header == succ) loop = &l;
+			if (loop == nullptr) {
+				loops.push_back(IRLoop());
+				loop = &loops.back();
+				loop->header = succ;
+				loop->blocks = stdvec<bool>(blocks.size(), false);
+				loop->blocks[succ] = true;
+			}
+
+			// every block reaching the back edge without going through the header.
+			stdvec<uint32_t> stack = { block.id };
+			while (stack.size() > 0) {
+				uint32_t id = stack.back(); stack.pop_back();
+				if (loop->blocks[id]) continue;
+				loop->blocks[id] = true;
+				for (uint32_t pred : blocks[id].predecessors) stack.push_back(pred);
+			}
+		}
+	}
+	return loops;
+}
+
+int IRFunction::add_preheader(const IRLoop& p_loop) {
+	const uint32_t header = p_loop.header;
+	if (header == 0) return -1; // the entry has no block before it.
+
+	stdvec<uint32_t> entries;
+	for (uint32_t pred : blocks[header].predecessors) {
+		if (!p_loop.blocks[pred]) entries.push_back(pred);
+	}
+	if (entries.size() == 0) return -1;
+
+	// an entry which goes nowhere else.
+	if (entries.size() == 1 && blocks[entries[0]].successors.size() == 1) {
+		const IRInstruction* term = blocks[entries[0]].get_terminator();
+		if (term == nullptr || term->get_opcode() == Opcode::JUMP) return (int)entries[0];
+	}
+
+	// the block before the header would fall through to the preheader.
+	if (p_loop.blocks[header - 1] && blocks[header - 1].falls_through()) return -1;
+
+	for (IRBlock& block : blocks) {
+		for (IRInstruction& instr : block.instructions) {
+			int target = instr.get_target_word();
+			if (target < 0) continue;
+			uint32_t& to = instr.words[target];
+			if (to > header || (to == header && p_loop.blocks[block.id])) to++;
+		}
+	}
+	blocks.insert(blocks.begin() + header, IRBlock());
+	update_cfg();
+	return (int)header;
+}
+
+uint32_t IRFunction::inline_call(uint32_t p_block, uint32_t p_index, const IRFunction& p_callee, const stdvec<Address>& p_args, bool p_guarded,
+		const stdvec<Address>* p_members) {
+	ASSERT(p_block < blocks.size() && p_index < blocks[p_block].instructions.size());
+
+	const IRInstruction call = blocks[p_block].instructions[p_index];
+	const uint32_t line = call.line;
+	const Address dst = call.get_address(call.size() - 1);
+	ASSERT(call.kinds[call.size() - 1] == IRInstruction::DEF);
+
+	// parameters and then the callee's stack are allocated after this stack.
+	const uint32_t param_base = stack_size;
+	const uint32_t stack_base = stack_size + (uint32_t)p_args.size();
+	stack_size = stack_base + p_callee.stack_size;
+
+	// the callee's body is tagged with a new site, the sites already expanded in it are nested in the new one.
+	const uint32_t site = (uint32_t)inline_sites.size() + 1;
+	InlineSite call_site;
+	call_site.name = p_callee.name;
+	call_site.line = line;
+	call_site.parent = call.site;
+	inline_sites.push_back(call_site);
+	for (InlineSite callee_site : p_callee.inline_sites) {
+		callee_site.parent = (callee_site.parent == 0) ? site : site + callee_site.parent;
+		inline_sites.push_back(callee_site);
+	}
+
+	// new layout: pre, [setup], callee blocks..., [slow call], post.
+	const uint32_t callee_base = p_block + 1 + (p_guarded ? 1 : 0);
+	const uint32_t slow_id = callee_base + (uint32_t)p_callee.blocks.size();
+	const uint32_t post_id = slow_id + (p_guarded ? 1 : 0);
+	const uint32_t shift = post_id - p_block;
+
+	// shift the targets after the call block.
+	for (IRBlock& block : blocks) {
+		for (IRInstruction& instr : block.instructions) {
+			int target = instr.get_target_word();
+			if (target >= 0 && instr.words[target] > p_block) instr.words[target] += shift;
+		}
+	}
+
+	IRBlock& original = blocks[p_block];
+	IRBlock post;
+	post.instructions.assign(original.instructions.begin() + p_index + 1, original.instructions.end());
+	original.instructions.erase(original.instructions.begin() + p_index, original.instructions.end());
+
+	stdvec<IRInstruction> setup;
+	for (int i = 0; i < (int)p_args.size(); i++) {
+		setup.push_back(IRInstruction::make_assign(Address(Address::STACK, param_base + i), p_args[i], line));
+	}
+	// the stack of a call starts with null values (a local could be declared without a value).
+	for (uint32_t i = 0; i < p_callee.stack_size; i++) {
+		setup.push_back(IRInstruction::make_assign(Address(Address::STACK, stack_base + i), Address(), line));
+	}
+	for (IRInstruction& instr : setup) instr.site = call.site;
+
+	stdvec<IRBlock> inserted;
+	if (p_guarded) {
+		original.instructions.push_back(IRInstruction::make_guard(slow_id, line));
+		original.instructions.back().site = call.site;
+		IRBlock setup_block;
+		setup_block.instructions = setup;
+		inserted.push_back(setup_block);
+	} else {
+		original.instructions.insert(original.instructions.end(), setup.begin(), setup.end());
+	}
+
+	for (const IRBlock& callee_block : p_callee.blocks) {
+		IRBlock block;
+		for (const IRInstruction& callee_instr : callee_block.instructions) {
+			IRInstruction instr = callee_instr;
+			instr.site = (instr.site == 0) ? site : site + instr.site;
+			for (int i = 1; i < (int)instr.size(); i++) {
+				switch (instr.kinds[i]) {
+					case IRInstruction::USE:
+					case IRInstruction::DEF:
+					case IRInstruction::USE_DEF: {
+						Address addr = instr.get_address(i);
+						if (addr.get_type() == Address::STACK) instr.set_address(i, Address(Address::STACK, stack_base + addr.get_index()));
+						else if (addr.get_type() == Address::PARAMETER) instr.set_address(i, Address(Address::STACK, param_base + addr.get_index()));
+						else if (addr.get_type() == Address::MEMBER_VAR && p_members != nullptr) {
+							ASSERT(addr.get_index() < p_members->size());
+							instr.set_address(i, (*p_members)[addr.get_index()]);
+						}
+					} break;
+					case IRInstruction::TARGET:
+						ASSERT(instr.words[i] < p_callee.blocks.size());
+						instr.words[i] += callee_base;
+						break;
+					default:
+						break;
+				}
+			}
+
+			// return value is assigned to the call's destination.
+			if (instr.get_opcode() == Opcode::RETURN || instr.get_opcode() == Opcode::END) {
+				Address value = (instr.get_opcode() == Opcode::RETURN) ? instr.get_address(1) : Address();
+				IRInstruction assign = IRInstruction::make_assign(dst, value, instr.line);
+				IRInstruction jump = IRInstruction::make_jump(post_id, instr.line);
+				assign.site = jump.site = instr.site;
+				block.instructions.push_back(assign);
+				block.instructions.push_back(jump);
+				break;
+			}
+			block.instructions.push_back(instr);
+		}
+		inserted.push_back(block);
+	}
+
+	if (p_guarded) {
+		IRBlock slow;
+		slow.instructions.push_back(call);
+		inserted.push_back(slow);
+	}
+	inserted.push_back(post);
+
+	blocks.insert(blocks.begin() + p_block + 1, inserted.begin(), inserted.end());
+	update_cfg();
+	return post_id;
+}
+
+String IRFunction::to_string() const {
+	const stdvec<String>* names = nullptr;
+	const stdvec<var>* consts = nullptr;
+	if (bytecode_file != nullptr) {
+		if (bytecode_file->_global_names_array.size() == bytecode_file->_global_names.size()) names = &bytecode_file->_global_names_array;
+		consts = &bytecode_file->_global_const_values;
+	}
+
+	std::stringstream ss;
+	ss << "func " << name << " (stack size: " << stack_size << ", opcodes: " << get_opcode_count() << ")\n";
+	for (const IRBlock& block : blocks) {
+		ss << "  B" << block.id << ":";
+		if (block.predecessors.size() > 0) {
+			ss << "  ; preds:";
+			for (uint32_t pred : block.predecessors) ss << " B" << pred;
+		}
+		ss << "\n";
+
+		for (const IRInstruction& instr : block.instructions) {
+			ss << "    " << Opcodes::get_opcode_name(instr.get_opcode()).c_str();
+			for (int i = 1; i < (int)instr.words.size(); i++) {
+				ss << ((i == 1) ? " " : ", ");
+				uint32_t word = instr.words[i];
+				switch (instr.kinds[i]) {
+					case IRInstruction::OPCODE:
+						break;
+					case IRInstruction::IMM:
+						if (instr.get_opcode() == Opcode::OPERATOR || instr.get_opcode() == Opcode::OPERATOR_INT || instr.get_opcode() == Opcode::OPERATOR_FLOAT ||
+							instr.get_opcode() == Opcode::OPERATOR_ASSIGN) ss << var::get_op_name_s((var::Operator)word).c_str();
+						else if (instr.get_opcode() == Opcode::CHECK_TYPE) ss << var::get_type_name_s((var::Type)word);
+						else if (i == 1 && (instr.get_opcode() == Opcode::CALL_BUILTIN || instr.get_opcode() == Opcode::CALL_INTRINSIC)) ss << BuiltinFunctions::get_func_name((BuiltinFunctions::Type)word).c_str();
+						else if (i == 1 && instr.get_opcode() == Opcode::CONSTRUCT_BUILTIN) ss << BuiltinTypes::get_type_name((BuiltinTypes::Type)word).c_str();
+						else ss << word;
+						break;
+					case IRInstruction::NAME:
+						if (names != nullptr && word < names->size()) ss << "\"" << (*names)[word].c_str() << "\"";
+						else ss << "name(" << word << ")";
+						break;
+					case IRInstruction::USE:
+					case IRInstruction::DEF:
+					case IRInstruction::USE_DEF:
+						ss << instr.get_address(i).as_string(names, consts).c_str();
+						break;
+					case IRInstruction::TARGET:
+						ss << "B" << word;
+						break;
+				}
+			}
+			ss << "  ; line " << instr.line;
+			if (instr.site != 0 && instr.site <= inline_sites.size()) ss << " (" << inline_sites[instr.site - 1].name.c_str() << ")";
+			ss << "\n";
+		}
+	}
+	return ss.str();
+}
+
+String IRFunction::dump_bytecode(Bytecode* p_bytecode) {
+	Bytecode* file = (p_bytecode->is_class()) ? p_bytecode->get_file().get() : p_bytecode;
+
+	String dump;
+	auto dump_function = [&](const Function* p_func, const String& p_name) {
+		if (p_func == nullptr) return;
+		IRFunction ir = build(p_func);
+		ir.name = p_name;
+		ir.bytecode_file = file;
+		dump += ir.to_string() + "\n";
+	};
+
+	String prefix = (p_bytecode->is_class()) ? p_bytecode->get_name() + "." : "";
+	dump_function(p_bytecode->get_static_initializer(), prefix + "@static_initializer");
+	if (p_bytecode->is_class()) dump_function(p_bytecode->get_member_initializer(), prefix + "@member_initializer");
+	for (auto& it : p_bytecode->get_functions()) {
+		dump_function(it.second.get(), prefix + it.first);
+	}
+
+	if (!p_bytecode->is_class()) {
+		for (auto& it : p_bytecode->get_classes()) {
+			dump += dump_bytecode(it.second.get());
+		}
+	}
+	return dump;
+}
+
+}
+
+/******************************************************************************************************************/
+/*                                         PASSES                                                                 */
+/******************************************************************************************************************/
+
+namespace carbon {
+
+void IRPassManager::add_pass(ptr<IRPass> p_pass) {
+	_passes.push_back(p_pass);
+}
+
+void IRPassManager::add_final_pass(ptr<IRPass> p_pass) {
+	_final_passes.push_back(p_pass);
+}
+
+void IRPassManager::run(IRFunction& p_function) const {
+	for (int i = 0; i < MAX_ITERATIONS; i++) {
+		bool changed = false;
+		for (const ptr<IRPass>& pass : _passes) {
+			p_function.update_cfg();
+			changed = pass->run(p_function) || changed;
+		}
+		if (!changed) break;
+	}
+	for (const ptr<IRPass>& pass : _final_passes) {
+		p_function.update_cfg();
+		pass->run(p_function);
+	}
+	p_function.update_cfg();
+}
+
+bool IRSimplifyCFGPass::run(IRFunction& p_function) {
+	bool changed = false;
+	stdvec<IRBlock>& blocks = p_function.blocks;
+
+	// returns the final target if the target block has nothing but a jump.
+	auto thread = [&](uint32_t p_target) -> uint32_t {
+		for (int i = 0; i < (int)blocks.size() && p_target < blocks.size(); i++) {
+			const IRBlock& target = blocks[p_target];
+			if (target.instructions.size() != 1 || target.instructions[0].get_opcode() != Opcode::JUMP) break;
+			uint32_t next = target.instructions[0].words[1];
+			if (next == p_target) break;
+			p_target = next;
+		}
+		return p_target;
+	};
+
+	for (IRBlock& block : blocks) {
+		for (IRInstruction& instr : block.instructions) {
+			int target = instr.get_target_word();
+			if (target < 0) continue;
+			uint32_t threaded = thread(instr.words[target]);
+			if (threaded != instr.words[target]) {
+				instr.words[target] = threaded;
+				changed = true;
+			}
+		}
+
+		// a jump to the next block is a fall through.
+		if (block.instructions.size() > 0) {
+			const IRInstruction& last = block.instructions.back();
+			if (last.get_opcode() == Opcode::JUMP && last.words[1] == block.id + 1) {
+				block.instructions.pop_back();
+				changed = true;
+			}
+		}
+	}
+
+	// a block only entered by falling through from the previous one is a part of it.
+	p_function.update_cfg();
+	for (int i = (int)blocks.size() - 1; i > 0; i--) {
+		IRBlock& prev = blocks[i - 1];
+		if (blocks[i].predecessors.size() != 1 || blocks[i].predecessors[0] != (uint32_t)i - 1) continue;
+		if (prev.get_terminator() != nullptr || prev.successors.size() != 1) continue;
+		if (blocks[i].instructions.size() == 0) continue;
+		prev.instructions.insert(prev.instructions.end(), blocks[i].instructions.begin(), blocks[i].instructions.end());
+		blocks[i].instructions.clear();
+		changed = true;
+	}
+
+	// empty blocks are merged into the next one.
+	stdvec<bool> erase(blocks.size(), false);
+	bool any = false;
+	for (int i = 0; i < (int)blocks.size(); i++) {
+		if (blocks[i].instructions.size() == 0) erase[i] = any = true;
+	}
+	if (any) {
+		p_function.erase_blocks(erase);
+		changed = true;
+	}
+
+	if (changed) p_function.update_cfg();
+	return changed;
+}
+
+bool IRBranchFoldPass::run(IRFunction& p_function) {
+	if (p_function.bytecode_file == nullptr) return false;
+
+	bool changed = false;
+	for (IRBlock& block : p_function.blocks) {
+		if (block.instructions.size() == 0) continue;
+		IRInstruction& last = block.instructions.back();
+		Opcode op = last.get_opcode();
+		if (op != Opcode::JUMP_IF && op != Opcode::JUMP_IF_NOT) continue;
+
+		Address cond = last.get_address(1);
+		bool value;
+		if (cond.get_type() == Address::_NULL) {
+			value = false;
+		} else if (cond.get_type() == Address::CONST_VALUE) {
+			try {
+				value = p_function.bytecode_file->get_global_const_value(cond.get_index())->operator bool();
+			} catch (Throwable&) {
+				continue; // let it throw at runtime.
+			}
+		} else {
+			continue;
+		}
+
+		bool taken = (op == Opcode::JUMP_IF) ? value : !value;
+		if (taken) last = IRInstruction::make_jump(last.words[2], last.line);
+		else block.instructions.pop_back();
+		changed = true;
+	}
+
+	if (changed) p_function.update_cfg();
+	return changed;
+}
+
+bool IROperatorAssignPass::run(IRFunction& p_function) {
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+
+	bool changed = false;
+	for (IRBlock& block : p_function.blocks) {
+		stdvec<var::Type> types = types_in[block.id];
+		for (IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() == Opcode::OPERATOR_ASSIGN) {
+				// the VM updates only strings, arrays and instances in place.
+				Address dst = instr.get_address(2);
+				var::Type type = p_function.get_type(dst, types);
+				if (type == var::_NULL || type == var::BOOL || type == var::INT || type == var::FLOAT) {
+					instr = IRInstruction::make_operator(dst, (var::Operator)instr.words[1], dst, instr.get_address(3), instr.line);
+					changed = true;
+				}
+			}
+			p_function.update_types(instr, types);
+		}
+	}
+	return changed;
+}
+
+bool IRUnreachableBlockPass::run(IRFunction& p_function) {
+	if (p_function.blocks.size() == 0) return false;
+
+	stdvec<bool> reachable(p_function.blocks.size(), false);
+	stdvec<uint32_t> stack = { 0 };
+	reachable[0] = true;
+	while (stack.size() > 0) {
+		uint32_t id = stack.back(); stack.pop_back();
+		for (uint32_t succ : p_function.blocks[id].successors) {
+			if (reachable[succ]) continue;
+			reachable[succ] = true;
+			stack.push_back(succ);
+		}
+	}
+
+	stdvec<bool> erase(p_function.blocks.size(), false);
+	bool any = false;
+	for (int i = 0; i < (int)p_function.blocks.size() - 1; i++) { // the last block (END) is kept for the VM's size checks.
+		erase[i] = !reachable[i];
+		any = any || erase[i];
+	}
+
+	// only the END of an unreachable last block is needed.
+	IRBlock& last = p_function.blocks.back();
+	bool trimmed = !reachable.back() && last.instructions.size() > 1;
+	if (trimmed) last.instructions.erase(last.instructions.begin(), last.instructions.end() - 1);
+
+	if (!any) return trimmed;
+	p_function.erase_blocks(erase);
+	return true;
+}
+
+bool IRDeadStorePass::run(IRFunction& p_function) {
+	stdvec<IRBlock>& blocks = p_function.blocks;
+	uint32_t slots = p_function.stack_size;
+	if (blocks.size() == 0 || slots == 0) return false;
+
+	stdvec<stdvec<bool>> live_in = p_function.get_live_in();
+
+	bool changed = false;
+	for (IRBlock& block : blocks) {
+		stdvec<bool> live = p_function.get_live_out(block.id, live_in);
+		stdvec<IRInstruction>& instructions = block.instructions;
+		for (int i = (int)instructions.size() - 1; i >= 0; i--) {
+			const IRInstruction& instr = instructions[i];
+
+			if (instr.is_pure()) {
+				int def = -1;
+				for (int w = 1; w < (int)instr.size(); w++) if (instr.kinds[w] == IRInstruction::DEF) def = w;
+				Address addr = (def >= 0) ? instr.get_address(def) : Address();
+				if (def >= 0 && addr.get_type() == Address::STACK && addr.get_index() < slots && !live[addr.get_index()]) {
+					instructions.erase(instructions.begin() + i);
+					changed = true;
+					continue;
+				}
+			}
+			p_function.update_live(instr, live);
+		}
+	}
+
+	if (changed) p_function.update_cfg();
+	return changed;
+}
+
+bool IRCoalescePass::run(IRFunction& p_function) {
+	if (p_function.blocks.size() == 0 || p_function.stack_size == 0) return false;
+
+	stdvec<stdvec<bool>> live_in = p_function.get_live_in();
+	bool changed = false;
+	for (IRBlock& block : p_function.blocks) {
+		// renaming inside a block doesn't change what's live out of it.
+		stdvec<bool> live_out = p_function.get_live_out(block.id, live_in);
+		while (_coalesce(p_function, block, live_out)) changed = true;
+		changed = _propagate(p_function, block) || changed;
+
+		// `x = x;` left after renaming.
+		stdvec<IRInstruction>& instructions = block.instructions;
+		for (int i = (int)instructions.size() - 1; i >= 0; i--) {
+			const IRInstruction& instr = instructions[i];
+			if (instr.get_opcode() != Opcode::ASSIGN || instr.words[1] != instr.words[2]) continue;
+			if (instr.get_address(1).get_type() != Address::STACK) continue;
+			instructions.erase(instructions.begin() + i);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+static bool _refers(const IRInstruction& p_instr, uint32_t p_addr) {
+	for (int w = 1; w < (int)p_instr.size(); w++) {
+		switch (p_instr.kinds[w]) {
+			case IRInstruction::USE:
+			case IRInstruction::DEF:
+			case IRInstruction::USE_DEF:
+				if (p_instr.words[w] == p_addr) return true;
+				break;
+			default:
+				break;
+		}
+	}
+	return false;
+}
+
+bool IRCoalescePass::_coalesce(IRFunction& p_function, IRBlock& p_block, const stdvec<bool>& p_live_out) const {
+	stdvec<IRInstruction>& instructions = p_block.instructions;
+
+	// live[i] : slots live after the instruction i.
+	stdvec<stdvec<bool>> live(instructions.size());
+	stdvec<bool> curr = p_live_out;
+	for (int i = (int)instructions.size() - 1; i >= 0; i--) {
+		live[i] = curr;
+		p_function.update_live(instructions[i], curr);
+	}
+
+	for (int j = 0; j < (int)instructions.size(); j++) {
+		const IRInstruction& copy = instructions[j];
+		if (copy.get_opcode() != Opcode::ASSIGN) continue;
+		Address dst = copy.get_address(1), src = copy.get_address(2);
+		if (dst.get_type() != Address::STACK || src.get_type() != Address::STACK || dst == src) continue;
+		if (src.get_index() >= p_function.stack_size || live[j][src.get_index()]) continue;
+
+		// the instruction defining src, dst can't be used or written till the copy.
+		int def = -1, def_word = -1;
+		for (int i = j - 1; i >= 0; i--) {
+			const IRInstruction& instr = instructions[i];
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (instr.kinds[w] == IRInstruction::DEF && instr.words[w] == src.get_address()) def_word = w;
+			}
+			if (def_word >= 0) {
+				def = i;
+				break;
+			}
+			if (_refers(instr, dst.get_address())) break;
+		}
+		if (def < 0) continue;
+
+		IRInstruction& instr = instructions[def];
+		bool other_ref = false;
+		for (int w = 1; w < (int)instr.size(); w++) {
+			if (w != def_word && instr.words[w] == src.get_address() && instr.kinds[w] != IRInstruction::IMM &&
+				instr.kinds[w] != IRInstruction::NAME && instr.kinds[w] != IRInstruction::TARGET) other_ref = true;
+		}
+		if (other_ref) continue;
+		// reads an element of it's container by reference (freed if it's overwritten).
+		if (instr.get_opcode() == Opcode::GET_MAPPED_UNCHECKED && _refers(instr, dst.get_address())) continue;
+
+		instr.set_address(def_word, dst);
+		for (int i = def + 1; i < j; i++) {
+			IRInstruction& use = instructions[i];
+			for (int w = 1; w < (int)use.size(); w++) {
+				if (use.kinds[w] != IRInstruction::IMM && use.kinds[w] != IRInstruction::NAME &&
+					use.kinds[w] != IRInstruction::TARGET && use.words[w] == src.get_address()) {
+					use.set_address(w, dst);
+				}
+			}
+		}
+		instructions.erase(instructions.begin() + j);
+		return true;
+	}
+	return false;
+}
+
+bool IRCoalescePass::_propagate(IRFunction& p_function, IRBlock& p_block) const {
+	bool changed = false;
+	stdvec<IRInstruction>& instructions = p_block.instructions;
+
+	for (int i = 0; i < (int)instructions.size(); i++) {
+		const IRInstruction& copy = instructions[i];
+		if (copy.get_opcode() != Opcode::ASSIGN) continue;
+		Address dst = copy.get_address(1), src = copy.get_address(2);
+		if (dst.get_type() != Address::STACK || dst == src) continue;
+		if (src.get_type() != Address::STACK && src.get_type() != Address::PARAMETER && src.get_type() != Address::CONST_VALUE) continue;
+
+		for (int j = i + 1; j < (int)instructions.size(); j++) {
+			IRInstruction& instr = instructions[j];
+			bool writes_src = false, writes_dst = false, modifies_dst = false;
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (instr.kinds[w] != IRInstruction::DEF && instr.kinds[w] != IRInstruction::USE_DEF) continue;
+				if (instr.words[w] == src.get_address()) writes_src = true;
+				if (instr.words[w] == dst.get_address()) writes_dst = true;
+				if (instr.words[w] == dst.get_address() && instr.kinds[w] == IRInstruction::USE_DEF) modifies_dst = true;
+			}
+			if (writes_src || modifies_dst) break;
+
+			// the operands are read before the result is written.
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (instr.kinds[w] == IRInstruction::USE && instr.words[w] == dst.get_address()) {
+					instr.set_address(w, src);
+					changed = true;
+				}
+			}
+			if (writes_dst) break;
+		}
+	}
+	return changed;
+}
+
+bool IRLoopInvariantPass::run(IRFunction& p_function) {
+	bool changed = false;
+	bool hoisted = true;
+	while (hoisted) {
+		hoisted = false;
+		for (const IRLoop& loop : p_function.find_loops()) {
+			if (_hoist(p_function, loop)) {
+				hoisted = changed = true;
+				break; // the block ids could be shifted.
+			}
+		}
+	}
+	if (changed) p_function.update_cfg();
+	return changed;
+}
+
+bool IRLoopInvariantPass::_hoist(IRFunction& p_function, const IRLoop& p_loop) const {
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+	stdvec<stdvec<bool>> numbers_in = p_function.infer_numbers(types_in);
+
+	// addresses written in the loop and if anything in it could call out.
+	stdmap<uint32_t, int> writes;
+	bool calls_out = false;
+	for (const IRBlock& block : p_function.blocks) {
+		if (!p_loop.blocks[block.id]) continue;
+		stdvec<var::Type> types = types_in[block.id];
+		stdvec<bool> numbers = numbers_in[block.id];
+		for (const IRInstruction& instr : block.instructions) {
+			calls_out = calls_out || p_function.may_call_out(instr, types, &numbers);
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (_is_write(p_function, instr, w, types)) writes[instr.words[w]]++;
+			}
+			p_function.update_numbers(instr, types, numbers);
+			p_function.update_types(instr, types);
+		}
+	}
+
+	auto invariant = [&](const Address& p_addr) -> bool {
+		switch (p_addr.get_type()) {
+			case Address::_NULL:
+			case Address::THIS:
+			case Address::CONST_VALUE:
+				return true;
+			case Address::STACK:
+			case Address::PARAMETER:
+				return writes.find(p_addr.get_address()) == writes.end();
+			case Address::MEMBER_VAR: // could be written through another reference of `this`.
+				return !calls_out && writes.find(p_addr.get_address()) == writes.end();
+			default:
+				return false;
+		}
+	};
+
+	auto hoistable = [&](const IRInstruction& p_instr, const stdvec<var::Type>& p_types, const stdvec<bool>& p_numbers) -> bool {
+		if (p_instr.is_branch() || p_instr.is_terminator()) return false;
+
+		int defs = 0;
+		for (int w = 1; w < (int)p_instr.size(); w++) {
+			Address addr = p_instr.get_address(w);
+			switch (p_instr.kinds[w]) {
+				case IRInstruction::USE:
+				case IRInstruction::USE_DEF:
+					if (!invariant(addr)) return false;
+					break;
+				case IRInstruction::DEF:
+					if (addr.get_type() != Address::STACK || addr.get_index() >= p_function.stack_size) return false;
+					defs++;
+					break;
+				default:
+					break;
+			}
+		}
+		if (defs != 1) return false;
+
+		// it's at the start of the header and runs (or throws) at the same point it used to.
+		switch (p_instr.get_opcode()) {
+			case Opcode::ASSIGN:
+			case Opcode::OPERATOR:
+				return !p_function.may_call_out(p_instr, p_types, &p_numbers);
+			case Opcode::CALL_METHOD: {
+				if (!_is_size_call(p_function, p_instr)) return false;
+				var::Type on = p_function.get_type(p_instr.get_address(1), p_types);
+				if (on == var::STRING) return true; // a value type.
+				return (on == var::ARRAY || on == var::MAP) && !calls_out;
+			}
+			case Opcode::CALL_INTRINSIC: {
+				if ((BuiltinFunctions::Type)p_instr.words[1] != BuiltinFunctions::LEN) return !p_function.may_call_out(p_instr, p_types, &p_numbers);
+				var::Type on = p_function.get_type(p_instr.get_address(2), p_types);
+				if (on == var::STRING) return true;
+				return (on == var::ARRAY || on == var::MAP) && !calls_out;
+			}
+			case Opcode::CONSTRUCT_LITERAL_ARRAY:
+			case Opcode::CONSTRUCT_LITERAL_CONST:
+				return false; // a new container for each iteration.
+			default:
+				return p_instr.is_pure();
+		}
+	};
+
+	// a slot written somewhere else in the loop (a reused temporary) gets a new slot if it's value
+	// is only used in the header.
+	stdvec<IRInstruction> instructions = p_function.blocks[p_loop.header].instructions;
+	stdvec<bool> live_out = p_function.get_live_out(p_loop.header, p_function.get_live_in());
+	uint32_t stack_size = p_function.stack_size;
+	auto rename = [&](uint32_t p_index, int p_word, uint32_t p_slot) -> bool {
+		stdvec<IRInstruction> renamed = instructions;
+		Address to(Address::STACK, stack_size);
+		renamed[p_index].set_address(p_word, to);
+		for (uint32_t i = p_index + 1; i < renamed.size(); i++) {
+			IRInstruction& instr = renamed[i];
+			bool redefined = false;
+			for (int w = 1; w < (int)instr.size(); w++) {
+				Address addr = instr.get_address(w);
+				if (addr.get_type() != Address::STACK || addr.get_index() != p_slot) continue;
+				if (instr.kinds[w] == IRInstruction::USE_DEF) return false;
+				if (instr.kinds[w] == IRInstruction::USE) instr.set_address(w, to);
+				if (instr.kinds[w] == IRInstruction::DEF) redefined = true;
+			}
+			if (redefined) {
+				instructions = renamed;
+				return true;
+			}
+		}
+		if (live_out[p_slot]) return false;
+		instructions = renamed;
+		return true;
+	};
+
+	stdvec<var::Type> types = types_in[p_loop.header];
+	stdvec<bool> numbers = numbers_in[p_loop.header];
+	uint32_t count = 0;
+	for (; count < instructions.size(); count++) {
+		const IRInstruction& instr = instructions[count];
+		if (!hoistable(instr, types, numbers)) break;
+
+		int def = 1;
+		while (instr.kinds[def] != IRInstruction::DEF) def++;
+		Address dst = instr.get_address(def);
+		if (writes[dst.get_address()] != 1) {
+			if (!rename(count, def, dst.get_index())) break;
+			writes[dst.get_address()]--;
+			stack_size++;
+		}
+		p_function.update_numbers(instructions[count], types, numbers);
+		p_function.update_types(instructions[count], types);
+	}
+	if (count == 0) return false;
+
+	int preheader = p_function.add_preheader(p_loop);
+	if (preheader < 0) return false;
+	uint32_t header_id = ((uint32_t)preheader == p_loop.header) ? p_loop.header + 1 : p_loop.header;
+	p_function.stack_size = stack_size;
+
+	stdvec<IRInstruction>& to = p_function.blocks[preheader].instructions;
+	auto pos = to.end();
+	if (to.size() > 0 && to.back().get_opcode() == Opcode::JUMP) pos = to.end() - 1;
+	to.insert(pos, instructions.begin(), instructions.begin() + count);
+	instructions.erase(instructions.begin(), instructions.begin() + count);
+	p_function.blocks[header_id].instructions = instructions;
+
+	p_function.update_cfg();
+	return true;
+}
+
+// facts known to be true at a point, for the indexes of containers.
+struct IRBoundsFact {
+	enum Kind {
+		NON_NEG,  // a >= 0 (an int).
+		SIZE,     // a == b.size()
+		LESS,     // a == (b < c.size())
+		IN_RANGE, // 0 <= a < b.size()
+	};
+	Kind kind;
+	uint32_t a = 0, b = 0, c = 0;  // addresses of stack slots (or parameters).
+	var::Type container = var::VAR; // type of the container (an Array's size could be changed by a call).
+
+	IRBoundsFact(Kind p_kind, uint32_t p_a, uint32_t p_b = 0, uint32_t p_c = 0, var::Type p_container = var::VAR)
+		: kind(p_kind), a(p_a), b(p_b), c(p_c), container(p_container) {}
+
+	bool has_slot(uint32_t p_slot) const {
+		switch (kind) {
+			case NON_NEG:  return a == p_slot;
+			case SIZE:     return a == p_slot || b == p_slot;
+			case LESS:     return a == p_slot || b == p_slot || c == p_slot;
+			case IN_RANGE: return a == p_slot || b == p_slot;
+		}
+		return true;
+	}
+
+	bool operator<(const IRBoundsFact& p_other) const {
+		if (kind != p_other.kind) return kind < p_other.kind;
+		if (a != p_other.a) return a < p_other.a;
+		if (b != p_other.b) return b < p_other.b;
+		if (c != p_other.c) return c < p_other.c;
+		return container < p_other.container;
+	}
+	bool operator==(const IRBoundsFact& p_other) const {
+		return !(*this < p_other) && !(p_other < *this);
+	}
+};
+
+bool IRBoundsCheckPass::run(IRFunction& p_function) {
+	typedef std::set<IRBoundsFact> Facts;
+	stdvec<IRBlock>& blocks = p_function.blocks;
+	if (blocks.size() == 0 || !p_function.has_opcode(Opcode::GET_MAPPED)) return false;
+
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+	stdvec<stdvec<bool>> numbers_in = p_function.infer_numbers(types_in);
+
+	// the facts are on the stack slots and the parameters (an annotated Array), by their address.
+	auto slot_of = [&](const IRInstruction& p_instr, int p_word, uint32_t* r_slot) -> bool {
+		Address addr = p_instr.get_address(p_word);
+		if (addr.get_type() != Address::STACK && addr.get_type() != Address::PARAMETER) return false;
+		*r_slot = addr.get_address();
+		return true;
+	};
+	auto non_neg = [&](const Facts& p_facts, const IRInstruction& p_instr, int p_word) -> bool {
+		Address addr = p_instr.get_address(p_word);
+		if (addr.get_type() == Address::CONST_VALUE) {
+			if (p_function.bytecode_file == nullptr) return false;
+			const var* value = p_function.bytecode_file->get_global_const_value(addr.get_index());
+			return value->get_type() == var::INT && value->operator int64_t() >= 0;
+		}
+		uint32_t slot;
+		return slot_of(p_instr, p_word, &slot) && p_facts.count(IRBoundsFact(IRBoundsFact::NON_NEG, slot)) > 0;
+	};
+
+	// p_rewrite: replace the indexing where it's in range. returns true if anything replaced.
+	auto transfer = [&](IRInstruction& p_instr, Facts& r_facts, stdvec<var::Type>& r_types, stdvec<bool>& r_numbers, bool p_rewrite) -> bool {
+		bool replaced = false;
+		Facts gen;
+		uint32_t dst = 0, on = 0, index = 0, size = 0;
+
+		switch (p_instr.get_opcode()) {
+			case Opcode::ASSIGN: {
+				if (slot_of(p_instr, 1, &dst) && non_neg(r_facts, p_instr, 2)) gen.insert(IRBoundsFact(IRBoundsFact::NON_NEG, dst));
+			} break;
+
+			case Opcode::OPERATOR: {
+				if (!slot_of(p_instr, 4, &dst)) break;
+				var::Operator op = (var::Operator)p_instr.words[1];
+				var::Type left = p_function.get_type(p_instr.get_address(2), r_types);
+				var::Type right = p_function.get_type(p_instr.get_address(3), r_types);
+
+				if (op == var::OP_ADDITION && left == var::INT && right == var::INT) {
+					if (non_neg(r_facts, p_instr, 2) && non_neg(r_facts, p_instr, 3)) gen.insert(IRBoundsFact(IRBoundsFact::NON_NEG, dst));
+				} else if (op == var::OP_LT || op == var::OP_GT) {
+					int i_word = (op == var::OP_LT) ? 2 : 3;
+					int s_word = (op == var::OP_LT) ? 3 : 2;
+					if (p_function.get_type(p_instr.get_address(i_word), r_types) != var::INT) break;
+					if (!slot_of(p_instr, i_word, &index) || !slot_of(p_instr, s_word, &size)) break;
+					for (const IRBoundsFact& fact : r_facts) {
+						if (fact.kind != IRBoundsFact::SIZE || fact.a != size) continue;
+						if (dst == index || dst == fact.b) continue;
+						gen.insert(IRBoundsFact(IRBoundsFact::LESS, dst, index, fact.b, fact.container));
+					}
+				}
+			} break;
+
+			case Opcode::CALL_METHOD: {
+				var::Type on_type = p_function.get_type(p_instr.get_address(1), r_types);
+				if (!_is_size_call(p_function, p_instr) || !(on_type == var::ARRAY || on_type == var::STRING)) break;
+				if (!slot_of(p_instr, 1, &on) || !slot_of(p_instr, 4, &dst) || on == dst) break;
+				gen.insert(IRBoundsFact(IRBoundsFact::SIZE, dst, on, 0, on_type));
+				gen.insert(IRBoundsFact(IRBoundsFact::NON_NEG, dst));
+			} break;
+
+			case Opcode::CALL_INTRINSIC: { // len(a) is the same as a.size().
+				if ((BuiltinFunctions::Type)p_instr.words[1] != BuiltinFunctions::LEN) break;
+				var::Type len_type = p_function.get_type(p_instr.get_address(2), r_types);
+				if (!(len_type == var::ARRAY || len_type == var::STRING)) break;
+				if (!slot_of(p_instr, 2, &on) || !slot_of(p_instr, 4, &dst) || on == dst) break;
+				gen.insert(IRBoundsFact(IRBoundsFact::SIZE, dst, on, 0, len_type));
+				gen.insert(IRBoundsFact(IRBoundsFact::NON_NEG, dst));
+			} break;
+
+			case Opcode::GET_MAPPED: {
+				var::Type on_type = p_function.get_type(p_instr.get_address(1), r_types);
+				if (!p_rewrite || !(on_type == var::ARRAY || on_type == var::STRING)) break;
+				if (!slot_of(p_instr, 1, &on) || !slot_of(p_instr, 2, &index)) break;
+				if (p_instr.words[3] == p_instr.words[1]) break; // the container is released before reading.
+				if (r_facts.count(IRBoundsFact(IRBoundsFact::IN_RANGE, index, on, 0, on_type)) == 0) break;
+				p_instr.words[0] = Opcode::GET_MAPPED_UNCHECKED;
+				replaced = true;
+			} break;
+
+			default:
+				break;
+		}
+
+		// kill the facts of the written slots, and the sizes of arrays if it could call out.
+		bool calls_out = p_function.may_call_out(p_instr, r_types, &r_numbers);
+		for (auto it = r_facts.begin(); it != r_facts.end();) {
+			bool kill = calls_out && it->kind != IRBoundsFact::NON_NEG && it->container != var::STRING;
+			for (int w = 1; w < (int)p_instr.size() && !kill; w++) {
+				uint32_t slot;
+				if (_is_write(p_function, p_instr, w, r_types) && slot_of(p_instr, w, &slot) && it->has_slot(slot)) kill = true;
+			}
+			if (kill) it = r_facts.erase(it);
+			else it++;
+		}
+		r_facts.insert(gen.begin(), gen.end());
+		p_function.update_numbers(p_instr, r_types, r_numbers);
+		p_function.update_types(p_instr, r_types);
+		return replaced;
+	};
+
+	// facts on the edge, the index is in range if the jump on `index < size` isn't taken.
+	auto edge_facts = [&](const IRBlock& p_from, uint32_t p_to, const Facts& p_out) -> Facts {
+		Facts facts = p_out;
+		const IRInstruction* term = p_from.get_terminator();
+		if (term == nullptr) return facts;
+		Opcode op = term->get_opcode();
+		if (op != Opcode::JUMP_IF && op != Opcode::JUMP_IF_NOT) return facts;
+
+		uint32_t target = term->words[2];
+		if (target == p_from.id + 1) return facts; // both the edges.
+		bool taken = p_to == target;
+		if (taken != (op == Opcode::JUMP_IF)) return facts; // the condition is false.
+
+		uint32_t cond;
+		if (!slot_of(*term, 1, &cond)) return facts;
+		for (const IRBoundsFact& fact : p_out) {
+			if (fact.kind != IRBoundsFact::LESS || fact.a != cond) continue;
+			if (p_out.count(IRBoundsFact(IRBoundsFact::NON_NEG, fact.b)) == 0) continue;
+			facts.insert(IRBoundsFact(IRBoundsFact::IN_RANGE, fact.b, fact.c, 0, fact.container));
+		}
+		return facts;
+	};
+
+	// must be true on every path, a block not visited yet doesn't restrict it's successors.
+	stdvec<Facts> facts_out(blocks.size());
+	stdvec<bool> visited(blocks.size(), false);
+	auto facts_in = [&](const IRBlock& p_block) -> Facts {
+		Facts facts;
+		bool first = true;
+		if (p_block.id == 0) return facts;
+		for (uint32_t pred : p_block.predecessors) {
+			if (!visited[pred]) continue;
+			Facts edge = edge_facts(blocks[pred], p_block.id, facts_out[pred]);
+			if (first) {
+				facts = edge;
+				first = false;
+				continue;
+			}
+			for (auto it = facts.begin(); it != facts.end();) {
+				if (edge.count(*it) == 0) it = facts.erase(it);
+				else it++;
+			}
+		}
+		return facts;
+	};
+
+	bool updated = true;
+	while (updated) {
+		updated = false;
+		for (IRBlock& block : blocks) {
+			if (block.id != 0 && !visited[block.id]) {
+				bool reached = false;
+				for (uint32_t pred : block.predecessors) reached = reached || visited[pred];
+				if (!reached) continue;
+			}
+			Facts facts = facts_in(block);
+			stdvec<var::Type> types = types_in[block.id];
+			stdvec<bool> numbers = numbers_in[block.id];
+			for (IRInstruction& instr : block.instructions) transfer(instr, facts, types, numbers, false);
+			if (!visited[block.id] || facts != facts_out[block.id]) {
+				visited[block.id] = true;
+				facts_out[block.id] = facts;
+				updated = true;
+			}
+		}
+	}
+
+	bool changed = false;
+	for (IRBlock& block : blocks) {
+		if (!visited[block.id]) continue;
+		Facts facts = facts_in(block);
+		stdvec<var::Type> types = types_in[block.id];
+		stdvec<bool> numbers = numbers_in[block.id];
+		for (IRInstruction& instr : block.instructions) {
+			changed = transfer(instr, facts, types, numbers, true) || changed;
+		}
+	}
+	return changed;
+}
+
+// the operator methods an instance could override (the ones which return any value).
+static const char* _operator_method(var::Operator p_op) {
+	switch (p_op) {
+		case var::OP_ADDITION:       return GlobalStrings::__add;
+		case var::OP_SUBTRACTION:    return GlobalStrings::__sub;
+		case var::OP_MULTIPLICATION: return GlobalStrings::__mul;
+		case var::OP_DIVISION:       return GlobalStrings::__div;
+		default:                     return nullptr;
+	}
+}
+
+bool IRScalarReplacePass::run(IRFunction& p_function) {
+	_inlined.clear();
+	if (p_function.bytecode_file == nullptr || p_function.blocks.size() == 0) return false;
+	if (!p_function.has_opcode(Opcode::CONSTRUCT_CARBON)) return false;
+
+	const uint32_t max_size = p_function.get_opcode_count() + MAX_GROWTH;
+	bool changed = false;
+	_Instance instance;
+	while (p_function.get_opcode_count() < max_size && _find(p_function, &instance)) {
+		_replace(p_function, instance);
+		for (auto& it : instance.bodies) _inlined.push_back(it.first);
+		changed = true;
+	}
+	return changed;
+}
+
+// the values written to a slot (webs) are found with the reaching definitions, the uses reached by a
+// definition are of the same value. a value is replaceable if all it's definitions are constructions
+// of the same class (the entry is a null definition) and every use of it is replaceable.
+bool IRScalarReplacePass::_find(IRFunction& p_function, _Instance* r_instance) const {
+	const stdvec<IRBlock>& blocks = p_function.blocks;
+
+	stdvec<bool> constructed(p_function.stack_size, false);
+	for (const IRBlock& block : blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() != Opcode::CONSTRUCT_CARBON) continue;
+			Address dst = instr.get_address(instr.size() - 1);
+			if (dst.get_type() == Address::STACK && dst.get_index() < p_function.stack_size) constructed[dst.get_index()] = true;
+		}
+	}
+
+	for (uint32_t slot = 0; slot < p_function.stack_size; slot++) {
+		if (!constructed[slot]) continue;
+		const uint32_t addr = Address(Address::STACK, slot).get_address();
+
+		auto uses = [&](const IRInstruction& p_instr) -> bool {
+			for (int w = 1; w < (int)p_instr.size(); w++) {
+				if (p_instr.kinds[w] != IRInstruction::USE && p_instr.kinds[w] != IRInstruction::USE_DEF) continue;
+				if (p_instr.words[w] == addr) return true;
+			}
+			return false;
+		};
+		auto defines = [&](const IRInstruction& p_instr, bool* r_through) -> bool {
+			bool def = false, use_def = false;
+			for (int w = 1; w < (int)p_instr.size(); w++) {
+				if (p_instr.words[w] != addr) continue;
+				if (p_instr.kinds[w] == IRInstruction::DEF) def = true;
+				if (p_instr.kinds[w] == IRInstruction::USE_DEF) use_def = true;
+			}
+			*r_through = !def && use_def; // the same value (a method called on it).
+			return def || use_def;
+		};
+
+		// definition 0 is the null value at the entry.
+		stdvec<std::pair<uint32_t, uint32_t>> defs = { { 0, 0 } };
+		stdmap<std::pair<uint32_t, uint32_t>, uint32_t> def_ids;
+		for (const IRBlock& block : blocks) {
+			for (uint32_t i = 0; i < block.instructions.size(); i++) {
+				bool through;
+				if (!defines(block.instructions[i], &through)) continue;
+				def_ids[{ block.id, i }] = (uint32_t)defs.size();
+				defs.push_back({ block.id, i });
+			}
+		}
+
+		typedef stdvec<bool> Reaching;
+		auto transfer = [&](const IRBlock& p_block, Reaching& r_reaching) {
+			for (uint32_t i = 0; i < p_block.instructions.size(); i++) {
+				auto it = def_ids.find({ p_block.id, i });
+				if (it == def_ids.end()) continue;
+				r_reaching.assign(defs.size(), false);
+				r_reaching[it->second] = true;
+			}
+		};
+
+		stdvec<Reaching> reaching_in(blocks.size(), Reaching(defs.size(), false));
+		reaching_in[0][0] = true;
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (const IRBlock& block : blocks) {
+				Reaching out = reaching_in[block.id];
+				transfer(block, out);
+				for (uint32_t succ : block.successors) {
+					for (uint32_t d = 0; d < defs.size(); d++) {
+						if (!out[d] || reaching_in[succ][d]) continue;
+						reaching_in[succ][d] = true;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		// union the definitions reaching the same use.
+		stdvec<uint32_t> parent(defs.size());
+		for (uint32_t d = 0; d < defs.size(); d++) parent[d] = d;
+		auto root = [&](uint32_t d) -> uint32_t {
+			while (parent[d] != d) d = parent[d] = parent[parent[d]];
+			return d;
+		};
+		stdvec<std::pair<std::pair<uint32_t, uint32_t>, uint32_t>> use_sites; // (site, a definition reaching it).
+
+		for (const IRBlock& block : blocks) {
+			Reaching reaching = reaching_in[block.id];
+			for (uint32_t i = 0; i < block.instructions.size(); i++) {
+				const IRInstruction& instr = block.instructions[i];
+				if (uses(instr)) {
+					int first = -1;
+					for (uint32_t d = 0; d < defs.size(); d++) {
+						if (!reaching[d]) continue;
+						if (first < 0) first = d;
+						else parent[root(d)] = root(first);
+					}
+					ASSERT(first >= 0);
+					use_sites.push_back({ { block.id, i }, (uint32_t)first });
+				}
+				bool through;
+				if (!defines(instr, &through)) continue;
+				uint32_t id = def_ids.at({ block.id, i });
+				if (through) {
+					for (uint32_t d = 0; d < defs.size(); d++) if (reaching[d]) parent[root(d)] = root(id);
+				}
+				reaching.assign(defs.size(), false);
+				reaching[id] = true;
+			}
+		}
+
+		// try every value constructed in this slot.
+		stdvec<bool> tried(defs.size(), false);
+		for (uint32_t d = 1; d < defs.size(); d++) {
+			const IRInstruction& construct = blocks[defs[d].first].instructions[defs[d].second];
+			uint32_t web = root(d);
+			if (construct.get_opcode() != Opcode::CONSTRUCT_CARBON || tried[web]) continue;
+			tried[web] = true;
+			if (root(0) == web) continue; // could be null.
+
+			*r_instance = _Instance();
+			r_instance->slot = slot;
+			bool replaceable = true;
+			for (uint32_t other = 1; other < defs.size() && replaceable; other++) {
+				if (root(other) != web) continue;
+				const IRInstruction& instr = blocks[defs[other].first].instructions[defs[other].second];
+				bool through;
+				defines(instr, &through);
+				if (through) continue; // it's a use too.
+				replaceable = instr.get_opcode() == Opcode::CONSTRUCT_CARBON && _is_replaceable(p_function, instr, slot, false, r_instance);
+				r_instance->sites.push_back(defs[other]);
+			}
+			for (auto& use : use_sites) {
+				if (!replaceable) break;
+				if (root(use.second) != web) continue;
+				const IRInstruction& instr = blocks[use.first.first].instructions[use.first.second];
+				replaceable = _is_replaceable(p_function, instr, slot, true, r_instance);
+				r_instance->sites.push_back(use.first);
+			}
+			if (replaceable) return true;
+		}
+	}
+	return false;
+}
+
+bool IRScalarReplacePass::_is_replaceable(IRFunction& p_function, const IRInstruction& p_instr, uint32_t p_slot, bool p_use, _Instance* r_instance) const {
+	const Bytecode* file = p_function.bytecode_file;
+	const uint32_t addr = Address(Address::STACK, p_slot).get_address();
+
+	// the instance could only be at p_word, (a destination is a new value).
+	auto only_at = [&](int p_word) -> bool {
+		for (int w = 1; w < (int)p_instr.size(); w++) {
+			if (w == p_word || p_instr.kinds[w] == IRInstruction::DEF) continue;
+			if (p_instr.kinds[w] != IRInstruction::USE && p_instr.kinds[w] != IRInstruction::USE_DEF) continue;
+			if (p_instr.words[w] == addr) return false;
+		}
+		return true;
+	};
+	auto member_of = [&](uint32_t p_name) -> bool {
+		return r_instance->blueprint->_members.find(file->_global_names_array[p_name]) != r_instance->blueprint->_members.end();
+	};
+	auto method_of = [&](const String& p_name) -> const Function* {
+		auto it = r_instance->blueprint->_functions.find(p_name);
+		if (it == r_instance->blueprint->_functions.end() || it->second->is_static()) return nullptr;
+		return it->second.get();
+	};
+
+	switch (p_instr.get_opcode()) {
+		case Opcode::CONSTRUCT_CARBON: {
+			if (p_use) return false; // an argument of a construction (it's arguments are of the previous value).
+			auto it = file->_classes.find(file->_global_names_array[p_instr.words[1]]);
+			if (it == file->_classes.end()) return false;
+			const Bytecode* blueprint = it->second.get();
+			if (r_instance->blueprint != nullptr && r_instance->blueprint != blueprint) return false;
+			r_instance->blueprint = blueprint;
+
+			// an instance of a derived class or a native class needs it's base.
+			if (blueprint->_has_base) return false;
+			if (blueprint->_member_initializer != nullptr && !_get_body(blueprint->_member_initializer.get(), r_instance)) return false;
+			if (blueprint->_constructor == nullptr) return p_instr.words[2] == 0;
+			return _get_body(blueprint->_constructor, r_instance) && _get_args(p_function, blueprint->_constructor, p_instr, 2, nullptr);
+		}
+
+		case Opcode::GET:
+		case Opcode::SET:
+			// a static member or a method is read from the class.
+			return p_instr.words[1] == addr && only_at(1) && member_of(p_instr.words[2]);
+
+		case Opcode::CALL_METHOD: {
+			if (p_instr.words[1] != addr || !only_at(1)) return false;
+			const Function* method = method_of(file->_global_names_array[p_instr.words[2]]);
+			return method != nullptr && _get_body(method, r_instance) && _get_args(p_function, method, p_instr, 3, nullptr);
+		}
+
+		case Opcode::OPERATOR: {
+			if (p_instr.words[2] != addr || !only_at(2)) return false;
+			const char* name = _operator_method((var::Operator)p_instr.words[1]);
+			const Function* method = (name != nullptr) ? method_of(name) : nullptr;
+			return method != nullptr && _get_body(method, r_instance) && _get_args(p_function, method, p_instr, 0, nullptr);
+		}
+
+		default:
+			return false;
+	}
+}
+
+// a body which doesn't need an instance other than it's members.
+bool IRScalarReplacePass::_get_body(const Function* p_func, _Instance* r_instance) const {
+	if (r_instance->bodies.find(p_func) != r_instance->bodies.end()) return true;
+	if (p_func->get_opcodes().size() > MAX_BODY_SIZE) return false;
+	for (bool is_reference : p_func->get_is_args_ref()) if (is_reference) return false;
+
+	IRFunction body = IRFunction::build(p_func);
+	body.generalize_operators();
+	if (body.has_address(Address::THIS) || body.has_address(Address::STATIC_MEMBER)) return false;
+	if (body.has_opcode(Opcode::CALL_FUNC) || body.has_opcode(Opcode::CALL_DIRECT)) return false; // could be a method.
+	if (body.has_opcode(Opcode::CALL_SUPER_CTOR) || body.has_opcode(Opcode::CALL_SUPER_METHOD)) return false;
+
+	uint32_t member_count = (uint32_t)r_instance->blueprint->_members.size();
+	for (const IRBlock& block : body.blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			int target = instr.get_target_word();
+			if (target >= 0 && instr.words[target] >= body.blocks.size()) return false; // jumps to the end.
+			for (int w = 1; w < (int)instr.size(); w++) {
+				if (instr.kinds[w] != IRInstruction::USE && instr.kinds[w] != IRInstruction::DEF && instr.kinds[w] != IRInstruction::USE_DEF) continue;
+				Address operand = instr.get_address(w);
+				if (operand.get_type() == Address::MEMBER_VAR && operand.get_index() >= member_count) return false;
+			}
+		}
+	}
+	r_instance->bodies[p_func] = body;
+	return true;
+}
+
+// the arguments of a construction, a method call or an operator (p_argc_word is 0) with the default values,
+// returns false if it's an error at runtime. if r_args is nullptr only the count is checked.
+bool IRScalarReplacePass::_get_args(IRFunction& p_function, const Function* p_func, const IRInstruction& p_instr, uint32_t p_argc_word,
+		stdvec<Address>* r_args) const {
+	uint32_t argc = (p_argc_word == 0) ? 1 : p_instr.words[p_argc_word];
+	const stdvec<var>& defaults = p_func->get_default_args();
+	uint32_t arg_count = (uint32_t)p_func->get_arg_count();
+	if (argc > arg_count || argc + defaults.size() < arg_count) return false;
+	if (r_args == nullptr) return true;
+
+	r_args->clear();
+	if (p_argc_word == 0) {
+		r_args->push_back(p_instr.get_address(3));
+	} else {
+		for (uint32_t i = 0; i < argc; i++) r_args->push_back(p_instr.get_address(p_argc_word + 1 + i));
+	}
+	while (r_args->size() < arg_count) {
+		uint32_t index = p_function.bytecode_file->_global_const_value_get(defaults[defaults.size() - (arg_count - r_args->size())]);
+		r_args->push_back(Address(Address::CONST_VALUE, index));
+	}
+	return true;
+}
+
+void IRScalarReplacePass::_replace(IRFunction& p_function, _Instance& p_instance) const {
+	const Bytecode* blueprint = p_instance.blueprint;
+	const Bytecode* file = p_function.bytecode_file;
+
+	stdvec<Address> members(blueprint->_members.size());
+	for (auto& it : blueprint->_members) members[it.second] = Address(Address::STACK, p_function.stack_size + it.second);
+	p_function.stack_size += (uint32_t)members.size();
+	Address scratch(Address::STACK, p_function.stack_size++); // return values of the constructors.
+
+	// inlining splits a block after the site, the sites before it are unchanged.
+	std::sort(p_instance.sites.begin(), p_instance.sites.end());
+	p_instance.sites.erase(std::unique(p_instance.sites.begin(), p_instance.sites.end()), p_instance.sites.end());
+
+	for (int s = (int)p_instance.sites.size() - 1; s >= 0; s--) {
+		uint32_t b = p_instance.sites[s].first, i = p_instance.sites[s].second;
+		stdvec<IRInstruction>& instructions = p_function.blocks[b].instructions;
+		const IRInstruction instr = instructions[i];
+		stdvec<Address> args;
+
+		switch (instr.get_opcode()) {
+			case Opcode::CONSTRUCT_CARBON: {
+				const Function* initializer = blueprint->_member_initializer.get();
+				const Function* constructor = blueprint->_constructor;
+
+				stdvec<IRInstruction> replaced;
+				for (const Address& member : members) replaced.push_back(IRInstruction::make_assign(member, Address(), instr.line));
+				if (initializer != nullptr) replaced.push_back(IRInstruction::make_clear(scratch, instr.line));
+				if (constructor != nullptr) replaced.push_back(IRInstruction::make_clear(scratch, instr.line));
+				instructions.erase(instructions.begin() + i);
+				instructions.insert(instructions.begin() + i, replaced.begin(), replaced.end());
+
+				// the placeholders are replaced with the bodies, the constructor first since it's after.
+				uint32_t at = i + (uint32_t)members.size();
+				if (constructor != nullptr) {
+					_get_args(p_function, constructor, instr, 2, &args);
+					p_function.inline_call(b, at + ((initializer != nullptr) ? 1 : 0), p_instance.bodies.at(constructor), args, false, &members);
+				}
+				if (initializer != nullptr) {
+					p_function.inline_call(b, at, p_instance.bodies.at(initializer), stdvec<Address>(), false, &members);
+				}
+			} break;
+
+			case Opcode::GET: {
+				uint32_t member = blueprint->_members.at(file->_global_names_array[instr.words[2]]);
+				instructions[i] = IRInstruction::make_assign(instr.get_address(3), members[member], instr.line);
+			} break;
+
+			case Opcode::SET: {
+				uint32_t member = blueprint->_members.at(file->_global_names_array[instr.words[2]]);
+				instructions[i] = IRInstruction::make_assign(members[member], instr.get_address(3), instr.line);
+			} break;
+
+			case Opcode::CALL_METHOD: {
+				const Function* method = blueprint->_functions.at(file->_global_names_array[instr.words[2]]).get();
+				_get_args(p_function, method, instr, 3, &args);
+				p_function.inline_call(b, i, p_instance.bodies.at(method), args, false, &members);
+			} break;
+
+			case Opcode::OPERATOR: {
+				const Function* method = blueprint->_functions.at(_operator_method((var::Operator)instr.words[1])).get();
+				_get_args(p_function, method, instr, 0, &args);
+				p_function.inline_call(b, i, p_instance.bodies.at(method), args, false, &members);
+			} break;
+
+			default:
+				THROW_BUG("invalid instruction to replace");
+		}
+	}
+	p_function.update_cfg();
+}
+
+bool IRTypeCheckPass::run(IRFunction& p_function) {
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+
+	bool changed = false;
+	for (IRBlock& block : p_function.blocks) {
+		stdvec<var::Type> types = types_in[block.id];
+		for (int i = 0; i < (int)block.instructions.size(); i++) {
+			const IRInstruction& instr = block.instructions[i];
+			// the type of a parameter is known because of it's check at the entry.
+			if (instr.get_opcode() == Opcode::CHECK_TYPE && instr.get_address(2).get_type() == Address::STACK &&
+				p_function.get_type(instr.get_address(2), types) == (var::Type)instr.words[1]) {
+				block.instructions.erase(block.instructions.begin() + i--);
+				changed = true;
+				continue;
+			}
+			p_function.update_types(instr, types);
+		}
+	}
+	return changed;
+}
+
+// the typed opcode of an operator, OPERATOR if there isn't one for the operand types.
+static Opcode _typed_operator(var::Operator p_op, var::Type p_left, var::Type p_right) {
+	bool ints = p_left == var::INT && p_right == var::INT;
+	bool numbers = (p_left == var::INT || p_left == var::FLOAT) && (p_right == var::INT || p_right == var::FLOAT);
+
+	switch (p_op) {
+		case var::OP_ADDITION:
+		case var::OP_SUBTRACTION:
+		case var::OP_MULTIPLICATION:
+		case var::OP_DIVISION:
+		case var::OP_EQ_CHECK:
+		case var::OP_NOT_EQ_CHECK:
+		case var::OP_LT:
+		case var::OP_LTEQ:
+		case var::OP_GT:
+		case var::OP_GTEQ:
+			if (ints) return Opcode::OPERATOR_INT;
+			if (numbers) return Opcode::OPERATOR_FLOAT;
+			return Opcode::OPERATOR;
+		case var::OP_MODULO:
+		case var::OP_BIT_LSHIFT:
+		case var::OP_BIT_RSHIFT:
+		case var::OP_BIT_AND:
+		case var::OP_BIT_OR:
+		case var::OP_BIT_XOR:
+			return (ints) ? Opcode::OPERATOR_INT : Opcode::OPERATOR;
+		default:
+			return Opcode::OPERATOR;
+	}
+}
+
+bool IRTypeSpecializePass::run(IRFunction& p_function) {
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+
+	bool changed = false;
+	for (IRBlock& block : p_function.blocks) {
+		stdvec<var::Type> types = types_in[block.id];
+		for (IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() == Opcode::OPERATOR) {
+				var::Type left = p_function.get_type(instr.get_address(2), types);
+				var::Type right = p_function.get_type(instr.get_address(3), types);
+				Opcode typed = _typed_operator((var::Operator)instr.words[1], left, right);
+				if (typed != Opcode::OPERATOR) {
+					instr.words[0] = typed;
+					changed = true;
+				}
+			}
+			p_function.update_types(instr, types);
+		}
+	}
+	return changed;
+}
+
+// the value of a bool or a number doesn't hold anything to be released.
+static bool _holds_value(var::Type p_type) {
+	return p_type != var::_NULL && p_type != var::BOOL && p_type != var::INT && p_type != var::FLOAT;
+}
+
+// the containers of the ITER_BEGIN instructions.
+static stdvec<bool> _iterated_slots(const IRFunction& p_function) {
+	stdvec<bool> iterated(p_function.stack_size, false);
+	for (const IRBlock& block : p_function.blocks) {
+		for (const IRInstruction& instr : block.instructions) {
+			if (instr.get_opcode() != Opcode::ITER_BEGIN) continue;
+			Address on = instr.get_address(2);
+			if (on.get_type() == Address::STACK && on.get_index() < p_function.stack_size) iterated[on.get_index()] = true;
+		}
+	}
+	return iterated;
+}
+
+bool IRSlotAllocationPass::run(IRFunction& p_function) {
+	stdvec<IRBlock>& blocks = p_function.blocks;
+	uint32_t slots = p_function.stack_size;
+
+	bool changed = false;
+	for (IRBlock& block : blocks) {
+		for (int i = (int)block.instructions.size() - 1; i >= 0; i--) {
+			if (block.instructions[i].get_opcode() != Opcode::CLEAR) continue;
+			block.instructions.erase(block.instructions.begin() + i);
+			changed = true;
+		}
+	}
+	if (slots == 0) return changed;
+
+	auto slot_at = [&](const IRInstruction& p_instr, int p_word) -> int {
+		switch (p_instr.kinds[p_word]) {
+			case IRInstruction::USE:
+			case IRInstruction::DEF:
+			case IRInstruction::USE_DEF: {
+				Address addr = p_instr.get_address(p_word);
+				if (addr.get_type() == Address::STACK && addr.get_index() < slots) return (int)addr.get_index();
+			} break;
+			default:
+				break;
+		}
+		return -1;
+	};
+
+	// a slot written while another one is live interferes with it (`x = y;` could share theirs). a slot
+	// read before it's written (null) is live from the entry and written only by the other slots.
+	// except for the operators, the result can't share a slot with the operands (an iterator refers to
+	// the container it's iterating, the element read by reference, ...).
+	stdvec<stdvec<bool>> interfere(slots, stdvec<bool>(slots, false));
+	stdvec<bool> used(slots, false);
+	stdvec<bool> iterated = _iterated_slots(p_function);
+	stdvec<stdvec<bool>> live_in = p_function.get_live_in();
+	for (const IRBlock& block : blocks) {
+		stdvec<bool> live = p_function.get_live_out(block.id, live_in);
+		for (int i = (int)block.instructions.size() - 1; i >= 0; i--) {
+			const IRInstruction& instr = block.instructions[i];
+			int copy_src = (instr.get_opcode() == Opcode::ASSIGN) ? slot_at(instr, 2) : -1;
+			for (int w = 1; w < (int)instr.size(); w++) {
+				int slot = slot_at(instr, w);
+				if (slot < 0) continue;
+				used[slot] = true;
+				if (instr.kinds[w] == IRInstruction::USE) continue;
+				for (uint32_t other = 0; other < slots; other++) {
+					if (!live[other] || (int)other == slot || (int)other == copy_src) continue;
+					interfere[slot][other] = interfere[other][slot] = true;
+				}
+				Opcode op = instr.get_opcode();
+				if (op == Opcode::OPERATOR || op == Opcode::OPERATOR_INT || op == Opcode::OPERATOR_FLOAT || op == Opcode::ASSIGN) continue;
+				for (int u = 1; u < (int)instr.size(); u++) {
+					int other = slot_at(instr, u);
+					if (other >= 0 && other != slot) interfere[slot][other] = interfere[other][slot] = true;
+				}
+			}
+			p_function.update_live(instr, live);
+		}
+	}
+
+	// the slots defined by the same instruction (never happens now) or live at the entry together.
+	for (uint32_t a = 0; a < slots; a++) {
+		for (uint32_t b = a + 1; b < slots && blocks.size() > 0; b++) {
+			if (live_in[0][a] && live_in[0][b]) interfere[a][b] = interfere[b][a] = true;
+		}
+	}
+
+	// an iterated container should be alive (and unchanged) till the iterator is done, which isn't known.
+	for (uint32_t slot = 0; slot < slots; slot++) {
+		if (!iterated[slot]) continue;
+		for (uint32_t other = 0; other < slots; other++) {
+			if (other != slot) interfere[slot][other] = interfere[other][slot] = true;
+		}
+	}
+
+	stdvec<int> color(slots, -1);
+	uint32_t colors = 0;
+	for (uint32_t slot = 0; slot < slots; slot++) {
+		if (!used[slot]) continue;
+		stdvec<bool> taken(colors, false);
+		for (uint32_t other = 0; other < slot; other++) {
+			if (interfere[slot][other] && color[other] >= 0) taken[color[other]] = true;
+		}
+		uint32_t c = 0;
+		while (c < colors && taken[c]) c++;
+		color[slot] = (int)c;
+		if (c == colors) colors++;
+	}
+
+	for (uint32_t slot = 0; slot < slots; slot++) {
+		if (color[slot] >= 0 && color[slot] != (int)slot) changed = true;
+	}
+	if (colors != slots) changed = true;
+	if (!changed) return false;
+
+	for (IRBlock& block : blocks) {
+		for (IRInstruction& instr : block.instructions) {
+			for (int w = 1; w < (int)instr.size(); w++) {
+				int slot = slot_at(instr, w);
+				if (slot >= 0) instr.set_address(w, Address(Address::STACK, (uint32_t)color[slot]));
+			}
+		}
+	}
+	p_function.stack_size = colors;
+	return true;
+}
+
+bool IRReleaseSlotsPass::run(IRFunction& p_function) {
+	stdvec<IRBlock>& blocks = p_function.blocks;
+	uint32_t slots = p_function.stack_size;
+	if (blocks.size() == 0 || slots == 0) return false;
+
+	stdvec<stdvec<bool>> live_in = p_function.get_live_in();
+	stdvec<stdvec<var::Type>> types_in = p_function.infer_types();
+
+	stdvec<bool> in_loop(blocks.size(), false);
+	for (const IRLoop& loop : p_function.find_loops()) {
+		for (uint32_t b = 0; b < blocks.size(); b++) in_loop[b] = in_loop[b] || loop.blocks[b];
+	}
+
+	// an iterated container is still referred by the iterator.
+	stdvec<bool> iterated = _iterated_slots(p_function);
+	auto is_slot = [&](const IRInstruction& p_instr, int p_word) -> bool {
+		Address addr = p_instr.get_address(p_word);
+		return addr.get_type() == Address::STACK && addr.get_index() < slots && !iterated[addr.get_index()];
+	};
+
+	bool changed = false;
+	for (IRBlock& block : blocks) {
+		// a block in a loop would clear them every iteration.
+		if (in_loop[block.id]) continue;
+		stdvec<IRInstruction>& instructions = block.instructions;
+		uint32_t line = (instructions.size() > 0) ? instructions[0].line : 0;
+
+		// the slots live out of a predecessor and dead on the edge to this block.
+		stdvec<IRInstruction> clears;
+		for (uint32_t slot = 0; slot < slots; slot++) {
+			if (live_in[block.id][slot] || iterated[slot] || !_holds_value(types_in[block.id][slot])) continue;
+			bool dies = false;
+			for (uint32_t pred : block.predecessors) {
+				dies = dies || p_function.get_live_out(pred, live_in)[slot];
+			}
+			if (dies) clears.push_back(IRInstruction::make_clear(Address(Address::STACK, slot), line));
+		}
+
+		// the slots dead after their last use in the block (the frame is released soon if it returns).
+		const IRInstruction* last = (instructions.size() > 0) ? &instructions.back() : nullptr;
+		bool exits = last != nullptr && (last->get_opcode() == Opcode::RETURN || last->get_opcode() == Opcode::END);
+		if (!exits) {
+			stdvec<var::Type> types = types_in[block.id];
+			stdvec<stdvec<var::Type>> types_before;
+			for (const IRInstruction& instr : instructions) {
+				types_before.push_back(types);
+				p_function.update_types(instr, types);
+			}
+
+			stdvec<bool> live = p_function.get_live_out(block.id, live_in);
+			stdvec<bool> written(slots, false); // written after the instruction (releases it anyway).
+			for (int i = (int)instructions.size() - 1; i >= 0; i--) {
+				IRInstruction instr = instructions[i];
+				bool branch = instr.is_branch() || instr.is_terminator();
+				stdvec<uint32_t> dead;
+				for (int w = 1; w < (int)instr.size() && !branch; w++) {
+					if (instr.kinds[w] != IRInstruction::USE && instr.kinds[w] != IRInstruction::USE_DEF) continue;
+					if (!is_slot(instr, w)) continue;
+					uint32_t slot = instr.get_address(w).get_index();
+					if (live[slot] || written[slot] || !_holds_value(types_before[i][slot])) continue;
+					if (std::find(dead.begin(), dead.end(), slot) != dead.end()) continue;
+
+					bool defined = false; // by the instruction itself.
+					for (int d = 1; d < (int)instr.size(); d++) {
+						if (instr.kinds[d] == IRInstruction::DEF && instr.words[d] == instr.words[w]) defined = true;
+					}
+					if (!defined) dead.push_back(slot);
+				}
+				for (uint32_t slot : dead) {
+					instructions.insert(instructions.begin() + i + 1, IRInstruction::make_clear(Address(Address::STACK, slot), instr.line));
+					changed = true;
+				}
+
+				for (int w = 1; w < (int)instr.size(); w++) {
+					if (is_slot(instr, w) && (instr.kinds[w] == IRInstruction::DEF || instr.kinds[w] == IRInstruction::USE_DEF)) {
+						written[instr.get_address(w).get_index()] = true;
+					}
+				}
+				p_function.update_live(instr, live);
+			}
+		}
+
+		if (clears.size() > 0) {
+			instructions.insert(instructions.begin(), clears.begin(), clears.end());
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+}
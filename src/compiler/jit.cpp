@@ -0,0 +1,419 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/jit.h"
+#include "compiler/builtin.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#include <exception>
+#endif
+
+namespace carbon {
+
+int JITFunction::_get_type_offset() {
+	var value;
+	return (int)((const char*)&value.type - (const char*)&value);
+}
+
+int JITFunction::_get_data_offset() {
+	var value;
+	return (int)((const char*)&value._data._int - (const char*)&value);
+}
+
+#ifdef JIT_X86_64
+
+// what the generated code returns to run().
+enum {
+	JIT_INTERPRET = 0,
+	JIT_RETURN = 1,
+	JIT_ERROR = 2,
+};
+
+// a stub returns 0 or the condition of the jump (1), and STUB_ERROR if it caught an exception.
+#define STUB_ERROR -1
+static thread_local std::exception_ptr _stub_error; // thrown again by run().
+
+typedef int (*_JITStub)(var* p_a, var* p_b, var* p_c, uint32_t p_imm);
+typedef int (*_JITCode)(var** p_frame, const uint8_t* p_entry, uint32_t* r_ip, var* r_ret);
+
+#define JIT_STUB(m_name, m_body)                                              \
+	static int m_name(var* p_a, var* p_b, var* p_c, uint32_t p_imm) {         \
+		try {                                                                 \
+			m_body                                                            \
+		} catch (...) {                                                       \
+			_stub_error = std::current_exception();                           \
+			return STUB_ERROR;                                                \
+		}                                                                     \
+	}
+
+JIT_STUB(_stub_move,           *p_c = *p_a; return 0;)
+JIT_STUB(_stub_set_true,       *p_c = true; return 0;)
+JIT_STUB(_stub_set_false,      *p_c = false; return 0;)
+JIT_STUB(_stub_clear,          *p_c = var(); return 0;)
+JIT_STUB(_stub_operator,       PredecodedOps::operator_generic((var::Operator)p_imm, p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_add_int,        PredecodedOps::add_int(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_sub_int,        PredecodedOps::sub_int(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_mul_int,        PredecodedOps::mul_int(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_operator_int,   PredecodedOps::operator_int((var::Operator)p_imm, p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_add_float,      PredecodedOps::add_float(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_sub_float,      PredecodedOps::sub_float(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_mul_float,      PredecodedOps::mul_float(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_operator_float, PredecodedOps::operator_float((var::Operator)p_imm, p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_compare_int,    return PredecodedOps::compare((var::Operator)p_imm, false, p_a, p_b, p_c) ? 1 : 0;)
+JIT_STUB(_stub_compare_float,  return PredecodedOps::compare((var::Operator)p_imm, true, p_a, p_b, p_c) ? 1 : 0;)
+JIT_STUB(_stub_get_mapped,     *p_c = p_a->__get_mapped(*p_b); return 0;)
+JIT_STUB(_stub_get_mapped_unchecked, PredecodedOps::get_mapped_unchecked(p_a, p_b, p_c); return 0;)
+JIT_STUB(_stub_set_mapped,     p_a->__set_mapped(*p_b, *p_c); return 0;)
+JIT_STUB(_stub_call_intrinsic, BuiltinFunctions::call_intrinsic((BuiltinFunctions::Type)p_imm, *p_a, *p_b, *p_c); return 0;)
+JIT_STUB(_stub_truth,          return p_a->operator bool() ? 1 : 0;)
+JIT_STUB(_stub_iter_begin,     *p_c = p_a->__iter_begin(); return 0;)
+JIT_STUB(_stub_iter_next,      if (!p_a->__iter_has_next()) return 1; *p_c = p_a->__iter_next(); return 0;)
+JIT_STUB(_stub_return,         *p_c = (p_a != nullptr) ? *p_a : var(); return 0;) // p_a is nullptr for END.
+
+#undef JIT_STUB
+
+// Writes the x86-64 instructions the JIT uses. rbx is the frame, r12 the address of r_ip and r13 of
+// r_ret for the whole function, the operands are loaded into rdi, rsi and rdx (the arguments of a stub).
+class _X64 {
+public:
+	enum Reg { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R12 = 12, R13 = 13 };
+	enum Cond { CC_E = 0x4, CC_NE = 0x5, CC_S = 0x8, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+	stdvec<uint8_t> code;
+
+	_X64(int p_type_offset, int p_data_offset) : _type_offset(p_type_offset), _data_offset(p_data_offset) {}
+
+	int new_label() { _labels.push_back(-1); return (int)_labels.size() - 1; }
+	void bind(int p_label) { _labels[p_label] = (int)code.size(); }
+	int get_label(int p_label) const { return _labels[p_label]; }
+
+	void push(Reg p_reg) { if (p_reg >= 8) _byte(0x41); _byte(0x50 | (p_reg & 7)); }
+	void pop(Reg p_reg) { if (p_reg >= 8) _byte(0x41); _byte(0x58 | (p_reg & 7)); }
+	void ret() { _byte(0xC3); }
+	void add_rsp(int8_t p_value) { _byte(0x48); _byte(0x83); _byte(0xC4); _byte((uint8_t)p_value); }
+	void sub_rsp(int8_t p_value) { _byte(0x48); _byte(0x83); _byte(0xEC); _byte((uint8_t)p_value); }
+	void jmp_reg(Reg p_reg) { _byte(0xFF); _byte(0xE0 | p_reg); }
+
+	// mov p_dst, p_src (64 bit).
+	void mov(Reg p_dst, Reg p_src) {
+		_byte(0x48 | ((p_src >= 8) ? 0x4 : 0) | ((p_dst >= 8) ? 0x1 : 0));
+		_byte(0x89); _modrm(3, p_src, p_dst);
+	}
+	void mov_imm(Reg p_dst, uint32_t p_value) { _byte(0xB8 | p_dst); _dword(p_value); }
+
+	// mov p_dst, [rbx + p_index * 8]
+	void load_operand(Reg p_dst, uint32_t p_index) { _byte(0x48); _byte(0x8B); _modrm(2, p_dst, RBX); _dword(p_index * 8); }
+	// mov dword [r12], p_ip
+	void store_ip(uint32_t p_ip) { _byte(0x41); _byte(0xC7); _byte(0x04); _byte(0x24); _dword(p_ip); }
+
+	// mov rax, p_func; call rax
+	void call(const void* p_func) {
+		_byte(0x48); _byte(0xB8);
+		uint64_t addr = (uint64_t)(uintptr_t)p_func;
+		for (int i = 0; i < 8; i++) _byte((uint8_t)(addr >> (i * 8)));
+		_byte(0xFF); _byte(0xD0);
+	}
+	void test_eax() { _byte(0x85); _byte(0xC0); }
+	void jmp(int p_label) { _byte(0xE9); _rel32(p_label); }
+	void jcc(Cond p_cond, int p_label) { _byte(0x0F); _byte(0x80 | p_cond); _rel32(p_label); }
+
+	// cmp dword [p_var + type], p_type
+	void cmp_type(Reg p_var, var::Type p_type) { _byte(0x83); _modrm(1, 7, p_var); _byte((uint8_t)_type_offset); _byte((uint8_t)p_type); }
+
+	// the int value of a var in rax.
+	void load_int(Reg p_var) { _byte(0x48); _byte(0x8B); _var_data(RAX, p_var); }
+	void store_int(Reg p_var) { _byte(0x48); _byte(0x89); _var_data(RAX, p_var); }
+	void add_int(Reg p_var) { _byte(0x48); _byte(0x03); _var_data(RAX, p_var); }
+	void sub_int(Reg p_var) { _byte(0x48); _byte(0x2B); _var_data(RAX, p_var); }
+	void mul_int(Reg p_var) { _byte(0x48); _byte(0x0F); _byte(0xAF); _var_data(RAX, p_var); }
+	void cmp_int(Reg p_var) { _byte(0x48); _byte(0x3B); _var_data(RAX, p_var); }
+
+	// setcc al; mov byte [p_var + data], al; movzx eax, al
+	void store_cond(Cond p_cond, Reg p_var) {
+		_byte(0x0F); _byte(0x90 | p_cond); _byte(0xC0);
+		_byte(0x88); _var_data(RAX, p_var);
+		_byte(0x0F); _byte(0xB6); _byte(0xC0);
+	}
+	// movzx eax, byte [p_var + data]
+	void load_bool(Reg p_var) { _byte(0x0F); _byte(0xB6); _var_data(RAX, p_var); }
+
+	// the float value of a var in xmm0, p_op is movsd (load 0x10, store 0x11), addsd, subsd or mulsd.
+	enum SSEOp { SSE_LOAD = 0x10, SSE_STORE = 0x11, SSE_ADD = 0x58, SSE_MUL = 0x59, SSE_SUB = 0x5C };
+	void sse(SSEOp p_op, Reg p_var) { _byte(0xF2); _byte(0x0F); _byte(p_op); _var_data(RAX, p_var); }
+
+	void resolve() {
+		for (const std::pair<int, int>& fixup : _fixups) {
+			ASSERT(_labels[fixup.second] >= 0);
+			int32_t rel = (int32_t)(_labels[fixup.second] - (fixup.first + 4));
+			for (int i = 0; i < 4; i++) code[fixup.first + i] = (uint8_t)((uint32_t)rel >> (i * 8));
+		}
+	}
+
+private:
+	int _type_offset, _data_offset;
+	stdvec<int> _labels;                    // code offset of the labels (-1 if it isn't bound yet).
+	stdvec<std::pair<int, int>> _fixups;    // offset of a rel32 and it's label.
+
+	void _byte(uint8_t p_byte) { code.push_back(p_byte); }
+	void _dword(uint32_t p_value) { for (int i = 0; i < 4; i++) _byte((uint8_t)(p_value >> (i * 8))); }
+	void _modrm(int p_mod, int p_reg, int p_rm) { _byte((uint8_t)((p_mod << 6) | ((p_reg & 7) << 3) | (p_rm & 7))); }
+	void _rel32(int p_label) { _fixups.push_back(std::make_pair((int)code.size(), p_label)); _dword(0); }
+	// [p_var + data] with a disp8, p_var is rdi, rsi or rdx (no SIB byte).
+	void _var_data(Reg p_reg, Reg p_var) { _modrm(1, p_reg, p_var); _byte((uint8_t)_data_offset); }
+};
+
+static _X64::Cond _condition_of(var::Operator p_op) {
+	switch (p_op) {
+		case var::OP_EQ_CHECK:     return _X64::CC_E;
+		case var::OP_NOT_EQ_CHECK: return _X64::CC_NE;
+		case var::OP_LT:           return _X64::CC_L;
+		case var::OP_LTEQ:         return _X64::CC_LE;
+		case var::OP_GT:           return _X64::CC_G;
+		case var::OP_GTEQ:         return _X64::CC_GE;
+		default:
+			THROW_BUG("invalid comparison operator.");
+	}
+}
+
+ptr<JITFunction> JITFunction::compile(const PredecodedFunction* p_predecoded) {
+	const stdvec<PredecodedInstruction>& instructions = p_predecoded->get_instructions();
+	int type_offset = _get_type_offset(), data_offset = _get_data_offset();
+	static_assert(sizeof(var::Type) == 4, "the type of a var is compared as a dword.");
+	if (type_offset >= 128 || data_offset >= 128) return nullptr;
+
+	_X64 x(type_offset, data_offset);
+	stdvec<int> labels;
+	for (size_t i = 0; i < instructions.size(); i++) labels.push_back(x.new_label());
+	int l_interpret = x.new_label(), l_error = x.new_label(), l_exit = x.new_label();
+
+	// int (var** p_frame, const uint8_t* p_entry, uint32_t* r_ip, var* r_ret), the stack is 16 byte aligned after it.
+	x.push(_X64::RBP); x.mov(_X64::RBP, _X64::RSP);
+	x.push(_X64::RBX); x.push(_X64::R12); x.push(_X64::R13); x.sub_rsp(8);
+	x.mov(_X64::RBX, _X64::RDI); x.mov(_X64::R12, _X64::RDX); x.mov(_X64::R13, _X64::RCX);
+	x.jmp_reg(_X64::RSI);
+
+	// calls the stub with the operands p_load ("abc") in rdi, rsi and rdx, and jumps to l_error if it fails.
+	auto call_stub = [&](const PredecodedInstruction& p_instr, _JITStub p_stub, const char* p_load, bool p_cond) {
+		for (const char* c = p_load; *c != '\0'; c++) {
+			if (*c == 'a') x.load_operand(_X64::RDI, p_instr.a);
+			if (*c == 'b') x.load_operand(_X64::RSI, p_instr.b);
+			if (*c == 'c') x.load_operand(_X64::RDX, p_instr.c);
+		}
+		x.mov_imm(_X64::RCX, p_instr.imm);
+		x.call((const void*)p_stub);
+		x.test_eax();
+		x.jcc((p_cond) ? _X64::CC_S : _X64::CC_NE, l_error);
+	};
+
+	for (size_t i = 0; i < instructions.size(); i++) {
+		const PredecodedInstruction& instr = instructions[i];
+		x.bind(labels[i]);
+		if (instr.op != PredecodedInstruction::JUMP) x.store_ip(instr.ip);
+
+		switch (instr.op) {
+			case PredecodedInstruction::INTERPRET:
+				x.jmp(l_interpret);
+				break;
+
+			case PredecodedInstruction::MOVE: {
+				int l_slow = x.new_label(), l_done = x.new_label();
+				x.load_operand(_X64::RDI, instr.a); x.load_operand(_X64::RDX, instr.c);
+				x.cmp_type(_X64::RDI, var::INT); x.jcc(_X64::CC_NE, l_slow);
+				x.cmp_type(_X64::RDX, var::INT); x.jcc(_X64::CC_NE, l_slow);
+				x.load_int(_X64::RDI); x.store_int(_X64::RDX);
+				x.jmp(l_done);
+				x.bind(l_slow);
+				call_stub(instr, _stub_move, "", false);
+				x.bind(l_done);
+			} break;
+			case PredecodedInstruction::SET_TRUE:  call_stub(instr, _stub_set_true, "c", false); break;
+			case PredecodedInstruction::SET_FALSE: call_stub(instr, _stub_set_false, "c", false); break;
+			case PredecodedInstruction::CLEAR:     call_stub(instr, _stub_clear, "c", false); break;
+
+			case PredecodedInstruction::OPERATOR:       call_stub(instr, _stub_operator, "abc", false); break;
+			case PredecodedInstruction::OPERATOR_INT:   call_stub(instr, _stub_operator_int, "abc", false); break;
+			case PredecodedInstruction::OPERATOR_FLOAT: call_stub(instr, _stub_operator_float, "abc", false); break;
+
+			case PredecodedInstruction::ADD_INT:
+			case PredecodedInstruction::SUB_INT:
+			case PredecodedInstruction::MUL_INT:
+			case PredecodedInstruction::ADD_FLOAT:
+			case PredecodedInstruction::SUB_FLOAT:
+			case PredecodedInstruction::MUL_FLOAT: {
+				bool is_int = instr.op == PredecodedInstruction::ADD_INT || instr.op == PredecodedInstruction::SUB_INT ||
+					instr.op == PredecodedInstruction::MUL_INT;
+				var::Type type = (is_int) ? var::INT : var::FLOAT;
+				int l_slow = x.new_label(), l_done = x.new_label();
+				x.load_operand(_X64::RDI, instr.a); x.load_operand(_X64::RSI, instr.b); x.load_operand(_X64::RDX, instr.c);
+				x.cmp_type(_X64::RDI, type); x.jcc(_X64::CC_NE, l_slow);
+				x.cmp_type(_X64::RSI, type); x.jcc(_X64::CC_NE, l_slow);
+				x.cmp_type(_X64::RDX, type); x.jcc(_X64::CC_NE, l_slow);
+
+				_JITStub stub = nullptr;
+				switch (instr.op) {
+					case PredecodedInstruction::ADD_INT:   x.load_int(_X64::RDI); x.add_int(_X64::RSI); stub = _stub_add_int; break;
+					case PredecodedInstruction::SUB_INT:   x.load_int(_X64::RDI); x.sub_int(_X64::RSI); stub = _stub_sub_int; break;
+					case PredecodedInstruction::MUL_INT:   x.load_int(_X64::RDI); x.mul_int(_X64::RSI); stub = _stub_mul_int; break;
+					case PredecodedInstruction::ADD_FLOAT: x.sse(_X64::SSE_LOAD, _X64::RDI); x.sse(_X64::SSE_ADD, _X64::RSI); stub = _stub_add_float; break;
+					case PredecodedInstruction::SUB_FLOAT: x.sse(_X64::SSE_LOAD, _X64::RDI); x.sse(_X64::SSE_SUB, _X64::RSI); stub = _stub_sub_float; break;
+					case PredecodedInstruction::MUL_FLOAT: x.sse(_X64::SSE_LOAD, _X64::RDI); x.sse(_X64::SSE_MUL, _X64::RSI); stub = _stub_mul_float; break;
+					default: break;
+				}
+				if (is_int) x.store_int(_X64::RDX);
+				else x.sse(_X64::SSE_STORE, _X64::RDX);
+				x.jmp(l_done);
+				x.bind(l_slow);
+				call_stub(instr, stub, "", false); // the operands are still loaded.
+				x.bind(l_done);
+			} break;
+
+			case PredecodedInstruction::COMPARE_JUMP_INT:
+			case PredecodedInstruction::COMPARE_JUMP_FLOAT: {
+				if (i + 2 >= instructions.size()) return nullptr; // the jump after it is always followed by another instruction.
+				int l_slow = x.new_label(), l_test = x.new_label();
+				x.load_operand(_X64::RDI, instr.a); x.load_operand(_X64::RSI, instr.b); x.load_operand(_X64::RDX, instr.c);
+				if (instr.op == PredecodedInstruction::COMPARE_JUMP_INT) {
+					x.cmp_type(_X64::RDI, var::INT); x.jcc(_X64::CC_NE, l_slow);
+					x.cmp_type(_X64::RSI, var::INT); x.jcc(_X64::CC_NE, l_slow);
+					x.cmp_type(_X64::RDX, var::BOOL); x.jcc(_X64::CC_NE, l_slow);
+					x.load_int(_X64::RDI); x.cmp_int(_X64::RSI);
+					x.store_cond(_condition_of((var::Operator)instr.imm), _X64::RDX);
+					x.jmp(l_test);
+				}
+				x.bind(l_slow);
+				call_stub(instr, (instr.op == PredecodedInstruction::COMPARE_JUMP_INT) ? _stub_compare_int : _stub_compare_float, "", true);
+				x.bind(l_test);
+				x.test_eax();
+				x.jcc((instr.jump_if) ? _X64::CC_NE : _X64::CC_E, labels[instr.target]);
+				x.jmp(labels[i + 2]); // the jump after it.
+			} break;
+
+			case PredecodedInstruction::GET_MAPPED:           call_stub(instr, _stub_get_mapped, "abc", false); break;
+			case PredecodedInstruction::GET_MAPPED_UNCHECKED: call_stub(instr, _stub_get_mapped_unchecked, "abc", false); break;
+			case PredecodedInstruction::SET_MAPPED:           call_stub(instr, _stub_set_mapped, "abc", false); break;
+			case PredecodedInstruction::CALL_INTRINSIC:       call_stub(instr, _stub_call_intrinsic, "abc", false); break;
+
+			case PredecodedInstruction::JUMP:
+				x.jmp(labels[instr.target]);
+				break;
+			case PredecodedInstruction::JUMP_IF:
+			case PredecodedInstruction::JUMP_IF_NOT: {
+				int l_slow = x.new_label(), l_test = x.new_label();
+				x.load_operand(_X64::RDI, instr.a);
+				x.cmp_type(_X64::RDI, var::BOOL); x.jcc(_X64::CC_NE, l_slow);
+				x.load_bool(_X64::RDI);
+				x.jmp(l_test);
+				x.bind(l_slow);
+				call_stub(instr, _stub_truth, "", true);
+				x.bind(l_test);
+				x.test_eax();
+				x.jcc((instr.op == PredecodedInstruction::JUMP_IF) ? _X64::CC_NE : _X64::CC_E, labels[instr.target]);
+			} break;
+
+			case PredecodedInstruction::ITER_BEGIN:
+				call_stub(instr, _stub_iter_begin, "ac", false);
+				break;
+			case PredecodedInstruction::ITER_NEXT:
+				call_stub(instr, _stub_iter_next, "ac", true);
+				x.jcc(_X64::CC_NE, labels[instr.target]); // the flags of the status.
+				break;
+
+			case PredecodedInstruction::RETURN:
+			case PredecodedInstruction::END:
+				if (instr.op == PredecodedInstruction::RETURN) x.load_operand(_X64::RDI, instr.a);
+				else x.mov_imm(_X64::RDI, 0);
+				x.mov(_X64::RDX, _X64::R13);
+				call_stub(instr, _stub_return, "", false);
+				x.mov_imm(_X64::RAX, JIT_RETURN);
+				x.jmp(l_exit);
+				break;
+		}
+	}
+
+	// r_ip is the position of the instruction which interprets or failed.
+	x.bind(l_interpret);
+	x.mov_imm(_X64::RAX, JIT_INTERPRET);
+	x.jmp(l_exit);
+	x.bind(l_error);
+	x.mov_imm(_X64::RAX, JIT_ERROR);
+	x.bind(l_exit);
+	x.add_rsp(8); x.pop(_X64::R13); x.pop(_X64::R12); x.pop(_X64::RBX); x.pop(_X64::RBP);
+	x.ret();
+	x.resolve();
+
+	// written while it's writable and made executable after it (never both).
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t size = (x.code.size() + page - 1) / page * page;
+	void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED) return nullptr;
+	memcpy(mem, x.code.data(), x.code.size());
+	if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+		munmap(mem, size);
+		return nullptr;
+	}
+
+	ptr<JITFunction> jit = newptr<JITFunction>();
+	jit->_code = (uint8_t*)mem;
+	jit->_code_size = x.code.size();
+	jit->_mapped_size = size;
+	for (int label : labels) jit->_entries.push_back((uint32_t)x.get_label(label));
+	return jit;
+}
+
+JITFunction::~JITFunction() {
+	if (_code != nullptr) munmap(_code, _mapped_size);
+}
+
+bool JITFunction::run(var** p_frame, int p_index, uint32_t& r_ip, var& r_ret) const {
+	ASSERT(p_index >= 0 && p_index < (int)_entries.size());
+	_JITCode code = reinterpret_cast<_JITCode>(reinterpret_cast<uintptr_t>(_code));
+	int status = code(p_frame, _code + _entries[p_index], &r_ip, &r_ret);
+	if (status == JIT_ERROR) {
+		std::exception_ptr error = _stub_error;
+		_stub_error = nullptr;
+		std::rethrow_exception(error);
+	}
+	return status == JIT_RETURN;
+}
+
+#else // JIT_X86_64
+
+ptr<JITFunction> JITFunction::compile(const PredecodedFunction* p_predecoded) {
+	return nullptr;
+}
+
+JITFunction::~JITFunction() {
+}
+
+bool JITFunction::run(var** p_frame, int p_index, uint32_t& r_ip, var& r_ret) const {
+	THROW_BUG("the JIT isn't supported on this platform.");
+}
+
+#endif // JIT_X86_64
+
+}
@@ -32,31 +32,41 @@ String Opcodes::get_opcode_name(Opcode p_opcode) {
 		"GET",
 		"SET",
 		"GET_MAPPED",
+		"GET_MAPPED_UNCHECKED",
 		"SET_MAPPED",
 		"SET_TRUE",
 		"SET_FALSE",
+		"CLEAR",
 		"OPERATOR",
+		"OPERATOR_ASSIGN",
+		"OPERATOR_INT",
+		"OPERATOR_FLOAT",
 		"ASSIGN",
+		"CHECK_TYPE",
 		"CONSTRUCT_BUILTIN",
 		"CONSTRUCT_NATIVE",
 		"CONSTRUCT_CARBON",
 		"CONSTRUCT_LITERAL_ARRAY",
 		"CONSTRUCT_LITERAL_DICT",
+		"CONSTRUCT_LITERAL_CONST",
 		"CALL",
 		"CALL_FUNC",
+		"CALL_DIRECT",
 		"CALL_METHOD",
 		"CALL_BUILTIN",
+		"CALL_INTRINSIC",
 		"CALL_SUPER_CTOR",
 		"CALL_SUPER_METHOD",
 		"JUMP",
 		"JUMP_IF",
 		"JUMP_IF_NOT",
+		"JUMP_IF_DERIVED",
 		"RETURN",
 		"ITER_BEGIN",
 		"ITER_NEXT",
 		"END",
 	};
-	MISSED_ENUM_CHECK(END, 25);
+	MISSED_ENUM_CHECK(END, 35);
 	return _names[p_opcode];
 }
 
@@ -276,6 +286,11 @@ void Opcodes::write_assign_bool(const Address& dst, bool value) {
 	insert(dst);
 }
 
+void Opcodes::write_clear(const Address& p_dst) {
+	insert(Opcode::CLEAR);
+	insert(p_dst);
+}
+
 void Opcodes::write_and_left(const Address& p_left) {
 	insert(Opcode::JUMP_IF_NOT);
 	insert(p_left);
@@ -377,6 +392,12 @@ void Opcodes::write_map_literal(const Address& p_dst, const stdvec<Address>& p_k
 	insert(p_dst);
 }
 
+void Opcodes::write_const_literal(const Address& p_dst, const Address& p_value) {
+	insert(Opcode::CONSTRUCT_LITERAL_CONST);
+	insert(p_value);
+	insert(p_dst);
+}
+
 void Opcodes::write_construct_builtin_type(const Address& p_dst, BuiltinTypes::Type p_type, const stdvec<Address>& p_args) {
 	insert(Opcode::CONSTRUCT_BUILTIN);
 	insert((uint32_t)p_type);
@@ -416,6 +437,14 @@ void Opcodes::write_call_builtin(const Address& p_ret, BuiltinFunctions::Type p_
 	insert(p_ret);
 }
 
+void Opcodes::write_call_intrinsic(const Address& p_ret, BuiltinFunctions::Type p_func, const Address& p_arg0, const Address& p_arg1) {
+	insert(Opcode::CALL_INTRINSIC);
+	insert((uint32_t)p_func);
+	insert(p_arg0);
+	insert(p_arg1);
+	insert(p_ret);
+}
+
 void Opcodes::write_call(const Address& p_ret, const Address& p_on, const stdvec<Address>& p_args) {
 	insert(Opcode::CALL);
 	insert(p_on);
@@ -436,6 +465,17 @@ void Opcodes::write_call_func(const Address& p_ret, uint32_t p_name, const stdve
 	insert(p_ret);
 }
 
+void Opcodes::write_call_direct(const Address& p_ret, uint32_t p_index, uint32_t p_name, const stdvec<Address>& p_args) {
+	insert(Opcode::CALL_DIRECT);
+	insert(p_index);
+	insert(p_name);
+	insert((uint32_t)p_args.size());
+	for (const Address& addr : p_args) {
+		insert(addr);
+	}
+	insert(p_ret);
+}
+
 void Opcodes::write_call_method(const Address& p_ret, Address& p_on, uint32_t p_method, const stdvec<Address>& p_args) {
 	insert(Opcode::CALL_METHOD);
 	insert(p_on);
@@ -473,5 +513,18 @@ void Opcodes::write_operator(const Address& p_dst, var::Operator p_op, const Add
 	insert(p_dst);
 }
 
+void Opcodes::write_operator_assign(const Address& p_dst, var::Operator p_op, const Address& p_value) {
+	insert(Opcode::OPERATOR_ASSIGN);
+	insert((uint32_t)p_op);
+	insert(p_dst);
+	insert(p_value);
+}
+
+void Opcodes::write_check_type(const Address& p_value, var::Type p_type) {
+	insert(Opcode::CHECK_TYPE);
+	insert((uint32_t)p_type);
+	insert(p_value);
+}
+
 
 }
\ No newline at end of file
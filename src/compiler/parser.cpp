@@ -35,6 +35,52 @@
 
 namespace carbon {
 
+constexpr size_t NodeArena::CHUNK_SIZE;
+
+NodeArena::~NodeArena() {
+	for (size_t i = _destructors.size(); i > 0; i--) _destructors[i - 1].second(_destructors[i - 1].first);
+	for (char* chunk : _chunks) ::operator delete(chunk);
+}
+
+void* NodeArena::allocate(size_t p_size, size_t p_align) {
+	size_t pad = (p_align - ((size_t)_current % p_align)) % p_align;
+	if (_current == nullptr || _current + pad + p_size > _end) {
+		// Oversized requests get a chunk of their own.
+		size_t size = std::max(CHUNK_SIZE, p_size + p_align);
+		_current = (char*)::operator new(size);
+		_end = _current + size;
+		_chunks.push_back(_current);
+		_reserved += size;
+		pad = (p_align - ((size_t)_current % p_align)) % p_align;
+	}
+	void* ret = _current + pad;
+	_current += pad + p_size;
+	_allocated += p_size;
+	return ret;
+}
+
+void Parser::BlockNode::add_local_var(VarNode* p_var) {
+	local_vars.push_back(p_var);
+	local_var_names[p_var->name] = p_var;
+}
+
+void Parser::BlockNode::add_local_const(ConstNode* p_const) {
+	local_const.push_back(p_const);
+	local_const_names[p_const->name] = p_const;
+}
+
+Parser::VarNode* Parser::BlockNode::find_local_var(const String& p_name) const {
+	auto it = local_var_names.find(p_name);
+	if (it == local_var_names.end()) return nullptr;
+	return it->second;
+}
+
+Parser::ConstNode* Parser::BlockNode::find_local_const(const String& p_name) const {
+	auto it = local_const_names.find(p_name);
+	if (it == local_const_names.end()) return nullptr;
+	return it->second;
+}
+
 CompileTimeError Parser::_unexp_token_error(const char* p_exptected, const DBGSourceInfo& p_dbg_info) const {
 	Error::Type err_type = Error::SYNTAX_ERROR;
 	if (tokenizer->peek(-1, true).type == Token::_EOF) err_type = Error::UNEXPECTED_EOF;
@@ -67,6 +113,8 @@ CompileTimeError Parser::_predefined_error(const String& p_what, const String& p
 void Parser::parse(ptr<Tokenizer> p_tokenizer) {
 	
 	tokenizer = p_tokenizer;
+	parser_context = ParserContext(); // could refer the nodes of a previous parse.
+	_arena = newptr<NodeArena>();
 	file_node = new_node<FileNode>();
 
 	// TODO: maybe redundant
@@ -78,6 +126,7 @@ void Parser::parse(ptr<Tokenizer> p_tokenizer) {
 		const TokenData& token = tokenizer->next();
 		switch (token.type) {
 			case  Token::_EOF:
+				file_node->declarations_hash = _hash_declarations();
 				return;
 
 			case Token::KWORD_IMPORT: {
@@ -86,12 +135,14 @@ void Parser::parse(ptr<Tokenizer> p_tokenizer) {
 
 			case Token::KWORD_CLASS: {
 				file_node->classes.push_back(_parse_class());
+				file_node->members[file_node->classes.back()->name] = file_node->classes.back();
 			} break;
 
 			case Token::KWORD_ENUM: {
-				ptr<EnumNode> _enum = _parse_enum(file_node);
+				EnumNode* _enum = _parse_enum(file_node);
 				if (_enum->named_enum) {
 					file_node->enums.push_back(_enum);
+					file_node->members[_enum->name] = _enum;
 				} else {
 					if (file_node->unnamed_enum == nullptr) {
 						file_node->unnamed_enum = _enum;
@@ -100,24 +151,37 @@ void Parser::parse(ptr<Tokenizer> p_tokenizer) {
 							file_node->unnamed_enum->values[it->first] = it->second;
 						}
 					}
+					for (auto it = _enum->values.begin(); it != _enum->values.end(); it++) {
+						file_node->members[it->first] = file_node->unnamed_enum;
+					}
 				}
 			} break;
 
 			case Token::KWORD_FUNC: {
-				ptr<FunctionNode> func = _parse_func(file_node);
+				FunctionNode* func = _parse_func(file_node);
 				file_node->functions.push_back(func);
+				file_node->members[func->name] = func;
 			} break;
 
 			case Token::KWORD_VAR: {
-				stdvec<ptr<VarNode>> vars = _parse_var(file_node);
-				for (ptr<VarNode>& _var : vars) {
+				stdvec<VarNode*> vars = _parse_var(file_node);
+				for (VarNode*& _var : vars) {
 					file_node->vars.push_back(_var);
+					file_node->members[_var->name] = _var;
 				}
 			} break;
 
 			case Token::KWORD_CONST: {
-				ptr<ConstNode> _const = _parse_const(file_node);
+				if (tokenizer->peek().type == Token::KWORD_FUNC) {
+					tokenizer->next(); // eat "func"
+					FunctionNode* func = _parse_func(file_node);
+					file_node->functions.push_back(func);
+					file_node->members[func->name] = func;
+					break;
+				}
+				ConstNode* _const = _parse_const(file_node);
 				file_node->constants.push_back(_const);
+				file_node->members[_const->name] = _const;
 			} break;
 
 			// Ignore.
@@ -127,9 +191,9 @@ void Parser::parse(ptr<Tokenizer> p_tokenizer) {
 
 			// compile time function call.
 			case Token::IDENTIFIER: {
-				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.identifier);
+				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.get_identifier());
 				if (builtin_func != BuiltinFunctions::UNKNOWN && BuiltinFunctions::is_compiletime(builtin_func)) {
-					ptr<CallNode> call = new_node<CallNode>();
+					CallNode* call = new_node<CallNode>();
 					call->base = new_node<BuiltinFunctionNode>(builtin_func);
 					if (tokenizer->next().type != Token::BRACKET_LPARAN) throw UNEXP_TOKEN_ERROR("symbol \"(\"");
 					call->args = _parse_arguments(file_node);
@@ -153,54 +217,31 @@ void Parser::_check_identifier_predefinition(const String& p_name, Node* p_scope
 		throw PARSER_ERROR(Error::NAME_ERROR, String::format("a native type named %s already exists", p_name.c_str()), Vect2i());
 	}
 
-	for (ptr<ImportNode>& in : file_node->imports) {
+	for (ImportNode*& in : file_node->imports) {
 		if (p_name == in->name) throw PREDEFINED_ERROR("an imported file", p_name, in->pos);
 	}
 
 	if (p_scope == nullptr || p_scope->type == Node::Type::CLASS || p_scope->type == Node::Type::FILE) {
 		const MemberContainer* scope = nullptr;
 
-		if (p_scope == nullptr) scope = file_node.get();
+		if (p_scope == nullptr) scope = file_node;
 		else scope = static_cast<const MemberContainer*>(p_scope);
 
-		for (int i = 0; i < (int)scope->vars.size(); i++) {
-			if (scope->vars[i]->name == p_name) {
-				throw PREDEFINED_ERROR("a var", scope->vars[i]->name, scope->vars[i]->pos);
-			}
-		}
-
-		for (int i = 0; i < (int)scope->constants.size(); i++) {
-			if (scope->constants[i]->name == p_name) {
-				throw PREDEFINED_ERROR("a constant", scope->constants[i]->name, scope->constants[i]->pos);
-			}
-		}
-
-		for (int i = 0; i < (int)scope->functions.size(); i++) {
-			if (scope->functions[i]->name == p_name) {
-				throw PREDEFINED_ERROR("a function", scope->functions[i]->name, scope->functions[i]->pos);
-			}
-		}
-
-		for (int i = 0; i < (int)scope->enums.size(); i++) {
-			if (scope->enums[i]->name == p_name) {
-				throw PREDEFINED_ERROR("an enum", scope->enums[i]->name, scope->enums[i]->pos);
-			}
-		}
-
-		if (scope->unnamed_enum != nullptr) {
-			for (auto it = scope->unnamed_enum->values.begin(); it != scope->unnamed_enum->values.end(); it++) {
-				if (it->first == p_name) {
-					throw PREDEFINED_ERROR("an enum value", p_name, it->second.pos);
-				}
-			}
-		}
-
-		if (scope->type == Node::Type::FILE) {
-			const Parser::FileNode* p_file = static_cast<const Parser::FileNode*>(scope);
-			for (int i = 0; i < (int)p_file->classes.size(); i++) {
-				if (p_file->classes[i]->name == p_name) {
-					throw PREDEFINED_ERROR("a classe", p_file->classes[i]->name, p_file->classes[i]->pos);
+		Node* member = scope->find_member(p_name);
+		if (member != nullptr) {
+			switch (member->type) {
+				case Node::Type::VAR:      throw PREDEFINED_ERROR("a var", p_name, member->pos);
+				case Node::Type::CONST:    throw PREDEFINED_ERROR("a constant", p_name, member->pos);
+				case Node::Type::FUNCTION: throw PREDEFINED_ERROR("a function", p_name, member->pos);
+				case Node::Type::CLASS:    throw PREDEFINED_ERROR("a classe", p_name, member->pos);
+				case Node::Type::ENUM: {
+					if (member == scope->unnamed_enum) {
+						throw PREDEFINED_ERROR("an enum value", p_name, scope->unnamed_enum->values.at(p_name).pos);
+					}
+					throw PREDEFINED_ERROR("an enum", p_name, member->pos);
 				}
+				default:
+					THROW_BUG("invalid member node type.");
 			}
 		}
 	} else if (p_scope->type == Node::Type::BLOCK) {
@@ -212,36 +253,36 @@ void Parser::_check_identifier_predefinition(const String& p_name, Node* p_scope
 		}
 		const BlockNode* block = static_cast<const BlockNode*>(p_scope);
 		while (block) {
-			for (int i = 0; i < (int)block->local_vars.size(); i++) {
-				if (block->local_vars[i]->name == p_name) {
-					throw  PREDEFINED_ERROR("a variable", p_name, block->local_vars[i]->pos);
-				}
+			const VarNode* local_var = block->find_local_var(p_name);
+			if (local_var != nullptr) {
+				throw  PREDEFINED_ERROR("a variable", p_name, local_var->pos);
 			}
 			if (block->parernt_node->type == Node::Type::FUNCTION) break;
-			block = ptrcast<BlockNode>(block->parernt_node).get();
+			block = static_cast<BlockNode*>(block->parernt_node);
 		}
 	} else {
 		ASSERT(false);
 	}
 }
 
-ptr<Parser::ImportNode> Parser::_parse_import() {
+Parser::ImportNode* Parser::_parse_import() {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_IMPORT);
 
-	ptr<ImportNode> import_node = new_node<ImportNode>();
+	ImportNode* import_node = new_node<ImportNode>();
 
 	const TokenData* tk = &tokenizer->next();
 	if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
 
-	String name = tk->identifier;
+	String name = tk->get_identifier();
 	_check_identifier_predefinition(name, nullptr);
 	import_node->name = name;
 
 	if (tokenizer->next().type != Token::OP_EQ) throw UNEXP_TOKEN_ERROR("symbol \"=\"");
 	tk = &tokenizer->next();
 	if (tk->type != Token::VALUE_STRING) throw UNEXP_TOKEN_ERROR("string path to source");
-	String path = tk->constant.operator String();
+	String path = tk->get_constant().operator String();
 
+	path = Compiler::singleton()->resolve_import(path, Path(file_node->path).parent());
 	import_node->bytecode = Compiler::singleton()->compile(path);
 
 	tk = &tokenizer->next();
@@ -250,12 +291,12 @@ ptr<Parser::ImportNode> Parser::_parse_import() {
 	return import_node;
 }
 
-ptr<Parser::ClassNode> Parser::_parse_class() {
+Parser::ClassNode* Parser::_parse_class() {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_CLASS);
-	ptr<ClassNode> class_node = new_node<ClassNode>();
+	ClassNode* class_node = new_node<ClassNode>();
 	class_node->parernt_node = file_node;
 
-	parser_context.current_class = class_node.get();
+	parser_context.current_class = class_node;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -270,9 +311,9 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 
 	const TokenData* tk = &tokenizer->next();
 	if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-	_check_identifier_predefinition(tk->identifier, nullptr);
+	_check_identifier_predefinition(tk->get_identifier(), nullptr);
 
-	class_node->name = tk->identifier;
+	class_node->name = tk->get_identifier();
 
 	// Inheritance.
 	tk = &tokenizer->next();
@@ -281,7 +322,7 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 		tk = &tokenizer->next();
 		if (tk->type == Token::BUILTIN_TYPE) throw PARSER_ERROR(Error::TYPE_ERROR, "cannot inherit a builtin type.", Vect2i());
 		if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-		class_node->base_class_name = tk->identifier;
+		class_node->base_class_name = tk->get_identifier();
 
 		tk = &tokenizer->next();
 		if (tk->type == Token::SYM_DOT) {
@@ -289,11 +330,11 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 			if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
 
 			String base_file_name  = class_node->base_class_name;
-			String base_class_name = tk->identifier;
+			String base_class_name = tk->get_identifier();
 			class_node->base_type = ClassNode::BASE_EXTERN;
 
 			Bytecode* base_file = nullptr;
-			for (ptr<ImportNode>& in : file_node->imports) {
+			for (ImportNode*& in : file_node->imports) {
 				if (in->name == base_file_name) {
 					base_file = in->bytecode.get();
 					break;
@@ -349,9 +390,10 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 			} break;
 
 			case Token::KWORD_ENUM: {
-				ptr<EnumNode> _enum = _parse_enum(class_node);
+				EnumNode* _enum = _parse_enum(class_node);
 				if (_enum->named_enum) {
 					class_node->enums.push_back(_enum);
+					class_node->members[_enum->name] = _enum;
 				} else {
 					if (class_node->unnamed_enum == nullptr) {
 						class_node->unnamed_enum = _enum;
@@ -360,6 +402,9 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 							class_node->unnamed_enum->values[it->first] = it->second;
 						}
 					}
+					for (auto it = _enum->values.begin(); it != _enum->values.end(); it++) {
+						class_node->members[it->first] = class_node->unnamed_enum;
+					}
 				}
 			} break;
 
@@ -371,27 +416,37 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 			} break;
 
 			case Token::KWORD_FUNC: {
-				ptr<FunctionNode> func = _parse_func(class_node);
+				FunctionNode* func = _parse_func(class_node);
 				class_node->functions.push_back(func);
+				class_node->members[func->name] = func;
 			} break;
 
 			case Token::KWORD_VAR: {
-				stdvec<ptr<VarNode>> vars = _parse_var(class_node);
-				for (ptr<VarNode>& _var : vars) {
+				stdvec<VarNode*> vars = _parse_var(class_node);
+				for (VarNode*& _var : vars) {
 					class_node->vars.push_back(_var);
+					class_node->members[_var->name] = _var;
 				}
 			} break;
 
 			case Token::KWORD_CONST: {
-				ptr<ConstNode> _const = _parse_const(class_node);
+				if (tokenizer->peek().type == Token::KWORD_FUNC) {
+					tokenizer->next(); // eat "func"
+					FunctionNode* func = _parse_func(class_node);
+					class_node->functions.push_back(func);
+					class_node->members[func->name] = func;
+					break;
+				}
+				ConstNode* _const = _parse_const(class_node);
 				class_node->constants.push_back(_const);
+				class_node->members[_const->name] = _const;
 			} break;
 
 			// compile time function call.
 			case Token::IDENTIFIER: {
 
-				ptr<CallNode> call = new_node<CallNode>();
-				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.identifier);
+				CallNode* call = new_node<CallNode>();
+				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.get_identifier());
 				if (builtin_func != BuiltinFunctions::UNKNOWN && BuiltinFunctions::is_compiletime(builtin_func)) {
 					call->base = new_node<BuiltinFunctionNode>(builtin_func);
 					if (tokenizer->next().type != Token::BRACKET_LPARAN) throw UNEXP_TOKEN_ERROR("symbol \"(\"");
@@ -408,14 +463,14 @@ ptr<Parser::ClassNode> Parser::_parse_class() {
 	}
 }
 
-ptr<Parser::EnumNode> Parser::_parse_enum(ptr<Node> p_parent) {
+Parser::EnumNode* Parser::_parse_enum(Node* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_ENUM);
 	ASSERT(p_parent->type == Node::Type::FILE || p_parent->type == Node::Type::CLASS);
 
-	ptr<EnumNode> enum_node = new_node<EnumNode>();
+	EnumNode* enum_node = new_node<EnumNode>();
 	enum_node->parernt_node = p_parent;
 
-	parser_context.current_enum = enum_node.get();
+	parser_context.current_enum = enum_node;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -433,9 +488,9 @@ ptr<Parser::EnumNode> Parser::_parse_enum(ptr<Node> p_parent) {
 		throw UNEXP_TOKEN_ERROR("an identifier or symbol \"{\"");	
 
 	if (tk->type == Token::IDENTIFIER) {
-		_check_identifier_predefinition(tk->identifier, p_parent.get());
+		_check_identifier_predefinition(tk->get_identifier(), p_parent);
 
-		enum_node->name = tk->identifier;
+		enum_node->name = tk->get_identifier();
 		enum_node->named_enum = true;
 		tk = &tokenizer->next();
 	}
@@ -463,15 +518,15 @@ ptr<Parser::EnumNode> Parser::_parse_enum(ptr<Node> p_parent) {
 
 			case Token::IDENTIFIER: {
 				for (const std::pair<String, EnumValueNode>& value : enum_node->values) {
-					if (value.first == token.identifier) throw PREDEFINED_ERROR("an enum value", value.first, value.second.pos);
+					if (value.first == token.get_identifier()) throw PREDEFINED_ERROR("an enum value", value.first, value.second.pos);
 				}
 
 				if (!enum_node->named_enum) {
 
 					// TODO: check if it's compile time function.
-					//BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.identifier);
+					//BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(token.get_identifier());
 					//if (builtin_func != BuiltinFunctions::UNKNOWN && BuiltinFunctions::is_compiletime(builtin_func)) {
-					//	ptr<CallNode> call = new_node<CallNode>();
+					//	CallNode* call = new_node<CallNode>();
 					//	call->base = new_node<BuiltinFunctionNode>(builtin_func);
 					//	if (tokenizer->next().type != Token::BRACKET_LPARAN) throw UNEXP_TOKEN_ERROR("symbol \"(\"");
 					//	call->args = _parse_arguments(file_node);
@@ -481,16 +536,16 @@ ptr<Parser::EnumNode> Parser::_parse_enum(ptr<Node> p_parent) {
 					//	break;
 					//}
 
-					_check_identifier_predefinition(token.identifier, p_parent.get());
+					_check_identifier_predefinition(token.get_identifier(), p_parent);
 				}
 				
 				const TokenData* tk = &tokenizer->peek();
 				if (tk->type == Token::OP_EQ) {
 					tk = &tokenizer->next(); // eat "=".
-					ptr<Node> expr = _parse_expression(enum_node, false);
-					enum_node->values[token.identifier] = EnumValueNode(expr, token.get_pos(), (enum_node->named_enum) ? enum_node.get() : nullptr);
+					Node* expr = _parse_expression(enum_node, false);
+					enum_node->values[token.get_identifier()] = EnumValueNode(expr, token.get_pos(), (enum_node->named_enum) ? enum_node : nullptr);
 				} else {
-					enum_node->values[token.identifier] = EnumValueNode(nullptr, token.get_pos(), (enum_node->named_enum) ? enum_node.get() : nullptr);
+					enum_node->values[token.get_identifier()] = EnumValueNode(nullptr, token.get_pos(), (enum_node->named_enum) ? enum_node : nullptr);
 				}
 
 				comma_valid = true;
@@ -503,7 +558,7 @@ ptr<Parser::EnumNode> Parser::_parse_enum(ptr<Node> p_parent) {
 	}
 }
 
-stdvec<ptr<Parser::VarNode>> Parser::_parse_var(ptr<Node> p_parent) {
+stdvec<Parser::VarNode*> Parser::_parse_var(Node* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_VAR);
 	ASSERT(p_parent != nullptr);
 	ASSERT(p_parent->type == Node::Type::FILE || p_parent->type == Node::Type::BLOCK || p_parent->type == Node::Type::CLASS);
@@ -511,20 +566,26 @@ stdvec<ptr<Parser::VarNode>> Parser::_parse_var(ptr<Node> p_parent) {
 	bool _static = p_parent->type == Node::Type::FILE || tokenizer->peek(-2, true).type == Token::KWORD_STATIC;
 
 	const TokenData* tk;
-	stdvec<ptr<VarNode>> vars;
+	stdvec<VarNode*> vars;
 
 	while (true) {
 		tk = &tokenizer->next();
 
 		if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-		_check_identifier_predefinition(tk->identifier, p_parent.get());
+		_check_identifier_predefinition(tk->get_identifier(), p_parent);
 
-		ptr<VarNode> var_node = new_node<VarNode>();
+		VarNode* var_node = new_node<VarNode>();
 		var_node->parernt_node = p_parent;
 		var_node->is_static = _static;
-		var_node->name = tk->identifier;
+		var_node->name = tk->get_identifier();
+
+		if (tokenizer->peek().type == Token::SYM_COLLON) {
+			if (p_parent->type != Node::Type::BLOCK) throw PARSER_ERROR(Error::SYNTAX_ERROR, "only local variables could have a type annotation.", tk->get_pos());
+			tokenizer->next(); // eat ":"
+			var_node->data_type = _parse_type_annotation();
+		}
 
-		parser_context.current_var = var_node.get();
+		parser_context.current_var = var_node;
 		class ScopeDestruct {
 		public:
 			Parser::ParserContext* context = nullptr;
@@ -539,7 +600,7 @@ stdvec<ptr<Parser::VarNode>> Parser::_parse_var(ptr<Node> p_parent) {
 
 		tk = &tokenizer->next();
 		if (tk->type == Token::OP_EQ) {
-			ptr<Node> expr = _parse_expression(p_parent, false);
+			Node* expr = _parse_expression(p_parent, false);
 			var_node->assignment = expr;
 
 			tk = &tokenizer->next();
@@ -562,7 +623,7 @@ stdvec<ptr<Parser::VarNode>> Parser::_parse_var(ptr<Node> p_parent) {
 	return vars;
 }
 
-ptr<Parser::ConstNode> Parser::_parse_const(ptr<Node> p_parent) {
+Parser::ConstNode* Parser::_parse_const(Node* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_CONST);
 	ASSERT(p_parent != nullptr);
 	ASSERT(p_parent->type == Node::Type::FILE || p_parent->type == Node::Type::BLOCK || p_parent->type == Node::Type::CLASS);
@@ -571,13 +632,13 @@ ptr<Parser::ConstNode> Parser::_parse_const(ptr<Node> p_parent) {
 	tk = &tokenizer->next();
 
 	if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-	_check_identifier_predefinition(tk->identifier, p_parent.get());
+	_check_identifier_predefinition(tk->get_identifier(), p_parent);
 
-	ptr<ConstNode> const_node = new_node<ConstNode>();
+	ConstNode* const_node = new_node<ConstNode>();
 	const_node->parernt_node = p_parent;
-	const_node->name = tk->identifier;
+	const_node->name = tk->get_identifier();
 
-	parser_context.current_const = const_node.get();
+	parser_context.current_const = const_node;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -592,7 +653,7 @@ ptr<Parser::ConstNode> Parser::_parse_const(ptr<Node> p_parent) {
 
 	tk = &tokenizer->next();
 	if (tk->type != Token::OP_EQ) throw UNEXP_TOKEN_ERROR("symbol \"=\"");
-	ptr<Node> expr = _parse_expression(p_parent, false);
+	Node* expr = _parse_expression(p_parent, false);
 	const_node->assignment = expr;
 
 	tk = &tokenizer->next();
@@ -601,17 +662,39 @@ ptr<Parser::ConstNode> Parser::_parse_const(ptr<Node> p_parent) {
 	return const_node;
 }
 
-ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
+uint64_t Parser::_hash_declarations() const {
+	stdvec<std::pair<int, int>> functions;
+	for (FunctionNode* func : file_node->functions) functions.push_back({ func->token_begin, func->token_end });
+	for (ClassNode* class_node : file_node->classes) {
+		for (FunctionNode* func : class_node->functions) functions.push_back({ func->token_begin, func->token_end });
+	}
+	std::sort(functions.begin(), functions.end());
+
+	uint64_t hash = 14695981039346656037ull;
+	int begin = 0;
+	for (const std::pair<int, int>& func : functions) {
+		hash = (hash ^ tokenizer->hash_tokens(begin, func.first)) * 1099511628211ull;
+		begin = func.second;
+	}
+	return (hash ^ tokenizer->hash_tokens(begin, (int)tokenizer->get_token_count())) * 1099511628211ull;
+}
+
+Parser::FunctionNode* Parser::_parse_func(Node* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_FUNC);
 	ASSERT(p_parent->type == Node::Type::FILE || p_parent->type == Node::Type::CLASS);
 
-	ptr<FunctionNode> func_node = new_node<FunctionNode>();
-	func_node->parent_node = p_parent.get();
+	FunctionNode* func_node = new_node<FunctionNode>();
+	func_node->parent_node = p_parent;
+	func_node->token_begin = tokenizer->get_token_index() - 1;
 	if (p_parent->type == Node::Type::FILE || tokenizer->peek(-2, true).type == Token::KWORD_STATIC) {
 		func_node->is_static = true;
 	}
+	if (tokenizer->peek(-2, true).type == Token::KWORD_CONST) {
+		func_node->is_const = true;
+		func_node->is_static = true; // a const function never has access to an instance.
+	}
 
-	parser_context.current_func = func_node.get();
+	parser_context.current_func = func_node;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -626,12 +709,13 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 
 	const TokenData* tk = &tokenizer->next();
 	if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-	_check_identifier_predefinition(tk->identifier, p_parent.get());
+	_check_identifier_predefinition(tk->get_identifier(), p_parent);
 
-	func_node->name = tk->identifier;
-	if (parser_context.current_class && parser_context.current_class->name == tk->identifier) {
+	func_node->name = tk->get_identifier();
+	if (parser_context.current_class && parser_context.current_class->name == tk->get_identifier()) {
+		if (func_node->is_const) throw PARSER_ERROR(Error::SYNTAX_ERROR, "constructor can't be a const function.", tk->get_pos());
 		func_node->is_constructor = true;
-		parser_context.current_class->constructor = func_node.get();
+		parser_context.current_class->constructor = func_node;
 	}
 
 	tk = &tokenizer->next();
@@ -643,11 +727,11 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 		while (true) {
 			if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
 			for (int i = 0; i < (int)func_node->args.size(); i++) {
-				if (func_node->args[i].name == tk->identifier)
-					throw PARSER_ERROR(Error::NAME_ERROR, String::format("identifier \"%s\" already defined in arguments", tk->identifier.c_str()), Vect2i());
+				if (func_node->args[i].name == tk->get_identifier())
+					throw PARSER_ERROR(Error::NAME_ERROR, String::format("identifier \"%s\" already defined in arguments", tk->get_identifier().c_str()), Vect2i());
 			}
 
-			ParameterNode parameter = ParameterNode(tk->identifier, tk->get_pos());
+			ParameterNode parameter = ParameterNode(tk->get_identifier(), tk->get_pos());
 			tk = &tokenizer->next();
 
 			if (tk->type == Token::OP_BIT_AND) {
@@ -655,6 +739,12 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 				tk = &tokenizer->next();
 			}
 
+			if (tk->type == Token::SYM_COLLON) {
+				if (parameter.is_reference) throw PARSER_ERROR(Error::SYNTAX_ERROR, "a reference parameter can't have a type annotation.", tk->get_pos());
+				parameter.type = _parse_type_annotation();
+				tk = &tokenizer->next();
+			}
+
 			if (tk->type == Token::OP_EQ) {
 				has_default = true;
 				parameter.default_value = _parse_expression(p_parent, false);
@@ -675,6 +765,12 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 		}
 	}
 
+	if (tokenizer->peek().type == Token::SYM_COLLON) {
+		tk = &tokenizer->next(); // eat ":"
+		if (func_node->is_constructor) throw PARSER_ERROR(Error::SYNTAX_ERROR, "constructor can't have a return type.", tk->get_pos());
+		func_node->return_type = _parse_type_annotation();
+	}
+
 	const TokenData& _next = tokenizer->next();
 	bool _single_expr = false;
 
@@ -693,10 +789,10 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 			}
 		}
 
-		ptr<BlockNode> block_node = newptr<BlockNode>();
+		BlockNode* block_node = alloc_node<BlockNode>();
 		block_node->parernt_node = func_node;
 
-		ptr<ControlFlowNode> _return = new_node<ControlFlowNode>(ControlFlowNode::RETURN);
+		ControlFlowNode* _return = new_node<ControlFlowNode>(ControlFlowNode::RETURN);
 		_return->args.push_back(_parse_expression(func_node, false));
 		_return->parernt_node = func_node;
 		_return->_return = parser_context.current_func;
@@ -716,9 +812,19 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 		func_node->end_line = (uint32_t)tokenizer->get_pos().x;
 	}
 
+	func_node->token_end = tokenizer->get_token_index();
+	func_node->tokens_hash = tokenizer->hash_tokens(func_node->token_begin, func_node->token_end);
 	return func_node;
 }
 
+var::Type Parser::_parse_type_annotation() {
+	ASSERT(tokenizer->peek(-1).type == Token::SYM_COLLON);
+
+	const TokenData* tk = &tokenizer->next();
+	if (tk->type != Token::BUILTIN_TYPE || tk->builtin_type == BuiltinTypes::_NULL) throw UNEXP_TOKEN_ERROR("a type name");
+	return BuiltinTypes::get_var_type(tk->builtin_type);
+}
+
 }
 
 /******************************************************************************************************************/
@@ -727,11 +833,11 @@ ptr<Parser::FunctionNode> Parser::_parse_func(ptr<Node> p_parent) {
 
 namespace carbon {
 
-ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_single_statement, stdvec<Token> p_termination) {
-	ptr<BlockNode> block_node = newptr<BlockNode>();
+Parser::BlockNode* Parser::_parse_block(Node* p_parent, bool p_single_statement, stdvec<Token> p_termination) {
+	BlockNode* block_node = alloc_node<BlockNode>();
 	block_node->parernt_node = p_parent;
 
-	parser_context.current_block = block_node.get();
+	parser_context.current_block = block_node;
 	class ScopeDestruct {
 	public:
 		Parser::ParserContext* context = nullptr;
@@ -755,17 +861,17 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 			case Token::KWORD_VAR: {
 				tokenizer->next(); // eat "var"
-				stdvec<ptr<VarNode>> vars = _parse_var(block_node);
-				for (ptr<VarNode>& _var : vars) {
-					block_node->local_vars.push_back(_var); // for quick access.
+				stdvec<VarNode*> vars = _parse_var(block_node);
+				for (VarNode*& _var : vars) {
+					block_node->add_local_var(_var); // for quick access.
 					block_node->statements.push_back(_var);
 				}
 			} break;
 
 			case Token::KWORD_CONST: {
 				tokenizer->next(); // ear "const"
-				ptr<ConstNode> _const = _parse_const(block_node);
-				block_node->local_const.push_back(_const);
+				ConstNode* _const = _parse_const(block_node);
+				block_node->add_local_const(_const);
 				block_node->statements.push_back(_const);
 			} break;
 
@@ -781,7 +887,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 				//case Token::VALUE_FLOAT:
 				//case Token::VALUE_STRING: {
 				//	tk = &tokenizer->next(); // will be ignored by analyzer
-				//	ptr<ConstValueNode> value = new_node<ConstValueNode>(tk->constant);
+				//	ConstValueNode* value = new_node<ConstValueNode>(tk->get_constant());
 				//	block_node->statements.push_back(value);
 				//} break;
 
@@ -792,10 +898,10 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 			case Token::KWORD_SWITCH: {
 				tk = &tokenizer->next(); // eat "switch"
-				ptr<ControlFlowNode> switch_block = new_node<ControlFlowNode>(ControlFlowNode::SWITCH);
+				ControlFlowNode* switch_block = new_node<ControlFlowNode>(ControlFlowNode::SWITCH);
 				switch_block->parernt_node = p_parent;
 				ControlFlowNode* outer_break = parser_context.current_break;
-				parser_context.current_break = switch_block.get();
+				parser_context.current_break = switch_block;
 
 				switch_block->args.push_back(_parse_expression(block_node, false));
 				if (tokenizer->next().type != Token::BRACKET_LCUR) throw UNEXP_TOKEN_ERROR("symbol \"{\"");
@@ -836,12 +942,12 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 			case Token::KWORD_WHILE: {
 				tk = &tokenizer->next(); // eat "while"
-				ptr<ControlFlowNode> while_block = new_node<ControlFlowNode>(ControlFlowNode::WHILE);
+				ControlFlowNode* while_block = new_node<ControlFlowNode>(ControlFlowNode::WHILE);
 
 				ControlFlowNode* outer_break = parser_context.current_break;
 				ControlFlowNode* outer_continue = parser_context.current_continue;
-				parser_context.current_break = while_block.get();
-				parser_context.current_continue = while_block.get();
+				parser_context.current_break = while_block;
+				parser_context.current_continue = while_block;
 
 				while_block->parernt_node = p_parent;
 				while_block->args.push_back(_parse_expression(block_node, false));
@@ -860,11 +966,11 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 			case Token::KWORD_FOR: {
 				tk = &tokenizer->next(); // eat "for"
-				ptr<ControlFlowNode> for_block = new_node<ControlFlowNode>(ControlFlowNode::FOR);
+				ControlFlowNode* for_block = new_node<ControlFlowNode>(ControlFlowNode::FOR);
 				ControlFlowNode* outer_break = parser_context.current_break;
 				ControlFlowNode* outer_continue = parser_context.current_continue;
-				parser_context.current_break = for_block.get();
-				parser_context.current_continue = for_block.get();
+				parser_context.current_break = for_block;
+				parser_context.current_continue = for_block;
 
 				for_block->parernt_node = p_parent;
 				if (tokenizer->next().type != Token::BRACKET_LPARAN) throw UNEXP_TOKEN_ERROR("symbol \"(\"");
@@ -878,16 +984,23 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 						tk = &tokenizer->next();
 						if (tk->type != Token::IDENTIFIER) throw UNEXP_TOKEN_ERROR("an identifier");
-						_check_identifier_predefinition(tk->identifier, block_node.get());
+						_check_identifier_predefinition(tk->get_identifier(), block_node);
 
-						ptr<VarNode> var_node = new_node<VarNode>();
+						VarNode* var_node = new_node<VarNode>();
 						var_node->parernt_node = p_parent;
-						var_node->name = tk->identifier;
+						var_node->name = tk->get_identifier();
+
+						// `for (var i: int = 0; ...)` (`for (var x : String(...))` is a foreach).
+						if (tokenizer->peek().type == Token::SYM_COLLON && tokenizer->peek(1, true).type == Token::BUILTIN_TYPE &&
+							(tokenizer->peek(2, true).type == Token::OP_EQ || tokenizer->peek(2, true).type == Token::SYM_SEMI_COLLON)) {
+							tokenizer->next(); // eat ":"
+							var_node->data_type = _parse_type_annotation();
+						}
 
 						tk = &tokenizer->next();
 						if (tk->type == Token::OP_EQ) {
-							parser_context.current_var = var_node.get();
-							ptr<Node> expr = _parse_expression(p_parent, false);
+							parser_context.current_var = var_node;
+							Node* expr = _parse_expression(p_parent, false);
 							parser_context.current_var = nullptr;
 							var_node->assignment = expr;
 							if (tokenizer->next().type != Token::SYM_SEMI_COLLON) throw UNEXP_TOKEN_ERROR("symbol \";\"");
@@ -934,7 +1047,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 
 				// add loop counter initialization to local vars.
 				if (for_block->args[0] != nullptr && for_block->args[0]->type == Node::Type::VAR) {
-					for_block->body->local_vars.insert(for_block->body->local_vars.begin(), ptrcast<VarNode>(for_block->args[0]));
+					for_block->body->add_local_var(static_cast<VarNode*>(for_block->args[0]));
 				}
 
 				block_node->statements.push_back(for_block);
@@ -945,7 +1058,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 			case Token::KWORD_BREAK: {
 				tk = &tokenizer->next(); // eat "break"
 				if (!parser_context.current_break) throw PARSER_ERROR(Error::SYNTAX_ERROR, "can't use break outside a loop/switch.", tk->get_pos());
-				ptr<ControlFlowNode> _break = new_node<ControlFlowNode>(ControlFlowNode::BREAK);
+				ControlFlowNode* _break = new_node<ControlFlowNode>(ControlFlowNode::BREAK);
 				_break->break_continue = parser_context.current_break;
 				parser_context.current_break->has_break = true;
 				_break->parernt_node = p_parent;
@@ -955,7 +1068,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 			case Token::KWORD_CONTINUE: {
 				tk = &tokenizer->next(); // eat "continue"
 				if (!parser_context.current_continue) throw PARSER_ERROR(Error::SYNTAX_ERROR, "can't use continue outside a loop.", tk->get_pos());
-				ptr<ControlFlowNode> _continue = new_node<ControlFlowNode>(ControlFlowNode::CONTINUE);
+				ControlFlowNode* _continue = new_node<ControlFlowNode>(ControlFlowNode::CONTINUE);
 				_continue->break_continue = parser_context.current_continue;
 				parser_context.current_continue->has_continue = true;
 				_continue->parernt_node = p_parent;
@@ -970,7 +1083,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 						throw PARSER_ERROR(Error::SYNTAX_ERROR, "constructor can't return anything.", tk->get_pos());
 					}
 				}
-				ptr<ControlFlowNode> _return = new_node<ControlFlowNode>(ControlFlowNode::RETURN);
+				ControlFlowNode* _return = new_node<ControlFlowNode>(ControlFlowNode::RETURN);
 				if (tokenizer->peek().type != Token::SYM_SEMI_COLLON)  _return->args.push_back(_parse_expression(block_node, false));
 				_return->parernt_node = p_parent;
 				_return->_return = parser_context.current_func;
@@ -985,7 +1098,7 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 						return block_node;
 					}
 				}
-				ptr<Node> expr = _parse_expression(block_node, true);
+				Node* expr = _parse_expression(block_node, true);
 				if (tokenizer->next().type != Token::SYM_SEMI_COLLON) throw UNEXP_TOKEN_ERROR("symbol \";\"");
 				block_node->statements.push_back(expr);
 			}
@@ -999,12 +1112,12 @@ ptr<Parser::BlockNode> Parser::_parse_block(const ptr<Node>& p_parent, bool p_si
 }
 
 
-ptr<Parser::ControlFlowNode> Parser::_parse_if_block(const ptr<BlockNode>& p_parent) {
+Parser::ControlFlowNode* Parser::_parse_if_block(BlockNode* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::KWORD_IF);
 
-	ptr<ControlFlowNode> if_block = new_node<ControlFlowNode>(ControlFlowNode::IF);
+	ControlFlowNode* if_block = new_node<ControlFlowNode>(ControlFlowNode::IF);
 	if_block->parernt_node = p_parent;
-	ptr<Node> cond = _parse_expression(p_parent, false);
+	Node* cond = _parse_expression(p_parent, false);
 	if_block->args.push_back(cond);
 
 	const TokenData* tk = &tokenizer->peek();
@@ -1050,7 +1163,7 @@ ptr<Parser::ControlFlowNode> Parser::_parse_if_block(const ptr<BlockNode>& p_par
 
 namespace carbon {
 
-ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_allow_assign) {
+Parser::Node* Parser::_parse_expression(Node* p_parent, bool p_allow_assign) {
 	p_allow_assign = true; // all expressions suport assignment now (test for any bugs)
 	ASSERT(p_parent != nullptr);
 
@@ -1059,7 +1172,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 	while (true) {
 
 		const TokenData* tk = &tokenizer->next();
-		ptr<Node> expr = nullptr;
+		Node* expr = nullptr;
 
 		if (tk->type == Token::BRACKET_LPARAN) {
 			expr = _parse_expression(p_parent, false);
@@ -1075,7 +1188,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 				throw PARSER_ERROR(Error::SYNTAX_ERROR, "keyword \"this\" only be used in non-static member function.", Vect2i());
 			if (tokenizer->peek().type == Token::BRACKET_LPARAN) { // super();
 				tk = &tokenizer->next(); // eat "("
-				ptr<CallNode> call = new_node<CallNode>();
+				CallNode* call = new_node<CallNode>();
 				call->base = new_node<ThisNode>();
 				call->method = nullptr;
 				call->args = _parse_arguments(p_parent);
@@ -1092,7 +1205,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 			}
 			if (tokenizer->peek().type == Token::BRACKET_LPARAN) { // super();
 				tk = &tokenizer->next(); // eat "("
-				ptr<CallNode> call = new_node<CallNode>();
+				CallNode* call = new_node<CallNode>();
 				call->base = new_node<SuperNode>();
 				call->method = nullptr;
 				call->args = _parse_arguments(p_parent);
@@ -1102,7 +1215,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 			}
 
 		} else if (tk->type == Token::VALUE_FLOAT || tk->type == Token::VALUE_INT || tk->type == Token::VALUE_STRING || tk->type == Token::VALUE_BOOL || tk->type == Token::VALUE_NULL) {
-			expr = new_node<ConstValueNode>(tk->constant);
+			expr = new_node<ConstValueNode>(tk->get_constant());
 
 		} else if (tk->type == Token::OP_PLUS || tk->type == Token::OP_MINUS || tk->type == Token::OP_NOT || tk->type == Token::OP_BIT_NOT) {
 			switch (tk->type) {
@@ -1121,10 +1234,10 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 			}
 			continue;
 		} else if ((tk->type == Token::IDENTIFIER || tk->type == Token::BUILTIN_TYPE) && tokenizer->peek().type == Token::BRACKET_LPARAN) {
-			ptr<CallNode> call = new_node<CallNode>();
+			CallNode* call = new_node<CallNode>();
 
 			if (tk->type == Token::IDENTIFIER) {
-				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(tk->identifier);
+				BuiltinFunctions::Type builtin_func = BuiltinFunctions::get_func_type(tk->get_identifier());
 				if (builtin_func != BuiltinFunctions::UNKNOWN) {
 					call->is_compilttime = BuiltinFunctions::is_compiletime(builtin_func);
 					call->base = new_node<BuiltinFunctionNode>(builtin_func);
@@ -1133,7 +1246,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 					// Identifier node could be builtin class like File(), another static method, ...
 					// will know when reducing.
 					call->base = new_node<Node>(); // UNKNOWN on may/may-not be self
-					call->method = new_node<IdentifierNode>(tk->identifier);
+					call->method = new_node<IdentifierNode>(tk->get_identifier());
 				}
 			} else {
 				call->base = new_node<BuiltinTypeNode>(tk->builtin_type);
@@ -1146,22 +1259,22 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 			expr = call;
 
 		} else if (tk->type == Token::IDENTIFIER) {
-			BuiltinFunctions::Type bif_type = BuiltinFunctions::get_func_type(tk->identifier);
+			BuiltinFunctions::Type bif_type = BuiltinFunctions::get_func_type(tk->get_identifier());
 			if (bif_type != BuiltinFunctions::UNKNOWN) {
-				ptr<BuiltinFunctionNode> bif = new_node<BuiltinFunctionNode>(bif_type);
+				BuiltinFunctionNode* bif = new_node<BuiltinFunctionNode>(bif_type);
 				expr = bif;
 			} else {
-				ptr<IdentifierNode> id = new_node<IdentifierNode>(tk->identifier);
+				IdentifierNode* id = new_node<IdentifierNode>(tk->get_identifier());
 				id->declared_block = parser_context.current_block;
 				expr = id;
 			}
 
 		} else if (tk->type == Token::BUILTIN_TYPE) { // String.format(...);
-			ptr<BuiltinTypeNode> bt = new_node<BuiltinTypeNode>(tk->builtin_type);
+			BuiltinTypeNode* bt = new_node<BuiltinTypeNode>(tk->builtin_type);
 			expr = bt;
 
 		} else if (tk->type == Token::BRACKET_LSQ) {
-			ptr<ArrayNode> arr = new_node<ArrayNode>();
+			ArrayNode* arr = new_node<ArrayNode>();
 			bool done = false;
 			bool comma_valid = false;
 			while (!done) {
@@ -1185,7 +1298,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 					default:
 						if (comma_valid) throw UNEXP_TOKEN_ERROR("symbol \",\"");
 
-						ptr<Node> subexpr = _parse_expression(p_parent, false);
+						Node* subexpr = _parse_expression(p_parent, false);
 						arr->elements.push_back(subexpr);
 						comma_valid = true;
 				}
@@ -1193,7 +1306,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 			expr = arr;
 
 		} else if (tk->type == Token::BRACKET_LCUR) {
-			ptr<MapNode> map = new_node<MapNode>();
+			MapNode* map = new_node<MapNode>();
 			bool done = false;
 			bool comma_valid = false;
 			while (!done) {
@@ -1215,10 +1328,10 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 					default:
 						if (comma_valid) throw UNEXP_TOKEN_ERROR("symbol \",\"");
 
-						ptr<Node> key = _parse_expression(p_parent, false);
+						Node* key = _parse_expression(p_parent, false);
 						tk = &tokenizer->next();
 						if (tk->type != Token::SYM_COLLON) throw UNEXP_TOKEN_ERROR("symbol \":\"");
-						ptr<Node> value = _parse_expression(p_parent, false);
+						Node* value = _parse_expression(p_parent, false);
 						map->elements.push_back(Parser::MapNode::Pair(key, value));
 						comma_valid = true;
 				}
@@ -1241,29 +1354,29 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 
 				// call
 				if (tokenizer->peek().type == Token::BRACKET_LPARAN) {
-					ptr<CallNode> call = new_node<CallNode>();
+					CallNode* call = new_node<CallNode>();
 
 					call->base = expr;
-					call->method = new_node<IdentifierNode>(tk->identifier);
+					call->method = new_node<IdentifierNode>(tk->get_identifier());
 					tk = &tokenizer->next(); // eat "("
 					call->args = _parse_arguments(p_parent);
 					expr = call;
 
 					// Just indexing.
 				} else {
-					ptr<IndexNode> ind = new_node<IndexNode>();
+					IndexNode* ind = new_node<IndexNode>();
 					ind->base = expr;
-					ind->member = new_node<IdentifierNode>(tk->identifier);
+					ind->member = new_node<IdentifierNode>(tk->get_identifier());
 					expr = ind;
 				}
 
 
 				// [mapped_index]
 			} else if (tk->type == Token::BRACKET_LSQ) {
-				ptr<MappedIndexNode> ind_mapped = new_node<MappedIndexNode>();
+				MappedIndexNode* ind_mapped = new_node<MappedIndexNode>();
 
 				tk = &tokenizer->next(); // eat "["
-				ptr<Node> key = _parse_expression(p_parent, false);
+				Node* key = _parse_expression(p_parent, false);
 				tk = &tokenizer->next();
 				if (tk->type != Token::BRACKET_RSQ) {
 					throw UNEXP_TOKEN_ERROR("symbol \"]\"");
@@ -1275,7 +1388,7 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 
 				// get_func()(...);
 			} else if (tk->type == Token::BRACKET_LPARAN) {
-				ptr<CallNode> call = new_node<CallNode>();
+				CallNode* call = new_node<CallNode>();
 
 				call->base = expr;
 				call->method = nullptr;
@@ -1345,9 +1458,9 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 		}
 	}
 
-	ptr<Node> op_tree = _build_operator_tree(expressions);
+	Node* op_tree = _build_operator_tree(expressions);
 	if (op_tree->type == Node::Type::OPERATOR) {
-		if (!p_allow_assign && OperatorNode::is_assignment(ptrcast<OperatorNode>(op_tree)->op_type)) {
+		if (!p_allow_assign && OperatorNode::is_assignment(static_cast<OperatorNode*>(op_tree)->op_type)) {
 			throw PARSER_ERROR(Error::SYNTAX_ERROR, "assignment is not allowed inside expression.", op_tree->pos);
 		}
 	}
@@ -1355,18 +1468,18 @@ ptr<Parser::Node> Parser::_parse_expression(const ptr<Node>& p_parent, bool p_al
 
 }
 
-stdvec<ptr<Parser::Node>> Parser::_parse_arguments(const ptr<Node>& p_parent) {
+stdvec<Parser::Node*> Parser::_parse_arguments(Node* p_parent) {
 	ASSERT(tokenizer->peek(-1).type == Token::BRACKET_LPARAN);
 
 	const TokenData* tk = &tokenizer->peek();
-	stdvec<ptr<Node>> args;
+	stdvec<Node*> args;
 
 	if (tk->type == Token::BRACKET_RPARAN) {
 		tokenizer->next(); // eat BRACKET_RPARAN
 	} else {
 		while (true) {
 
-			ptr<Node> arg = _parse_expression(p_parent, false);
+			Node* arg = _parse_expression(p_parent, false);
 			args.push_back(arg);
 
 			tk = &tokenizer->next();
@@ -1437,7 +1550,7 @@ int Parser::_get_operator_precedence(OperatorNode::OpType p_op) {
 	MISSED_ENUM_CHECK(OperatorNode::OpType::_OP_MAX_, 33);
 }
 
-ptr<Parser::Node> Parser::_build_operator_tree(stdvec<Expr>& p_expr) {
+Parser::Node* Parser::_build_operator_tree(stdvec<Expr>& p_expr) {
 	ASSERT(p_expr.size() > 0);
 
 	while (p_expr.size() > 1) {
@@ -1476,7 +1589,7 @@ ptr<Parser::Node> Parser::_build_operator_tree(stdvec<Expr>& p_expr) {
 			}
 
 			for (int i = next_expr - 1; i >= next_op; i--) {
-				ptr<OperatorNode> op_node = new_node<OperatorNode>(p_expr[i].get_op());
+				OperatorNode* op_node = new_node<OperatorNode>(p_expr[i].get_op());
 				op_node->pos = p_expr[i].get_pos();
 				op_node->args.push_back(p_expr[(size_t)i + 1].get_expr());
 				p_expr.at(i) = Expr(op_node);
@@ -1487,19 +1600,19 @@ ptr<Parser::Node> Parser::_build_operator_tree(stdvec<Expr>& p_expr) {
 			ASSERT(next_op >= 1 && next_op < (int)p_expr.size() - 1);
 			ASSERT(!p_expr[(size_t)next_op - 1].is_op() && !p_expr[(size_t)next_op + 1].is_op());
 
-			ptr<OperatorNode> op_node = new_node<OperatorNode>(p_expr[(size_t)next_op].get_op());
+			OperatorNode* op_node = new_node<OperatorNode>(p_expr[(size_t)next_op].get_op());
 			op_node->pos = p_expr[next_op].get_pos();
 
 			if (p_expr[(size_t)next_op - 1].get_expr()->type == Node::Type::OPERATOR) {
-				if (OperatorNode::is_assignment(ptrcast<OperatorNode>(p_expr[(size_t)next_op - 1].get_expr())->op_type)) {
-					Vect2i pos = ptrcast<OperatorNode>(p_expr[(size_t)next_op - 1].get_expr())->pos;
+				if (OperatorNode::is_assignment(static_cast<OperatorNode*>(p_expr[(size_t)next_op - 1].get_expr())->op_type)) {
+					Vect2i pos = static_cast<OperatorNode*>(p_expr[(size_t)next_op - 1].get_expr())->pos;
 					throw PARSER_ERROR(Error::SYNTAX_ERROR, "unexpected assignment.", Vect2i(pos.x, pos.y));
 				}
 			}
 
 			if (p_expr[(size_t)next_op + 1].get_expr()->type == Node::Type::OPERATOR) {
-				if (OperatorNode::is_assignment(ptrcast<OperatorNode>(p_expr[(size_t)next_op + 1].get_expr())->op_type)) {
-					Vect2i pos = ptrcast<OperatorNode>(p_expr[(size_t)next_op + 1].get_expr())->pos;
+				if (OperatorNode::is_assignment(static_cast<OperatorNode*>(p_expr[(size_t)next_op + 1].get_expr())->op_type)) {
+					Vect2i pos = static_cast<OperatorNode*>(p_expr[(size_t)next_op + 1].get_expr())->pos;
 					throw PARSER_ERROR(Error::SYNTAX_ERROR, "unexpected assignment.", Vect2i(pos.x, pos.y));
 				}
 			}
@@ -1578,7 +1691,7 @@ String TokenData::to_string() const {
 		case Token::OP_BIT_XOR:       return "^";
 		case Token::OP_BIT_XOR_EQ:    return "^=";
 
-		case Token::IDENTIFIER:     return identifier;
+		case Token::IDENTIFIER:     return get_identifier();
 		case Token::BUILTIN_TYPE:   return BuiltinTypes::get_type_name(builtin_type);
 
 		case Token::KWORD_IMPORT:   return "import";
@@ -1609,12 +1722,12 @@ String TokenData::to_string() const {
 			
 		case Token::VALUE_NULL:     return "null";
 		case Token::VALUE_STRING: 
-			return String("\"") + constant.operator String() + "\"";
+			return String("\"") + get_constant().operator String() + "\"";
 		case Token::VALUE_INT: 
 		case Token::VALUE_FLOAT: 
-			return constant.to_string();
+			return get_constant().to_string();
 		case Token::VALUE_BOOL:
-			return (constant.operator bool()) ? "true" : "false";
+			return (get_constant().operator bool()) ? "true" : "false";
 
 		case Token::_TK_MAX_: return "<_TK_MAX_>";
 	}
@@ -1823,9 +1936,13 @@ stdmap<BuiltinFunctions::Type, String> BuiltinFunctions::_func_list = {
 	{ BuiltinFunctions::MATH_MIN,  "min"      },
 	{ BuiltinFunctions::MATH_MAX,  "max"      },
 	{ BuiltinFunctions::MATH_POW,  "pow"      },
+	{ BuiltinFunctions::MATH_ABS,  "abs"      },
+	{ BuiltinFunctions::MATH_FLOOR,"floor"    },
+	{ BuiltinFunctions::MATH_SQRT, "sqrt"     },
+	{ BuiltinFunctions::LEN,       "len"      },
 
 };
-MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 13);
+MISSED_ENUM_CHECK(BuiltinFunctions::Type::_FUNC_MAX_, 17);
 
 stdmap<BuiltinTypes::Type, String> BuiltinTypes::_type_list = {
 	//{ "", BuiltinTypes::UNKNOWN    },
@@ -0,0 +1,320 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/predecode.h"
+#include "compiler/function.h"
+#include "compiler/ir.h"
+
+namespace carbon {
+
+// typed operators of OPERATOR_INT and OPERATOR_FLOAT, returns false if the operator isn't one of them.
+bool PredecodedOps::_operator_int(var::Operator p_op, int64_t p_left, int64_t p_right, var* p_dst) {
+	switch (p_op) {
+		case var::OP_ADDITION:       set_int(p_dst, p_left + p_right); return true;
+		case var::OP_SUBTRACTION:    set_int(p_dst, p_left - p_right); return true;
+		case var::OP_MULTIPLICATION: set_int(p_dst, p_left * p_right); return true;
+		case var::OP_DIVISION:
+			if (p_right == 0) THROW_ERROR(Error::ZERO_DIVISION, "");
+			set_int(p_dst, p_left / p_right); return true;
+		case var::OP_MODULO:
+			if (p_right == 0) THROW_ERROR(Error::ZERO_DIVISION, "");
+			set_int(p_dst, p_left % p_right); return true;
+		case var::OP_BIT_LSHIFT:     set_int(p_dst, p_left << p_right); return true;
+		case var::OP_BIT_RSHIFT:     set_int(p_dst, p_left >> p_right); return true;
+		case var::OP_BIT_AND:        set_int(p_dst, p_left & p_right); return true;
+		case var::OP_BIT_OR:         set_int(p_dst, p_left | p_right); return true;
+		case var::OP_BIT_XOR:        set_int(p_dst, p_left ^ p_right); return true;
+		case var::OP_EQ_CHECK:       *p_dst = p_left == p_right; return true;
+		case var::OP_NOT_EQ_CHECK:   *p_dst = p_left != p_right; return true;
+		case var::OP_LT:             *p_dst = p_left < p_right; return true;
+		case var::OP_LTEQ:           *p_dst = p_left <= p_right; return true;
+		case var::OP_GT:             *p_dst = p_left > p_right; return true;
+		case var::OP_GTEQ:           *p_dst = p_left >= p_right; return true;
+		default:
+			return false;
+	}
+}
+
+bool PredecodedOps::_operator_float(var::Operator p_op, double p_left, double p_right, var* p_dst) {
+	switch (p_op) {
+		case var::OP_ADDITION:       set_float(p_dst, p_left + p_right); return true;
+		case var::OP_SUBTRACTION:    set_float(p_dst, p_left - p_right); return true;
+		case var::OP_MULTIPLICATION: set_float(p_dst, p_left * p_right); return true;
+		case var::OP_DIVISION:
+			if (p_right == 0.0) THROW_ERROR(Error::ZERO_DIVISION, "");
+			set_float(p_dst, p_left / p_right); return true;
+		case var::OP_EQ_CHECK:       *p_dst = p_left == p_right; return true;
+		case var::OP_NOT_EQ_CHECK:   *p_dst = p_left != p_right; return true;
+		case var::OP_LT:             *p_dst = p_left < p_right; return true;
+		case var::OP_LTEQ:           *p_dst = p_left <= p_right; return true;
+		case var::OP_GT:             *p_dst = p_left > p_right; return true;
+		case var::OP_GTEQ:           *p_dst = p_left >= p_right; return true;
+		default:
+			return false;
+	}
+}
+
+// the generic operators, same as the typed ones if the operands aren't of the type.
+void PredecodedOps::operator_generic(var::Operator p_op, var* p_left, var* p_right, var* p_dst) {
+	switch (p_op) {
+		case var::OP_ASSIGNMENT: {
+			THROW_BUG("assignment operations should be under ASSIGN opcode");
+		};
+		case var::OP_ADDITION: { *p_dst = *p_left + *p_right; } break;
+		case var::OP_SUBTRACTION: { *p_dst = *p_left - *p_right; } break;
+		case var::OP_MULTIPLICATION: { *p_dst = *p_left * *p_right; } break;
+		case var::OP_DIVISION: { *p_dst = *p_left / *p_right; } break;
+		case var::OP_MODULO: { *p_dst = *p_left % *p_right; } break;
+		case var::OP_POSITIVE: { *p_dst = *p_left; /* is it okey? */ } break;
+		case var::OP_NEGATIVE: {
+			if (p_left->get_type() == var::INT) {
+				*p_dst = -p_left->operator int64_t();
+			} else if (p_left->get_type() == var::FLOAT) {
+				*p_dst = -p_left->operator double();
+			} else {
+				THROW_ERROR(Error::OPERATOR_NOT_SUPPORTED,
+					String::format("operator (-) not supported on base %s.", p_left->get_type_name().c_str()));
+			}
+		} break;
+		case var::OP_EQ_CHECK: { *p_dst = *p_left == *p_right; } break;
+		case var::OP_NOT_EQ_CHECK: { *p_dst = *p_left != *p_right; } break;
+		case var::OP_LT: { *p_dst = *p_left < *p_right; } break;
+		case var::OP_LTEQ: { *p_dst = *p_left <= *p_right; } break;
+		case var::OP_GT: { *p_dst = *p_left > * p_right; } break;
+		case var::OP_GTEQ: { *p_dst = *p_left >= *p_right; } break;
+		case var::OP_AND: { *p_dst = *p_left && *p_right; } break;
+		case var::OP_OR: { *p_dst = *p_left || *p_right; } break;
+		case var::OP_NOT: { *p_dst = !*p_left; } break;
+		case var::OP_BIT_LSHIFT: { *p_dst = p_left->operator int64_t() << p_right->operator int64_t(); } break;
+		case var::OP_BIT_RSHIFT: { *p_dst = p_left->operator int64_t() >> p_right->operator int64_t(); } break;
+		case var::OP_BIT_AND: { *p_dst = p_left->operator int64_t() & p_right->operator int64_t(); } break;
+		case var::OP_BIT_OR: { *p_dst = p_left->operator int64_t() | p_right->operator int64_t(); } break;
+		case var::OP_BIT_XOR: { *p_dst = p_left->operator int64_t() ^ p_right->operator int64_t(); } break;
+		case var::OP_BIT_NOT: { *p_dst = ~p_left->operator int64_t(); } break;
+	}
+}
+
+// the optimizer proved the type of `on` and 0 <= key < on.size().
+void PredecodedOps::get_mapped_unchecked(var* p_on, var* p_key, var* p_dst) {
+	ASSERT(p_key->get_type() == var::INT && 0 <= p_key->operator int64_t());
+	size_t index = (size_t)p_key->operator int64_t();
+	if (p_on->get_type() == var::ARRAY) {
+		const stdvec<var>& elements = *p_on->operator const Array&().get_stdvec();
+		ASSERT(index < elements.size());
+		*p_dst = elements[index];
+	} else {
+		ASSERT(p_on->get_type() == var::STRING && index < p_on->operator const String&().size());
+		*p_dst = String(p_on->operator const String&().c_str()[index]);
+	}
+}
+
+// the addresses which refer to the same var for the whole call. the others (members, statics, externs, ...)
+// are resolved by the interpreter every time.
+static bool _is_frame_address(const Address& p_addr, IRInstruction::OperandKind p_kind) {
+	switch (p_addr.get_type()) {
+		case Address::STACK:
+		case Address::PARAMETER:
+			return true;
+		case Address::_NULL:
+		case Address::CONST_VALUE:
+			return p_kind == IRInstruction::USE;
+		default:
+			return false;
+	}
+}
+
+static bool _is_comparison(var::Operator p_op) {
+	switch (p_op) {
+		case var::OP_EQ_CHECK:
+		case var::OP_NOT_EQ_CHECK:
+		case var::OP_LT:
+		case var::OP_LTEQ:
+		case var::OP_GT:
+		case var::OP_GTEQ:
+			return true;
+		default:
+			return false;
+	}
+}
+
+ptr<PredecodedFunction> PredecodedFunction::build(const Function* p_func) {
+	const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+	ptr<PredecodedFunction> predecoded = newptr<PredecodedFunction>();
+
+	stdvec<IRInstruction> decoded;
+	stdvec<bool> is_target(opcodes.size(), false);
+	predecoded->_index = stdvec<int>(opcodes.size(), -1);
+	for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+		predecoded->_index[ip] = (int)decoded.size();
+		decoded.push_back(IRInstruction::decode(opcodes, ip));
+		int target = decoded.back().get_target_word();
+		if (target >= 0 && decoded.back().words[target] < opcodes.size()) is_target[decoded.back().words[target]] = true;
+	}
+
+	stdmap<uint32_t, uint32_t> frame_index; // address -> operand index.
+	auto operand = [&](const IRInstruction& p_instr, int p_word) -> uint32_t {
+		uint32_t addr = p_instr.words[p_word];
+		auto it = frame_index.find(addr);
+		if (it != frame_index.end()) return it->second;
+		uint32_t index = (uint32_t)predecoded->_operands.size();
+		predecoded->_operands.push_back(Address(addr));
+		frame_index[addr] = index;
+		return index;
+	};
+	auto target_of = [&](const IRInstruction& p_instr, int p_word) -> int {
+		uint32_t ip = p_instr.words[p_word];
+		return (ip < opcodes.size()) ? predecoded->_index[ip] : -1;
+	};
+
+	uint32_t ip = 0;
+	for (int i = 0; i < (int)decoded.size(); ip += decoded[i++].size()) {
+		const IRInstruction& instr = decoded[i];
+		PredecodedInstruction pd;
+		pd.ip = ip;
+
+		bool frame = true;
+		for (int w = 1; w < (int)instr.size(); w++) {
+			switch (instr.kinds[w]) {
+				case IRInstruction::USE:
+				case IRInstruction::DEF:
+				case IRInstruction::USE_DEF:
+					frame = frame && _is_frame_address(instr.get_address(w), instr.kinds[w]);
+					break;
+				default:
+					break;
+			}
+		}
+		int target = instr.get_target_word();
+		if (target >= 0 && target_of(instr, target) < 0) frame = false;
+		if (!frame) {
+			predecoded->_instructions.push_back(pd);
+			continue;
+		}
+
+		switch (instr.get_opcode()) {
+			case Opcode::ASSIGN:
+				pd.op = PredecodedInstruction::MOVE;
+				pd.c = operand(instr, 1); pd.a = operand(instr, 2);
+				break;
+			case Opcode::SET_TRUE:
+			case Opcode::SET_FALSE:
+			case Opcode::CLEAR:
+				pd.op = (instr.get_opcode() == Opcode::SET_TRUE) ? PredecodedInstruction::SET_TRUE :
+					(instr.get_opcode() == Opcode::SET_FALSE) ? PredecodedInstruction::SET_FALSE : PredecodedInstruction::CLEAR;
+				pd.c = operand(instr, 1);
+				break;
+
+			case Opcode::OPERATOR:
+			case Opcode::OPERATOR_INT:
+			case Opcode::OPERATOR_FLOAT: {
+				var::Operator op = (var::Operator)instr.words[1];
+				pd.imm = op;
+				pd.a = operand(instr, 2); pd.b = operand(instr, 3); pd.c = operand(instr, 4);
+				bool is_int = instr.get_opcode() == Opcode::OPERATOR_INT;
+				if (instr.get_opcode() == Opcode::OPERATOR) {
+					pd.op = PredecodedInstruction::OPERATOR;
+					break;
+				}
+
+				// `if (i < n)`, the jump after it reads the result (and it isn't a target of another jump).
+				if (_is_comparison(op) && i + 1 < (int)decoded.size() && !is_target[ip + instr.size()]) {
+					const IRInstruction& next = decoded[i + 1];
+					bool cond_jump = next.get_opcode() == Opcode::JUMP_IF || next.get_opcode() == Opcode::JUMP_IF_NOT;
+					if (cond_jump && next.words[1] == instr.words[4] && target_of(next, 2) >= 0) {
+						pd.op = (is_int) ? PredecodedInstruction::COMPARE_JUMP_INT : PredecodedInstruction::COMPARE_JUMP_FLOAT;
+						pd.jump_if = next.get_opcode() == Opcode::JUMP_IF;
+						pd.target = (uint32_t)target_of(next, 2);
+						break;
+					}
+				}
+
+				switch (op) {
+					case var::OP_ADDITION:       pd.op = (is_int) ? PredecodedInstruction::ADD_INT : PredecodedInstruction::ADD_FLOAT; break;
+					case var::OP_SUBTRACTION:    pd.op = (is_int) ? PredecodedInstruction::SUB_INT : PredecodedInstruction::SUB_FLOAT; break;
+					case var::OP_MULTIPLICATION: pd.op = (is_int) ? PredecodedInstruction::MUL_INT : PredecodedInstruction::MUL_FLOAT; break;
+					default:                     pd.op = (is_int) ? PredecodedInstruction::OPERATOR_INT : PredecodedInstruction::OPERATOR_FLOAT; break;
+				}
+			} break;
+
+			case Opcode::GET_MAPPED:
+			case Opcode::GET_MAPPED_UNCHECKED:
+			case Opcode::SET_MAPPED:
+				pd.op = (instr.get_opcode() == Opcode::GET_MAPPED) ? PredecodedInstruction::GET_MAPPED :
+					(instr.get_opcode() == Opcode::SET_MAPPED) ? PredecodedInstruction::SET_MAPPED : PredecodedInstruction::GET_MAPPED_UNCHECKED;
+				pd.a = operand(instr, 1); pd.b = operand(instr, 2); pd.c = operand(instr, 3);
+				break;
+			case Opcode::CALL_INTRINSIC:
+				pd.op = PredecodedInstruction::CALL_INTRINSIC;
+				pd.imm = instr.words[1];
+				pd.a = operand(instr, 2); pd.b = operand(instr, 3); pd.c = operand(instr, 4);
+				break;
+
+			case Opcode::JUMP:
+				pd.op = PredecodedInstruction::JUMP;
+				pd.target = (uint32_t)target_of(instr, 1);
+				break;
+			case Opcode::JUMP_IF:
+			case Opcode::JUMP_IF_NOT:
+				pd.op = (instr.get_opcode() == Opcode::JUMP_IF) ? PredecodedInstruction::JUMP_IF : PredecodedInstruction::JUMP_IF_NOT;
+				pd.a = operand(instr, 1);
+				pd.target = (uint32_t)target_of(instr, 2);
+				break;
+			case Opcode::ITER_BEGIN:
+				pd.op = PredecodedInstruction::ITER_BEGIN;
+				pd.c = operand(instr, 1); pd.a = operand(instr, 2);
+				break;
+			case Opcode::ITER_NEXT:
+				pd.op = PredecodedInstruction::ITER_NEXT;
+				pd.c = operand(instr, 1); pd.a = operand(instr, 2);
+				pd.target = (uint32_t)target_of(instr, 3);
+				break;
+			case Opcode::RETURN:
+				pd.op = PredecodedInstruction::RETURN;
+				pd.a = operand(instr, 1);
+				break;
+			case Opcode::END:
+				pd.op = PredecodedInstruction::END;
+				break;
+
+			default: // calls, constructors, members, ...
+				break;
+		}
+
+		if (pd.op != PredecodedInstruction::INTERPRET) predecoded->_predecoded_count++;
+		predecoded->_instructions.push_back(pd);
+	}
+
+	if (predecoded->_predecoded_count == 0) return nullptr;
+	return predecoded;
+}
+
+int PredecodedFunction::get_index(uint32_t p_ip) const {
+	ASSERT(p_ip < _index.size());
+	int index = _index[p_ip];
+	if (index < 0 || _instructions[index].op == PredecodedInstruction::INTERPRET) return -1;
+	return index;
+}
+
+}
@@ -0,0 +1,233 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "compiler/profile.h"
+#include "compiler/bytecode.h"
+#include "compiler/function.h"
+#include "compiler/ir.h"
+#include "compiler/predecode.h"
+#include "native/file.h"
+
+namespace carbon {
+
+static const char* _site_kind_names[] = {
+	"OPERATOR",
+	"GET_MAPPED",
+	"CALL_METHOD",
+	nullptr, // _SITE_MAX_
+};
+MISSED_ENUM_CHECK(Profile::_SITE_MAX_, 3);
+
+String Profile::_get_key(const Function* p_func) {
+	const Bytecode* owner = p_func->get_owner();
+	String path = (owner->is_class()) ? owner->get_file()->get_name() : owner->get_name();
+
+	String name = p_func->get_name();
+	if (name.size() == 0) {
+		name = (owner->get_static_initializer() == p_func) ? "@static_initializer" : "@member_initializer";
+	}
+	if (owner->is_class()) name = owner->get_name() + "." + name;
+	return path + ":" + name;
+}
+
+uint32_t Profile::hash(const Function* p_func) {
+	const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+	uint32_t hash = 2166136261u; // FNV-1a
+	uint32_t next = 0;           // position of the next opcode.
+	for (uint32_t ip = 0; ip < opcodes.size(); ip++) {
+		uint32_t word = opcodes[ip];
+		if (ip == next) {
+			if (word == Opcode::OPERATOR_INT || word == Opcode::OPERATOR_FLOAT) word = Opcode::OPERATOR;
+			next += IRInstruction::get_size(opcodes, ip);
+		}
+		for (int i = 0; i < 4; i++) {
+			hash ^= (word >> (i * 8)) & 0xff;
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+Profile::FunctionProfile* Profile::get_function(const Function* p_func) {
+	auto it = _recording.find(p_func);
+	if (it != _recording.end()) return it->second;
+
+	FunctionProfile* profile = &_functions[_get_key(p_func)];
+	uint32_t hash = Profile::hash(p_func);
+	if (profile->hash != hash) { // a loaded profile of an older version.
+		*profile = FunctionProfile();
+		profile->hash = hash;
+	}
+	_recording[p_func] = profile;
+	return profile;
+}
+
+void Profile::record(FunctionProfile* p_func, uint32_t p_ip, SiteKind p_kind, const String& p_key) {
+	Site& site = p_func->sites[p_ip];
+	site.kind = p_kind;
+	site.histogram[p_key]++;
+}
+
+void Profile::record_operator(FunctionProfile* p_func, uint32_t p_ip, const var* p_left, const var* p_right) {
+	String key = var::get_type_name_s(p_left->get_type());
+	key += ",";
+	key += var::get_type_name_s(p_right->get_type());
+	record(p_func, p_ip, OPERATOR, key);
+}
+
+void Profile::set_hot(const Function* p_func) {
+	get_function(p_func)->hot = true;
+}
+
+// OPERATOR_INT and OPERATOR_FLOAT implement only these, the others would always be generic.
+static bool _is_typed_operator(var::Operator p_op, bool p_int) {
+	switch (p_op) {
+		case var::OP_ADDITION:
+		case var::OP_SUBTRACTION:
+		case var::OP_MULTIPLICATION:
+		case var::OP_DIVISION:
+		case var::OP_EQ_CHECK:
+		case var::OP_NOT_EQ_CHECK:
+		case var::OP_LT:
+		case var::OP_LTEQ:
+		case var::OP_GT:
+		case var::OP_GTEQ:
+			return true;
+		case var::OP_MODULO:
+		case var::OP_BIT_LSHIFT:
+		case var::OP_BIT_RSHIFT:
+		case var::OP_BIT_AND:
+		case var::OP_BIT_OR:
+		case var::OP_BIT_XOR:
+			return p_int;
+		default:
+			return false;
+	}
+}
+
+void Profile::_apply(Bytecode* p_bytecode, uint32_t& r_count) const {
+	stdvec<Function*> functions;
+	for (auto& it : p_bytecode->get_functions()) functions.push_back(it.second.get());
+	if (p_bytecode->get_static_initializer()) functions.push_back((Function*)p_bytecode->get_static_initializer());
+	if (p_bytecode->is_class() && p_bytecode->get_member_initializer()) functions.push_back((Function*)p_bytecode->get_member_initializer());
+
+	for (Function* func : functions) {
+		auto it = _functions.find(_get_key(func));
+		if (it == _functions.end() || it->second.hash != hash(func)) continue; // changed after it's recorded.
+		const FunctionProfile& profile = it->second;
+
+		if (profile.hot && func->_hot_count < PredecodedFunction::HOT_COUNT - 1) func->_hot_count = PredecodedFunction::HOT_COUNT - 1;
+
+		for (const auto& site : profile.sites) {
+			if (site.second.kind != OPERATOR || site.second.histogram.size() == 0) continue;
+			ASSERT(site.first + 1 < func->_opcodes.size());
+			if (func->_opcodes[site.first] != Opcode::OPERATOR) continue;
+
+			bool is_int = true, is_float = true;
+			for (const auto& types : site.second.histogram) {
+				is_int = is_int && types.first == "int,int";
+				is_float = is_float && (types.first == "float,float" || types.first == "int,float" || types.first == "float,int");
+			}
+			var::Operator op = (var::Operator)func->_opcodes[site.first + 1];
+			if (is_int && _is_typed_operator(op, true)) {
+				func->_opcodes[site.first] = Opcode::OPERATOR_INT;
+				r_count++;
+			} else if (is_float && _is_typed_operator(op, false)) {
+				func->_opcodes[site.first] = Opcode::OPERATOR_FLOAT;
+				r_count++;
+			}
+		}
+	}
+
+	if (!p_bytecode->is_class()) {
+		for (auto& it : p_bytecode->get_classes()) _apply(it.second.get(), r_count);
+	}
+}
+
+uint32_t Profile::apply(Bytecode* p_bytecode) const {
+	uint32_t count = 0;
+	_apply(p_bytecode, count);
+	return count;
+}
+
+// one line for each function and each type of a site:
+//     function <path:name> <hash> <hot>
+//     site <ip> <kind> <types> <count>
+void Profile::save(const String& p_path) const {
+	String text;
+	for (const auto& func : _functions) {
+		text += String::format("function\t%s\t%u\t%i\n", func.first.c_str(), func.second.hash, (int)func.second.hot);
+		for (const auto& site : func.second.sites) {
+			for (const auto& types : site.second.histogram) {
+				text += String::format("site\t%u\t%s\t%s\t%u\n", site.first, _site_kind_names[site.second.kind], types.first.c_str(), types.second);
+			}
+		}
+	}
+
+	File file(p_path, File::WRITE);
+	file.write_text(text);
+	file.close();
+}
+
+ptr<Profile> Profile::load(const String& p_path) {
+	File file(p_path, File::READ);
+	String text = file.read_text();
+	file.close();
+
+	ptr<Profile> profile = newptr<Profile>();
+	FunctionProfile* func = nullptr;
+	int line_no = 0;
+	Array lines = text.split("\n");
+	for (const var& line_var : *lines.get_stdvec()) {
+		line_no++;
+		String line = line_var.operator String();
+		if (line.size() == 0) continue;
+
+		Array fields = line.split("\t");
+		const String& type = fields[0].operator String();
+		if (type == "function" && fields.size() == 4) {
+			func = &profile->_functions[fields[1].operator String()];
+			func->hash = (uint32_t)fields[2].operator String().to_int();
+			func->hot = fields[3].operator String() == "1";
+			continue;
+		}
+		if (type == "site" && fields.size() == 5 && func != nullptr) {
+			int kind = -1;
+			for (int i = 0; i < _SITE_MAX_; i++) {
+				if (fields[2].operator String() == _site_kind_names[i]) kind = i;
+			}
+			if (kind >= 0) {
+				Site& site = func->sites[(uint32_t)fields[1].operator String().to_int()];
+				site.kind = (SiteKind)kind;
+				site.histogram[fields[3].operator String()] = (uint32_t)fields[4].operator String().to_int();
+				continue;
+			}
+		}
+		THROW_ERROR(Error::IO_ERROR, String::format("invalid profile \"%s\" at line %i.", p_path.c_str(), line_no));
+	}
+	return profile;
+}
+
+}
@@ -85,7 +85,30 @@ static KeywordName _keyword_name_list[] = {
 };
 MISSED_ENUM_CHECK(Token::_TK_MAX_, 79);
 
-void Tokenizer::_eat_escape(String& p_str) {
+// a perfect hash of the keywords above, a new keyword may need new constants.
+#define KEYWORD_HASH(m_text, m_len) \
+( ((unsigned)(m_text)[0] + (unsigned)(m_text)[1] * 23u + (unsigned)(m_len) * 25u) & 63u )
+
+struct _KeywordTable {
+	const KeywordName* slots[64] = {};
+	_KeywordTable() {
+		for (const KeywordName& kw : _keyword_name_list) {
+			unsigned hash = KEYWORD_HASH(kw.name, strlen(kw.name));
+			if (slots[hash] != nullptr) THROW_BUG("keyword hash collision.");
+			slots[hash] = &kw;
+		}
+	}
+};
+
+static const KeywordName* _get_keyword(const char* p_text, size_t p_len) {
+	static const _KeywordTable table; // built once, files are tokenized from the compiler threads.
+	if (p_len < 2) return nullptr; // no single letter keywords.
+	const KeywordName* kw = table.slots[KEYWORD_HASH(p_text, p_len)];
+	if (kw != nullptr && strncmp(kw->name, p_text, p_len) == 0 && kw->name[p_len] == '\0') return kw;
+	return nullptr;
+}
+
+void Tokenizer::_eat_escape() {
 	char c = GET_CHAR(0);
 	ASSERT(c == '\\');
 	c = GET_CHAR(1);
@@ -93,18 +116,58 @@ void Tokenizer::_eat_escape(String& p_str) {
 		case 0:
 			throw TOKENIZER_ERROR(Error::UNEXPECTED_EOF, "");
 			break;
-		case '\\': p_str += '\\'; EAT_CHAR(2); break;
-		case '\'': p_str += '\''; EAT_CHAR(2); break;
-		case 't':  p_str += '\t'; EAT_CHAR(2); break;
-		case 'n':  p_str += '\n'; EAT_CHAR(2); break;
-		case '"':  p_str += '"';  EAT_CHAR(2); break;
-		case 'r':  p_str += '\r'; EAT_CHAR(2); break;
+		case '\\':
+		case '\'':
+		case 't':
+		case 'n':
+		case '"':
+		case 'r':
+			EAT_CHAR(2); break;
 		case '\n': EAT_CHAR(1); EAT_LINE(); break;
 		default: 
 			throw TOKENIZER_ERROR(Error::SYNTAX_ERROR, "invalid escape character");
 	}
 }
 
+const String& TokenData::get_identifier() const {
+	static String none;
+	if (type != Token::IDENTIFIER) return none;
+	return *_identifier;
+}
+
+var TokenData::get_constant() const {
+	switch (type) {
+		case Token::VALUE_NULL:
+			return var();
+		case Token::VALUE_BOOL:
+			return _text[0] == 't';
+		case Token::VALUE_INT:
+			return String(std::string(_text, length)).to_int();
+		case Token::VALUE_FLOAT:
+			return String(std::string(_text, length)).to_float();
+		case Token::VALUE_STRING: { // escapes are validated by the tokenizer.
+			std::string str;
+			str.reserve(length);
+			for (uint32_t i = 1; i + 1 < length; i++) {
+				if (_text[i] != '\\') {
+					str += _text[i];
+					continue;
+				}
+				switch (_text[++i]) {
+					case 't':  str += '\t'; break;
+					case 'n':  str += '\n'; break;
+					case 'r':  str += '\r'; break;
+					case '\n': break;
+					default:   str += _text[i]; break; // \\ \' \"
+				}
+			}
+			return String(str);
+		}
+		default:
+			return var();
+	}
+}
+
 CompileTimeError Tokenizer::_tokenize_error(Error::Type m_err_type, const String& m_msg, const DBGSourceInfo& p_dbg_info) const {
 	uint32_t err_len = 1;
 	String token_str = peek(-1, true).to_string();
@@ -134,6 +197,24 @@ Vect2i Tokenizer::get_pos() const {
 	return Vect2i(cur_line, cur_col);
 }
 
+uint64_t Tokenizer::hash_tokens(int p_begin, int p_end) const {
+	uint64_t hash = 14695981039346656037ull; // FNV-1a
+	auto add = [&hash](const void* p_data, size_t p_size) {
+		for (size_t i = 0; i < p_size; i++) {
+			hash ^= ((const uint8_t*)p_data)[i];
+			hash *= 1099511628211ull;
+		}
+	};
+	for (int i = std::max(p_begin, 0); i < std::min(p_end, (int)tokens.size()); i++) {
+		const TokenData& tk = tokens[i];
+		add(&tk.type, sizeof tk.type);
+		add(&tk.builtin_type, sizeof tk.builtin_type);
+		if (tk.type == Token::IDENTIFIER) add(tk._identifier->c_str(), tk._identifier->size());
+		else if (tk.length != 0) add(tk._text, tk.length);
+	}
+	return hash;
+}
+
 uint32_t Tokenizer::get_width() const {
 	int last_token_ind = token_ptr - 1;
 	if (last_token_ind < 0 || tokens.size() <= last_token_ind) return 1;
@@ -179,92 +260,83 @@ void Tokenizer::_eat_eof() {
 
 // TODO: eat const value, ... cur_line, cur_col are not at the end of the token
 // make the position to be at the start
-void Tokenizer::_eat_const_value(const var& p_value, int p_eat_size) {
+// the value is eaten already, it's from p_begin till the current char.
+void Tokenizer::_eat_const_value(Token p_tk, int p_begin, int p_line, int p_col) {
 	TokenData tk;
-	tk.line = cur_line;
-	tk.col = cur_col - __const_val_token_len;
-	tk.constant = p_value;
-
-	switch (p_value.get_type()) {
-		case var::STRING:
-			tk.type = Token::VALUE_STRING;
-			break;
-		case var::INT:
-			tk.type = Token::VALUE_INT;
-			break;
-		case var::FLOAT:
-			tk.type = Token::VALUE_FLOAT;
-			break;
-		default:
-			THROW_BUG("invalid switch case.");
-			break;
-	}
-
+	tk.type = p_tk;
+	tk.line = p_line;
+	tk.col = p_col;
+	tk._text = source.c_str() + p_begin;
+	tk.length = (uint32_t)(char_ptr - p_begin);
 	tokens.push_back(tk);
-	EAT_CHAR(p_eat_size);
 }
 
-void Tokenizer::_eat_identifier(const String& p_idf, int p_eat_size) {
-	
+// the identifier is eaten already, it's from p_begin till the current char.
+void Tokenizer::_eat_identifier(int p_begin) {
+	const char* text = source.c_str() + p_begin;
+	size_t len = (size_t)(char_ptr - p_begin);
+
 	TokenData tk;
 	tk.type = Token::IDENTIFIER;
-	tk.identifier = p_idf; // method name may be builtin func
-	tk.col = cur_col - (int)p_idf.size();
+	tk.col = cur_col - (int)len;
 	tk.line = cur_line;
 
-	for (const KeywordName& kw : _keyword_name_list) {
-		if (kw.name == p_idf) {
-			tk.type = kw.tk;
-
-			// remap tokens.
-			switch (tk.type) {
-				case Token::KWORD_TRUE:
-					tk.type = Token::VALUE_BOOL;
-					tk.constant = var(true);
-					break;
-				case Token::KWORD_FALSE:
-					tk.type = Token::VALUE_BOOL;
-					tk.constant = var(false);
-					break;
-				case Token::KWORD_NULL:
-					tk.type = Token::VALUE_NULL;
-					tk.constant = var();
-					break;
-				case Token::KWORD_AND:
-					tk.type = Token::OP_AND;
-					break;
-				case Token::KWORD_OR:
-					tk.type = Token::OP_OR;
-					break;
-				case Token::KWORD_NOT:
-					tk.type = Token::OP_NOT;
-					break;
-			}
-
-			break;
+	const KeywordName* kw = _get_keyword(text, len);
+	if (kw != nullptr) {
+		tk.type = kw->tk;
+
+		// remap tokens.
+		switch (tk.type) {
+			case Token::KWORD_TRUE:
+			case Token::KWORD_FALSE:
+				tk.type = Token::VALUE_BOOL;
+				tk._text = text;
+				tk.length = (uint32_t)len;
+				break;
+			case Token::KWORD_NULL:
+				tk.type = Token::VALUE_NULL;
+				tk._text = text;
+				tk.length = (uint32_t)len;
+				break;
+			case Token::KWORD_AND:
+				tk.type = Token::OP_AND;
+				break;
+			case Token::KWORD_OR:
+				tk.type = Token::OP_OR;
+				break;
+			case Token::KWORD_NOT:
+				tk.type = Token::OP_NOT;
+				break;
 		}
-	}
 
-	if (tk.type == Token::IDENTIFIER) {
-		BuiltinTypes::Type bf_type = BuiltinTypes::get_type_type(tk.identifier);
-		if (bf_type != BuiltinTypes::UNKNOWN) {
+	} else {
+		// interned once for each name (a method name may be a builtin func).
+		std::string name(text, len);
+		auto it = _identifiers.find(name);
+		if (it == _identifiers.end()) {
+			_Identifier& identifier = _identifiers[name];
+			identifier.name = name;
+			identifier.builtin_type = BuiltinTypes::get_type_type(identifier.name);
+			it = _identifiers.find(name);
+		}
+		if (it->second.builtin_type != BuiltinTypes::UNKNOWN) {
 			tk.type = Token::BUILTIN_TYPE;
-			tk.builtin_type = bf_type;
+			tk.builtin_type = it->second.builtin_type;
 		}
+		tk._identifier = &it->second.name;
 	}
 
 	tokens.push_back(tk);
-	EAT_CHAR(p_eat_size);
 }
 
 void Tokenizer::_clear() {
 	source = "";
 	source_path = "";
 	tokens.clear();
+	_identifiers.clear();
 	cur_line = 1, cur_col = 1;
 	char_ptr = 0;
 	token_ptr = 0;
-	__const_val_token_len = 0;
 }
 
 void Tokenizer::tokenize(ptr<File> p_file) {
@@ -418,11 +490,11 @@ void Tokenizer::tokenize(const String& p_source, const String& p_source_path) {
 
 			// double quote string value (single quote not supported)
 			case '"': {
+				int begin = char_ptr, line = cur_line, col = cur_col;
 				EAT_CHAR(1);
-				String str;
 				while (GET_CHAR(0) != '"') {
 					if (GET_CHAR(0) == '\\') {
-						_eat_escape(str);
+						_eat_escape();
 					} else if (GET_CHAR(0) == 0) {
 						throw TOKENIZER_ERROR(Error::UNEXPECTED_EOF, "unexpected EOF while parsing String.");
 						break;
@@ -431,14 +503,12 @@ void Tokenizer::tokenize(const String& p_source, const String& p_source_path) {
 					//	throw TOKENIZER_ERROR(Error::SYNTAX_ERROR, "unexpected EOL while parsing String.");
 					//	break;
 					} else {
-						str += GET_CHAR(0);
 						if (GET_CHAR(0) == '\n') { EAT_LINE(); }
 						else { EAT_CHAR(1); }
 					}
 				}
 				EAT_CHAR(1);
-				__const_val_token_len = (int)str.size() + 2;
-				_eat_const_value(str);
+				_eat_const_value(Token::VALUE_STRING, begin, line, col);
 				break;
 			}
 			case '\'':
@@ -450,20 +520,17 @@ void Tokenizer::tokenize(const String& p_source, const String& p_source_path) {
 
 				// float value begins with '.'
 				if (GET_CHAR(0) == '.' && IS_NUM(GET_CHAR(1)) ) {
-					String float_str = '.';
+					int begin = char_ptr, col = cur_col;
 					EAT_CHAR(1);
 					while (IS_NUM(GET_CHAR(0))) {
-						float_str += GET_CHAR(0);
 						EAT_CHAR(1);
 					}
-					double float_val = float_str.to_float();
-					__const_val_token_len = (int)float_str.size();
-					_eat_const_value(float_val);
+					_eat_const_value(Token::VALUE_FLOAT, begin, cur_line, col);
 					break;
 				}
 				// integer/float value
 				if (IS_NUM(GET_CHAR(0))) {
-					String num = GET_CHAR(0);
+					int begin = char_ptr, col = cur_col;
 					
 					enum _ReadMode { INT, FLOAT, BIN, HEX };
 					_ReadMode mode = INT;
@@ -479,45 +546,37 @@ void Tokenizer::tokenize(const String& p_source, const String& p_source_path) {
 									throw TOKENIZER_ERROR(Error::SYNTAX_ERROR, "invalid numeric value.");
 								if (GET_CHAR(0) == '.')
 									mode = FLOAT;
-								num += GET_CHAR(0);
 								EAT_CHAR(1);
 							}
 						} break;
 						case BIN: {
-							num += GET_CHAR(0); EAT_CHAR(1); // eat 'b';
+							EAT_CHAR(1); // eat 'b';
 							while (GET_CHAR(0) == '0' || GET_CHAR(0) == '1') {
-								num += GET_CHAR(0);
 								EAT_CHAR(1);
 							}
 						} break;
 						case HEX: {
-							num += GET_CHAR(0); EAT_CHAR(1); // eat 'x';
+							EAT_CHAR(1); // eat 'x';
 							while (IS_HEX_CHAR(GET_CHAR(0))) {
-								num += GET_CHAR(0);
 								EAT_CHAR(1);
 							}
 						} break;
 					}
 
 					// "1." parsed as 1.0 which should be error.
-					if (num[num.size() - 1] == '.') throw TOKENIZER_ERROR(Error::SYNTAX_ERROR, "invalid numeric value.");
+					if (GET_CHAR(-1) == '.') throw TOKENIZER_ERROR(Error::SYNTAX_ERROR, "invalid numeric value.");
 
-					__const_val_token_len = (int)num.size();
-					if (mode == FLOAT)
-						_eat_const_value(num.to_float());
-					else
-						_eat_const_value(num.to_int());
+					_eat_const_value((mode == FLOAT) ? Token::VALUE_FLOAT : Token::VALUE_INT, begin, cur_line, col);
 					break;
 				}
 				// identifier
 				if (IS_TEXT(GET_CHAR(0))) {
-					String identifier = GET_CHAR(0);
+					int begin = char_ptr;
 					EAT_CHAR(1);
 					while (IS_TEXT(GET_CHAR(0)) || IS_NUM(GET_CHAR(0))) {
-						identifier += GET_CHAR(0);
 						EAT_CHAR(1);
 					}
-					_eat_identifier(identifier);
+					_eat_identifier(begin);
 					break;
 				}
 
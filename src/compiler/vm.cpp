@@ -41,7 +41,7 @@ VMStack::VMStack(uint32_t p_max_size) {
 	_stack = newptr<stdvec<var>>(p_max_size);
 }
 var* VMStack::get_at(uint32_t p_pos) {
-	THROW_INVALID_INDEX(_stack->size(), p_pos);
+	ASSERT(p_pos < _stack->size()); // the slots were verified with the stack size of the function.
 	return &(*_stack)[p_pos];
 }
 
@@ -57,6 +57,9 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 	THROW_IF_NULLPTR(p_bytecode);
 	if (__stack >= STACK_MAX) THROW_ERROR(Error::STACK_OVERFLOW, "stack was overflowed.");
 
+	// the operands aren't checked while running, only a verified function could be called.
+	if (!p_func->is_verified()) THROW_BUG(String::format("function \"%s\" wasn't verified.", p_func->get_name().c_str()));
+
 	// check argc and add default args
 	stdvec<var> default_args_copy;
 	if (p_args.size() > p_func->get_arg_count()) {
@@ -100,6 +103,14 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 	uint32_t ip = 0; // instruction pointer
 	const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
 
+	// the predecoded form of a hot function, it's frame is resolved the first time it's entered.
+	const PredecodedFunction* predecoded = _get_hot_predecoded(p_func);
+	stdvec<var*> pd_frame;
+	bool pd_bound = false;
+	var pd_null;
+
+	Profile::FunctionProfile* profile = (_profile != nullptr) ? _profile->get_function(p_func) : nullptr;
+
 #define CHECK_OPCODE_SIZE(m_size) ASSERT(ip + m_size < opcodes.size())
 #define DISPATCH() goto L_loop
 
@@ -108,6 +119,23 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 		ASSERT(opcodes[ip] <= Opcode::END);
 		uint32_t last_ip = ip;
 		try {
+		if (predecoded != nullptr && predecoded->get_index(ip) >= 0) {
+			if (!pd_bound) {
+				for (const Address& addr : predecoded->get_operands()) {
+					pd_frame.push_back((addr.get_type() == Address::_NULL) ? &pd_null : context.get_var_at(addr));
+				}
+				pd_bound = true;
+			}
+			var ret;
+			PredecodedNativeFunc native = predecoded->get_native();
+			const JITFunction* jit = predecoded->get_jit();
+			bool done = (native != nullptr) ? native(pd_frame.data(), predecoded->get_index(ip), last_ip, ret)
+				: (jit != nullptr) ? jit->run(pd_frame.data(), predecoded->get_index(ip), last_ip, ret)
+				: _run_predecoded(predecoded, predecoded->get_index(ip), pd_frame.data(), last_ip, ret);
+			if (done) return ret;
+			ip = last_ip; // the interpreter runs it.
+		}
+
 		switch (opcodes[ip]) {
 			case Opcode::GET: {
 				CHECK_OPCODE_SIZE(4);
@@ -136,9 +164,20 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				var* dst = context.get_var_at(opcodes[++ip]);
 				ip++;
 
+				if (profile != nullptr) _profile->record(profile, last_ip, Profile::GET_MAPPED, on->get_type_name());
 				*dst = on->__get_mapped(*key);
 			} DISPATCH();
 
+			case Opcode::GET_MAPPED_UNCHECKED: {
+				CHECK_OPCODE_SIZE(4);
+				var* on = context.get_var_at(opcodes[++ip]);
+				var* key = context.get_var_at(opcodes[++ip]);
+				var* dst = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				PredecodedOps::get_mapped_unchecked(on, key, dst);
+			} DISPATCH();
+
 			case Opcode::SET_MAPPED: {
 				CHECK_OPCODE_SIZE(4);
 				var* on = context.get_var_at(opcodes[++ip]);
@@ -165,50 +204,61 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				*dst = false;
 			} break;
 
+			case Opcode::CLEAR: {
+				CHECK_OPCODE_SIZE(2);
+				var* dst = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				*dst = var();
+			} DISPATCH();
+
+			case Opcode::OPERATOR_INT:
+			case Opcode::OPERATOR_FLOAT:
 			case Opcode::OPERATOR: {
 				CHECK_OPCODE_SIZE(5);
 				ASSERT(opcodes[ip + 1] < var::_OP_MAX_);
+				Opcode opcode = (Opcode)opcodes[ip];
 				var::Operator op = (var::Operator)opcodes[++ip];
 				var* left = context.get_var_at(opcodes[++ip]);
 				var* right = context.get_var_at(opcodes[++ip]);
 				var* dst = context.get_var_at(opcodes[++ip]);
 				ip++;
 
+				if (profile != nullptr) _profile->record_operator(profile, last_ip, left, right);
+
+				// the typed operands are proven by the compiler, but they're still checked for a value which
+				// isn't (a parameter written through a reference) and it goes through the generic path.
+				if (opcode == Opcode::OPERATOR_INT) PredecodedOps::operator_int(op, left, right, dst);
+				else if (opcode == Opcode::OPERATOR_FLOAT) PredecodedOps::operator_float(op, left, right, dst);
+				else PredecodedOps::operator_generic(op, left, right, dst);
+			} break;
+
+			case Opcode::OPERATOR_ASSIGN: {
+				CHECK_OPCODE_SIZE(4);
+				var::Operator op = (var::Operator)opcodes[++ip];
+				var* dst = context.get_var_at(opcodes[++ip]);
+				var* value = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				// appending to a string or an array doesn't copy it, an instance could define __add_eq() ...
+				// for anything else it's the same as (+) and (=).
+				if (op == var::OP_ADDITION && value->get_type() == dst->get_type() &&
+					(dst->get_type() == var::STRING || dst->get_type() == var::ARRAY)) {
+					*dst += *value;
+					break;
+				}
+				if (dst->get_type() == var::OBJECT) {
+					ptr<Object> obj = dst->operator ptr<Object>();
+					if (!obj->_is_registered() && ptrcast<Instance>(obj)->call_operator_assign(op, *value)) break;
+				}
+
 				switch (op) {
-					case var::OP_ASSIGNMENT: {
-						THROW_BUG("assignment operations should be under ASSIGN opcode");
-					};
-					case var::OP_ADDITION: { *dst = *left + *right; } break;
-					case var::OP_SUBTRACTION: { *dst = *left - *right; } break;
-					case var::OP_MULTIPLICATION: { *dst = *left * *right; } break;
-					case var::OP_DIVISION: { *dst = *left / *right; } break;
-					case var::OP_MODULO: { *dst = *left % *right; } break;
-					case var::OP_POSITIVE: { *dst = *left; /* is it okey? */ } break;
-					case var::OP_NEGATIVE: {
-						if (left->get_type() == var::INT) {
-							*dst = -left->operator int64_t();
-						} else if (left->get_type() == var::FLOAT) {
-							*dst = -left->operator double();
-						} else {
-							THROW_ERROR(Error::OPERATOR_NOT_SUPPORTED,
-								String::format("operator (-) not supported on base %s.", left->get_type_name().c_str()));
-						}
-					} break;
-					case var::OP_EQ_CHECK: { *dst = *left == *right; } break;
-					case var::OP_NOT_EQ_CHECK: { *dst = *left != *right; } break;
-					case var::OP_LT: { *dst = *left < *right; } break;
-					case var::OP_LTEQ: { *dst = *left <= *right; } break;
-					case var::OP_GT: { *dst = *left > * right; } break;
-					case var::OP_GTEQ: { *dst = *left >= *right; } break;
-					case var::OP_AND: { *dst = *left && *right; } break;
-					case var::OP_OR: { *dst = *left || *right; } break;
-					case var::OP_NOT: { *dst = !*left; } break;
-					case var::OP_BIT_LSHIFT: { *dst = left->operator int64_t() << right->operator int64_t(); } break;
-					case var::OP_BIT_RSHIFT: { *dst = left->operator int64_t() >> right->operator int64_t(); } break;
-					case var::OP_BIT_AND: { *dst = left->operator int64_t() & right->operator int64_t(); } break;
-					case var::OP_BIT_OR: { *dst = left->operator int64_t() | right->operator int64_t(); } break;
-					case var::OP_BIT_XOR: { *dst = left->operator int64_t() ^ right->operator int64_t(); } break;
-					case var::OP_BIT_NOT: { *dst = ~left->operator int64_t(); } break;
+					case var::OP_ADDITION: { *dst = *dst + *value; } break;
+					case var::OP_SUBTRACTION: { *dst = *dst - *value; } break;
+					case var::OP_MULTIPLICATION: { *dst = *dst * *value; } break;
+					case var::OP_DIVISION: { *dst = *dst / *value; } break;
+					default:
+						THROW_BUG("invalid operator for OPERATOR_ASSIGN opcode");
 				}
 			} break;
 
@@ -221,6 +271,21 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				ip++;
 			} break;
 
+			case Opcode::CHECK_TYPE: {
+				CHECK_OPCODE_SIZE(3);
+				var::Type type = (var::Type)opcodes[++ip];
+				var* value = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				if (value->get_type() == type) break;
+				if (type == var::FLOAT && value->get_type() == var::INT) {
+					*value = value->operator double();
+					break;
+				}
+				THROW_ERROR(Error::TYPE_ERROR, String::format("expected a value of type \"%s\" but got \"%s\".",
+					var::get_type_name_s(type), value->get_type_name().c_str()));
+			} break;
+
 			case Opcode::CONSTRUCT_BUILTIN: {
 				CHECK_OPCODE_SIZE(4);
 				uint32_t b_type = opcodes[++ip];
@@ -313,6 +378,16 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				*dst = map;
 			} DISPATCH();
 
+			case Opcode::CONSTRUCT_LITERAL_CONST: {
+				CHECK_OPCODE_SIZE(3);
+				var* value = context.get_var_at(opcodes[++ip]);
+				var* dst = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				// the constant is never written, every evaluation of the literal is a new container.
+				*dst = value->copy(true);
+			} DISPATCH();
+
 			case Opcode::CALL: {
 				CHECK_OPCODE_SIZE(4);
 				var* on = context.get_var_at(opcodes[++ip]);
@@ -341,49 +416,37 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				var* ret_value = context.get_var_at(opcodes[++ip]);
 				ip++;
 
-				Bytecode* call_base;
-				ptr<Function> func_ptr;
-
-				// first search through inheritance
-				if (p_self != nullptr) {
-					call_base = p_self->blueprint.get();
-					while (call_base != nullptr) {
-						auto it = call_base->get_functions().find(func);
-						if (it != call_base->get_functions().end()) {
-							func_ptr = it->second;
-							break;
-						}
-						call_base = call_base->get_base_binary().get();
-					}
+				*ret_value = _call_function_by_name(func, p_func, p_bytecode, p_self, args, __stack + 1);
 
-				// search in static class functions
-				} else if (p_bytecode->is_class()) {
-					call_base = p_bytecode;
-					func_ptr = call_base->get_function(func);
-					if (func_ptr != nullptr && !func_ptr->is_static() && p_func->is_static()) {
-						THROW_BUG("can't call a non static function from static function");
-					}
-				}
+			} DISPATCH();
 
-				// search in the file
-				if (func_ptr == nullptr) {
-					if (p_bytecode->is_class()) call_base = p_bytecode->get_file().get();
-					else call_base = p_bytecode;
-				
-					auto& functions = call_base->get_functions();
-					auto it = functions.find(func);
-					if (it != functions.end()) func_ptr = it->second;
+			case Opcode::CALL_DIRECT: {
+				CHECK_OPCODE_SIZE(5);
+
+				uint32_t index = opcodes[++ip];
+				const String& func = context.get_name_at(opcodes[++ip]);
+				uint32_t argc = opcodes[++ip];
+				stdvec<var*> args(argc);
+				for (int i = 0; i < (int)argc; i++) {
+					var* arg = context.get_var_at(opcodes[++ip]);
+					args[i] = arg;
 				}
+				var* ret_value = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				// the target was resolved with the classes of the function's file, `this` could be an instance of a
+				// class from another file which overrides it (or a method called without it's instance).
+				const Bytecode* file = (p_func->_owner->is_class()) ? p_func->_owner->get_file().get() : p_func->_owner;
+				bool bound = (p_self == nullptr) == p_func->is_static();
+				if (bound && p_self != nullptr) bound = p_self->blueprint->get_file().get() == file;
 
-				//if (func_ptr == nullptr) THROW_BUG(String::format("can't find the function \"%s\"", func.c_str()));
-				if (func_ptr == nullptr) {
-					//*ret_value = NativeClasses::singleton()->call_method_on(p_self->native_instance, func, args);
-					*ret_value = Object::call_method_s(p_self->native_instance, func, args);
+				if (bound) {
+					const Function* fn = file->_direct_functions[index];
+					*ret_value = call_function(fn, fn->_owner, (fn->is_static()) ? nullptr : p_self, args, __stack + 1);
 				} else {
-					*ret_value = call_function(func_ptr.get(), call_base, (func_ptr->is_static()) ? nullptr : p_self, args, __stack + 1);
+					*ret_value = _call_function_by_name(func, p_func, p_bytecode, p_self, args, __stack + 1);
 				}
 
-
 			} DISPATCH();
 
 			case Opcode::CALL_METHOD: {
@@ -400,6 +463,7 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				var* ret_value = context.get_var_at(opcodes[++ip]);
 				ip++;
 
+				if (profile != nullptr) _profile->record(profile, last_ip, Profile::CALL_METHOD, on->get_type_name() + "." + method);
 				*ret_value = on->call_method(method, args);
 
 			} DISPATCH();
@@ -421,6 +485,18 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				ip++;
 			} DISPATCH();
 
+			case Opcode::CALL_INTRINSIC: {
+				CHECK_OPCODE_SIZE(5);
+				uint32_t func = opcodes[++ip];
+				var* arg0 = context.get_var_at(opcodes[++ip]);
+				var* arg1 = context.get_var_at(opcodes[++ip]);
+				var* ret = context.get_var_at(opcodes[++ip]);
+				ip++;
+
+				ASSERT(func < BuiltinFunctions::_FUNC_MAX_);
+				BuiltinFunctions::call_intrinsic((BuiltinFunctions::Type)func, *arg0, *arg1, *ret);
+			} DISPATCH();
+
 			case Opcode::CALL_SUPER_CTOR: {
 				CHECK_OPCODE_SIZE(2);
 				uint32_t argc = opcodes[++ip];
@@ -491,6 +567,9 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				CHECK_OPCODE_SIZE(2);
 				uint32_t addr = opcodes[++ip];
 				ip = addr;
+
+				// a loop's iteration, it could be predecoded and entered from the loop header.
+				if (addr < last_ip && predecoded == nullptr) predecoded = _get_hot_predecoded(p_func);
 			} DISPATCH();
 
 			case Opcode::JUMP_IF: {
@@ -509,6 +588,13 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				else ip++;
 			} DISPATCH();
 
+			case Opcode::JUMP_IF_DERIVED: {
+				CHECK_OPCODE_SIZE(2);
+				uint32_t addr = opcodes[++ip];
+				if (p_self == nullptr || p_self->blueprint.get() != context.bytecode_class) ip = addr;
+				else ip++;
+			} DISPATCH();
+
 			case Opcode::RETURN: {
 				CHECK_OPCODE_SIZE(2);
 				var* val = context.get_var_at(opcodes[++ip]);
@@ -543,7 +629,7 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				return var();
 			} DISPATCH();
 
-			MISSED_ENUM_CHECK(Opcode::END, 25);
+			MISSED_ENUM_CHECK(Opcode::END, 35);
 
 		}} catch (Throwable& err) {
 			ptr<Throwable> nested;
@@ -571,6 +657,17 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 				func = p_func->get_name();
 			}
 
+			// an inlined call gets a frame as if it was called, the line of the frame is the line of it's call.
+			const stdvec<InlineSite>& sites = p_func->get_inline_sites();
+			auto site_it = p_func->get_op_inline().lower_bound(last_ip);
+			uint32_t site = (site_it != p_func->get_op_inline().end()) ? site_it->second : 0;
+			while (site != 0 && site <= sites.size()) {
+				const InlineSite& inline_site = sites[site - 1];
+				nested = newptr<TraceBack>(nested, DBGSourceInfo(context.bytecode_file->get_name(), line, inline_site.name), _DBG_SOURCE);
+				line = inline_site.line;
+				site = inline_site.parent;
+			}
+
 			throw TraceBack(nested, DBGSourceInfo(context.bytecode_file->get_name(), line, func), _DBG_SOURCE);
 		}
 
@@ -578,6 +675,138 @@ var VM::call_function(const Function* p_func, Bytecode* p_bytecode, ptr<Instance
 	THROW_BUG("can't reach here");
 }
 
+var VM::_call_function_by_name(const String& p_name, const Function* p_func, Bytecode* p_bytecode, ptr<Instance> p_self, stdvec<var*>& p_args, int __stack) {
+	Bytecode* call_base = nullptr;
+	ptr<Function> func_ptr;
+
+	// first search through inheritance
+	if (p_self != nullptr) {
+		call_base = p_self->blueprint.get();
+		while (call_base != nullptr) {
+			auto it = call_base->get_functions().find(p_name);
+			if (it != call_base->get_functions().end()) {
+				func_ptr = it->second;
+				break;
+			}
+			call_base = call_base->get_base_binary().get();
+		}
+
+	// search in static class functions
+	} else if (p_bytecode->is_class()) {
+		call_base = p_bytecode;
+		func_ptr = call_base->get_function(p_name);
+		if (func_ptr != nullptr && !func_ptr->is_static() && p_func->is_static()) {
+			THROW_BUG("can't call a non static function from static function");
+		}
+	}
+
+	// search in the file
+	if (func_ptr == nullptr) {
+		if (p_bytecode->is_class()) call_base = p_bytecode->get_file().get();
+		else call_base = p_bytecode;
+
+		auto& functions = call_base->get_functions();
+		auto it = functions.find(p_name);
+		if (it != functions.end()) func_ptr = it->second;
+	}
+
+	//if (func_ptr == nullptr) THROW_BUG(String::format("can't find the function \"%s\"", p_name.c_str()));
+	if (func_ptr == nullptr) {
+		//return NativeClasses::singleton()->call_method_on(p_self->native_instance, p_name, p_args);
+		return Object::call_method_s(p_self->native_instance, p_name, p_args);
+	}
+	return call_function(func_ptr.get(), call_base, (func_ptr->is_static()) ? nullptr : p_self, p_args, __stack);
+}
+
+const PredecodedFunction* VM::_get_hot_predecoded(const Function* p_func) {
+	if (!_predecode_enabled || p_func->_predecoded_built) return p_func->_predecoded.get();
+	if (++p_func->_hot_count < PredecodedFunction::HOT_COUNT) return nullptr;
+	p_func->_predecoded_built = true;
+	p_func->_predecoded = PredecodedFunction::build(p_func);
+	if (_jit_enabled && p_func->_predecoded != nullptr) p_func->_predecoded->set_jit(JITFunction::compile(p_func->_predecoded.get()));
+	if (_profile != nullptr) _profile->set_hot(p_func);
+	return p_func->_predecoded.get();
+}
+
+bool VM::_run_predecoded(const PredecodedFunction* p_predecoded, int p_index, var** p_frame, uint32_t& r_ip, var& r_ret) {
+	const PredecodedInstruction* instructions = p_predecoded->get_instructions().data();
+	const PredecodedInstruction* instr = instructions + p_index;
+
+#define PD_A p_frame[instr->a]
+#define PD_B p_frame[instr->b]
+#define PD_C p_frame[instr->c]
+#define PD_JUMP() instr = instructions + instr->target; continue
+
+	while (true) {
+		r_ip = instr->ip;
+		switch (instr->op) {
+			case PredecodedInstruction::INTERPRET:
+				return false;
+
+			case PredecodedInstruction::MOVE:      *PD_C = *PD_A; break;
+			case PredecodedInstruction::SET_TRUE:  *PD_C = true; break;
+			case PredecodedInstruction::SET_FALSE: *PD_C = false; break;
+			case PredecodedInstruction::CLEAR:     *PD_C = var(); break;
+
+			case PredecodedInstruction::OPERATOR:       PredecodedOps::operator_generic((var::Operator)instr->imm, PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::ADD_INT:        PredecodedOps::add_int(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::SUB_INT:        PredecodedOps::sub_int(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::MUL_INT:        PredecodedOps::mul_int(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::OPERATOR_INT:   PredecodedOps::operator_int((var::Operator)instr->imm, PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::ADD_FLOAT:      PredecodedOps::add_float(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::SUB_FLOAT:      PredecodedOps::sub_float(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::MUL_FLOAT:      PredecodedOps::mul_float(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::OPERATOR_FLOAT: PredecodedOps::operator_float((var::Operator)instr->imm, PD_A, PD_B, PD_C); break;
+
+			case PredecodedInstruction::COMPARE_JUMP_INT:
+			case PredecodedInstruction::COMPARE_JUMP_FLOAT: {
+				bool is_float = instr->op == PredecodedInstruction::COMPARE_JUMP_FLOAT;
+				if (PredecodedOps::compare((var::Operator)instr->imm, is_float, PD_A, PD_B, PD_C) == instr->jump_if) {
+					PD_JUMP();
+				}
+				instr += 2; // the jump after it.
+			} continue;
+
+			case PredecodedInstruction::GET_MAPPED:           *PD_C = PD_A->__get_mapped(*PD_B); break;
+			case PredecodedInstruction::GET_MAPPED_UNCHECKED: PredecodedOps::get_mapped_unchecked(PD_A, PD_B, PD_C); break;
+			case PredecodedInstruction::SET_MAPPED:           PD_A->__set_mapped(*PD_B, *PD_C); break;
+			case PredecodedInstruction::CALL_INTRINSIC:
+				BuiltinFunctions::call_intrinsic((BuiltinFunctions::Type)instr->imm, *PD_A, *PD_B, *PD_C);
+				break;
+
+			case PredecodedInstruction::JUMP:
+				PD_JUMP();
+			case PredecodedInstruction::JUMP_IF:
+				if (PD_A->operator bool()) { PD_JUMP(); }
+				break;
+			case PredecodedInstruction::JUMP_IF_NOT:
+				if (!PD_A->operator bool()) { PD_JUMP(); }
+				break;
+
+			case PredecodedInstruction::ITER_BEGIN:
+				*PD_C = PD_A->__iter_begin();
+				break;
+			case PredecodedInstruction::ITER_NEXT:
+				if (!PD_A->__iter_has_next()) { PD_JUMP(); }
+				*PD_C = PD_A->__iter_next();
+				break;
+
+			case PredecodedInstruction::RETURN:
+				r_ret = *PD_A;
+				return true;
+			case PredecodedInstruction::END:
+				r_ret = var();
+				return true;
+		}
+		instr++;
+	}
+
+#undef PD_A
+#undef PD_B
+#undef PD_C
+#undef PD_JUMP
+}
+
 int VM::run(ptr<Bytecode> bytecode, stdvec<String> args) {
 
 	const Function* main = bytecode->get_main();
@@ -643,7 +872,7 @@ var* RuntimeContext::get_var_at(const Address& p_addr) {
 		} break;
 		case Address::MEMBER_VAR: {
 			stdvec<var>& members = self.operator ptr<Instance>()->members;
-			THROW_INVALID_INDEX(members.size(), index);
+			ASSERT(index < members.size());
 			return &members[index];
 		} break;
 		case Address::STATIC_MEMBER: {
@@ -655,7 +884,8 @@ var* RuntimeContext::get_var_at(const Address& p_addr) {
 			return member;
 		} break;
 		case Address::CONST_VALUE: {
-			return bytecode_file->get_global_const_value(index);
+			ASSERT(index < bytecode_file->_global_const_values.size());
+			return &bytecode_file->_global_const_values[index];
 		} break;
 
 		MISSED_ENUM_CHECK(Address::CONST_VALUE, 10);
@@ -674,7 +904,8 @@ int RuntimeContext::get_arg_value_index(int p_arg_ind) const {
 }
 
 const String& RuntimeContext::get_name_at(uint32_t p_pos) {
-	return bytecode_file->get_global_name(p_pos);
+	ASSERT(p_pos < bytecode_file->_global_names_array.size());
+	return bytecode_file->_global_names_array[p_pos];
 }
 
 var* VM::_get_native_ref(const String& p_name) {
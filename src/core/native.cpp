@@ -61,11 +61,18 @@ void NativeClasses::bind_data(ptr<BindData> p_bind_data) {
 	entries.bind_data[data_name.hash()] = p_bind_data;
 }
 
+NativeClasses::ClassEntries* NativeClasses::_get_entries(const String& p_class_name) {
+	auto it = classes.find(p_class_name.hash());
+	if (it == classes.end() || it->second.class_name.size() == 0) return nullptr;
+	return &it->second;
+}
+
 ptr<BindData> NativeClasses::get_bind_data(const String& cls, const String& attrib) {
-	if (!is_class_registered(cls))
+	ClassEntries* entries = _get_entries(cls);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("class \"%s\" not registered on NativeClasses entries.", cls.c_str()));
-	auto it = classes[cls.hash()].bind_data.find(attrib.hash());
-	if (it == classes[cls.hash()].bind_data.end()) return nullptr;
+	auto it = entries->bind_data.find(attrib.hash());
+	if (it == entries->bind_data.end()) return nullptr;
 	return it->second;
 }
 
@@ -101,25 +108,28 @@ void NativeClasses::set_new_function(const String& p_class_name, __new_f p__new)
 }
 
 String NativeClasses::get_inheritance(const String& p_class_name) {
-	if (classes[p_class_name.hash()].class_name.size() == 0)
+	ClassEntries* entries = _get_entries(p_class_name);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("class \"%s\" isn't registered in native class entries.", p_class_name.c_str()));
-	return classes[p_class_name.hash()].parent_class_name;
+	return entries->parent_class_name;
 }
 
 bool NativeClasses::is_class_registered(const String& p_class_name) {
-	return classes[p_class_name.hash()].class_name.size() != 0;
+	return _get_entries(p_class_name) != nullptr;
 }
 
 ptr<Object> NativeClasses::_new(const String& p_class_name) {
-	if (!is_class_registered(p_class_name))
+	ClassEntries* entries = _get_entries(p_class_name);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("the class \"%s\" isn't registered in native class entries.", p_class_name.c_str()));
-	return classes[p_class_name.hash()].__new();
+	return entries->__new();
 }
 
 const StaticFuncBind* NativeClasses::get_constructor(const String& p_class_name) {
-	if (!is_class_registered(p_class_name))
+	ClassEntries* entries = _get_entries(p_class_name);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("the class \"%s\" isn't registered in native class entries.", p_class_name.c_str()));
-	return classes[p_class_name.hash()].__constructor;
+	return entries->__constructor;
 }
 
 ptr<Object> NativeClasses::construct(const String& p_class_name, stdvec<var*>& p_args) {
@@ -131,15 +141,17 @@ ptr<Object> NativeClasses::construct(const String& p_class_name, stdvec<var*>& p
 }
 
 const stdmap<size_t, ptr<BindData>>& NativeClasses::get_bind_data_list(const String& p_class_name) {
-	if (!is_class_registered(p_class_name))
+	ClassEntries* entries = _get_entries(p_class_name);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("the class \"%s\" isn't registered in native class entries.", p_class_name.c_str()));
-	return classes[p_class_name.hash()].bind_data;
+	return entries->bind_data;
 }
 
 const stdmap<size_t, ptr<MemberInfo>>& NativeClasses::get_member_info_list(const String& p_class_name) {
-	if (!is_class_registered(p_class_name))
+	ClassEntries* entries = _get_entries(p_class_name);
+	if (entries == nullptr)
 		THROW_ERROR(Error::ATTRIBUTE_ERROR, String::format("the class \"%s\" isn't registered in native class entries.", p_class_name.c_str()));
-	return classes[p_class_name.hash()].member_info;
+	return entries->member_info;
 }
 
 var NativeClasses::call_static(const String& p_base, const String& p_attrib, stdvec<var*>& p_args) {
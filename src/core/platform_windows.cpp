@@ -207,6 +207,40 @@ stdvec<std::string> _Platform::path_listdir(const std::string& p_path) {
 	return ret;
 }
 
+void* _Platform::dl_open(const std::string& p_path) {
+	HMODULE handle = LoadLibraryA(p_path.c_str());
+	if (handle == NULL) {
+		THROW_ERROR(Error::IO_ERROR, String::format("can't load library \"%s\".", p_path.c_str()));
+	}
+	return (void*)handle;
+}
+
+void* _Platform::dl_symbol(void* p_handle, const std::string& p_name) {
+	return (void*)GetProcAddress((HMODULE)p_handle, p_name.c_str());
+}
+
+const void* _Platform::file_map(const std::string& p_path, size_t* r_size) {
+	HANDLE file = CreateFileA(p_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return nullptr;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL) return nullptr;
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping); // the view keeps the mapping.
+	if (data == NULL) return nullptr;
+	*r_size = (size_t)size.QuadPart;
+	return data;
+}
+
+void _Platform::file_unmap(const void* p_data, size_t p_size) {
+	UnmapViewOfFile(p_data);
+}
+
 }
 
 #endif // PLATFORM_WINDOWS
\ No newline at end of file
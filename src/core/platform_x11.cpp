@@ -31,6 +31,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 
 namespace carbon {
 
@@ -157,6 +160,37 @@ bool _Platform::path_isdir(const std::string& p_path) {
     return false;
 }
 
+void* _Platform::dl_open(const std::string& p_path) {
+	void* handle = dlopen(p_path.c_str(), RTLD_NOW);
+	if (handle == nullptr) {
+		THROW_ERROR(Error::IO_ERROR, String::format("can't load library \"%s\" (%s).", p_path.c_str(), dlerror()));
+	}
+	return handle;
+}
+
+void* _Platform::dl_symbol(void* p_handle, const std::string& p_name) {
+	return dlsym(p_handle, p_name.c_str());
+}
+
+const void* _Platform::file_map(const std::string& p_path, size_t* r_size) {
+	int fd = open(p_path.c_str(), O_RDONLY);
+	if (fd < 0) return nullptr;
+	struct stat _stat;
+	if (fstat(fd, &_stat) != 0 || _stat.st_size == 0) {
+		close(fd);
+		return nullptr;
+	}
+	void* data = mmap(nullptr, (size_t)_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping keeps the file.
+	if (data == MAP_FAILED) return nullptr;
+	*r_size = (size_t)_stat.st_size;
+	return data;
+}
+
+void _Platform::file_unmap(const void* p_data, size_t p_size) {
+	munmap((void*)p_data, p_size);
+}
+
 } // namespace carbon
 
 #endif // PLATFORM_WINDOWS
\ No newline at end of file
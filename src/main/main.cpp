@@ -28,6 +28,8 @@
 #include "carbon.h"
 using namespace carbon;
 
+#include <chrono>
+
 #define CARBON_INCLUDE_CRASH_HANDLER_MAIN
 #define CARBON_CRASH_HANDLER_IMPLEMENTATION
 #include "crash_handler.h"
@@ -51,6 +53,18 @@ Options:
     -o                  : Output path.
     -w                  : Warnings are treated as errors.
     -I(path)            : Import search path.
+    --dump-ir           : Print the optimized IR of each function and exit.
+    --bench-tokenizer   : Tokenize the file repeatedly and print the tokens per second.
+    --bench-compile     : Compile the file repeatedly and print the time and the node memory.
+    --no-predecode      : Interpret every function (hot functions aren't predecoded).
+    --no-jit            : Run the predecoded hot functions without compiling them to machine code.
+    --aot <out.cpp>     : Write the native code of the file as a C++ module and exit.
+    --load <module>     : Load a module written by --aot (can be repeated).
+    --profile <file>    : Record the types seen by the interpreter and write them to the file.
+    --use-profile <file>: Specialize the functions with a profile written by --profile.
+    --jobs <count>      : Threads to compile the imports with (default: the core count).
+    --cache             : Write the compiled files as .cbc next to them and load those while valid.
+    --cache-dir <dir>   : Same as --cache but the .cbc files are written to the directory.
 )");
 }
 
@@ -65,11 +79,125 @@ int _main(int argc, char** argv) {
 			log_help();
 		} else {
 			// TODO: properly parse command line args
-			stdvec<String> args;
-			for (int i = 1; i < argc; i++) args.push_back(argv[i]);
+			if (String(argv[1]) == "--dump-ir") {
+				if (argc < 3) {
+					log_help();
+				} else {
+					ptr<Bytecode> bytecode = Compiler::singleton()->compile(argv[2]);
+					Logger::log(IRFunction::dump_bytecode(bytecode.get()).c_str());
+				}
+			} else if (String(argv[1]) == "--bench-tokenizer") {
+				if (argc < 3) {
+					log_help();
+				} else {
+					ptr<File> file = newptr<File>(argv[2]);
+					String source = file->read_text();
+					file->close();
+
+					Tokenizer tokenizer;
+					size_t token_count = 0;
+					int runs = 0;
+					auto begin = std::chrono::steady_clock::now();
+					double seconds = 0;
+					while (seconds < 1.0) { // at least a second.
+						tokenizer.tokenize(source, argv[2]);
+						token_count += tokenizer.get_token_count();
+						runs++;
+						seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+					}
+					Logger::log(String::format("%i runs, %lli tokens in %f seconds (%.0f tokens/sec)\n",
+						runs, (long long)token_count, seconds, token_count / seconds).c_str());
+				}
+			} else if (String(argv[1]) == "--bench-compile") {
+				if (argc < 3) {
+					log_help();
+				} else {
+					ptr<File> file = newptr<File>(argv[2]);
+					String source = file->read_text();
+					file->close();
+
+					size_t allocated = 0, reserved = 0;
+					int runs = 0;
+					auto begin = std::chrono::steady_clock::now();
+					double seconds = 0;
+					double phases[4] = { 0, 0, 0, 0 }; // tokenize, parse, analyze, codegen.
+					while (seconds < 1.0) { // at least a second.
+						ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+						ptr<Parser> parser = newptr<Parser>();
+						ptr<Analyzer> analyzer = newptr<Analyzer>();
+						ptr<CodeGen> codegen = newptr<CodeGen>();
+						auto t0 = std::chrono::steady_clock::now();
+						tokenizer->tokenize(source, argv[2]);
+						auto t1 = std::chrono::steady_clock::now();
+						parser->parse(tokenizer);
+						auto t2 = std::chrono::steady_clock::now();
+						analyzer->analyze(parser);
+						auto t3 = std::chrono::steady_clock::now();
+						codegen->generate(analyzer);
+						auto t4 = std::chrono::steady_clock::now();
+						phases[0] += std::chrono::duration<double>(t1 - t0).count();
+						phases[1] += std::chrono::duration<double>(t2 - t1).count();
+						phases[2] += std::chrono::duration<double>(t3 - t2).count();
+						phases[3] += std::chrono::duration<double>(t4 - t3).count();
+						allocated = parser->get_arena()->get_allocated();
+						reserved = parser->get_arena()->get_reserved();
+						runs++;
+						seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+					}
+					Logger::log(String::format("%i runs in %f seconds (%f ms per compile), nodes: %lli bytes in %lli bytes of arena\n",
+						runs, seconds, seconds * 1000 / runs, (long long)allocated, (long long)reserved).c_str());
+					Logger::log(String::format("tokenize: %f ms, parse: %f ms, analyze: %f ms, codegen: %f ms\n",
+						phases[0] * 1000 / runs, phases[1] * 1000 / runs, phases[2] * 1000 / runs, phases[3] * 1000 / runs).c_str());
+				}
+			} else {
+				int file = 1;
+				String aot_path, profile_path;
+				ptr<Profile> profile;
+				while (file < argc && String(argv[file]).startswith("--")) {
+					String option = argv[file++];
+					if (option == "--no-predecode") {
+						VM::singleton()->set_predecode_enabled(false);
+					} else if (option == "--no-jit") {
+						VM::singleton()->set_jit_enabled(false);
+					} else if (option == "--aot" && file < argc) {
+						aot_path = argv[file++];
+					} else if (option == "--load" && file < argc) {
+						Compiler::singleton()->add_aot_module(AOTModule::load(argv[file++]));
+					} else if (option == "--profile" && file < argc) {
+						profile_path = argv[file++];
+					} else if (option == "--use-profile" && file < argc) {
+						profile = Profile::load(argv[file++]);
+						Compiler::singleton()->set_profile(profile);
+					} else if (option == "--jobs" && file < argc) {
+						Compiler::singleton()->set_thread_count(String(argv[file++]).to_int());
+					} else if (option == "--cache") {
+						Compiler::singleton()->set_bytecode_cache(true);
+					} else if (option == "--cache-dir" && file < argc) {
+						Compiler::singleton()->set_bytecode_cache(true, argv[file++]);
+					} else {
+						file = argc; // invalid option.
+					}
+				}
+				if (profile_path.size() > 0) { // continues the used profile.
+					VM::singleton()->set_profile((profile != nullptr) ? profile : newptr<Profile>());
+				}
+				if (file >= argc) {
+					log_help();
+				} else if (aot_path.size() > 0) {
+					ptr<Bytecode> bytecode = Compiler::singleton()->compile(argv[file]);
+					ptr<File> out = newptr<File>();
+					out->open(aot_path, File::WRITE);
+					out->write_text(AOTModule::write(bytecode.get()));
+					out->close();
+				} else {
+					stdvec<String> args;
+					for (int i = file; i < argc; i++) args.push_back(argv[i]);
 
-			ptr<Bytecode> bytecode = Compiler::singleton()->compile(argv[1]);
-			VM::singleton()->run(bytecode, args);
+					ptr<Bytecode> bytecode = Compiler::singleton()->compile(argv[file]);
+					VM::singleton()->run(bytecode, args);
+					if (profile_path.size() > 0) VM::singleton()->get_profile()->save(profile_path);
+				}
+			}
 		}
 	} catch (Throwable& err) {
 		err.console_log();
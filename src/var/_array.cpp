@@ -153,11 +153,13 @@ bool Array::operator ==(const Array& p_other) const {
 
 Array Array::copy(bool p_deep) const {
 	Array ret;
-	for (size_t i = 0; i < size(); i++) {
-		if (p_deep)
-			ret.push_back(operator[](i).copy(true));
-		else
-			ret.push_back(operator[](i));
+	*ret._data = *_data;
+	if (p_deep) {
+		// only the references need a copy, the other values are already copied.
+		for (var& value : *ret._data) {
+			var::Type type = value.get_type();
+			if (type == var::ARRAY || type == var::MAP || type == var::OBJECT) value = value.copy(true);
+		}
 	}
 	return ret;
 }
@@ -173,7 +175,8 @@ Array Array::operator+(const Array& p_other) const {
 }
 
 Array& Array::operator+=(const Array& p_other) {
-	for (size_t i = 0; i < p_other.size(); i++) {
+	size_t size = p_other.size(); // `arr += arr;`
+	for (size_t i = 0; i < size; i++) {
 		push_back(p_other[i].copy());
 	}
 	return *this;
@@ -91,11 +91,11 @@ String Map::to_string() const {
 
 Map Map::copy(bool p_deep) const {
 	Map ret;
-	for (_map_internal_t::iterator it = (*_data).begin(); it != (*_data).end(); it++) {
-		if (p_deep) {
-			ret[it->first] = it->second.copy(true);
-		} else {
-			ret[it->first] = it->second;
+	*ret._data = *_data; // copies the tree without comparing the keys.
+	if (p_deep) {
+		for (_map_internal_t::iterator it = (*ret._data).begin(); it != (*ret._data).end(); it++) {
+			var::Type type = it->second.get_type();
+			if (type == var::ARRAY || type == var::MAP || type == var::OBJECT) it->second = it->second.copy(true);
 		}
 	}
 	return ret;
@@ -294,6 +294,7 @@ VAR_OP_PRE_INCR_DECR(++)
 #undef VAR_OP_POST_INCR_DECR
 
 	var& var::operator=(const var& p_other) {
+	if (this == &p_other) return *this; // copy_data() clears it first.
 	copy_data(p_other);
 	return *this;
 }
@@ -38,6 +38,10 @@ TEST_CASE("[analyzer_tests]:analyzer_failure") {
 		}
 	})");
 
+	// propagated local constants.
+	CHECK_THROWS__ANALYZE(Error::ZERO_DIVISION, "func f() { var x = 1; println(x / 0); }");
+	CHECK_THROWS__ANALYZE(Error::ZERO_DIVISION, "func f(a) { var x = 0; if (a) { x = 0; } println(1 / x); }");
+
 	// functions and arguments.
 	CHECK_THROWS__ANALYZE(Error::INVALID_ARG_COUNT, "func f(arg1, arg2 = \"default\"){} func g(){ f(); }");
 	CHECK_THROWS__ANALYZE(Error::INVALID_ARG_COUNT, "func f(arg1, arg2 = \"default\"){} func g(){ f(1, false, -3.14); }");
@@ -56,6 +60,21 @@ TEST_CASE("[analyzer_tests]:analyzer_failure") {
 	CHECK_THROWS__ANALYZE(Error::ATTRIBUTE_ERROR, "class A{ func f(){} } class B:A{ static func g(){ super.f(); } }");
 	CHECK_THROWS__ANALYZE(Error::ATTRIBUTE_ERROR, "class A{ /*non static*/ func f(){} } var x = A.f;");
 
+	// const functions
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "const func f(x) { print(x); }");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "var v = 1; const func f() = v;");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func g() {} const func f() = g();");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "const func f(x&) { x = 1; }");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "class Aclass { static var s; const func f() = s; }");
+	CHECK_THROWS__ANALYZE(Error::ZERO_DIVISION, "const func f(x) = 1 / x; const C = f(0);");
+
+	// type annotations
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func f() { var x: int = \"1\"; }");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func f() { var x: int = 1; x = 2.5; }");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func f(a: String = 1) {}");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func f(a: int, b: int): bool { return a + b; }");
+	CHECK_THROWS__ANALYZE(Error::TYPE_ERROR, "func f(): int { return; }");
+
 	// super errors
 
 	// TODO: more invalid attribute access tests
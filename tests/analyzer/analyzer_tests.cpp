@@ -120,6 +120,23 @@ line 2
 	//CHECK_NOTHROW__ANALYZE("func fn() {} var v = fn.get_name();");
 	// if ref of identifier is func pass it as callable object.
 
+	// const functions.
+	CHECK_NOTHROW__ANALYZE("const func sq(x) = x * x; const C = sq(7); __assert(C == 49);");
+	CHECK_NOTHROW__ANALYZE("const func f(a, b = 2) = a + b; const C = f(1); __assert(C == 3);");
+	CHECK_NOTHROW__ANALYZE("const func fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); } const C = fib(15); __assert(C == 610);");
+	CHECK_NOTHROW__ANALYZE("class Aclass { const func twice(x) = 2 * x; } const C = Aclass.twice(21); __assert(C == 42);");
+	CHECK_NOTHROW__ANALYZE(R"(
+		const func table(n) {
+			var arr = [];
+			for (var i = 0; i < n; i += 1) arr.append(i * i);
+			var sum = 0;
+			for (var x : arr) sum += x;
+			return sum;
+		}
+		const C = table(4); __assert(C == 14);
+		func fn(x) { return table(x); } // evaluated at runtime.
+	)");
+
 	// Native classes.
 	CHECK_NOTHROW__ANALYZE("const C = File.READ;");
 	CHECK_NOTHROW__ANALYZE("var now = OS.unix_time; var time = now();");
@@ -132,4 +149,33 @@ line 2
 	// attribute access tests.
 
 
-}
\ No newline at end of file
+}
+TEST_CASE("[analyzer_tests]:symbol_tables") {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	Analyzer analyzer;
+
+	// every kind of member through the file and class tables.
+	CHECK_NOTHROW__ANALYZE(R"(
+		enum { A = 1 } enum { B = A + 1 } enum E { V = B }
+		const C = E.V + 1;
+		class Aclass { const K = C; enum { X = K } func f() { return X; } }
+		__assert(A == 1 && B == 2 && C == 3 && Aclass.K == 3 && Aclass.X == 3);
+	)");
+	CHECK_NOTHROW__ANALYZE(R"(
+		class Base { var b = 1; func g() { return b; } }
+		class Derived : Base { func h() { return g() + b; } }
+	)");
+
+	// locals of the outer blocks.
+	CHECK_NOTHROW__ANALYZE(R"(
+		func f(a) {
+			const K = 2; var x = a;
+			for (var i : [1, 2]) { if (i) { var y = x + i; while (y) { y -= K; } } }
+			return x;
+		}
+	)");
+	CHECK_THROWS__ANALYZE(Error::NAME_ERROR, "func f() { if (true) { var x = 1; } return x; }");
+	CHECK_THROWS__ANALYZE(Error::NAME_ERROR, "func f() { var y = x; var x = 1; }");
+	CHECK_THROWS__ANALYZE(Error::ATTRIBUTE_ERROR, "class Aclass { func Aclass() {} } func f() { return Aclass.g; }");
+}
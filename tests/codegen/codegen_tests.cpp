@@ -11,7 +11,7 @@ TEST_CASE("[codeten_tests]:codegen_tests") {
 	CHECK_NOTHROW__CODEGEN(R"(
 	var x = "some string";
 	const C = "another string";
-	func f(arg, arg2 = 2) { var x = arg; }
+	func f(arg, arg2 = 2) { var x = arg; if (arg2) x = 3; return x; }
 )");
 	CHECK(bytecode->get_static_var("x") != nullptr); // but value of v is null till runtime.
 	CHECK(bytecode->get_constant("C") == "another string");
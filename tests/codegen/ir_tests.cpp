@@ -0,0 +1,670 @@
+//------------------------------------------------------------------------------
+// MIT License
+//------------------------------------------------------------------------------
+// 
+// Copyright (c) 2020-2021 Thakee Nathees
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//------------------------------------------------------------------------------
+
+#include "../carbon_tests.h"
+
+static ptr<Bytecode> _compile_ir_test(const String& p_source) {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	CodeGen codegen;
+	_PARSE(p_source);
+	analyzer->analyze(parser);
+	return codegen.generate(analyzer);
+}
+
+static var _call_ir_test(ptr<Bytecode>& p_bytecode, const String& p_func, stdvec<var> p_args = {}) {
+	stdvec<var*> args;
+	for (var& arg : p_args) args.push_back(&arg);
+	return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+}
+
+TEST_CASE("[codegen_tests]:ir_tests") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func sum_to(n) {
+		var total = 0;
+		for (var i = 0; i < n; i += 1) {
+			if (i % 2 == 0) { total += i; }
+			else { total -= 1; }
+		}
+		return total;
+	}
+	func first_even(arr) {
+		for (var x : arr) {
+			if (x % 2 == 0) return x;
+		}
+		while (true) { break; }
+		return -1;
+	}
+)");
+	CHECK(_call_ir_test(bytecode, "sum_to", { 10 }) == 15);
+	CHECK(_call_ir_test(bytecode, "first_even", { Array(1, 3, 4, 5) }) == 4);
+	CHECK(_call_ir_test(bytecode, "first_even", { Array(1, 3) }) == -1);
+
+	// lifting the generated opcodes and lowering them back is lossless.
+	for (auto& it : bytecode->get_functions()) {
+		const Function* fn = it.second.get();
+		IRFunction ir = IRFunction::build(fn->get_opcodes(), fn->get_op_dbg(), fn->get_stack_size());
+		CHECK(ir.get_opcode_count() == fn->get_opcodes().size());
+
+		stdvec<uint32_t> opcodes; stdmap<uint32_t, uint32_t> op_dbg;
+		ir.lower(opcodes, op_dbg);
+		CHECK(opcodes == fn->get_opcodes());
+
+		// every instruction reports the same line.
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			auto lowered = op_dbg.lower_bound(ip);
+			auto original = fn->get_op_dbg().lower_bound(ip);
+			REQUIRE(lowered != op_dbg.end());
+			REQUIRE(original != fn->get_op_dbg().end());
+			CHECK(lowered->second == original->second);
+		}
+
+		// no jump to a jump or to the next block are left after simplify-cfg.
+		for (const IRBlock& block : ir.blocks) {
+			const IRInstruction* term = block.get_terminator();
+			if (term == nullptr || !term->is_branch()) continue;
+			uint32_t target = term->words[term->get_target_word()];
+			if (term->get_opcode() == Opcode::JUMP) CHECK(target != block.id + 1);
+			if (target < ir.blocks.size() && ir.blocks[target].instructions.size() == 1) {
+				CHECK(ir.blocks[target].instructions[0].get_opcode() != Opcode::JUMP);
+			}
+		}
+	}
+
+	String dump = IRFunction::dump_bytecode(bytecode.get());
+	CHECK(dump.find("func sum_to") >= 0);
+	CHECK(dump.find("ITER_NEXT") >= 0);
+}
+
+TEST_CASE("[codegen_tests]:ir_passes") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func set_ref(x&) { x = 42; }
+	func folded() {
+		var x = 2;
+		var y = x * 3;
+		if (y > 5) return y;
+		return 0;
+	}
+	func loop() { var i = 0; while (i < 3) { i += 1; } return i; }
+	func by_ref() { var k = 1; set_ref(k); return k; }
+	func merge(a) { var x = 1; if (a) { x = 2; } return x; }
+	func compare() { return 3 <= 3 and 2 >= 3 == false; }
+	func dead_store(a) { var t = a; t = 5; return t; }
+	func after_break() { while (true) { break; println("unreachable"); } return 1; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "folded") == 6);
+	CHECK(_call_ir_test(bytecode, "loop") == 3);
+	CHECK(_call_ir_test(bytecode, "by_ref") == 42);
+	CHECK(_call_ir_test(bytecode, "merge", { true }) == 2);
+	CHECK(_call_ir_test(bytecode, "merge", { false }) == 1);
+	CHECK(_call_ir_test(bytecode, "compare") == true);
+	CHECK(_call_ir_test(bytecode, "dead_store", { 1 }) == 5);
+	CHECK(_call_ir_test(bytecode, "after_break") == 1);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// x and y are propagated: `return 6;` and the constant branch is folded.
+	const Function* folded = bytecode->get_function("folded").get();
+	CHECK(count_opcode(folded, Opcode::OPERATOR) == 0);
+	CHECK(count_opcode(folded, Opcode::JUMP_IF_NOT) == 0);
+	CHECK(count_opcode(folded, Opcode::RETURN) == 1);
+
+	// `var t = a;` is overwritten before it's read.
+	CHECK(count_opcode(bytecode->get_function("dead_store").get(), Opcode::ASSIGN) == 0);
+
+	// the loop is non-terminating without the break, statements after the break are removed.
+	CHECK(count_opcode(bytecode->get_function("after_break").get(), Opcode::CALL_BUILTIN) == 0);
+}
+
+TEST_CASE("[codegen_tests]:ir_inline") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func sq(x) {
+		return x * x;
+	}
+	func add(a, b = 5) { return a + b; }
+	func use(a) { return sq(a) + sq(3) + add(1); }
+	func set_ref(x&) { x = 42; }
+	func use_ref() { var k = 1; set_ref(k); return k; }
+
+	class A {
+		func f() { return 1; }
+		func g() { return f() + this.f() + 10; }
+	}
+	class B : A {
+		func f() { return 2; }
+	}
+	func test_a() { return A().g(); }
+	func test_b() { return B().g(); }
+)");
+
+	CHECK(_call_ir_test(bytecode, "use", { 2 }) == 19);
+	CHECK(_call_ir_test(bytecode, "use_ref") == 42);
+	CHECK(_call_ir_test(bytecode, "test_a") == 12);
+	CHECK(_call_ir_test(bytecode, "test_b") == 14); // B.f() is called through the guard.
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	const Function* use = bytecode->get_function("use").get();
+	CHECK(count_opcode(use, Opcode::CALL_FUNC) == 0);
+	CHECK(count_opcode(bytecode->get_function("use_ref").get(), Opcode::CALL_DIRECT) == 1); // reference parameter.
+
+	// the inlined body reports the line of the callee.
+	uint32_t sq_line = bytecode->get_function("sq")->get_op_dbg().begin()->second;
+	bool has_sq_line = false;
+	for (auto& it : use->get_op_dbg()) has_sq_line = has_sq_line || it.second == sq_line;
+	CHECK(has_sq_line);
+
+	// the method could be overridden, the call is kept behind the guard.
+	const Function* g = bytecode->get_class("A")->get_functions().at("g").get();
+	CHECK(count_opcode(g, Opcode::JUMP_IF_DERIVED) == 2);
+}
+
+TEST_CASE("[codegen_tests]:ir_direct_call") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func fact(n) {
+		if (n <= 1) return 1;
+		return n * fact(n - 1);
+	}
+
+	class A {
+		func count(n) { if (n == 0) return 0; return 1 + this.count(n - 1); }
+		func over(n) { if (n == 0) return 0; return 1 + this.over(n - 1); }
+		static func sum(n) { if (n == 0) return 0; return n + sum(n - 1); }
+	}
+	class B : A {
+		func over(n) { if (n == 0) return 0; return 10 + this.over(n - 1); }
+	}
+	func test_a() { return A().count(3) + A().over(3); }
+	func test_b() { return B().count(3) + B().over(3); }
+	func test_static() { return A.sum(4); }
+)");
+
+	CHECK(_call_ir_test(bytecode, "fact", { 5 }) == 120);
+	CHECK(_call_ir_test(bytecode, "test_a") == 6);
+	CHECK(_call_ir_test(bytecode, "test_b") == 33);
+	CHECK(_call_ir_test(bytecode, "test_static") == 10);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	CHECK(count_opcode(bytecode->get_function("fact").get(), Opcode::CALL_DIRECT) == 1);
+
+	// A.count isn't overridden in any class of the file, A.over is.
+	const stdmap<String, ptr<Function>>& functions = bytecode->get_class("A")->get_functions();
+	CHECK(count_opcode(functions.at("count").get(), Opcode::CALL_DIRECT) == 1);
+	CHECK(count_opcode(functions.at("over").get(), Opcode::CALL_DIRECT) == 0);
+	CHECK(count_opcode(functions.at("over").get(), Opcode::CALL_METHOD) == 1);
+	CHECK(count_opcode(functions.at("sum").get(), Opcode::CALL_DIRECT) == 1);
+}
+
+TEST_CASE("[codegen_tests]:ir_loops") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func count_o() {
+		var s = "hello world"; var n = 0;
+		for (var i = 0; i < s.size(); i += 1) { if (s[i] == "o") n += 1; }
+		return n;
+	}
+	func fill() {
+		var arr = Array(); arr.resize(5);
+		for (var i = 0; i < arr.size(); i += 1) arr[i] = i * 2;
+		var t = 0;
+		for (var i = 0; i < arr.size(); i += 1) t += arr[i];
+		return t;
+	}
+	func shrink() {
+		var arr = [1, 2, 3, 4, 5]; var t = 0;
+		for (var i = 0; i < arr.size(); i += 1) { t += arr[i]; arr.pop(); }
+		return t;
+	}
+	func sum(arr: Array) {
+		var total = 0;
+		for (var i = 0; i < arr.size(); i += 1) total += arr[i];
+		return total;
+	}
+	func sum_local() {
+		var arr = [1, 2, 3, 4]; var total = 0;
+		for (var i = 0; i < arr.size(); i += 1) total += arr[i];
+		return total;
+	}
+	func sum_untyped(arr) {
+		var total = 0;
+		for (var i = 0; i < arr.size(); i += 1) total += arr[i];
+		return total;
+	}
+)");
+
+	CHECK(_call_ir_test(bytecode, "count_o") == 2);
+	CHECK(_call_ir_test(bytecode, "fill") == 20);
+	CHECK(_call_ir_test(bytecode, "shrink") == 6);
+	CHECK(_call_ir_test(bytecode, "sum", { Array(1, 2.5, 3) }) == 6.5);
+	CHECK(_call_ir_test(bytecode, "sum_local") == 10);
+	CHECK(_call_ir_test(bytecode, "sum_untyped", { Array(1, 2, 3) }) == 6);
+	CHECK_THROWS(_call_ir_test(bytecode, "sum", { Array(1, "a") }));
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// the size() call is moved before the header of the first loop (the target of it's back jump).
+	auto size_hoisted = [](const Function* p_func) -> bool {
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		uint32_t call = 0, header = 0;
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == Opcode::CALL_METHOD && call == 0) call = ip;
+			if (opcodes[ip] == Opcode::JUMP && opcodes[ip + 1] < ip && header == 0) header = opcodes[ip + 1];
+		}
+		return call < header;
+	};
+
+	const Function* count_o = bytecode->get_function("count_o").get();
+	CHECK(size_hoisted(count_o));
+	CHECK(count_opcode(count_o, Opcode::GET_MAPPED_UNCHECKED) == 1);
+	CHECK(count_opcode(count_o, Opcode::GET_MAPPED) == 0);
+
+	// size() of both the loops are hoisted, `t += arr[i]` on a number can't call an element's operator.
+	const Function* fill = bytecode->get_function("fill").get();
+	CHECK(count_opcode(fill, Opcode::CALL_METHOD) == 3);
+	CHECK(count_opcode(fill, Opcode::GET_MAPPED_UNCHECKED) == 1);
+
+	// pop() changes the size in the loop, but it's compared again before the indexing.
+	const Function* shrink = bytecode->get_function("shrink").get();
+	CHECK(!size_hoisted(shrink));
+	CHECK(count_opcode(shrink, Opcode::GET_MAPPED_UNCHECKED) == 1);
+
+	// an annotated parameter is an Array, the accumulator starting with 0 is a number.
+	for (const char* name : { "sum", "sum_local" }) {
+		const Function* fn = bytecode->get_function(name).get();
+		CHECK(size_hoisted(fn));
+		CHECK(count_opcode(fn, Opcode::GET_MAPPED_UNCHECKED) == 1);
+		CHECK(count_opcode(fn, Opcode::GET_MAPPED) == 0);
+	}
+
+	// an untyped parameter could be an instance with any size() and __get_mapped().
+	const Function* sum_untyped = bytecode->get_function("sum_untyped").get();
+	CHECK(!size_hoisted(sum_untyped));
+	CHECK(count_opcode(sum_untyped, Opcode::GET_MAPPED) == 1);
+
+	// `_str[r]` of z_function is compared with `n = _str.size()` and it's a String (the size can't change).
+	ptr<Bytecode> z_function = Compiler::singleton()->compile("tests/test_files/z_function.cb");
+	const Function* z = z_function->get_function("z_function").get();
+	CHECK(count_opcode(z, Opcode::GET_MAPPED_UNCHECKED) == 2);
+	stdvec<var*> args; var str = String("aabxaab"); args.push_back(&str);
+	CHECK(VM::singleton()->call_function("z_function", z_function.get(), nullptr, args) == var(Array(0, 1, 0, 0, 3, 1, 0)));
+}
+
+TEST_CASE("[codegen_tests]:ir_coalesce") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func sq(x) { return x * x; }
+	func nested() { var a = sq(sq(3)); return a; }
+	func self_and() { var x = true; x = x && true; return x; }
+	func self_or() { var y = false; y = true || y; return y; }
+	func temps(a, b, c, d) { return (a + b) * (c + d) - (a * b + c * d); }
+	func compound(arr) { arr[0] += arr[1] * 2; return arr[0]; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "nested") == 81);
+	CHECK(_call_ir_test(bytecode, "self_and") == true);
+	CHECK(_call_ir_test(bytecode, "self_or") == true);
+	CHECK(_call_ir_test(bytecode, "temps", { 1, 2, 3, 4 }) == 7);
+	CHECK(_call_ir_test(bytecode, "compound", { Array(1, 2) }) == 5);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// the inlined parameters and return values are written to their final slot.
+	CHECK(count_opcode(bytecode->get_function("nested").get(), Opcode::ASSIGN) == 0);
+
+	// results are written to the temp of an operand (not a new one above them).
+	CHECK(bytecode->get_function("temps")->get_stack_size() == 3);
+}
+
+TEST_CASE("[codegen_tests]:ir_slots") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func phases(n) {
+		var a = [n, n]; var x = a.size();
+		var b = [x, x, x]; var y = b.size();
+		var c = [y]; return c.size() + y;
+	}
+	func iterate() { var sum = 0; for (var i : [1, 2, 3]) { var t = [i]; sum += t[0]; } return sum; }
+	func unset(n) { if (n) { var a = [n]; } var b; return b; }
+	func release(n) { var a = [n]; var x = a.size(); while (x < n) x += 1; return x; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "phases", { 1 }) == 4);
+	CHECK(_call_ir_test(bytecode, "iterate") == 6);
+	CHECK(_call_ir_test(bytecode, "unset", { 1 }).get_type() == var::_NULL);
+	CHECK(_call_ir_test(bytecode, "release", { 5 }) == 5);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// locals which aren't live at the same time share a slot.
+	CHECK(bytecode->get_function("phases")->get_stack_size() == 3);
+
+	// the array is released after it's last use instead of living till the function returns.
+	CHECK(count_opcode(bytecode->get_function("release").get(), Opcode::CLEAR) == 1);
+}
+
+TEST_CASE("[codegen_tests]:ir_operator_assign") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	class Acc {
+		var items = [];
+		func __add_eq(x) { items.append(x); }
+	}
+	class Holder { var s = "a"; var arr = [1]; }
+	func append_str(n) { var s = ""; for (var i = 0; i < n; i += 1) s += "x"; return s; }
+	func append_arr() { var a = [1, 2]; var b = a; a += [3]; a += a; return b.size(); }
+	func instance() { var acc = Acc(); var alias = acc; acc += 3; acc += 4; return alias.items.size(); }
+	func member() { var h = Holder(); h.s += "b"; h.arr += [2]; return h.s + str(h.arr.size()); }
+	func string_value() { var s = "q"; var t = s; s += "r"; return t; }
+	func number() { var n = 10; n += 0.5; n -= 0.5; n *= 2; n /= 4; return n; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "append_str", { 5 }) == "xxxxx");
+	CHECK(_call_ir_test(bytecode, "append_arr") == 6); // arrays are references.
+	CHECK(_call_ir_test(bytecode, "instance") == 2);
+	CHECK(_call_ir_test(bytecode, "member") == "ab2");
+	CHECK(_call_ir_test(bytecode, "string_value") == "q");
+	CHECK(_call_ir_test(bytecode, "number") == 5.0);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// appending to the string is in place, the counter is a number (known to the other passes).
+	const Function* append_str = bytecode->get_function("append_str").get();
+	CHECK(count_opcode(append_str, Opcode::OPERATOR_ASSIGN) == 1);
+	CHECK(count_opcode(bytecode->get_function("number").get(), Opcode::OPERATOR_ASSIGN) == 0);
+}
+
+TEST_CASE("[codegen_tests]:ir_const_literal") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func table() { var t = [[1, 2], { "a" : [3] }]; t[0].append(9); t[1]["a"].append(9); return t; }
+	func mixed() { return [1.0, 1, true]; }
+	func fresh() { var out = []; var i = 0; while (i < 3) { var a = [1]; out.append(a); i += 1; } out[0].append(2); return out; }
+)");
+
+	// each evaluation of the literal is a new container.
+	CHECK(_call_ir_test(bytecode, "table").to_string() == "[ [ 1, 2, 9 ], { \"a\" : [ 3, 9 ] } ]");
+	CHECK(_call_ir_test(bytecode, "table").to_string() == "[ [ 1, 2, 9 ], { \"a\" : [ 3, 9 ] } ]");
+	CHECK(_call_ir_test(bytecode, "fresh").to_string() == "[ [ 1, 2 ], [ 1 ], [ 1 ] ]");
+	CHECK(_call_ir_test(bytecode, "mixed").to_string() == "[ 1.000000, 1, true ]");
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	const Function* table = bytecode->get_function("table").get();
+	CHECK(count_opcode(table, Opcode::CONSTRUCT_LITERAL_CONST) == 1);
+	CHECK(count_opcode(table, Opcode::CONSTRUCT_LITERAL_ARRAY) == 0);
+	CHECK(count_opcode(table, Opcode::CONSTRUCT_LITERAL_MAP) == 0);
+}
+
+TEST_CASE("[codegen_tests]:ir_intrinsic") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func min_max(a, b) { return [min(a, b), max(a, b)]; }
+	func math(x) { return [abs(x), floor(x), sqrt(x * x), pow(x, 2)]; }
+	func sum(arr) { var s = 0; for (var i = 0; i < len(arr); i += 1) s += arr[i]; return s; }
+	func lengths(s, m) { return len(s) + len(m); }
+)");
+
+	CHECK(_call_ir_test(bytecode, "min_max", { 3, 5 }).to_string() == "[ 3, 5 ]");
+	CHECK(_call_ir_test(bytecode, "min_max", { 2.5, 1 }).to_string() == "[ 1, 2.500000 ]");
+	CHECK(_call_ir_test(bytecode, "min_max", { "b", "a" }).to_string() == "[ \"a\", \"b\" ]");
+	CHECK(_call_ir_test(bytecode, "math", { -3 }).to_string() == "[ 3, -3, 3.000000, 9.000000 ]");
+	CHECK(_call_ir_test(bytecode, "math", { -2.5 }).to_string() == "[ 2.500000, -3.000000, 2.500000, 6.250000 ]");
+	CHECK(_call_ir_test(bytecode, "sum", { Array(1, 2, 3, 4) }) == 10);
+	CHECK(_call_ir_test(bytecode, "lengths", { "abc", Map() }) == 3);
+	CHECK_THROWS(_call_ir_test(bytecode, "lengths", { 1, Map() }));
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	const Function* math = bytecode->get_function("math").get();
+	CHECK(count_opcode(math, Opcode::CALL_INTRINSIC) == 4);
+	CHECK(count_opcode(math, Opcode::CALL_BUILTIN) == 0);
+	CHECK(count_opcode(bytecode->get_function("min_max").get(), Opcode::CALL_INTRINSIC) == 2);
+}
+
+TEST_CASE("[codegen_tests]:ir_verify") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	class Point {
+		var x = 1; var y = 2;
+		static var count = 0;
+		func sum() { return x + y; }
+	}
+	func get(arr, i) { return arr[i]; }
+	func main() { return Point().sum() + get([1, 2, 3], 2); }
+)");
+
+	// every function is verified when it's generated.
+	for (auto& it : bytecode->get_functions()) CHECK(it.second->is_verified());
+	const ptr<Bytecode>& point = bytecode->get_classes().at("Point");
+	for (auto& it : point->get_functions()) CHECK(it.second->is_verified());
+	CHECK(point->get_member_initializer()->is_verified());
+	CHECK(point->get_static_initializer()->is_verified());
+
+	CHECK(_call_ir_test(bytecode, "main") == 6);
+	CHECK_THROWS(_call_ir_test(bytecode, "get", { Array(1, 2), 5 })); // the values are still checked.
+}
+
+TEST_CASE("[codegen_tests]:ir_scalar_replace") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	class Vector {
+		var x; var y;
+		func Vector(x = 0, y = 0) { this.x = x; this.y = y; }
+		func __add(other) { return Vector(x + other.x, y + other.y); }
+		func len2() { return x * x + y * y; }
+	}
+	class Vector3 : Vector { var z = 0; }
+	func add(a, b, c, d) { var v = Vector(a, b) + Vector(c, d); return [v.x, v.y]; }
+	func scale(a, k) { var v = Vector(a, a); v.x *= k; v.y = v.x + 1; return v.len2(); }
+	func escape(a) { var v = Vector(a, a); return v; }
+	func stored(a) { var v = Vector(a, 1); return [v]; }
+	func maybe_null(c) { var v; if (c) v = Vector(1, 2); return v == null; }
+	func derived() { var v = Vector3(); return v.x + v.z; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "add", { 1, 2, 3, 4 }).to_string() == "[ 4, 6 ]");
+	CHECK(_call_ir_test(bytecode, "scale", { 2, 3 }) == 85);
+	CHECK(_call_ir_test(bytecode, "escape", { 5 }).get_member("x") == 5);
+	CHECK(_call_ir_test(bytecode, "stored", { 5 })[0].get_member("y") == 1);
+	CHECK(_call_ir_test(bytecode, "maybe_null", { true }) == false);
+	CHECK(_call_ir_test(bytecode, "maybe_null", { false }) == true);
+	CHECK(_call_ir_test(bytecode, "derived") == 0);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// instances that never leave the function are kept in their member slots.
+	CHECK(count_opcode(bytecode->get_function("add").get(), Opcode::CONSTRUCT_CARBON) == 0);
+	CHECK(count_opcode(bytecode->get_function("scale").get(), Opcode::CONSTRUCT_CARBON) == 0);
+
+	// the rest are still allocated.
+	CHECK(count_opcode(bytecode->get_function("escape").get(), Opcode::CONSTRUCT_CARBON) == 1);
+	CHECK(count_opcode(bytecode->get_function("stored").get(), Opcode::CONSTRUCT_CARBON) == 1);
+	CHECK(count_opcode(bytecode->get_function("maybe_null").get(), Opcode::CONSTRUCT_CARBON) == 1);
+	CHECK(count_opcode(bytecode->get_function("derived").get(), Opcode::CONSTRUCT_CARBON) == 1);
+}
+
+TEST_CASE("[codegen_tests]:ir_typed") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func sum_to(n: int): int {
+		var total: int;
+		for (var i: int = 0; i < n; i += 1) total += i * 2;
+		return total;
+	}
+	func average(arr): float {
+		var s: float = 0;
+		for (var x : arr) s += x;
+		return s / len(arr);
+	}
+	func half(x: float) { return x / 2; }
+	func call_half(x) { return half(x); }
+	func no_return(): int { }
+	func untyped(a, b) { return a + b; }
+)");
+
+	CHECK(_call_ir_test(bytecode, "sum_to", { 5 }) == 20);
+	CHECK(_call_ir_test(bytecode, "average", { Array(1, 2) }) == 1.5);
+	CHECK(_call_ir_test(bytecode, "half", { 3 }) == 1.5); // ints are converted to float.
+	CHECK(_call_ir_test(bytecode, "untyped", { "a", "b" }) == "ab");
+
+	// the annotations are checked at runtime when the types aren't known.
+	CHECK_THROWS(_call_ir_test(bytecode, "sum_to", { 2.5 }));
+	CHECK_THROWS(_call_ir_test(bytecode, "call_half", { "1" }));
+	CHECK_THROWS(_call_ir_test(bytecode, "no_return"));
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	const Function* sum_to = bytecode->get_function("sum_to").get();
+	CHECK(count_opcode(sum_to, Opcode::OPERATOR) == 0);
+	CHECK(count_opcode(sum_to, Opcode::OPERATOR_INT) > 0);
+	CHECK(count_opcode(sum_to, Opcode::CHECK_TYPE) == 1); // only the parameter.
+	CHECK(count_opcode(bytecode->get_function("half").get(), Opcode::OPERATOR_FLOAT) == 1);
+	CHECK(count_opcode(bytecode->get_function("untyped").get(), Opcode::OPERATOR_INT) == 0);
+}
+
+TEST_CASE("[codegen_tests]:ir_return_types") {
+
+	ptr<Bytecode> bytecode = _compile_ir_test(R"(
+	func count(n) {
+		var c = 0;
+		while (n > 0) { n = n / 10; c += 1; }
+		if (c == 0) c = 1;
+		var s = 0; for (var i = 0; i < c; i += 1) s += i;
+		var t = 0; for (var j = 0; j < c; j += 1) t += j;
+		return c;
+	}
+	func twice(n) { return count(n) * 2; }
+	func any(c) { if (c) return 1; return "1"; }
+	func fact(n) { if (n <= 1) return 1; return n * fact(n - 1); }
+	func nothing() { }
+)");
+
+	CHECK(_call_ir_test(bytecode, "twice", { 12345 }) == 10);
+	CHECK(_call_ir_test(bytecode, "fact", { 5 }) == 120);
+
+	CHECK(bytecode->get_function("count")->get_return_type() == var::INT);
+	CHECK(bytecode->get_function("any")->get_return_type() == var::VAR);
+	CHECK(bytecode->get_function("fact")->get_return_type() == var::VAR); // the recursive call isn't known.
+	CHECK(bytecode->get_function("nothing")->get_return_type() == var::_NULL);
+
+	auto count_opcode = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	// the result of a call is typed without annotations.
+	const Function* twice = bytecode->get_function("twice").get();
+	CHECK(count_opcode(twice, Opcode::CALL_DIRECT) == 1);
+	CHECK(count_opcode(twice, Opcode::OPERATOR_INT) == 1);
+	CHECK(count_opcode(twice, Opcode::OPERATOR) == 0);
+}
@@ -62,6 +62,9 @@ TEST_CASE("[parser_tests]:invalid_syntax_test") {
 			static func ENUM_NAME(){}
 		}
 	)"));
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, _PARSE("var x: int = 1;")); // only locals could be annotated.
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, _PARSE("func f(a&: int) {}"));
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, _PARSE("func f() { var x: Aclass; }"));
 	CHECK_THROWS_ERR(Error::NAME_ERROR, _PARSE(R"(
 		func f() {
 			var x;
@@ -126,4 +126,49 @@ TEST_CASE("[parser_tests]:valid_syntax_test") {
 	";
 	)"));
 
-}
\ No newline at end of file
+}
+TEST_CASE("[parser_tests]:tokenizer") {
+	Tokenizer tokenizer;
+	tokenizer.tokenize("var s = \"a\\tb\\\"\"; x = 0x1F + .5 + x; if (true) return null; int", "<tokenizer-test>");
+
+	const TokenData& s = tokenizer.peek(3);
+	CHECK(s.type == Token::VALUE_STRING);
+	CHECK(s.get_constant() == "a\tb\"");
+	CHECK(s.get_pos() == Vect2i(1, 9));
+
+	const TokenData& x = tokenizer.peek(5);
+	CHECK(x.get_identifier() == "x");
+	CHECK(&x.get_identifier() == &tokenizer.peek(11).get_identifier()); // interned.
+	CHECK(tokenizer.peek(7).get_constant() == 31);
+	CHECK(tokenizer.peek(9).get_constant() == 0.5);
+	CHECK(tokenizer.peek(9).get_pos() == Vect2i(1, 30));
+
+	CHECK(tokenizer.peek(13).type == Token::KWORD_IF);
+	CHECK(tokenizer.peek(15).type == Token::VALUE_BOOL);
+	CHECK(tokenizer.peek(15).get_constant() == true);
+	CHECK(tokenizer.peek(17).type == Token::KWORD_RETURN);
+	CHECK(tokenizer.peek(18).type == Token::VALUE_NULL);
+	CHECK(tokenizer.peek(20).type == Token::BUILTIN_TYPE);
+	CHECK(tokenizer.peek(20).builtin_type == BuiltinTypes::INT);
+}
+
+TEST_CASE("[parser_tests]:node_arena") {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	tokenizer->tokenize(R"(
+		class A { var x = 1; func f(a) { if (a) { while (true) { return x; } } } }
+		func main() { for (var i : [1, 2, 3]) { var a = A(); a.f(i); } }
+	)", NO_PATH);
+	parser->parse(tokenizer);
+	analyzer->analyze(parser);
+
+	std::weak_ptr<NodeArena> arena = parser->get_arena();
+	CHECK(parser->get_arena()->get_allocated() > 0);
+	CHECK(parser->get_arena()->get_allocated() <= parser->get_arena()->get_reserved());
+
+	// the nodes are owned by the arena, the whole tree is released with the parser.
+	analyzer = nullptr;
+	parser = nullptr;
+	CHECK(arena.expired());
+}
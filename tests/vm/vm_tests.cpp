@@ -19,4 +19,493 @@ TEST_CASE("[vm_tests]:vm_tests") {
 	}
 )");
 	
-}
\ No newline at end of file
+}
+TEST_CASE("[vm_tests]:predecode") {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	CodeGen codegen;
+	_PARSE(R"(
+	func sum(n) {
+		var s = 0;
+		for (var i = 0; i < n; i += 1) {
+			if (i % 3 == 0) s += i * 2;
+			else s -= 1;
+		}
+		return s;
+	}
+	func mean(arr) {
+		var s = 0.0;
+		for (var x : arr) s += x;
+		return s / arr.size();
+	}
+	func div(a, b) { return a / b; }
+)");
+	analyzer->analyze(parser);
+	ptr<Bytecode> bytecode = codegen.generate(analyzer);
+
+	auto call = [&](const String& p_func, stdvec<var> p_args) -> var {
+		stdvec<var*> args;
+		for (var& arg : p_args) args.push_back(&arg);
+		return VM::singleton()->call_function(p_func, bytecode.get(), nullptr, args);
+	};
+
+	// the loop is predecoded while it's running, the method call is left to the interpreter.
+	CHECK(call("sum", { 1000 }) == 333000);
+	CHECK(call("mean", { Array(1, 2.5, 3, 4.5) }) == 2.75);
+
+	ptr<PredecodedFunction> predecoded = PredecodedFunction::build(bytecode->get_function("sum").get());
+	REQUIRE(predecoded != nullptr);
+	bool fused = false;
+	for (const PredecodedInstruction& instr : predecoded->get_instructions()) fused = fused || instr.op == PredecodedInstruction::COMPARE_JUMP_INT;
+	CHECK(fused);
+
+	VM::singleton()->set_predecode_enabled(false);
+	CHECK(call("sum", { 1000 }) == 333000);
+	VM::singleton()->set_predecode_enabled(true);
+
+	for (int i = 0; i < (int)PredecodedFunction::HOT_COUNT + 1; i++) call("div", { i, 2 });
+	CHECK(call("div", { 3, 2.0 }) == 1.5);
+	CHECK_THROWS(call("div", { 1, 0 }));
+	CHECK_THROWS(call("div", { "a", 1 }));
+}
+
+TEST_CASE("[vm_tests]:jit") {
+	auto compile = []() -> ptr<Bytecode> {
+		ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+		ptr<Parser> parser = newptr<Parser>();
+		ptr<Analyzer> analyzer = newptr<Analyzer>();
+		CodeGen codegen;
+		_PARSE(R"(
+		func isum(n) {
+			var s = 0;
+			for (var i = 0; i < n; i += 1) {
+				if (i % 3 == 0) s += i * 2;
+				else s -= 1;
+			}
+			return s;
+		}
+		func fsum(n) {
+			var s = 0.5; var x = 1.5;
+			for (var i = 0; i < n; i += 1) { s += x * 2.0; s -= 1.0; }
+			return s;
+		}
+		func find(arr, v) {
+			var i = 0;
+			while (i < arr.size()) { if (arr[i] == v) return i; i += 1; }
+			return -1;
+		}
+		func div_all(n, d) {
+			var s = 0;
+			for (var i = 0; i < n; i += 1) s += i / d;
+			return s;
+		}
+	)");
+		analyzer->analyze(parser);
+		return codegen.generate(analyzer);
+	};
+	ptr<Bytecode> bytecode = compile();
+
+	auto call = [&](const ptr<Bytecode>& p_bytecode, const String& p_func, stdvec<var> p_args) -> var {
+		stdvec<var*> args;
+		for (var& arg : p_args) args.push_back(&arg);
+		return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+	};
+
+#if defined(__x86_64__) && defined(__linux__)
+	ptr<PredecodedFunction> predecoded = PredecodedFunction::build(bytecode->get_function("isum").get());
+	REQUIRE(predecoded != nullptr);
+	ptr<JITFunction> jit = JITFunction::compile(predecoded.get());
+	REQUIRE(jit != nullptr);
+	CHECK(jit->get_code_size() > 0);
+#endif
+
+	// the loops are compiled while they're running, the method call and the == on any are in the stubs.
+	CHECK(call(bytecode, "isum", { 1000 }) == 333000);
+	CHECK(call(bytecode, "isum", { 10 }) == 30);
+	CHECK(call(bytecode, "fsum", { 1000 }) == 2000.5);
+	CHECK(call(bytecode, "find", { Array(1, 2, "x", 4.5), "x" }) == 2);
+	for (int i = 0; i < (int)PredecodedFunction::HOT_COUNT; i++) call(bytecode, "find", { Array(1, 2), 3 });
+	CHECK(call(bytecode, "find", { Array(1, 2, 3), 3 }) == 2);
+
+	// the errors of the stubs are thrown by the VM, the code runs again after them.
+	CHECK(call(bytecode, "div_all", { 1000, 2 }) == 249500);
+	try {
+		call(bytecode, "div_all", { 10, 0 });
+		CHECK(false);
+	} catch (Throwable& err) {
+		const Throwable* error = &err;
+		while (error->_get_nested() != nullptr) error = error->_get_nested();
+		CHECK(error->get_type() == Error::ZERO_DIVISION);
+		REQUIRE(err.get_kind() == Throwable::TRACEBACK);
+		CHECK(static_cast<const TraceBack&>(err).get_cb_dbg_info().line == 22); // the line of the division.
+	}
+	CHECK_THROWS(call(bytecode, "div_all", { 10, "a" }));
+	CHECK(call(bytecode, "div_all", { 1000, 2 }) == 249500);
+	CHECK(call(bytecode, "div_all", { 4, 2.0 }) == 3.0);
+
+	VM::singleton()->set_jit_enabled(false);
+	ptr<Bytecode> predecoded_only = compile();
+	CHECK(call(predecoded_only, "isum", { 1000 }) == 333000);
+	CHECK(call(predecoded_only, "fsum", { 1000 }) == 2000.5);
+	VM::singleton()->set_jit_enabled(true);
+}
+
+static int _native_calls = 0;
+static bool _native_twice(var** p_frame, int p_index, uint32_t& r_ip, var& r_ret) {
+	_native_calls++;
+	r_ret = 42;
+	return true;
+}
+
+TEST_CASE("[vm_tests]:aot") {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	CodeGen codegen;
+	_PARSE(R"(
+	func twice(x) { var y = x * 2; return y; }
+	class A { func f(n) { var i = 0; while (i < n) i += 1; return i; } }
+)");
+	analyzer->analyze(parser);
+	ptr<Bytecode> bytecode = codegen.generate(analyzer);
+
+	String src = AOTModule::write(bytecode.get());
+	CHECK(src.find("carbon_aot_module") >= 0);
+	CHECK(src.find("\"twice\"") >= 0);
+	CHECK(src.find("\"A.f\"") >= 0);
+
+	auto call = [&](stdvec<var> p_args) -> var {
+		stdvec<var*> args;
+		for (var& arg : p_args) args.push_back(&arg);
+		return VM::singleton()->call_function("twice", bytecode.get(), nullptr, args);
+	};
+	CHECK(call({ 3 }) == 6);
+
+	// written from other opcodes, it's interpreted.
+	AOTModule stale;
+	stale.add("twice", AOTModule::hash(bytecode->get_function("twice").get()) + 1, _native_twice);
+	CHECK(stale.apply(bytecode.get()) == 0);
+
+	AOTModule module;
+	module.add("twice", AOTModule::hash(bytecode->get_function("twice").get()), _native_twice);
+	CHECK(module.apply(bytecode.get()) == 1);
+	CHECK(call({ 3 }) == 42);
+	CHECK(_native_calls == 1);
+}
+
+TEST_CASE("[vm_tests]:imports") {
+	// a.cb and b.cb both import c.cb, the imports are relative to the importing file.
+	Compiler::singleton()->set_thread_count(4);
+	ptr<Bytecode> bytecode = Compiler::singleton()->compile("tests/test_files/imports/main.cb");
+	stdvec<var*> args;
+	CHECK(VM::singleton()->call_function("value", bytecode.get(), nullptr, args) == 203);
+	CHECK(Compiler::singleton()->compile("tests/test_files/imports/main.cb") == bytecode);
+
+	CHECK_THROWS_ERR(Error::IO_ERROR, Compiler::singleton()->compile("tests/test_files/imports/cyclic_a.cb"));
+	CHECK_THROWS_ERR(Error::IO_ERROR, Compiler::singleton()->compile("tests/test_files/imports/cyclic_a.cb"));
+	Compiler::singleton()->set_thread_count(0);
+}
+
+TEST_CASE("[vm_tests]:bytecode_cache") {
+	const char* cache_path = "tests/test_files/bytecode_cache_test.cbc";
+	auto get_import = [](const String& p_path) -> ptr<Bytecode> { return Compiler::singleton()->compile(p_path); };
+	auto call = [](ptr<Bytecode> p_bytecode, const String& p_func) -> var {
+		stdvec<var*> args;
+		return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+	};
+
+	// the constants, enums, initializers and direct calls of a file written and loaded back.
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	CodeGen codegen;
+	_PARSE(R"(
+	enum E { V1 = 2, V2 }
+	enum { ONE = 1 }
+	const C = 1 + 2;
+	var count = C * 2;
+	class A {
+		var x = 10;
+		func A(y) { x += y; }
+		func get() { return x; }
+	}
+	class B : A {
+		func B() { super(E.V2); }
+	}
+	func helper(a, b = 4) { return a * b + ONE; }
+	func literals() { return [1, "two", 3.5, { "k" : [true, null] }]; }
+	func value() { return helper(2) + B().get() + count; }
+)");
+	analyzer->analyze(parser);
+	ptr<Bytecode> bytecode = codegen.generate(analyzer);
+
+	BytecodeCache::Header header;
+	header.source_hash = 1;
+	header.hash = 2;
+	header.import_paths = { "lib.cb" };
+	BytecodeCache::save(cache_path, header, bytecode.get());
+
+	BytecodeCache::Header read;
+	CHECK(BytecodeCache::read_header(cache_path, &read));
+	CHECK(read.source_hash == 1);
+	CHECK(read.hash == 2);
+	CHECK(read.import_paths == header.import_paths);
+
+	ptr<Bytecode> loaded = BytecodeCache::load(cache_path, get_import);
+	CHECK(loaded->get_class("B")->get_base_binary() == loaded->get_class("A"));
+	CHECK(loaded->get_constant("C") == 3);
+	CHECK(loaded->get_function("helper")->get_default_args() == bytecode->get_function("helper")->get_default_args());
+	CHECK(loaded->get_function("value")->get_opcodes() == bytecode->get_function("value")->get_opcodes());
+	CHECK(call(loaded, "value") == call(bytecode, "value"));
+	CHECK(call(loaded, "literals").to_string() == call(bytecode, "literals").to_string());
+
+	// an extern base class is written as the name of it's import.
+	ptr<Bytecode> main = Compiler::singleton()->compile("tests/test_files/imports/main.cb");
+	BytecodeCache::save(cache_path, header, main.get());
+	loaded = BytecodeCache::load(cache_path, get_import);
+	CHECK(loaded->get_class("Derived")->get_base_binary() == main->get_import("a")->get_class("Base"));
+	CHECK(call(loaded, "value") == 203);
+
+	// a file which isn't a cache of this version, and a truncated one.
+	CHECK_FALSE(BytecodeCache::read_header("tests/test_files/imports/main.cb", &read));
+	File file(cache_path, File::WRITE);
+	file.write_text(String("CBC"));
+	file.close();
+	CHECK_FALSE(BytecodeCache::read_header(cache_path, &read));
+	CHECK_THROWS_ERR(Error::IO_ERROR, BytecodeCache::load(cache_path, get_import));
+	std::remove(cache_path);
+}
+
+TEST_CASE("[vm_tests]:recompile") {
+	const char* path = "tests/test_files/recompile_test.cb";
+	auto write = [&](const char* p_source) {
+		File file(path, File::WRITE);
+		file.write_text(p_source);
+		file.close();
+	};
+	auto call = [](ptr<Bytecode> p_bytecode, const String& p_func) -> var {
+		stdvec<var*> args;
+		return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+	};
+
+	write(R"(
+class A {
+	func get() { return 1; }
+}
+func f() { return 2; }
+func g() { return f() * 10; }
+func h() { return A().get(); }
+)");
+	ptr<Bytecode> bytecode = Compiler::singleton()->compile(path, false);
+	const Function* g = bytecode->get_function("g").get();
+	const Function* h = bytecode->get_function("h").get();
+	stdvec<uint32_t> h_opcodes = h->get_opcodes();
+	uint32_t h_line = h->get_op_dbg().begin()->second;
+	CHECK(call(bytecode, "g") == 20);
+
+	// only f is changed, g is generated again as it could have inlined f, h is moved a line down.
+	write(R"(
+class A {
+	func get() { return 1; }
+}
+func f() {
+	return 3;
+}
+func g() { return f() * 10; }
+func h() { return A().get(); }
+)");
+	CHECK(Compiler::singleton()->compile(path, false) == bytecode);
+	CHECK(bytecode->get_function("g").get() == g);
+	CHECK(call(bytecode, "g") == 30);
+	CHECK(h->get_opcodes() == h_opcodes);
+	CHECK(h->get_op_dbg().begin()->second == h_line + 2);
+
+	// a method of a class.
+	write(R"(
+class A {
+	func get() { return 4; }
+}
+func f() {
+	return 3;
+}
+func g() { return f() * 10; }
+func h() { return A().get(); }
+)");
+	CHECK(Compiler::singleton()->compile(path, false) == bytecode);
+	CHECK(call(bytecode, "h") == 4);
+
+	// a syntax error keeps the last bytecode, a declaration change is a new one.
+	write("func f() { return ; ; }}");
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, Compiler::singleton()->compile(path, false));
+	CHECK(Compiler::singleton()->compile(path) == bytecode);
+	write(R"(
+var x = 5;
+func f() { return x; }
+)");
+	ptr<Bytecode> other = Compiler::singleton()->compile(path, false);
+	CHECK(other != bytecode);
+	CHECK(call(other, "f") == 5);
+	std::remove(path);
+}
+
+TEST_CASE("[vm_tests]:compile_string") {
+	auto call = [](ptr<Bytecode> p_bytecode, const String& p_func) -> var {
+		stdvec<var*> args;
+		return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+	};
+	Compiler* compiler = Compiler::singleton();
+	compiler->clear_string_cache();
+	compiler->set_string_cache_capacity(2);
+
+	ptr<Bytecode> a = compiler->compile_string("func f() { return 1; }");
+	CHECK(call(a, "f") == 1);
+	CHECK(compiler->compile_string("func f() { return 1; }") == a);
+
+	// the least recently used one is evicted.
+	ptr<Bytecode> b = compiler->compile_string("func f() { return 2; }");
+	CHECK(compiler->compile_string("func f() { return 1; }") == a);
+	ptr<Bytecode> c = compiler->compile_string("func f() { return 3; }");
+	CHECK(call(c, "f") == 3);
+	CHECK(compiler->compile_string("func f() { return 1; }") == a);
+	CHECK(compiler->compile_string("func f() { return 2; }") != b);
+	CHECK(compiler->compile_string("func f() { return 1; }", "other.cb") != a); // the path is a part of the key.
+
+	Compiler::StringCacheStats stats = compiler->get_string_cache_stats();
+	CHECK(stats.hits == 3);
+	CHECK(stats.misses == 5);
+	CHECK(stats.evictions == 3);
+	CHECK(stats.size == 2);
+
+	// the imports are relative to the path, a compile error isn't cached.
+	const char* source = R"(
+import c = "c.cb";
+func f() { return c.fc() + 1; }
+)";
+	ptr<Bytecode> d = compiler->compile_string(source, "tests/test_files/imports/<string-source>");
+	CHECK(call(d, "f") == 101);
+	CHECK(compiler->compile_string(source, "tests/test_files/imports/<string-source>") == d);
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, compiler->compile_string("func f() { return ; ; }}"));
+	CHECK_THROWS_ERR(Error::SYNTAX_ERROR, compiler->compile_string("func f() { return ; ; }}"));
+	CHECK(compiler->get_string_cache_stats().size == 2);
+
+	compiler->set_string_cache_capacity(0);
+	CHECK(compiler->get_string_cache_stats().size == 0);
+	CHECK(compiler->compile_string(source, "tests/test_files/imports/<string-source>") != d);
+	compiler->clear_string_cache();
+	compiler->set_string_cache_capacity(64);
+}
+
+TEST_CASE("[vm_tests]:profile") {
+	const char* source = R"(
+	func sum(arr) {
+		var s = 0;
+		for (var x : arr) s = s + x;
+		return s;
+	}
+	func name(x) { return x.upper(); }
+)";
+	auto generate = [&]() -> ptr<Bytecode> {
+		ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+		ptr<Parser> parser = newptr<Parser>();
+		ptr<Analyzer> analyzer = newptr<Analyzer>();
+		CodeGen codegen;
+		_PARSE(source);
+		analyzer->analyze(parser);
+		return codegen.generate(analyzer);
+	};
+	auto call = [&](ptr<Bytecode> p_bytecode, const String& p_func, var p_arg) -> var {
+		stdvec<var*> args = { &p_arg };
+		return VM::singleton()->call_function(p_func, p_bytecode.get(), nullptr, args);
+	};
+	auto count = [](const Function* p_func, Opcode p_opcode) -> int {
+		int count = 0;
+		const stdvec<uint32_t>& opcodes = p_func->get_opcodes();
+		for (uint32_t ip = 0; ip < opcodes.size(); ip += IRInstruction::get_size(opcodes, ip)) {
+			if (opcodes[ip] == p_opcode) count++;
+		}
+		return count;
+	};
+
+	ptr<Bytecode> bytecode = generate();
+	ptr<Profile> profile = newptr<Profile>();
+	VM::singleton()->set_profile(profile);
+	CHECK(call(bytecode, "sum", Array(1, 2, 3)) == 6);
+	CHECK(call(bytecode, "name", String("carbon")) == "CARBON");
+	VM::singleton()->set_profile(nullptr);
+
+	bool found_operator = false, found_method = false;
+	for (const auto& func : profile->get_functions()) {
+		for (const auto& site : func.second.sites) {
+			if (site.second.kind == Profile::OPERATOR) found_operator = found_operator || site.second.histogram.at("int,int") == 3;
+			if (site.second.kind == Profile::CALL_METHOD) found_method = found_method || site.second.histogram.count("String.upper") == 1;
+		}
+	}
+	CHECK(found_operator);
+	CHECK(found_method);
+
+	// the next run compiles the same source and specializes it with the profile.
+	ptr<Bytecode> next = generate();
+	const Function* sum = next->get_function("sum").get();
+	int generic = count(sum, Opcode::OPERATOR);
+	CHECK(profile->apply(next.get()) == 1);
+	CHECK(count(sum, Opcode::OPERATOR) == generic - 1);
+	CHECK(count(sum, Opcode::OPERATOR_INT) == 1);
+	CHECK(Profile::hash(sum) == Profile::hash(bytecode->get_function("sum").get()));
+	CHECK(call(next, "sum", Array(1, 2.5)) == 3.5); // not an int anymore, it's the generic operator.
+}
+
+TEST_CASE("[vm_tests]:inline traceback") {
+	ptr<Tokenizer> tokenizer = newptr<Tokenizer>();
+	ptr<Parser> parser = newptr<Parser>();
+	ptr<Analyzer> analyzer = newptr<Analyzer>();
+	CodeGen codegen;
+	_PARSE(R"(func at(arr) {
+	var i = 5;
+	return arr[i];
+}
+class P {
+	var x;
+	func P(a) { this.x = a[3]; }
+	func get() { return this.x; }
+}
+func main() {
+	println(at([1, 2, 3]));
+}
+func make() {
+	var p = P([1]);
+	return p.get();
+}
+)");
+	analyzer->analyze(parser);
+	ptr<Bytecode> bytecode = codegen.generate(analyzer);
+
+	// the frames (function and line) from the outermost one.
+	auto trace = [&](const String& p_func) -> stdvec<std::pair<std::string, uint32_t>> {
+		stdvec<std::pair<std::string, uint32_t>> frames;
+		try {
+			stdvec<var*> args;
+			VM::singleton()->call_function(p_func, bytecode.get(), nullptr, args);
+		} catch (Throwable& err) {
+			for (const Throwable* frame = &err; frame != nullptr; frame = frame->_get_nested()) {
+				if (frame->get_kind() != Throwable::TRACEBACK) continue;
+				const DBGSourceInfo& info = static_cast<const TraceBack*>(frame)->get_cb_dbg_info();
+				frames.push_back({ info.func, info.line });
+			}
+		}
+		return frames;
+	};
+
+	// both of the calls are inlined, an error in them still has the callee's frame.
+	CHECK(bytecode->get_function("main")->get_inline_sites().size() == 1);
+	stdvec<std::pair<std::string, uint32_t>> frames = trace("main");
+	REQUIRE(frames.size() == 2);
+	CHECK(frames[0] == std::make_pair(std::string("main"), (uint32_t)11));
+	CHECK(frames[1] == std::make_pair(std::string("at"), (uint32_t)3));
+
+	CHECK(bytecode->get_function("make")->get_inline_sites().size() >= 1);
+	frames = trace("make");
+	REQUIRE(frames.size() == 2);
+	CHECK(frames[0] == std::make_pair(std::string("make"), (uint32_t)14));
+	CHECK(frames[1] == std::make_pair(std::string("P.P"), (uint32_t)7));
+}